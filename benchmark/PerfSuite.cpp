@@ -0,0 +1,932 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: PerfSuite.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// The performance regression suite: a separate program from Numbers that times the library's hot paths
+//  (integer formatting, float decoding, dot products) and writes machine-readable results.
+// Numbers --benchmark prints a quick table for a person to read; this program is for builds and scripts.
+// It follows the command line and the JSON layout of Google Benchmark, so its output works with the
+//  tools written for that library (compare.py, CI dashboards), without depending on it:
+//   --benchmark_filter=<regex>           run only the benchmarks whose name matches
+//   --benchmark_min_time=<seconds>       time each benchmark for at least this long (default 0.5)
+//   --benchmark_repetitions=<n>          measure each benchmark n times and report the median as well
+//   --benchmark_out=<file>               also write the results to file as JSON
+//   --benchmark_format=<console|json>    the format written to standard output
+//   --benchmark_list_tests               print the benchmark names and exit
+//   --benchmark_baseline=<file>          compare against the JSON written by an earlier run (on standard error
+//                                        with --benchmark_format=json); the exit status is 1 on a regression
+//   --benchmark_regression_threshold=<f>  the slowdown that counts as a regression (default 0.10)
+// The CMake build makes one copy of this program per -march variant (see CMakeLists.txt),
+//  so the same suite shows what a wider baseline instruction set buys.
+
+#include "../header/Bits.h"
+#include "../header/CpuFeatures.h"
+#include "../header/Decimal.h"
+#include "../header/FloatCompare.h"
+#include "../header/FloatDecode.h"
+#include "../header/FloatFormat.h"
+#include "../header/FloatMath.h"
+#include "../header/MiniFloat.h"
+#include "../header/ParallelFor.h"
+#include "../header/Radix.h"
+#include "../header/Summation.h"
+#include "../header/VarInt.h"
+#include "../header/Vec3Batch.h"
+#include "../header/WideInt.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+// Set by the build to the -march value this copy was compiled with.
+#ifndef NUMBERS_MARCH
+#define NUMBERS_MARCH "default"
+#endif
+
+namespace
+{
+	// Results are written here so the compiler cannot discard the work being timed.
+	volatile uint64_t g_sink;
+
+	struct Benchmark {
+		std::string name;
+		size_t items;                 // items processed by one call of body
+		size_t bytes;                 // bytes read by one call of body (0 if not meaningful)
+		std::function<void()> body;
+	};
+
+	struct Run {
+		std::string name;
+		uint64_t iterations;
+		double realTime;              // nanoseconds per iteration
+		double cpuTime;
+		double itemsPerSecond;
+		double bytesPerSecond;
+		int repetitionIndex;          // -1 for the median of the repetitions
+	};
+
+	struct Options {
+		std::string filter = ".";
+		double minTime = 0.5;
+		int repetitions = 1;
+		std::string out;
+		bool json = false;
+		bool list = false;
+		std::string baseline;
+		double threshold = 0.10;
+	};
+
+	// Every input is sized to stay in L2 cache, so the suite measures the kernels rather than memory bandwidth.
+	const size_t Count = 1 << 14;
+
+	// ---------------------------------------------------------------- integer formatting
+
+	void AddIntegerFormatting(std::vector<Benchmark>& benchmarks)
+	{
+		// Random magnitudes from 1 to 20 digits, the mix a log writer or serializer sees.
+		auto values = std::make_shared<std::vector<uint64_t>>(Count);
+		std::mt19937_64 rng(1);
+		for (uint64_t& value : *values)
+			value = rng() >> (rng() % 64);
+		for (unsigned base : { 10u, 16u })
+		{
+			auto text = std::make_shared<std::vector<char>>(Count * Radix_MaxChars);
+			auto lengths = std::make_shared<std::vector<size_t>>(Count);
+			std::string suffix = "/base" + std::to_string(base);
+			benchmarks.push_back({ "Radix_Format" + suffix, Count, 0, [=] {
+				for (size_t i = 0; i < Count; ++i)
+					(*lengths)[i] = Radix_Format((*values)[i], base, &(*text)[i * Radix_MaxChars], Radix_MaxChars);
+				g_sink = (*lengths)[Count - 1];
+			} });
+			benchmarks.push_back({ "Radix_Parse" + suffix, Count, 0, [=] {
+				uint64_t sum = 0;
+				for (size_t i = 0; i < Count; ++i)
+				{
+					uint64_t value = 0;
+					Radix_Parse(&(*text)[i * Radix_MaxChars], (*lengths)[i], base, value);
+					sum += value;
+				}
+				g_sink = sum;
+			} });
+			// The parse benchmark reads what the format benchmark wrote; format once now so it can run alone.
+			for (size_t i = 0; i < Count; ++i)
+				(*lengths)[i] = Radix_Format((*values)[i], base, &(*text)[i * Radix_MaxChars], Radix_MaxChars);
+		}
+		auto fixed = std::make_shared<std::vector<char>>(Count * 16);
+		Radix_FormatHex64Batch(values->data(), Count, fixed->data());
+		benchmarks.push_back({ "Radix_FormatHex64Batch", Count, Count * 8, [=] {
+			Radix_FormatHex64Batch(values->data(), Count, fixed->data());
+			g_sink = uint8_t((*fixed)[0]);
+		} });
+		auto parsed = std::make_shared<std::vector<uint64_t>>(Count);
+		benchmarks.push_back({ "Radix_ParseHex64Batch", Count, Count * 16, [=] {
+			g_sink = Radix_ParseHex64Batch(fixed->data(), Count, parsed->data());
+		} });
+
+		auto wide = std::make_shared<std::vector<UInt256>>(Count / 16);
+		for (UInt256& value : *wide)
+			for (unsigned word = 0; word < 4; ++word)
+				value.SetWord(word, rng());
+		benchmarks.push_back({ "WideInt_Format/base10/UInt256", wide->size(), 0, [=] {
+			char buffer[WideInt_MaxChars<256>::value];
+			size_t total = 0;
+			for (const UInt256& value : *wide)
+				total += WideInt_Format(value, 10, buffer, sizeof(buffer));
+			g_sink = total;
+		} });
+	}
+
+	// ---------------------------------------------------------------- float decoding
+
+	void AddFloatDecoding(std::vector<Benchmark>& benchmarks)
+	{
+		// Every bit pattern is equally likely, so all five categories and both signs appear.
+		std::mt19937 rng(2);
+		auto floats = std::make_shared<std::vector<float>>(Count);
+		for (float& value : *floats)
+		{
+			uint32_t bits = rng();
+			std::memcpy(&value, &bits, sizeof(value));
+		}
+		auto doubles = std::make_shared<std::vector<double>>(Count);
+		for (double& value : *doubles)
+		{
+			uint64_t bits = (uint64_t(rng()) << 32) | rng();
+			std::memcpy(&value, &bits, sizeof(value));
+		}
+		auto signs = std::make_shared<std::vector<uint8_t>>(Count);
+		auto exponents = std::make_shared<std::vector<uint16_t>>(Count);
+		auto floatExponents = std::make_shared<std::vector<uint8_t>>(Count);
+		auto floatSignificands = std::make_shared<std::vector<uint32_t>>(Count);
+		auto significands = std::make_shared<std::vector<uint64_t>>(Count);
+
+		benchmarks.push_back({ "FloatDecode_Split/float", Count, Count * sizeof(float), [=] {
+			FloatCategoryCounts counts;
+			FloatDecode_Split(floats->data(), Count, signs->data(), floatExponents->data(), floatSignificands->data(), &counts);
+			g_sink = counts.normal;
+		} });
+		benchmarks.push_back({ "FloatDecode_Split/double", Count, Count * sizeof(double), [=] {
+			FloatCategoryCounts counts;
+			FloatDecode_Split(doubles->data(), Count, signs->data(), exponents->data(), significands->data(), &counts);
+			g_sink = counts.normal;
+		} });
+		benchmarks.push_back({ "FloatDecode_Count/float", Count, Count * sizeof(float), [=] {
+			g_sink = FloatDecode_Count(floats->data(), Count).normal;
+		} });
+		benchmarks.push_back({ "FloatDecode_Count/double", Count, Count * sizeof(double), [=] {
+			g_sink = FloatDecode_Count(doubles->data(), Count).normal;
+		} });
+
+		// Decoding text: shortest round-trip formatting and parsing it back.
+		auto text = std::make_shared<std::vector<char>>(Count * FloatFormat_MaxChars);
+		auto lengths = std::make_shared<std::vector<size_t>>(Count);
+		for (size_t i = 0; i < Count; ++i)
+			(*lengths)[i] = FloatFormat_Shortest((*doubles)[i], &(*text)[i * FloatFormat_MaxChars], FloatFormat_MaxChars);
+		benchmarks.push_back({ "FloatFormat_Shortest/float", Count, 0, [=] {
+			char buffer[FloatFormat_MaxChars];
+			size_t total = 0;
+			for (float value : *floats)
+				total += FloatFormat_Shortest(value, buffer, sizeof(buffer));
+			g_sink = total;
+		} });
+		benchmarks.push_back({ "FloatFormat_Shortest/double", Count, 0, [=] {
+			char buffer[FloatFormat_MaxChars];
+			size_t total = 0;
+			for (double value : *doubles)
+				total += FloatFormat_Shortest(value, buffer, sizeof(buffer));
+			g_sink = total;
+		} });
+		benchmarks.push_back({ "FloatFormat_Parse/double", Count, 0, [=] {
+			uint64_t hash = 0;
+			for (size_t i = 0; i < Count; ++i)
+			{
+				double value = 0;
+				FloatFormat_Parse(&(*text)[i * FloatFormat_MaxChars], (*lengths)[i], value);
+				uint64_t bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+				hash ^= bits;
+			}
+			g_sink = hash;
+		} });
+	}
+
+	// ---------------------------------------------------------------- dot products
+
+	const char* KernelName(Vec3Kernel kernel)
+	{
+		switch (kernel)
+		{
+		case Vec3Kernel::Scalar: return "scalar";
+		case Vec3Kernel::SSE2: return "sse2";
+		case Vec3Kernel::AVX2: return "avx2";
+		default: return "auto";
+		}
+	}
+
+	const char* KernelName(FloatMathKernel kernel)
+	{
+		switch (kernel)
+		{
+		case FloatMathKernel::Scalar: return "scalar";
+		case FloatMathKernel::SSE2: return "sse2";
+		case FloatMathKernel::AVX2: return "avx2";
+		default: return "auto";
+		}
+	}
+
+	const char* KernelName(FloatCompareKernel kernel)
+	{
+		switch (kernel)
+		{
+		case FloatCompareKernel::Scalar: return "scalar";
+		case FloatCompareKernel::AVX2: return "avx2";
+		default: return "auto";
+		}
+	}
+
+	const char* KernelName(SumKernel kernel)
+	{
+		switch (kernel)
+		{
+		case SumKernel::Scalar: return "scalar";
+		case SumKernel::SSE2: return "sse2";
+		case SumKernel::AVX2: return "avx2";
+		default: return "auto";
+		}
+	}
+
+	void AddDotProducts(std::vector<Benchmark>& benchmarks)
+	{
+		std::mt19937 rng(3);
+		std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+		auto points = std::make_shared<vec3SoA>();
+		points->resize(Count);
+		for (size_t i = 0; i < Count; ++i)
+		{
+			points->x[i] = coordinate(rng);
+			points->y[i] = coordinate(rng);
+			points->z[i] = coordinate(rng);
+		}
+		auto out = std::make_shared<std::vector<float>>(Count);
+		const vec3 normal = { 0.48f, 0.6f, 0.64f };
+
+		// Kernels the processor lacks are left out rather than timed as the scalar fallback under another name.
+		for (Vec3Kernel kernel : { Vec3Kernel::Scalar, Vec3Kernel::SSE2, Vec3Kernel::AVX2 })
+		{
+			if (!Vec3_KernelSupported(kernel))
+				continue;
+			benchmarks.push_back({ std::string("Vec3_DotProductBatch/") + KernelName(kernel), Count, Count * 3 * sizeof(float), [=] {
+				Vec3_DotProductBatch(*points, normal, out->data(), kernel);
+				g_sink = uint64_t((*out)[Count - 1]);
+			} });
+		}
+
+		const struct { SumMethod method; const char* name; } methods[] = {
+			{ SumMethod::Naive, "naive" },
+			{ SumMethod::Kahan, "kahan" },
+			{ SumMethod::Neumaier, "neumaier" },
+			{ SumMethod::Pairwise, "pairwise" },
+			{ SumMethod::Cascaded, "cascaded" },
+		};
+		for (SumKernel kernel : { SumKernel::Scalar, SumKernel::AVX2 })
+		{
+			if (!Sum_KernelSupported(kernel))
+				continue;
+			for (const auto& m : methods)
+			{
+				SumMethod method = m.method;
+				benchmarks.push_back({ std::string("Sum_DotProduct/") + m.name + "/" + KernelName(kernel), Count, Count * 2 * sizeof(float), [=] {
+					g_sink = uint64_t(Sum_DotProduct(points->x.data(), points->y.data(), Count, method, kernel));
+				} });
+			}
+		}
+	}
+
+	// ---------------------------------------------------------------- bitmaps
+
+	const char* KernelName(BitsCountKernel kernel)
+	{
+		switch (kernel)
+		{
+		case BitsCountKernel::Portable: return "portable";
+		case BitsCountKernel::Hardware: return "popcnt";
+		case BitsCountKernel::AVX2: return "avx2";
+		default: return "auto";
+		}
+	}
+
+	const char* KernelName(BitsDepositKernel kernel)
+	{
+		switch (kernel)
+		{
+		case BitsDepositKernel::Portable: return "portable";
+		case BitsDepositKernel::Hardware: return "bmi2";
+		default: return "auto";
+		}
+	}
+
+	void AddBitmaps(std::vector<Benchmark>& benchmarks)
+	{
+		std::mt19937_64 rng(6);
+		auto rows = std::make_shared<std::vector<uint64_t>>(Count);
+		auto other = std::make_shared<std::vector<uint64_t>>(Count);
+		auto out = std::make_shared<std::vector<uint64_t>>(Count);
+		for (size_t i = 0; i < Count; ++i)
+		{
+			(*rows)[i] = rng() & rng();
+			(*other)[i] = rng();
+		}
+
+		for (BitsCountKernel kernel : { BitsCountKernel::Portable, BitsCountKernel::Hardware, BitsCountKernel::AVX2 })
+		{
+			if (!Bits_KernelSupported(kernel))
+				continue;
+			benchmarks.push_back({ std::string("Bits_PopCountArray/") + KernelName(kernel), Count, Count * sizeof(uint64_t), [=] {
+				g_sink = Bits_PopCountArray(rows->data(), Count, kernel);
+			} });
+			benchmarks.push_back({ std::string("Bits_PopCountAnd/") + KernelName(kernel), Count, Count * 2 * sizeof(uint64_t), [=] {
+				g_sink = Bits_PopCountAnd(rows->data(), other->data(), Count, kernel);
+			} });
+		}
+		for (BitsDepositKernel kernel : { BitsDepositKernel::Portable, BitsDepositKernel::Hardware })
+			if (Bits_KernelSupported(kernel))
+				benchmarks.push_back({ std::string("Bits_ExtractArray/") + KernelName(kernel), Count, Count * sizeof(uint64_t), [=] {
+					Bits_ExtractArray(rows->data(), Count, 0x00FF00FF00FF00FFull, out->data(), kernel);
+					g_sink = (*out)[Count - 1];
+				} });
+	}
+
+	// ---------------------------------------------------------------- elementary functions
+
+	void AddFloatMath(std::vector<Benchmark>& benchmarks)
+	{
+		std::mt19937 rng(8);
+		std::uniform_real_distribution<float> positive(0.001f, 1000.0f), angle(-10.0f, 10.0f), exponent(-80.0f, 80.0f);
+		auto positives = std::make_shared<std::vector<float>>(Count);
+		auto angles = std::make_shared<std::vector<float>>(Count);
+		auto exponents = std::make_shared<std::vector<float>>(Count);
+		auto out = std::make_shared<std::vector<float>>(Count);
+		auto normals = std::make_shared<vec3SoA>();
+		normals->resize(Count);
+		for (size_t i = 0; i < Count; ++i)
+		{
+			(*positives)[i] = positive(rng);
+			(*angles)[i] = angle(rng);
+			(*exponents)[i] = exponent(rng);
+			normals->x[i] = angle(rng);
+			normals->y[i] = angle(rng);
+			normals->z[i] = angle(rng);
+		}
+
+		typedef void (*Batch)(const float*, size_t, float*, FloatMathKernel);
+		const struct { const char* name; Batch batch; std::shared_ptr<std::vector<float>> in; } functions[] = {
+			{ "FloatMath_Rsqrt", FloatMath_Rsqrt, positives },
+			{ "FloatMath_Sqrt", FloatMath_Sqrt, positives },
+			{ "FloatMath_Exp", FloatMath_Exp, exponents },
+			{ "FloatMath_Log", FloatMath_Log, positives },
+			{ "FloatMath_Sin", FloatMath_Sin, angles },
+			{ "FloatMath_Cos", FloatMath_Cos, angles },
+		};
+		for (FloatMathKernel kernel : { FloatMathKernel::Scalar, FloatMathKernel::SSE2, FloatMathKernel::AVX2 })
+		{
+			if (!FloatMath_KernelSupported(kernel))
+				continue;
+			for (const auto& f : functions)
+			{
+				Batch batch = f.batch;
+				auto in = f.in;
+				benchmarks.push_back({ std::string(f.name) + "/" + KernelName(kernel), Count, Count * sizeof(float), [=] {
+					batch(in->data(), Count, out->data(), kernel);
+					g_sink = static_cast<uint64_t>((*out)[Count - 1]);
+				} });
+			}
+			// Normalizing an already normalized batch gives it back, to within rounding, so it can run in place.
+			benchmarks.push_back({ std::string("Vec3_NormalizeBatch/") + KernelName(kernel), Count, Count * 3 * sizeof(float), [=] {
+				Vec3_NormalizeBatch(*normals, kernel);
+				g_sink = static_cast<uint64_t>(normals->x[Count - 1] * 1000.0f);
+			} });
+		}
+	}
+
+	// ---------------------------------------------------------------- decimal fixed point
+
+	const char* KernelName(DecimalKernel kernel)
+	{
+		switch (kernel)
+		{
+		case DecimalKernel::Scalar: return "scalar";
+		case DecimalKernel::AVX2: return "avx2";
+		default: return "auto";
+		}
+	}
+
+	void AddDecimals(std::vector<Benchmark>& benchmarks)
+	{
+		// Ledger amounts of up to 100,000.00 times quantities of up to 1,000.00.
+		typedef Decimal64<2> Money;
+		std::mt19937 rng(11);
+		std::uniform_int_distribution<int64_t> cents(-10000000, 10000000), quantity(1, 100000);
+		auto amounts = std::make_shared<std::vector<Money>>(Count);
+		auto quantities = std::make_shared<std::vector<Money>>(Count);
+		auto products = std::make_shared<std::vector<Money>>(Count);
+		for (size_t i = 0; i < Count; ++i)
+		{
+			(*amounts)[i] = Money::FromUnits(cents(rng));
+			(*quantities)[i] = Money::FromUnits(quantity(rng));
+		}
+
+		benchmarks.push_back({ "Decimal_Multiply/loop", Count, Count * 2 * sizeof(Money), [=] {
+			for (size_t i = 0; i < Count; ++i)
+				(*products)[i] = Decimal_Multiply((*amounts)[i], (*quantities)[i]);
+			g_sink = static_cast<uint64_t>((*products)[Count - 1].Units());
+		} });
+		for (DecimalKernel kernel : { DecimalKernel::Scalar, DecimalKernel::AVX2 })
+		{
+			if (!Decimal_KernelSupported(kernel))
+				continue;
+			benchmarks.push_back({ std::string("Decimal_MultiplyBatch/") + KernelName(kernel), Count, Count * 2 * sizeof(Money), [=] {
+				Decimal_MultiplyBatch(amounts->data(), quantities->data(), products->data(), Count, RoundingMode::HalfEven, nullptr, kernel);
+				g_sink = static_cast<uint64_t>((*products)[Count - 1].Units());
+			} });
+		}
+		benchmarks.push_back({ "Decimal_SumProducts", Count, Count * 2 * sizeof(Money), [=] {
+			g_sink = static_cast<uint64_t>(Decimal_SumProducts(amounts->data(), quantities->data(), Count).Units());
+		} });
+	}
+
+	// ---------------------------------------------------------------- variable-length integers
+
+	const char* KernelName(VarIntKernel kernel)
+	{
+		switch (kernel)
+		{
+		case VarIntKernel::Scalar: return "scalar";
+		case VarIntKernel::SSSE3: return "ssse3";
+		case VarIntKernel::AVX2: return "avx2";
+		default: return "auto";
+		}
+	}
+
+	void AddVarInts(std::vector<Benchmark>& benchmarks)
+	{
+		// Mostly 1-byte values with a tail of longer ones, as in event logs and posting lists.
+		std::mt19937 rng(7);
+		auto wide = std::make_shared<std::vector<uint64_t>>(Count);
+		auto narrow = std::make_shared<std::vector<uint32_t>>(Count);
+		for (size_t i = 0; i < Count; ++i)
+		{
+			uint32_t roll = rng() % 100;
+			int bits = roll < 70 ? 7 : roll < 90 ? 14 : roll < 99 ? 21 : 32;
+			(*narrow)[i] = static_cast<uint32_t>(rng() & ((uint64_t(1) << bits) - 1));
+			(*wide)[i] = (*narrow)[i];
+		}
+		auto leb = std::make_shared<std::vector<uint8_t>>(VarInt_LEB128MaxBytes * Count);
+		auto svb = std::make_shared<std::vector<uint8_t>>(VarInt_StreamVByteMaxBytes(Count));
+		const size_t lebSize = VarInt_EncodeLEB128(wide->data(), Count, leb->data());
+		const size_t svbSize = VarInt_EncodeStreamVByte(narrow->data(), Count, svb->data());
+		auto wideOut = std::make_shared<std::vector<uint64_t>>(Count);
+		auto narrowOut = std::make_shared<std::vector<uint32_t>>(Count);
+
+		benchmarks.push_back({ "VarInt_EncodeLEB128", Count, Count * sizeof(uint64_t), [=] {
+			g_sink = VarInt_EncodeLEB128(wide->data(), Count, leb->data());
+		} });
+		benchmarks.push_back({ "VarInt_DecodeLEB128", Count, lebSize, [=] {
+			g_sink = static_cast<uint64_t>(VarInt_DecodeLEB128(leb->data(), lebSize, wideOut->data(), Count)) + (*wideOut)[Count - 1];
+		} });
+		benchmarks.push_back({ "VarInt_EncodeStreamVByte", Count, Count * sizeof(uint32_t), [=] {
+			g_sink = VarInt_EncodeStreamVByte(narrow->data(), Count, svb->data());
+		} });
+		for (VarIntKernel kernel : { VarIntKernel::Scalar, VarIntKernel::SSSE3, VarIntKernel::AVX2 })
+		{
+			if (!VarInt_KernelSupported(kernel))
+				continue;
+			benchmarks.push_back({ std::string("VarInt_DecodeStreamVByte/") + KernelName(kernel), Count, svbSize, [=] {
+				g_sink = static_cast<uint64_t>(VarInt_DecodeStreamVByte(svb->data(), svbSize, narrowOut->data(), Count, nullptr, kernel))
+					+ (*narrowOut)[Count - 1];
+			} });
+		}
+	}
+
+	// ---------------------------------------------------------------- array comparison
+
+	void AddFloatComparison(std::vector<Benchmark>& benchmarks)
+	{
+		// An output that matches its reference except for neighbours in one element out of 16.
+		std::mt19937 rng(5);
+		std::uniform_real_distribution<float> value(-1000.0f, 1000.0f);
+		auto reference = std::make_shared<std::vector<float>>(Count);
+		auto output = std::make_shared<std::vector<float>>(Count);
+		for (size_t i = 0; i < Count; ++i)
+		{
+			(*reference)[i] = value(rng);
+			(*output)[i] = (rng() % 16 == 0) ? std::nextafter((*reference)[i], 0.0f) : (*reference)[i];
+		}
+		auto indices = std::make_shared<std::vector<size_t>>(100);
+		FloatTolerance tolerance;
+		tolerance.ulps = 2;
+
+		for (FloatCompareKernel kernel : { FloatCompareKernel::Scalar, FloatCompareKernel::AVX2 })
+		{
+			if (!Float_KernelSupported(kernel))
+				continue;
+			benchmarks.push_back({ std::string("Float_CompareArrays/float/") + KernelName(kernel), Count, Count * 2 * sizeof(float), [=] {
+				g_sink = Float_CompareArrays(output->data(), reference->data(), Count, tolerance,
+					indices->data(), indices->size(), kernel, false).maxUlps;
+			} });
+		}
+	}
+
+	// ---------------------------------------------------------------- small float formats
+
+	const char* KernelName(MiniFloatKernel kernel)
+	{
+		switch (kernel)
+		{
+		case MiniFloatKernel::Scalar: return "scalar";
+		case MiniFloatKernel::AVX2: return "avx2";
+		case MiniFloatKernel::AVX512: return "avx512";
+		default: return "auto";
+		}
+	}
+
+	void AddMiniFloats(std::vector<Benchmark>& benchmarks)
+	{
+		// Readings spread over a few binades, as stored model weights or sensor values are.
+		std::mt19937 rng(4);
+		std::normal_distribution<float> reading(0.0f, 4.0f);
+		auto floats = std::make_shared<std::vector<float>>(Count);
+		for (float& value : *floats)
+			value = reading(rng);
+		auto halves = std::make_shared<std::vector<uint16_t>>(Count);
+		auto bytes = std::make_shared<std::vector<uint8_t>>(Count);
+		auto out = std::make_shared<std::vector<float>>(Count);
+		Half_FromFloats(floats->data(), Count, halves->data(), MiniFloatKernel::Scalar);
+		FP8E4M3_FromFloats(floats->data(), Count, bytes->data(), FP8Overflow::NonFinite, MiniFloatKernel::Scalar);
+
+		for (MiniFloatKernel kernel : { MiniFloatKernel::Scalar, MiniFloatKernel::AVX2, MiniFloatKernel::AVX512 })
+		{
+			if (!MiniFloat_KernelSupported(kernel))
+				continue;
+			const std::string suffix = std::string("/") + KernelName(kernel);
+			benchmarks.push_back({ "Half_FromFloats" + suffix, Count, Count * sizeof(float), [=] {
+				Half_FromFloats(floats->data(), Count, halves->data(), kernel);
+				g_sink = (*halves)[Count - 1];
+			} });
+			benchmarks.push_back({ "Half_ToFloats" + suffix, Count, Count * sizeof(uint16_t), [=] {
+				Half_ToFloats(halves->data(), Count, out->data(), kernel);
+				g_sink = uint64_t((*out)[Count - 1]);
+			} });
+			benchmarks.push_back({ "BFloat16_FromFloats" + suffix, Count, Count * sizeof(float), [=] {
+				BFloat16_FromFloats(floats->data(), Count, halves->data(), kernel);
+				g_sink = (*halves)[Count - 1];
+			} });
+			benchmarks.push_back({ "FP8E4M3_FromFloats" + suffix, Count, Count * sizeof(float), [=] {
+				FP8E4M3_FromFloats(floats->data(), Count, bytes->data(), FP8Overflow::NonFinite, kernel);
+				g_sink = (*bytes)[Count - 1];
+			} });
+			benchmarks.push_back({ "FP8E4M3_ToFloats" + suffix, Count, Count * sizeof(uint8_t), [=] {
+				FP8E4M3_ToFloats(bytes->data(), Count, out->data(), kernel);
+				g_sink = uint64_t((*out)[Count - 1]);
+			} });
+		}
+	}
+
+	// ---------------------------------------------------------------- runner
+
+	// Times iterations calls of body: wall clock time and processor time of the whole process, in seconds.
+	void Time(const Benchmark& benchmark, uint64_t iterations, double& real, double& cpu)
+	{
+		std::clock_t cpuStart = std::clock();
+		auto start = std::chrono::steady_clock::now();
+		for (uint64_t i = 0; i < iterations; ++i)
+			benchmark.body();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		real = elapsed.count();
+		cpu = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+	}
+
+	Run MakeRun(const Benchmark& benchmark, uint64_t iterations, double real, double cpu, int repetitionIndex)
+	{
+		Run run;
+		run.name = benchmark.name;
+		run.iterations = iterations;
+		run.realTime = real * 1e9 / iterations;
+		run.cpuTime = cpu * 1e9 / iterations;
+		run.itemsPerSecond = real > 0 ? double(benchmark.items) * iterations / real : 0;
+		run.bytesPerSecond = real > 0 ? double(benchmark.bytes) * iterations / real : 0;
+		run.repetitionIndex = repetitionIndex;
+		return run;
+	}
+
+	// Grows the iteration count until one measurement lasts minTime, the way Google Benchmark does:
+	//  the last, long enough measurement is the first repetition, and the others reuse its iteration count.
+	std::vector<Run> Measure(const Benchmark& benchmark, const Options& options)
+	{
+		benchmark.body();   // warm the caches and the branch predictors
+		uint64_t iterations = 1;
+		double real = 0, cpu = 0;
+		for (;;)
+		{
+			Time(benchmark, iterations, real, cpu);
+			if (real >= options.minTime || iterations >= 1000000000)
+				break;
+			double scale = real > 0 ? options.minTime * 1.4 / real : 10.0;
+			iterations = std::min<uint64_t>(1000000000, std::max<uint64_t>(iterations + 1, uint64_t(iterations * std::min(scale, 10.0))));
+		}
+
+		std::vector<Run> runs;
+		runs.push_back(MakeRun(benchmark, iterations, real, cpu, 0));
+		for (int repetition = 1; repetition < options.repetitions; ++repetition)
+		{
+			Time(benchmark, iterations, real, cpu);
+			runs.push_back(MakeRun(benchmark, iterations, real, cpu, repetition));
+		}
+		if (runs.size() > 1)
+		{
+			std::vector<Run> sorted = runs;
+			std::sort(sorted.begin(), sorted.end(), [](const Run& a, const Run& b) { return a.realTime < b.realTime; });
+			Run median = sorted[sorted.size() / 2];
+			median.repetitionIndex = -1;
+			runs.push_back(median);
+		}
+		return runs;
+	}
+
+	std::string JsonEscape(const std::string& text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+				escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	// Each benchmark entry is written on one line; ReadBaseline relies on that.
+	void WriteJson(std::ostream& out, const std::vector<Run>& runs, const Options& options, const char* executable)
+	{
+		char date[64];
+		std::time_t now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+		out << "{\n  \"context\": {\n"
+			<< "    \"date\": \"" << date << "\",\n"
+			<< "    \"executable\": \"" << JsonEscape(executable) << "\",\n"
+			<< "    \"num_cpus\": " << ParallelFor_ThreadCount() << ",\n"
+#if defined(NDEBUG)
+			<< "    \"library_build_type\": \"release\",\n"
+#else
+			<< "    \"library_build_type\": \"debug\",\n"
+#endif
+			<< "    \"numbers_march\": \"" << NUMBERS_MARCH << "\",\n"
+			<< "    \"numbers_has_sse2\": " << (CpuFeatures::HasSSE2() ? "true" : "false") << ",\n"
+			<< "    \"numbers_has_avx\": " << (CpuFeatures::HasAVX() ? "true" : "false") << ",\n"
+			<< "    \"numbers_has_avx2\": " << (CpuFeatures::HasAVX2() ? "true" : "false") << ",\n"
+			<< "    \"numbers_min_time\": " << options.minTime << "\n"
+			<< "  },\n  \"benchmarks\": [\n";
+		for (size_t i = 0; i < runs.size(); ++i)
+		{
+			const Run& run = runs[i];
+			bool aggregate = run.repetitionIndex < 0;
+			out << "    {\"name\": \"" << JsonEscape(run.name) << (aggregate ? "_median" : "") << "\", "
+				<< "\"run_name\": \"" << JsonEscape(run.name) << "\", "
+				<< "\"run_type\": \"" << (aggregate ? "aggregate" : "iteration") << "\", "
+				<< "\"repetitions\": " << options.repetitions << ", ";
+			if (aggregate)
+				out << "\"aggregate_name\": \"median\", ";
+			else
+				out << "\"repetition_index\": " << run.repetitionIndex << ", ";
+			out << "\"iterations\": " << run.iterations << ", "
+				<< "\"real_time\": " << run.realTime << ", "
+				<< "\"cpu_time\": " << run.cpuTime << ", "
+				<< "\"time_unit\": \"ns\", "
+				<< "\"items_per_second\": " << run.itemsPerSecond;
+			if (run.bytesPerSecond > 0)
+				out << ", \"bytes_per_second\": " << run.bytesPerSecond;
+			out << "}" << (i + 1 < runs.size() ? "," : "") << "\n";
+		}
+		out << "  ]\n}\n";
+	}
+
+	void WriteConsoleHeader()
+	{
+		std::printf("%-36s %13s %13s %12s %14s\n", "Benchmark", "Time", "CPU", "Iterations", "Throughput");
+		std::printf("%s\n", std::string(92, '-').c_str());
+	}
+
+	void WriteConsole(const Run& run)
+	{
+		std::string name = run.repetitionIndex < 0 ? run.name + "_median" : run.name;
+		std::printf("%-36s %10.1f ns %10.1f ns %12llu %10.1f M/s\n", name.c_str(), run.realTime, run.cpuTime,
+			static_cast<unsigned long long>(run.iterations), run.itemsPerSecond / 1e6);
+	}
+
+	// Reads the fastest real_time of each benchmark from a file written by WriteJson.
+	bool ReadBaseline(const std::string& path, std::map<std::string, double>& times)
+	{
+		std::ifstream in(path);
+		if (!in)
+			return false;
+		std::string line;
+		while (std::getline(in, line))
+		{
+			if (line.find("\"run_type\": \"iteration\"") == std::string::npos)
+				continue;
+			const std::string nameKey = "\"name\": \"", timeKey = "\"real_time\": ";
+			size_t name = line.find(nameKey), time = line.find(timeKey);
+			if (name == std::string::npos || time == std::string::npos)
+				continue;
+			name += nameKey.size();
+			std::string key = line.substr(name, line.find('"', name) - name);
+			double value = std::strtod(line.c_str() + time + timeKey.size(), nullptr);
+			auto found = times.find(key);
+			if (found == times.end() || value < found->second)
+				times[key] = value;
+		}
+		return true;
+	}
+
+	// Prints the change of each benchmark against the baseline, to standard error when standard output carries JSON;
+	//  returns false if any slowed down past the threshold.
+	bool CompareWithBaseline(const std::vector<Run>& runs, const Options& options)
+	{
+		std::map<std::string, double> baseline;
+		if (!ReadBaseline(options.baseline, baseline))
+		{
+			std::cerr << "Cannot read the baseline " << options.baseline << '\n';
+			return false;
+		}
+		std::map<std::string, double> current;
+		for (const Run& run : runs)
+		{
+			if (run.repetitionIndex < 0)
+				continue;
+			auto found = current.find(run.name);
+			if (found == current.end() || run.realTime < found->second)
+				current[run.name] = run.realTime;
+		}
+
+		FILE* stream = options.json ? stderr : stdout;
+		bool passed = true;
+		std::fprintf(stream, "\nComparison with %s (threshold %+.0f%%)\n", options.baseline.c_str(), options.threshold * 100);
+		for (const auto& entry : current)
+		{
+			auto found = baseline.find(entry.first);
+			if (found == baseline.end() || found->second <= 0)
+			{
+				std::fprintf(stream, "%-36s %13s\n", entry.first.c_str(), "new");
+				continue;
+			}
+			double change = entry.second / found->second - 1;
+			bool regressed = change > options.threshold;
+			passed = passed && !regressed;
+			std::fprintf(stream, "%-36s %+12.1f%%%s\n", entry.first.c_str(), change * 100, regressed ? "  REGRESSION" : "");
+		}
+		return passed;
+	}
+
+	// Accepts "--name=value"; returns false if argument is a different option.
+	bool Flag(const char* argument, const char* name, std::string& value)
+	{
+		size_t length = std::strlen(name);
+		if (std::strncmp(argument, name, length) != 0 || argument[length] != '=')
+			return false;
+		value = argument + length + 1;
+		return true;
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string value;
+			if (Flag(argv[i], "--benchmark_filter", value))
+				options.filter = value;
+			else if (Flag(argv[i], "--benchmark_min_time", value))
+				options.minTime = std::strtod(value.c_str(), nullptr);   // Google Benchmark also accepts a trailing 's'
+			else if (Flag(argv[i], "--benchmark_repetitions", value))
+				options.repetitions = std::max(1, std::atoi(value.c_str()));
+			else if (Flag(argv[i], "--benchmark_out", value))
+				options.out = value;
+			else if (Flag(argv[i], "--benchmark_format", value) && (value == "json" || value == "console"))
+				options.json = value == "json";
+			else if (Flag(argv[i], "--benchmark_baseline", value))
+				options.baseline = value;
+			else if (Flag(argv[i], "--benchmark_regression_threshold", value))
+				options.threshold = std::strtod(value.c_str(), nullptr);
+			else if (std::strcmp(argv[i], "--benchmark_list_tests") == 0 || std::strcmp(argv[i], "--benchmark_list_tests=true") == 0)
+				options.list = true;
+			else if (std::strncmp(argv[i], "--benchmark_out_format", 22) == 0)
+				continue;   // always JSON
+			else
+			{
+				std::cerr << "Unknown argument " << argv[i] << "\nSee benchmark/PerfSuite.cpp for the options.\n";
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+		return 2;
+
+	std::vector<Benchmark> all;
+	AddIntegerFormatting(all);
+	AddFloatDecoding(all);
+	AddDotProducts(all);
+	AddMiniFloats(all);
+	AddFloatComparison(all);
+	AddBitmaps(all);
+	AddVarInts(all);
+	AddDecimals(all);
+	AddFloatMath(all);
+
+	std::vector<Benchmark> selected;
+	try
+	{
+		std::regex filter(options.filter);
+		for (const Benchmark& benchmark : all)
+			if (std::regex_search(benchmark.name, filter))
+				selected.push_back(benchmark);
+	}
+	catch (const std::regex_error&)
+	{
+		std::cerr << "Invalid --benchmark_filter " << options.filter << '\n';
+		return 2;
+	}
+	if (options.list)
+	{
+		for (const Benchmark& benchmark : selected)
+			std::cout << benchmark.name << '\n';
+		return 0;
+	}
+
+	if (!options.json)
+	{
+		std::printf("numbers_bench (-march=%s), %u threads, AVX2 %s\n", NUMBERS_MARCH, ParallelFor_ThreadCount(),
+			CpuFeatures::HasAVX2() ? "yes" : "no");
+		WriteConsoleHeader();
+	}
+	std::vector<Run> runs;
+	for (const Benchmark& benchmark : selected)
+	{
+		for (const Run& run : Measure(benchmark, options))
+		{
+			runs.push_back(run);
+			if (!options.json)
+				WriteConsole(run);
+		}
+	}
+
+	if (options.json)
+		WriteJson(std::cout, runs, options, argv[0]);
+	if (!options.out.empty())
+	{
+		std::ofstream out(options.out);
+		WriteJson(out, runs, options, argv[0]);
+		if (!out)
+		{
+			std::cerr << "Cannot write " << options.out << '\n';
+			return 2;
+		}
+	}
+	if (!options.baseline.empty() && !CompareWithBaseline(runs, options))
+		return 1;
+	return 0;
+}
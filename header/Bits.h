@@ -0,0 +1,237 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Bits.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Counting, finding and moving the bits of an unsigned integer (see the binary representations in Integers.cpp).
+// The single-value functions are constexpr, so they can size arrays and fill tables at compile time, and take any
+//  unsigned type of up to 64 bits. With GCC and Clang they are built on the compiler builtins, which become single
+//  instructions (POPCNT, LZCNT, TZCNT, BSWAP) when the build targets a processor that has them (NUMBERS_MARCH in
+//  CMakeLists.txt); otherwise they use portable arithmetic with the same results.
+// Choosing an instruction at runtime costs more than one count, so that choice is made by the batch functions
+//  at the end instead, which process a whole bitmap per call.
+
+// GCC and Clang expand __builtin_popcountll to a library call unless the target has POPCNT;
+//  the portable sum of bit fields is faster than that call.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__POPCNT__) || !(defined(__x86_64__) || defined(__i386__)))
+#define NUMBERS_BUILTIN_POPCOUNT 1
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define NUMBERS_BUILTIN_BITS 1
+#endif
+
+namespace BitsDetail
+{
+	template <typename T>
+	constexpr uint64_t Word(T value)
+	{
+		static_assert(std::is_unsigned<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= 8,
+			"the Bits_ functions take unsigned integers of up to 64 bits");
+		return value;
+	}
+
+	template <typename T>
+	constexpr int Width() { return static_cast<int>(sizeof(T) * 8); }
+
+	constexpr int PopCount(uint64_t x)
+	{
+#if defined(NUMBERS_BUILTIN_POPCOUNT)
+		return __builtin_popcountll(x);
+#else
+		// Sums of 2, 4 and 8 bits side by side, then the 8 byte sums added up by one multiplication.
+		x = x - ((x >> 1) & 0x5555555555555555ull);
+		x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+		x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return static_cast<int>((x * 0x0101010101010101ull) >> 56);
+#endif
+	}
+
+	constexpr int LeadingZeros(uint64_t x)
+	{
+		if (x == 0)
+			return 64;
+#if defined(NUMBERS_BUILTIN_BITS)
+		return __builtin_clzll(x);
+#else
+		int n = 0;
+		for (int shift = 32; shift > 0; shift /= 2)
+			if (x < (uint64_t(1) << (64 - shift)))
+			{
+				n += shift;
+				x <<= shift;
+			}
+		return n;
+#endif
+	}
+
+	constexpr int TrailingZeros(uint64_t x)
+	{
+		if (x == 0)
+			return 64;
+#if defined(NUMBERS_BUILTIN_BITS)
+		return __builtin_ctzll(x);
+#else
+		// The bits below the lowest set one, counted.
+		return PopCount((x & (0 - x)) - 1);
+#endif
+	}
+
+	constexpr uint64_t ByteSwap(uint64_t x)
+	{
+#if defined(NUMBERS_BUILTIN_BITS)
+		return __builtin_bswap64(x);
+#else
+		x = ((x & 0x00FF00FF00FF00FFull) << 8) | ((x >> 8) & 0x00FF00FF00FF00FFull);
+		x = ((x & 0x0000FFFF0000FFFFull) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFull);
+		return (x << 32) | (x >> 32);
+#endif
+	}
+
+	constexpr uint64_t Reverse(uint64_t x)
+	{
+		// Swap neighbouring bits, pairs and nibbles within each byte, then reverse the bytes.
+		x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+		x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+		x = ((x >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((x & 0x0F0F0F0F0F0F0F0Full) << 4);
+		return ByteSwap(x);
+	}
+
+	// One step per set bit of mask, without branching on the data.
+	constexpr uint64_t Deposit(uint64_t value, uint64_t mask)
+	{
+		uint64_t result = 0;
+		for (; mask != 0; mask &= mask - 1, value >>= 1)
+			result |= mask & (0 - mask) & (0 - (value & 1));
+		return result;
+	}
+
+	constexpr uint64_t Extract(uint64_t value, uint64_t mask)
+	{
+		uint64_t result = 0;
+		for (int next = 0; mask != 0; mask &= mask - 1, ++next)
+			result |= static_cast<uint64_t>((value & mask & (0 - mask)) != 0) << next;
+		return result;
+	}
+}
+
+// The number of set bits.
+template <typename T>
+constexpr int Bits_PopCount(T value)
+{
+	return BitsDetail::PopCount(BitsDetail::Word(value));
+}
+
+// The number of zero bits above the highest set bit; the width of T when value is 0.
+template <typename T>
+constexpr int Bits_CountLeadingZeros(T value)
+{
+	return BitsDetail::LeadingZeros(BitsDetail::Word(value)) - (64 - BitsDetail::Width<T>());
+}
+
+// The number of zero bits below the lowest set bit; the width of T when value is 0.
+template <typename T>
+constexpr int Bits_CountTrailingZeros(T value)
+{
+	return value == 0 ? BitsDetail::Width<T>() : BitsDetail::TrailingZeros(BitsDetail::Word(value));
+}
+
+// The number of bits needed to write value: 0 for 0, otherwise one more than the position of the highest set bit.
+template <typename T>
+constexpr int Bits_Width(T value)
+{
+	return BitsDetail::Width<T>() - Bits_CountLeadingZeros(value);
+}
+
+// The bits in reverse order: bit 0 becomes the highest bit.
+template <typename T>
+constexpr T Bits_Reverse(T value)
+{
+	return static_cast<T>(BitsDetail::Reverse(BitsDetail::Word(value)) >> (64 - BitsDetail::Width<T>()));
+}
+
+// The bytes in reverse order, which converts between little- and big-endian.
+template <typename T>
+constexpr T Bits_ByteSwap(T value)
+{
+	return static_cast<T>(BitsDetail::ByteSwap(BitsDetail::Word(value)) >> (64 - BitsDetail::Width<T>()));
+}
+
+// Parallel deposit (PDEP): the low bits of value, in order, placed at the positions of the set bits of mask.
+// Bits_Deposit(0b101, 0b11010) == 0b10010.
+template <typename T>
+constexpr T Bits_Deposit(T value, T mask)
+{
+	return static_cast<T>(BitsDetail::Deposit(BitsDetail::Word(value), mask));
+}
+
+// Parallel extract (PEXT), the inverse: the bits of value at the positions of the set bits of mask, packed together
+//  at the bottom. Bits_Extract(0b10010, 0b11010) == 0b101.
+template <typename T>
+constexpr T Bits_Extract(T value, T mask)
+{
+	return static_cast<T>(BitsDetail::Extract(BitsDetail::Word(value), mask));
+}
+
+// The instruction sets the batch functions can run on. Counting and moving bits use different instructions, so each
+//  has its own kernels, checked against the processor separately. Every kernel gives the same results.
+enum class BitsCountKernel
+{
+	Auto,      // the widest kernel the processor supports
+	Portable,  // the arithmetic above, one word at a time
+	Hardware,  // one POPCNT per word
+	AVX2       // 4 words per step through a nibble lookup table (VPSHUFB)
+};
+
+enum class BitsDepositKernel
+{
+	Auto,      // Hardware where PDEP and PEXT are fast, otherwise Portable
+	Portable,  // one mask and shift per run of set bits in the mask
+	Hardware   // one BMI2 PDEP or PEXT per word
+};
+
+// Returns true if the given kernel can run on this processor. All but Portable need 64-bit x86: Hardware counting
+//  needs POPCNT, AVX2 counting AVX2 and POPCNT, and Hardware deposit and extract BMI2.
+bool Bits_KernelSupported(BitsCountKernel kernel);
+bool Bits_KernelSupported(BitsDepositKernel kernel);
+// Returns the kernel that will actually run: an unsupported kernel becomes Portable, and Auto becomes the widest
+//  supported counting kernel. For deposit and extract Auto keeps to Portable on AMD processors before Zen 3, where
+//  PDEP and PEXT are microcoded and take time proportional to the number of set bits in mask (CpuFeatures::HasFastBMI2);
+//  asking for Hardware still runs them there.
+BitsCountKernel Bits_ResolveKernel(BitsCountKernel kernel);
+BitsDepositKernel Bits_ResolveKernel(BitsDepositKernel kernel);
+
+// The number of set bits in count words, and in a[i] & b[i] (the size of the intersection of two bitmaps).
+uint64_t Bits_PopCountArray(const uint64_t* words, size_t count, BitsCountKernel kernel = BitsCountKernel::Auto);
+uint64_t Bits_PopCountAnd(const uint64_t* a, const uint64_t* b, size_t count, BitsCountKernel kernel = BitsCountKernel::Auto);
+
+// out[i] = Bits_Deposit(values[i], mask) or Bits_Extract(values[i], mask). out may be values.
+void Bits_DepositArray(const uint64_t* values, size_t count, uint64_t mask, uint64_t* out,
+	BitsDepositKernel kernel = BitsDepositKernel::Auto);
+void Bits_ExtractArray(const uint64_t* values, size_t count, uint64_t mask, uint64_t* out,
+	BitsDepositKernel kernel = BitsDepositKernel::Auto);
+
+// Writes the position (64 * word + bit) of every set bit of a bitmap of count words to positions, in increasing
+//  order, and returns how many were written. positions must have room for Bits_PopCountArray(words, count).
+size_t Bits_SetPositions(const uint64_t* words, size_t count, uint64_t* positions);
@@ -0,0 +1,376 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: CheckedInt.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Integer arithmetic that does something defined when the result does not fit.
+// The built-in types wrap around (unsigned) or have undefined behaviour (signed) on overflow; see the maximum and
+//  minimum values printed in Integers.cpp. The three policies here make the choice explicit:
+//  Wrapping<T>    wraps around modulo 2^bits, for signed types too, and costs nothing over the built-in operators;
+//  Saturating<T>  clamps to the minimum or maximum value, the behaviour wanted for counters and meters;
+//  Checked<T>     wraps, but remembers that an overflow happened (a sticky flag, like a NaN), so a long
+//                 computation can be checked once at the end instead of branching after every step.
+// DebugChecked<T> asserts on overflow in debug builds and compiles to plain wrapping arithmetic when NDEBUG is defined.
+// With GCC and Clang everything is built on __builtin_add_overflow and friends, which compile to the add/multiply
+//  followed by a read of the overflow or carry flag; other compilers get portable code with the same results.
+// T may be any built-in integer type, __int128 where the compiler has it, or one of the wide integers in WideInt.h.
+
+#if defined(__SIZEOF_INT128__)
+#define NUMBERS_HAS_INT128 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NUMBERS_HAS_OVERFLOW_BUILTINS 1
+#endif
+
+// The unsigned type of the same width, and the range of T. std::numeric_limits and std::make_unsigned
+//  are not specialized for __int128 in strict standard modes, so these are spelled out.
+template <typename T> struct IntTraits;
+
+template <typename T, typename U>
+struct IntTraitsBase
+{
+	typedef U Unsigned;
+	// Arithmetic on U without promotion to (signed) int, which could overflow for short types.
+	typedef typename std::conditional<(sizeof(U) < sizeof(unsigned)), unsigned, U>::type Promoted;
+	static constexpr bool isSigned = T(-1) < T(0);
+	static constexpr T Max() { return isSigned ? T(U(~U(0)) >> 1) : T(~U(0)); }
+	static constexpr T Min() { return isSigned ? T(-Max() - 1) : T(0); }
+	static constexpr int bits = sizeof(T) * 8;
+};
+
+#define NUMBERS_INT_TRAITS(S, U) \
+	template <> struct IntTraits<S> : IntTraitsBase<S, U> {}; \
+	template <> struct IntTraits<U> : IntTraitsBase<U, U> {};
+NUMBERS_INT_TRAITS(signed char, unsigned char)
+NUMBERS_INT_TRAITS(short, unsigned short)
+NUMBERS_INT_TRAITS(int, unsigned)
+NUMBERS_INT_TRAITS(long, unsigned long)
+NUMBERS_INT_TRAITS(long long, unsigned long long)
+#if defined(NUMBERS_HAS_INT128)
+NUMBERS_INT_TRAITS(__int128, unsigned __int128)
+#endif
+#undef NUMBERS_INT_TRAITS
+template <> struct IntTraits<char> : IntTraitsBase<char, unsigned char> {};
+
+// Stores a + b, a - b or a * b wrapped to the width of T in result, and returns true if the exact result did not fit.
+template <typename T>
+inline bool Int_AddOverflow(T a, T b, T& result)
+{
+#if defined(NUMBERS_HAS_OVERFLOW_BUILTINS)
+	return __builtin_add_overflow(a, b, &result);
+#else
+	typedef typename IntTraits<T>::Promoted P;
+	result = T(P(a) + P(b));
+	if (IntTraits<T>::isSigned)
+		return ((a ^ result) & (b ^ result)) < 0;
+	return result < a;
+#endif
+}
+
+template <typename T>
+inline bool Int_SubOverflow(T a, T b, T& result)
+{
+#if defined(NUMBERS_HAS_OVERFLOW_BUILTINS)
+	return __builtin_sub_overflow(a, b, &result);
+#else
+	typedef typename IntTraits<T>::Promoted P;
+	result = T(P(a) - P(b));
+	if (IntTraits<T>::isSigned)
+		return ((a ^ b) & (a ^ result)) < 0;
+	return b > a;
+#endif
+}
+
+template <typename T>
+inline bool Int_MulOverflow(T a, T b, T& result)
+{
+#if defined(NUMBERS_HAS_OVERFLOW_BUILTINS)
+	return __builtin_mul_overflow(a, b, &result);
+#else
+	// Multiply the magnitudes into a double-width high:low pair (schoolbook on half-width digits),
+	//  then check the high half and, for signed types, the room left for the sign.
+	typedef typename IntTraits<T>::Unsigned U;
+	typedef typename IntTraits<T>::Promoted P;
+	const bool negative = IntTraits<T>::isSigned && ((a < 0) != (b < 0));
+	U ma = IntTraits<T>::isSigned && a < 0 ? U(P(0) - P(a)) : U(a);
+	U mb = IntTraits<T>::isSigned && b < 0 ? U(P(0) - P(b)) : U(b);
+	const int half = IntTraits<T>::bits / 2;
+	const P mask = (P(1) << half) - 1;
+	P a0 = ma & mask, a1 = P(ma) >> half, b0 = mb & mask, b1 = P(mb) >> half;
+	P p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+	P middle = (p00 >> half) + (p01 & mask) + (p10 & mask);
+	U low = U((p00 & mask) | (middle << half));
+	U high = U(p11 + (p01 >> half) + (p10 >> half) + (middle >> half));
+	result = T(negative ? U(P(0) - P(low)) : low);
+	if (!IntTraits<T>::isSigned)
+		return high != 0;
+	U limit = negative ? U(U(IntTraits<T>::Max()) + 1) : U(IntTraits<T>::Max());
+	return high != 0 || low > limit;
+#endif
+}
+
+// Stores a / b in result and returns true for division by zero (result 0) or Min / -1 (result Min).
+template <typename T>
+inline bool Int_DivOverflow(T a, T b, T& result)
+{
+	if (b == 0)
+	{
+		result = 0;
+		return true;
+	}
+	if (IntTraits<T>::isSigned && a == IntTraits<T>::Min() && b == T(-1))
+	{
+		result = a;
+		return true;
+	}
+	result = T(a / b);
+	return false;
+}
+
+// Wrapping arithmetic: the result modulo 2^bits, with no undefined behaviour for signed types.
+template <typename T> inline T Int_WrappingAdd(T a, T b) { typedef typename IntTraits<T>::Promoted P; return T(P(a) + P(b)); }
+template <typename T> inline T Int_WrappingSub(T a, T b) { typedef typename IntTraits<T>::Promoted P; return T(P(a) - P(b)); }
+template <typename T> inline T Int_WrappingMul(T a, T b) { typedef typename IntTraits<T>::Promoted P; return T(P(a) * P(b)); }
+template <typename T> inline T Int_WrappingNeg(T a) { typedef typename IntTraits<T>::Promoted P; return T(P(0) - P(a)); }
+
+// Saturating arithmetic: the exact result clamped to [Min, Max].
+// The clamp value is selected without a branch, so these vectorize when used in a loop.
+template <typename T>
+inline T Int_SaturatingAdd(T a, T b)
+{
+	T result;
+	bool overflow = Int_AddOverflow(a, b, result);
+	// Signed addition can only overflow toward the sign of b.
+	T limit = IntTraits<T>::isSigned && b < 0 ? IntTraits<T>::Min() : IntTraits<T>::Max();
+	return overflow ? limit : result;
+}
+
+template <typename T>
+inline T Int_SaturatingSub(T a, T b)
+{
+	T result;
+	bool overflow = Int_SubOverflow(a, b, result);
+	T limit = IntTraits<T>::isSigned && b >= 0 ? IntTraits<T>::Min() : (IntTraits<T>::isSigned ? IntTraits<T>::Max() : T(0));
+	return overflow ? limit : result;
+}
+
+template <typename T>
+inline T Int_SaturatingMul(T a, T b)
+{
+	T result;
+	bool overflow = Int_MulOverflow(a, b, result);
+	T limit = IntTraits<T>::isSigned && ((a < 0) != (b < 0)) ? IntTraits<T>::Min() : IntTraits<T>::Max();
+	return overflow ? limit : result;
+}
+
+// b must not be zero, as with the built-in operator; Min / -1 gives Max.
+template <typename T>
+inline T Int_SaturatingDiv(T a, T b)
+{
+	if (IntTraits<T>::isSigned && a == IntTraits<T>::Min() && b == T(-1))
+		return IntTraits<T>::Max();
+	return T(a / b);
+}
+
+template <typename T>
+inline T Int_SaturatingNeg(T a)
+{
+	return Int_SaturatingSub(T(0), a);
+}
+
+// The wrappers below hold a T and give it one of the overflow policies through the usual operators.
+// They convert implicitly from T, so Saturating<uint32_t> total = 0; total += price; reads like plain code,
+//  and they are exactly the size of T (except Checked, which adds its flag).
+
+template <typename T>
+class Wrapping
+{
+public:
+	Wrapping() : m_value(0) {}
+	Wrapping(T value) : m_value(value) {}
+
+	T Value() const { return m_value; }
+
+	Wrapping& operator+=(Wrapping other) { m_value = Int_WrappingAdd(m_value, other.m_value); return *this; }
+	Wrapping& operator-=(Wrapping other) { m_value = Int_WrappingSub(m_value, other.m_value); return *this; }
+	Wrapping& operator*=(Wrapping other) { m_value = Int_WrappingMul(m_value, other.m_value); return *this; }
+	// other must not be zero; Min / -1 wraps to Min.
+	Wrapping& operator/=(Wrapping other) { Int_DivOverflow(m_value, other.m_value, m_value); return *this; }
+	Wrapping operator-() const { return Wrapping(Int_WrappingNeg(m_value)); }
+
+	friend Wrapping operator+(Wrapping a, Wrapping b) { return a += b; }
+	friend Wrapping operator-(Wrapping a, Wrapping b) { return a -= b; }
+	friend Wrapping operator*(Wrapping a, Wrapping b) { return a *= b; }
+	friend Wrapping operator/(Wrapping a, Wrapping b) { return a /= b; }
+	friend bool operator==(Wrapping a, Wrapping b) { return a.m_value == b.m_value; }
+	friend bool operator!=(Wrapping a, Wrapping b) { return a.m_value != b.m_value; }
+	friend bool operator<(Wrapping a, Wrapping b) { return a.m_value < b.m_value; }
+	friend bool operator<=(Wrapping a, Wrapping b) { return a.m_value <= b.m_value; }
+	friend bool operator>(Wrapping a, Wrapping b) { return a.m_value > b.m_value; }
+	friend bool operator>=(Wrapping a, Wrapping b) { return a.m_value >= b.m_value; }
+
+private:
+	T m_value;
+};
+
+template <typename T>
+class Saturating
+{
+public:
+	Saturating() : m_value(0) {}
+	Saturating(T value) : m_value(value) {}
+
+	T Value() const { return m_value; }
+
+	Saturating& operator+=(Saturating other) { m_value = Int_SaturatingAdd(m_value, other.m_value); return *this; }
+	Saturating& operator-=(Saturating other) { m_value = Int_SaturatingSub(m_value, other.m_value); return *this; }
+	Saturating& operator*=(Saturating other) { m_value = Int_SaturatingMul(m_value, other.m_value); return *this; }
+	// other must not be zero.
+	Saturating& operator/=(Saturating other) { m_value = Int_SaturatingDiv(m_value, other.m_value); return *this; }
+	Saturating operator-() const { return Saturating(Int_SaturatingNeg(m_value)); }
+
+	friend Saturating operator+(Saturating a, Saturating b) { return a += b; }
+	friend Saturating operator-(Saturating a, Saturating b) { return a -= b; }
+	friend Saturating operator*(Saturating a, Saturating b) { return a *= b; }
+	friend Saturating operator/(Saturating a, Saturating b) { return a /= b; }
+	friend bool operator==(Saturating a, Saturating b) { return a.m_value == b.m_value; }
+	friend bool operator!=(Saturating a, Saturating b) { return a.m_value != b.m_value; }
+	friend bool operator<(Saturating a, Saturating b) { return a.m_value < b.m_value; }
+	friend bool operator<=(Saturating a, Saturating b) { return a.m_value <= b.m_value; }
+	friend bool operator>(Saturating a, Saturating b) { return a.m_value > b.m_value; }
+	friend bool operator>=(Saturating a, Saturating b) { return a.m_value >= b.m_value; }
+
+private:
+	T m_value;
+};
+
+template <typename T>
+class Checked
+{
+public:
+	Checked() : m_value(0), m_overflow(false) {}
+	Checked(T value) : m_value(value), m_overflow(false) {}
+
+	// True if any operation that led to this value overflowed (or divided by zero).
+	bool Overflowed() const { return m_overflow; }
+	// The wrapped result; only meaningful when Overflowed() is false.
+	T Value() const { return m_value; }
+	// Stores the value and returns true if no overflow happened.
+	bool Get(T& value) const { value = m_value; return !m_overflow; }
+
+	// The flags are combined with | rather than ||, so an update is straight-line code.
+	Checked& operator+=(Checked other) { m_overflow = Int_AddOverflow(m_value, other.m_value, m_value) | m_overflow | other.m_overflow; return *this; }
+	Checked& operator-=(Checked other) { m_overflow = Int_SubOverflow(m_value, other.m_value, m_value) | m_overflow | other.m_overflow; return *this; }
+	Checked& operator*=(Checked other) { m_overflow = Int_MulOverflow(m_value, other.m_value, m_value) | m_overflow | other.m_overflow; return *this; }
+	Checked& operator/=(Checked other) { m_overflow = Int_DivOverflow(m_value, other.m_value, m_value) | m_overflow | other.m_overflow; return *this; }
+	Checked operator-() const
+	{
+		Checked result;
+		result.m_overflow = Int_SubOverflow(T(0), m_value, result.m_value) | m_overflow;
+		return result;
+	}
+
+	friend Checked operator+(Checked a, Checked b) { return a += b; }
+	friend Checked operator-(Checked a, Checked b) { return a -= b; }
+	friend Checked operator*(Checked a, Checked b) { return a *= b; }
+	friend Checked operator/(Checked a, Checked b) { return a /= b; }
+	// Comparisons look at the values only.
+	friend bool operator==(Checked a, Checked b) { return a.m_value == b.m_value; }
+	friend bool operator!=(Checked a, Checked b) { return a.m_value != b.m_value; }
+	friend bool operator<(Checked a, Checked b) { return a.m_value < b.m_value; }
+	friend bool operator<=(Checked a, Checked b) { return a.m_value <= b.m_value; }
+	friend bool operator>(Checked a, Checked b) { return a.m_value > b.m_value; }
+	friend bool operator>=(Checked a, Checked b) { return a.m_value >= b.m_value; }
+
+private:
+	T m_value;
+	bool m_overflow;
+};
+
+template <typename T>
+class DebugChecked
+{
+public:
+	DebugChecked() : m_value(0) {}
+	DebugChecked(T value) : m_value(value) {}
+
+	T Value() const { return m_value; }
+
+#if defined(NDEBUG)
+	DebugChecked& operator+=(DebugChecked other) { m_value = Int_WrappingAdd(m_value, other.m_value); return *this; }
+	DebugChecked& operator-=(DebugChecked other) { m_value = Int_WrappingSub(m_value, other.m_value); return *this; }
+	DebugChecked& operator*=(DebugChecked other) { m_value = Int_WrappingMul(m_value, other.m_value); return *this; }
+#else
+	DebugChecked& operator+=(DebugChecked other) { bool overflow = Int_AddOverflow(m_value, other.m_value, m_value); assert(!overflow && "integer overflow"); (void)overflow; return *this; }
+	DebugChecked& operator-=(DebugChecked other) { bool overflow = Int_SubOverflow(m_value, other.m_value, m_value); assert(!overflow && "integer overflow"); (void)overflow; return *this; }
+	DebugChecked& operator*=(DebugChecked other) { bool overflow = Int_MulOverflow(m_value, other.m_value, m_value); assert(!overflow && "integer overflow"); (void)overflow; return *this; }
+#endif
+	DebugChecked& operator/=(DebugChecked other) { bool overflow = Int_DivOverflow(m_value, other.m_value, m_value); assert(!overflow && "integer overflow"); (void)overflow; return *this; }
+	DebugChecked operator-() const { return DebugChecked(0) -= *this; }
+
+	friend DebugChecked operator+(DebugChecked a, DebugChecked b) { return a += b; }
+	friend DebugChecked operator-(DebugChecked a, DebugChecked b) { return a -= b; }
+	friend DebugChecked operator*(DebugChecked a, DebugChecked b) { return a *= b; }
+	friend DebugChecked operator/(DebugChecked a, DebugChecked b) { return a /= b; }
+	friend bool operator==(DebugChecked a, DebugChecked b) { return a.m_value == b.m_value; }
+	friend bool operator!=(DebugChecked a, DebugChecked b) { return a.m_value != b.m_value; }
+	friend bool operator<(DebugChecked a, DebugChecked b) { return a.m_value < b.m_value; }
+	friend bool operator<=(DebugChecked a, DebugChecked b) { return a.m_value <= b.m_value; }
+	friend bool operator>(DebugChecked a, DebugChecked b) { return a.m_value > b.m_value; }
+	friend bool operator>=(DebugChecked a, DebugChecked b) { return a.m_value >= b.m_value; }
+
+private:
+	T m_value;
+};
+
+// The instruction sets the batch functions below can run on. There is no SSE2 kernel: the comparisons and blends
+//  it would need are SSE4.
+enum class IntKernel
+{
+	Auto,
+	Scalar,  // one value at a time, built by the compiler from the overflow builtins
+	AVX2     // 8 (32-bit) or 4 (64-bit) lanes per instruction
+};
+
+// Returns true if the given kernel can run on this processor.
+bool Int_KernelSupported(IntKernel kernel);
+// Returns the kernel that will actually run: Auto becomes the widest supported kernel,
+//  and an unsupported kernel becomes Scalar.
+IntKernel Int_ResolveKernel(IntKernel kernel);
+
+// Batch saturating arithmetic: out[i] = a[i] + b[i] or a[i] * b[i], clamped. out may be the same array as a or b,
+//  so a block of counters can be updated in place. Returns how many results were clamped, so that the caller
+//  can tell that a counter hit its limit without checking each one.
+// AVX2 has no 64-bit multiply, so the 64-bit multiplications always run the scalar kernel.
+size_t Int_SaturatingAddBatch(const int32_t* a, const int32_t* b, int32_t* out, size_t count, IntKernel kernel = IntKernel::Auto);
+size_t Int_SaturatingAddBatch(const uint32_t* a, const uint32_t* b, uint32_t* out, size_t count, IntKernel kernel = IntKernel::Auto);
+size_t Int_SaturatingAddBatch(const int64_t* a, const int64_t* b, int64_t* out, size_t count, IntKernel kernel = IntKernel::Auto);
+size_t Int_SaturatingAddBatch(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t count, IntKernel kernel = IntKernel::Auto);
+size_t Int_SaturatingMulBatch(const int32_t* a, const int32_t* b, int32_t* out, size_t count, IntKernel kernel = IntKernel::Auto);
+size_t Int_SaturatingMulBatch(const uint32_t* a, const uint32_t* b, uint32_t* out, size_t count, IntKernel kernel = IntKernel::Auto);
+size_t Int_SaturatingMulBatch(const int64_t* a, const int64_t* b, int64_t* out, size_t count, IntKernel kernel = IntKernel::Auto);
+size_t Int_SaturatingMulBatch(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t count, IntKernel kernel = IntKernel::Auto);
@@ -37,3 +37,45 @@ class FloatingPoint
 public:
 	static void FloatingPointExample();
 };
+
+// Microbenchmarks for the batch kernels. Run the program with --benchmark to execute them.
+class Benchmarks
+{
+public:
+	static void RunAll();
+	static void DotProductBenchmark();
+	static void PlaneClassifyBenchmark();
+	static void RadixBenchmark();
+	static void FloatDecodeBenchmark();
+	static void DenormalBenchmark();
+	static void DecimalBenchmark();
+	static void FloatFormatBenchmark();
+	static void SummationBenchmark();
+	static void CheckedIntBenchmark();
+	static void MiniFloatBenchmark();
+	static void FloatCompareBenchmark();
+	static void BitsBenchmark();
+	static void VarIntBenchmark();
+	static void FloatMathBenchmark();
+};
+
+// Exhaustive and randomized correctness checks. Run the program with --check to execute them.
+class SelfChecks
+{
+public:
+	// Returns true if every check passed.
+	static bool RunAll();
+	static bool RadixCheck();
+	static bool FloatFormatCheck();
+	static bool SummationCheck();
+	static bool FloatClassifyCheck();
+	static bool FloatBitsCheck();
+	static bool UlpHarnessCheck();
+	static bool CheckedIntCheck();
+	static bool DecimalCheck();
+	static bool MiniFloatCheck();
+	static bool FloatCompareCheck();
+	static bool BitsCheck();
+	static bool VarIntCheck();
+	static bool FloatMathCheck();
+};
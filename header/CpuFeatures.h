@@ -0,0 +1,53 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: CpuFeatures.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Runtime detection of the instruction set extensions used by the batch kernels.
+// Every kernel that uses SSE/AVX has a portable scalar fallback, so the library still works on
+//  non-x86 targets (where NUMBERS_X86 is not defined) and on older x86 processors.
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NUMBERS_X86 1
+#endif
+
+// GCC and Clang only allow an intrinsic to be used inside a function compiled for its instruction set.
+// NUMBERS_TARGET("avx2") marks such a function without raising the baseline of the whole program.
+// MSVC allows any intrinsic anywhere, so the macro expands to nothing there.
+#if defined(__GNUC__) || defined(__clang__)
+#define NUMBERS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define NUMBERS_TARGET(isa)
+#endif
+
+class CpuFeatures
+{
+public:
+	static bool HasSSE2();
+	static bool HasSSSE3();    // byte shuffles (PSHUFB) in 128-bit registers (VarInt.h)
+	static bool HasPOPCNT();
+	static bool HasAVX();
+	static bool HasAVX2();
+	static bool HasF16C();     // conversion between float and half precision (MiniFloat.h)
+	static bool HasAVX512F();  // the 512-bit foundation instructions
+	static bool HasBMI2();     // PDEP and PEXT (Bits.h)
+	static bool HasFastBMI2(); // BMI2 without the microcoded PDEP and PEXT of AMD processors before Zen 3
+};
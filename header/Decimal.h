@@ -0,0 +1,484 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Decimal.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "DecimalWideMath.h"
+#include "WideInt.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// A fixed-point decimal number: an integer count of units of 10^-Scale.
+// Decimal64<2> holds 12.34 as the integer 1234, so sums of money are exact (no 0.1 + 0.2 != 0.3, see FloatingPoint.cpp)
+//  and cost the same as integer sums. Multiplication and division are computed exactly in a double-width
+//  intermediate and rounded once, with the rounding mode chosen by the caller.
+// Like the built-in integers, arithmetic does not trap on overflow; the functions that can overflow
+//  take an optional bool* that is set to true when the result did not fit.
+// Decimal64 counts units in an int64_t (18 digits of scale at most), Decimal128 in an Int128 from WideInt.h
+//  (38 digits), which is the same two words on every compiler.
+
+// The representations a decimal can use, with the conversions and double-width arithmetic BasicDecimal needs
+//  from each. The unsigned type holds magnitudes and the two's complement bits of the signed one.
+template <typename Rep>
+struct DecimalRep;
+
+template <>
+struct DecimalRep<int64_t>
+{
+	typedef uint64_t unsigned_type;
+	static const int maxScale = 18;
+
+	static uint64_t ToBits(int64_t value) { return static_cast<uint64_t>(value); }
+	// Converting an out-of-range unsigned value to signed is implementation defined before C++20;
+	//  every supported compiler wraps, which is what the decimal operators document.
+	static int64_t FromBits(uint64_t bits) { return static_cast<int64_t>(bits); }
+	static double ToDouble(int64_t value) { return static_cast<double>(value); }
+	// value is an integer already, and in range.
+	static int64_t FromDouble(double value) { return static_cast<int64_t>(value); }
+
+	// Divides value by 10 and returns the digit that was removed.
+	static unsigned DivideBy10(uint64_t& value)
+	{
+		unsigned digit = static_cast<unsigned>(value % 10);
+		value /= 10;
+		return digit;
+	}
+
+	static void Multiply(uint64_t a, uint64_t b, uint64_t& high, uint64_t& low)
+	{
+		DecimalWideMath::Multiply(a, b, high, low);
+	}
+
+	static uint64_t Divide(uint64_t high, uint64_t low, uint64_t divisor, uint64_t& remainder)
+	{
+		return DecimalWideMath::Divide(high, low, divisor, remainder);
+	}
+};
+
+template <>
+struct DecimalRep<Int128>
+{
+	typedef UInt128 unsigned_type;
+	static const int maxScale = 38;
+
+	static UInt128 ToBits(const Int128& value) { return value.ToBits(); }
+	static Int128 FromBits(const UInt128& bits) { return Int128::FromBits(bits); }
+
+	static double ToDouble(const Int128& value)
+	{
+		UInt128 magnitude = value.Magnitude();
+		double result = std::ldexp(static_cast<double>(magnitude.Word(1)), 64) + static_cast<double>(magnitude.Word(0));
+		return value.IsNegative() ? -result : result;
+	}
+
+	// value is an integer already, and in range; both halves of its magnitude are exact doubles.
+	static Int128 FromDouble(double value)
+	{
+		double magnitude = std::fabs(value);
+		double high = std::floor(std::ldexp(magnitude, -64));
+		UInt128 bits(static_cast<uint64_t>(magnitude - std::ldexp(high, 64)));
+		bits.SetWord(1, static_cast<uint64_t>(high));
+		return Int128::FromBits(value < 0 ? -bits : bits);
+	}
+
+	static unsigned DivideBy10(UInt128& value) { return static_cast<unsigned>(value.DivideWord(10)); }
+
+	static void Multiply(const UInt128& a, const UInt128& b, UInt128& high, UInt128& low)
+	{
+		UInt128::MultiplyFull(a, b, high, low);
+	}
+
+	// high must be less than divisor. A divisor of up to 64 bits (10^19 and below) takes one word division per word.
+	static UInt128 Divide(const UInt128& high, const UInt128& low, const UInt128& divisor, UInt128& remainder)
+	{
+		UInt256 dividend(low);
+		dividend.SetWord(2, high.Word(0));
+		dividend.SetWord(3, high.Word(1));
+		UInt256 rest;
+		UInt128 quotient(UInt256::DivMod(dividend, UInt256(divisor), rest));
+		remainder = UInt128(rest);
+		return quotient;
+	}
+};
+
+template <typename Rep, int Scale>
+class BasicDecimal
+{
+public:
+	typedef Rep rep_type;
+	typedef DecimalRep<Rep> Traits;
+	typedef typename Traits::unsigned_type unsigned_type;
+	static_assert(Scale >= 0 && Scale <= DecimalRep<Rep>::maxScale, "Scale does not fit in the representation");
+
+	// 10^Scale, the number of units in 1
+	static constexpr Rep Unit()
+	{
+		Rep unit = 1;
+		for (int i = 0; i < Scale; ++i)
+			unit *= 10;
+		return unit;
+	}
+
+	constexpr BasicDecimal() : m_units(0) {}
+	static constexpr BasicDecimal FromUnits(Rep units) { return BasicDecimal(units, 0); }
+	static constexpr BasicDecimal FromInteger(Rep value) { return BasicDecimal(value * Unit(), 0); }
+
+	// Rounds value * 10^Scale to an integer. Like every conversion from binary floating point this is only as exact
+	//  as the double: FromDouble(0.1) is 0.1000000000000000055..., which rounds to exactly 0.10 at any sensible scale.
+	// NaN, infinities and values whose units do not fit in Rep set *overflow and give 0.
+	static BasicDecimal FromDouble(double value, RoundingMode mode = RoundingMode::HalfEven, bool* overflow = nullptr)
+	{
+		double scaled = value * Traits::ToDouble(Unit());
+		double rounded;
+		switch (mode)
+		{
+		case RoundingMode::HalfEven: rounded = scaled - std::remainder(scaled, 1.0); break;
+		case RoundingMode::HalfAwayFromZero: rounded = std::round(scaled); break;
+		case RoundingMode::Floor: rounded = std::floor(scaled); break;
+		case RoundingMode::Ceiling: rounded = std::ceil(scaled); break;
+		default: rounded = std::trunc(scaled); break;
+		}
+		// Rep holds [-2^(bits - 1), 2^(bits - 1)); both ends are exact doubles, and NaN fails both comparisons.
+		const double limit = std::ldexp(1.0, static_cast<int>(sizeof(Rep) * 8) - 1);
+		if (!(rounded >= -limit && rounded < limit))
+		{
+			if (overflow)
+				*overflow = true;
+			return BasicDecimal();
+		}
+		return FromUnits(Traits::FromDouble(rounded));
+	}
+
+	constexpr Rep Units() const { return m_units; }
+	double ToDouble() const { return Traits::ToDouble(m_units) / Traits::ToDouble(Unit()); }
+
+	// Writes the value as [-]digits.digits with exactly Scale fractional digits. Returns the length written,
+	//  or 0 if bufferSize is too small. No '\0' is appended.
+	size_t Format(char* buffer, size_t bufferSize) const
+	{
+		char scratch[DecimalRep<Rep>::maxScale + 4];
+		char* p = scratch + sizeof(scratch);
+		unsigned_type magnitude = Magnitude(m_units);
+		int digits = 0;
+		do
+		{
+			if (digits == Scale && Scale > 0)
+				*--p = '.';
+			*--p = static_cast<char>('0' + Traits::DivideBy10(magnitude));
+			++digits;
+		} while (magnitude != 0 || digits <= Scale);
+		if (m_units < Rep(0))
+			*--p = '-';
+		size_t length = static_cast<size_t>(scratch + sizeof(scratch) - p);
+		if (length > bufferSize)
+			return 0;
+		for (size_t i = 0; i < length; ++i)
+			buffer[i] = p[i];
+		return length;
+	}
+
+	// Parses [-+]digits[.digits]. Fractional digits beyond Scale are rounded with the given mode.
+	// Returns false (leaving value untouched) if the text is malformed or out of range.
+	static bool Parse(const char* text, size_t length, BasicDecimal& value, RoundingMode mode = RoundingMode::HalfEven)
+	{
+		size_t i = 0;
+		bool negative = false;
+		if (i < length && (text[i] == '-' || text[i] == '+'))
+			negative = text[i++] == '-';
+		const unsigned_type limit = MaxMagnitude(negative);
+		unsigned_type units = 0;
+		int fractionDigits = 0;
+		bool seenPoint = false, seenDigit = false;
+		// Beyond Scale only the first dropped digit and whether anything non-zero follows it matter.
+		int firstDropped = -1;
+		bool restNonZero = false;
+		for (; i < length; ++i)
+		{
+			char c = text[i];
+			if (c == '.' && !seenPoint)
+			{
+				seenPoint = true;
+				continue;
+			}
+			if (c < '0' || c > '9')
+				return false;
+			seenDigit = true;
+			unsigned digit = static_cast<unsigned>(c - '0');
+			if (seenPoint && fractionDigits == Scale)
+			{
+				if (firstDropped < 0)
+					firstDropped = static_cast<int>(digit);
+				else
+					restNonZero |= digit != 0;
+				continue;
+			}
+			if (units > (limit - digit) / 10)
+				return false;
+			units = units * 10 + digit;
+			fractionDigits += seenPoint ? 1 : 0;
+		}
+		if (!seenDigit)
+			return false;
+		for (; fractionDigits < Scale; ++fractionDigits)
+		{
+			if (units > limit / 10)
+				return false;
+			units *= 10;
+		}
+		if (firstDropped >= 0)
+		{
+			// Rounding the dropped digits as a remainder out of a divisor of 10 (5 is exactly half way).
+			unsigned_type remainder = static_cast<unsigned_type>(firstDropped) * 2 + (restNonZero ? 1 : 0);
+			units = DecimalWideMath::Round<unsigned_type>(units, remainder, 20, negative, mode);
+			if (units > limit)
+				return false;
+		}
+		value = FromUnits(Traits::FromBits(negative ? unsigned_type(0) - units : units));
+		return true;
+	}
+
+	// Exact; wraps around on overflow like the underlying integer.
+	friend BasicDecimal operator+(BasicDecimal a, BasicDecimal b) { return FromUnits(Traits::FromBits(Traits::ToBits(a.m_units) + Traits::ToBits(b.m_units))); }
+	friend BasicDecimal operator-(BasicDecimal a, BasicDecimal b) { return FromUnits(Traits::FromBits(Traits::ToBits(a.m_units) - Traits::ToBits(b.m_units))); }
+	friend BasicDecimal operator-(BasicDecimal a) { return FromUnits(Traits::FromBits(unsigned_type(0) - Traits::ToBits(a.m_units))); }
+	BasicDecimal& operator+=(BasicDecimal other) { return *this = *this + other; }
+	BasicDecimal& operator-=(BasicDecimal other) { return *this = *this - other; }
+
+	// Rounded half-to-even; use Decimal_Multiply and Decimal_Divide to choose the rounding or detect overflow.
+	friend BasicDecimal operator*(BasicDecimal a, BasicDecimal b) { return Multiply(a, b, RoundingMode::HalfEven, nullptr); }
+	friend BasicDecimal operator/(BasicDecimal a, BasicDecimal b) { return Divide(a, b, RoundingMode::HalfEven, nullptr); }
+	BasicDecimal& operator*=(BasicDecimal other) { return *this = *this * other; }
+	BasicDecimal& operator/=(BasicDecimal other) { return *this = *this / other; }
+
+	friend bool operator==(BasicDecimal a, BasicDecimal b) { return a.m_units == b.m_units; }
+	friend bool operator!=(BasicDecimal a, BasicDecimal b) { return a.m_units != b.m_units; }
+	friend bool operator<(BasicDecimal a, BasicDecimal b) { return a.m_units < b.m_units; }
+	friend bool operator<=(BasicDecimal a, BasicDecimal b) { return a.m_units <= b.m_units; }
+	friend bool operator>(BasicDecimal a, BasicDecimal b) { return a.m_units > b.m_units; }
+	friend bool operator>=(BasicDecimal a, BasicDecimal b) { return a.m_units >= b.m_units; }
+
+	// a * b = (a.units * b.units) / 10^Scale units, rounded once
+	static BasicDecimal Multiply(BasicDecimal a, BasicDecimal b, RoundingMode mode, bool* overflow)
+	{
+		unsigned_type high, low;
+		Traits::Multiply(Magnitude(a.m_units), Magnitude(b.m_units), high, low);
+		return DivideWide(high, low, Traits::ToBits(Unit()), IsNegative(a) != IsNegative(b), mode, overflow);
+	}
+
+	// a / b = (a.units * 10^Scale) / b.units units, rounded once. b must not be zero.
+	static BasicDecimal Divide(BasicDecimal a, BasicDecimal b, RoundingMode mode, bool* overflow)
+	{
+		unsigned_type high, low;
+		Traits::Multiply(Magnitude(a.m_units), Traits::ToBits(Unit()), high, low);
+		return DivideWide(high, low, Magnitude(b.m_units), IsNegative(a) != IsNegative(b), mode, overflow);
+	}
+
+private:
+	constexpr BasicDecimal(Rep units, int) : m_units(units) {}
+
+	// The largest magnitude of a positive or negative Rep
+	static unsigned_type MaxMagnitude(bool negative)
+	{
+		return (unsigned_type(~unsigned_type(0)) >> 1) + (negative ? 1 : 0);
+	}
+
+	static bool IsNegative(BasicDecimal value) { return value.m_units < Rep(0); }
+
+	static unsigned_type Magnitude(Rep value)
+	{
+		return value < Rep(0) ? unsigned_type(0) - Traits::ToBits(value) : Traits::ToBits(value);
+	}
+
+	static BasicDecimal DivideWide(unsigned_type high, unsigned_type low, unsigned_type divisor, bool negative,
+		RoundingMode mode, bool* overflow)
+	{
+		const unsigned_type limit = MaxMagnitude(negative);
+		if (high >= divisor)
+		{
+			if (overflow)
+				*overflow = true;
+			high %= divisor;
+		}
+		unsigned_type remainder;
+		unsigned_type quotient = Traits::Divide(high, low, divisor, remainder);
+		unsigned_type up = DecimalWideMath::RoundUp(quotient, remainder, divisor, negative, mode);
+		// Checked before the increment, which carries out of the top when the quotient is all ones.
+		if ((quotient > limit || (quotient == limit && up != 0)) && overflow)
+			*overflow = true;
+		quotient += up;
+		return FromUnits(Traits::FromBits(negative ? unsigned_type(0) - quotient : quotient));
+	}
+
+	Rep m_units;
+};
+
+template <int Scale>
+using Decimal64 = BasicDecimal<int64_t, Scale>;
+template <int Scale>
+using Decimal128 = BasicDecimal<Int128, Scale>;
+
+template <typename Rep, int Scale>
+BasicDecimal<Rep, Scale> Decimal_Multiply(BasicDecimal<Rep, Scale> a, BasicDecimal<Rep, Scale> b,
+	RoundingMode mode = RoundingMode::HalfEven, bool* overflow = nullptr)
+{
+	return BasicDecimal<Rep, Scale>::Multiply(a, b, mode, overflow);
+}
+
+template <typename Rep, int Scale>
+BasicDecimal<Rep, Scale> Decimal_Divide(BasicDecimal<Rep, Scale> a, BasicDecimal<Rep, Scale> b,
+	RoundingMode mode = RoundingMode::HalfEven, bool* overflow = nullptr)
+{
+	return BasicDecimal<Rep, Scale>::Divide(a, b, mode, overflow);
+}
+
+/////////////////////
+// Batch routines //
+/////////////////////
+
+// Sums count values exactly. The loop is free of branches and keeps four independent double-width accumulators
+//  (a wrapping low word plus a high word of sign extensions and carries), so the compiler turns it into SIMD adds.
+//  If the double-width total does not fit in Rep, *overflow is set.
+template <typename Rep, int Scale>
+BasicDecimal<Rep, Scale> Decimal_Sum(const BasicDecimal<Rep, Scale>* values, size_t count, bool* overflow = nullptr)
+{
+	typedef typename BasicDecimal<Rep, Scale>::unsigned_type U;
+	const int signShift = sizeof(U) * 8 - 1;
+	U lows[4] = { 0, 0, 0, 0 };
+	U highs[4] = { 0, 0, 0, 0 };
+	auto add = [signShift](U& low, U& high, U value) {
+		low += value;
+		// The high word gains all ones for a negative value and one for a carry out of the low word.
+		high += (U(0) - (value >> signShift)) + U(low < value);
+	};
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		for (int k = 0; k < 4; ++k)
+			add(lows[k], highs[k], DecimalRep<Rep>::ToBits(values[i + k].Units()));
+	for (; i < count; ++i)
+		add(lows[0], highs[0], DecimalRep<Rep>::ToBits(values[i].Units()));
+	for (int k = 1; k < 4; ++k)
+	{
+		lows[0] += lows[k];
+		highs[0] += highs[k] + U(lows[0] < lows[k]);
+	}
+	// The total fits when the high word is just the sign extension of the low word.
+	if (highs[0] != U(0) - (lows[0] >> signShift) && overflow)
+		*overflow = true;
+	return BasicDecimal<Rep, Scale>::FromUnits(DecimalRep<Rep>::FromBits(lows[0]));
+}
+
+// The instruction sets Decimal_MultiplyBatch can run on for Decimal64. Auto picks the widest one the processor supports.
+// Every kernel gives the same results.
+enum class DecimalKernel
+{
+	Auto,
+	Scalar,  // one Decimal_Multiply at a time
+	AVX2     // 4 products per step when both operands fit in 32 bits and the product in 51 (scales up to 15), the rest
+	         //  as Scalar
+};
+
+// Returns true if the given kernel can run on this processor.
+bool Decimal_KernelSupported(DecimalKernel kernel);
+// Returns the kernel that will actually run: Auto becomes the widest supported kernel,
+//  and an unsupported kernel becomes Scalar.
+DecimalKernel Decimal_ResolveKernel(DecimalKernel kernel);
+
+// Decimal_MultiplyBatch on the units of Decimal64<scale> values; out may be a or b. A scale outside [0, 18] sets
+//  *overflow and leaves out untouched.
+void Decimal_MultiplyUnitsBatch(const int64_t* a, const int64_t* b, int64_t* out, size_t count, int scale,
+	RoundingMode mode = RoundingMode::HalfEven, bool* overflow = nullptr, DecimalKernel kernel = DecimalKernel::Auto);
+
+// out[i] = Decimal_Multiply(a[i], b[i], mode). out may be a or b.
+template <typename Rep, int Scale>
+void Decimal_MultiplyBatch(const BasicDecimal<Rep, Scale>* a, const BasicDecimal<Rep, Scale>* b,
+	BasicDecimal<Rep, Scale>* out, size_t count, RoundingMode mode = RoundingMode::HalfEven, bool* overflow = nullptr)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i] = BasicDecimal<Rep, Scale>::Multiply(a[i], b[i], mode, overflow);
+}
+
+// Decimal64 has vector kernels: with AVX2, products of units that fit in 32 bits are formed 4 at a time and divided
+//  by 10^Scale through a multiplication by its reciprocal in double precision, corrected to the exact quotient.
+template <int Scale>
+void Decimal_MultiplyBatch(const Decimal64<Scale>* a, const Decimal64<Scale>* b, Decimal64<Scale>* out, size_t count,
+	RoundingMode mode = RoundingMode::HalfEven, bool* overflow = nullptr, DecimalKernel kernel = DecimalKernel::Auto)
+{
+	static_assert(sizeof(Decimal64<Scale>) == sizeof(int64_t), "Decimal64 is its units and nothing else");
+	Decimal_MultiplyUnitsBatch(reinterpret_cast<const int64_t*>(a), reinterpret_cast<const int64_t*>(b),
+		reinterpret_cast<int64_t*>(out), count, Scale, mode, overflow, kernel);
+}
+
+// The sum of a[i] * b[i] (for example quantity times price over a ledger), with every product kept exact at
+//  scale 2 * Scale in a triple-width accumulator and a single rounding at the end. This is both more accurate
+//  and faster than rounding each product, since no division happens inside the loop.
+// Each product is below 2^126 in magnitude, so the 192-bit accumulator cannot wrap for any count that fits in size_t.
+template <int Scale>
+Decimal64<Scale> Decimal_SumProducts(const Decimal64<Scale>* a, const Decimal64<Scale>* b, size_t count,
+	RoundingMode mode = RoundingMode::HalfEven, bool* overflow = nullptr)
+{
+	// A two's complement 192-bit accumulator in three words; the top word absorbs the sign extension.
+	uint64_t top = 0, high = 0, low = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		int64_t x = a[i].Units(), y = b[i].Units();
+		uint64_t negative = uint64_t((x < 0) != (y < 0));
+		uint64_t productHigh, productLow;
+		DecimalWideMath::Multiply(x < 0 ? 0 - uint64_t(x) : uint64_t(x), y < 0 ? 0 - uint64_t(y) : uint64_t(y),
+			productHigh, productLow);
+		// Negate the product when its sign is negative: invert all three words and add one.
+		uint64_t mask = 0 - negative;
+		productLow = (productLow ^ mask) + negative;
+		uint64_t carry = negative & uint64_t(productLow == 0);
+		productHigh = (productHigh ^ mask) + carry;
+		uint64_t productTop = mask + (carry & uint64_t(productHigh == 0));
+		low += productLow;
+		carry = uint64_t(low < productLow);
+		high += productHigh;
+		uint64_t carryOut = uint64_t(high < productHigh);
+		high += carry;
+		carryOut |= uint64_t(high < carry);
+		top += productTop + carryOut;
+	}
+	bool negative = (top >> 63) != 0;
+	if (negative)
+	{
+		low = 0 - low;
+		uint64_t borrow = uint64_t(low != 0);
+		uint64_t newHigh = 0 - high - borrow;
+		borrow |= uint64_t(high != 0);
+		high = newHigh;
+		top = 0 - top - borrow;
+	}
+	const uint64_t unit = static_cast<uint64_t>(Decimal64<Scale>::Unit());
+	const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0);
+	if ((top != 0 || high >= unit) && overflow)
+		*overflow = true;
+	uint64_t remainder;
+	uint64_t quotient = DecimalWideMath::Divide(high % unit, low, unit, remainder);
+	uint64_t up = DecimalWideMath::RoundUp(quotient, remainder, unit, negative, mode);
+	if ((quotient > limit || (quotient == limit && up != 0)) && overflow)
+		*overflow = true;
+	quotient += up;
+	return Decimal64<Scale>::FromUnits(static_cast<int64_t>(negative ? 0 - quotient : quotient));
+}
@@ -0,0 +1,138 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: DecimalWideMath.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+// The double-width word arithmetic behind Decimal.h and WideInt.h: a 64 x 64 bit product in two words,
+//  a 128 / 64 bit division, and rounding a truncated quotient with one of the decimal rounding modes.
+
+#if defined(__SIZEOF_INT128__)
+#define NUMBERS_HAS_INT128 1
+#endif
+
+enum class RoundingMode
+{
+	HalfEven,          // to nearest, ties to the even neighbour ("banker's rounding")
+	HalfAwayFromZero,  // to nearest, ties away from zero (the schoolbook rule)
+	TowardZero,        // truncate
+	Floor,             // toward negative infinity
+	Ceiling            // toward positive infinity
+};
+
+// The double-width arithmetic behind multiplication and division, on unsigned magnitudes.
+struct DecimalWideMath
+{
+	static void Multiply(uint64_t a, uint64_t b, uint64_t& high, uint64_t& low)
+	{
+#if defined(NUMBERS_HAS_INT128)
+		unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+		high = static_cast<uint64_t>(product >> 64);
+		low = static_cast<uint64_t>(product);
+#else
+		MultiplyHalves(a, b, high, low);
+#endif
+	}
+
+	// Divides high:low by divisor; high must be less than divisor so that the quotient fits.
+	static uint64_t Divide(uint64_t high, uint64_t low, uint64_t divisor, uint64_t& remainder)
+	{
+		if (high == 0)
+		{
+			remainder = low % divisor;
+			return low / divisor;
+		}
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+		// The hardware divides 128 by 64 bits in one instruction, but compilers call a library routine for a
+		//  128-bit division because they cannot know that the quotient fits; here high < divisor guarantees it.
+		uint64_t quotient;
+		__asm__("divq %[divisor]" : "=a"(quotient), "=d"(remainder) : "a"(low), "d"(high), [divisor] "rm"(divisor));
+		return quotient;
+#elif defined(NUMBERS_HAS_INT128)
+		unsigned __int128 dividend = (static_cast<unsigned __int128>(high) << 64) | low;
+		remainder = static_cast<uint64_t>(dividend % divisor);
+		return static_cast<uint64_t>(dividend / divisor);
+#else
+		return ShiftSubtract(high, low, divisor, remainder);
+#endif
+	}
+
+	// Schoolbook multiplication on half-width digits.
+	template <typename U>
+	static void MultiplyHalves(U a, U b, U& high, U& low)
+	{
+		const int half = sizeof(U) * 4;
+		const U mask = (U(1) << half) - 1;
+		U a0 = a & mask, a1 = a >> half, b0 = b & mask, b1 = b >> half;
+		U p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+		U middle = (p00 >> half) + (p01 & mask) + (p10 & mask);
+		low = (p00 & mask) | (middle << half);
+		high = p11 + (p01 >> half) + (p10 >> half) + (middle >> half);
+	}
+
+	// Restoring binary long division, one quotient bit per step. Only used when the fast paths do not apply.
+	template <typename U>
+	static U ShiftSubtract(U high, U low, U divisor, U& remainder)
+	{
+		const int bits = sizeof(U) * 8;
+		U rest = high, quotient = 0;
+		for (int i = bits - 1; i >= 0; --i)
+		{
+			bool carry = (rest >> (bits - 1)) != 0;
+			rest = (rest << 1) | ((low >> i) & 1);
+			bool subtract = carry || rest >= divisor;
+			rest -= subtract ? divisor : U(0);
+			quotient = (quotient << 1) | U(subtract);
+		}
+		remainder = rest;
+		return quotient;
+	}
+
+	// Adds one to the truncated magnitude quotient when the rounding mode asks for it.
+	// The sum wraps to zero when quotient is all ones; callers that can get there check RoundUp first.
+	template <typename U>
+	static U Round(U quotient, U remainder, U divisor, bool negative, RoundingMode mode)
+	{
+		return quotient + RoundUp(quotient, remainder, divisor, negative, mode);
+	}
+
+	// The increment (0 or 1) that Round adds. remainder < divisor; the half-way comparisons are written so that
+	//  nothing can overflow.
+	template <typename U>
+	static U RoundUp(U quotient, U remainder, U divisor, bool negative, RoundingMode mode)
+	{
+		// Bitwise rather than logical operators, so that the comparisons become flag moves instead of
+		//  branches that a random remainder would mispredict half of the time.
+		U rest = divisor - remainder;
+		U above = U(remainder > rest), half = U(remainder == rest), inexact = U(remainder != 0), sign = U(negative);
+		U up;
+		switch (mode)
+		{
+		case RoundingMode::HalfEven: up = above | (half & quotient & 1); break;
+		case RoundingMode::HalfAwayFromZero: up = above | half; break;
+		case RoundingMode::Floor: up = sign & inexact; break;
+		case RoundingMode::Ceiling: up = (sign ^ 1) & inexact; break;
+		default: up = 0; break;
+		}
+		return up;
+	}
+};
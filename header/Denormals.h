@@ -0,0 +1,128 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Denormals.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "FloatBits.h"
+#include "Vec3Batch.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Subnormal (denormal) numbers extend the range of floats below FLT_MIN, but on many x86 processors
+//  an operation that reads or produces one falls back to a microcode assist that can be 10-100 times slower.
+// Two bits in the MXCSR register, which controls SSE/AVX arithmetic for the current thread, avoid this:
+//  - FTZ (flush to zero): subnormal results are replaced by zero.
+//  - DAZ (denormals are zero): subnormal inputs are read as zero.
+// Both give up the gradual underflow described in FloatingPoint.cpp, so only enable them where
+//  values that small are noise anyway (audio, physics, graphics).
+// On AArch64 the single FZ bit of FPCR covers both. On other targets the mode cannot be changed.
+
+struct DenormalMode {
+	bool flushToZero = false;
+	bool denormalsAreZero = false;
+};
+
+// True if Denormals_SetMode has any effect on this target.
+bool Denormals_ModeSupported();
+
+// The mode of the calling thread. Every thread has its own copy of the control register.
+DenormalMode Denormals_GetMode();
+void Denormals_SetMode(DenormalMode mode);
+
+// Enables FTZ and DAZ on the current thread for the lifetime of the object and restores the previous mode after.
+// ParallelFor copies the calling thread's mode to its workers for the duration of each call,
+//  so a guard around a parallel kernel covers the whole kernel. Threads started any other way need their own guard.
+class ScopedFlushDenormals
+{
+public:
+	ScopedFlushDenormals();
+	~ScopedFlushDenormals();
+	ScopedFlushDenormals(const ScopedFlushDenormals&) = delete;
+	ScopedFlushDenormals& operator=(const ScopedFlushDenormals&) = delete;
+
+private:
+	DenormalMode m_previous;
+};
+
+// The sticky status flags of the current thread: the processor sets them whenever an operation
+//  read a subnormal operand (x86 DE) or underflowed to a tiny result (x86 UE), and they stay set until cleared.
+// They only say whether it happened, not how often; use CountedFloat for counts. Always false off x86.
+struct DenormalFlags {
+	bool consumed = false;
+	bool produced = false;
+};
+
+void Denormals_ClearFlags();
+DenormalFlags Denormals_ReadFlags();
+
+inline bool Denormals_IsSubnormal(float value)
+{
+	return Float_Classify(value) == FloatCategory::Subnormal;
+}
+
+struct SubnormalCounts {
+	uint64_t operations = 0;
+	uint64_t consumed = 0;   // operations with at least one subnormal operand
+	uint64_t produced = 0;   // operations whose result was subnormal
+};
+
+// A float that counts, per thread, how many of the arithmetic operations done with it consumed or produced
+//  subnormals. Instantiate a templated kernel with CountedFloat (or rewrite a loop with it) to find out
+//  how much of its work hits the slow path. Results are counted after the current mode is applied,
+//  so with FTZ enabled no subnormal results are produced.
+class CountedFloat
+{
+public:
+	CountedFloat(float value = 0.0f) : m_value(value) {}
+	float Value() const { return m_value; }
+
+	static SubnormalCounts& Counts()
+	{
+		static thread_local SubnormalCounts counts;
+		return counts;
+	}
+
+	friend CountedFloat operator+(CountedFloat a, CountedFloat b) { return Record(a.m_value + b.m_value, a, b); }
+	friend CountedFloat operator-(CountedFloat a, CountedFloat b) { return Record(a.m_value - b.m_value, a, b); }
+	friend CountedFloat operator*(CountedFloat a, CountedFloat b) { return Record(a.m_value * b.m_value, a, b); }
+	friend CountedFloat operator/(CountedFloat a, CountedFloat b) { return Record(a.m_value / b.m_value, a, b); }
+	CountedFloat& operator+=(CountedFloat other) { return *this = *this + other; }
+	CountedFloat& operator-=(CountedFloat other) { return *this = *this - other; }
+	CountedFloat& operator*=(CountedFloat other) { return *this = *this * other; }
+	CountedFloat& operator/=(CountedFloat other) { return *this = *this / other; }
+
+private:
+	static CountedFloat Record(float result, CountedFloat a, CountedFloat b)
+	{
+		SubnormalCounts& counts = Counts();
+		++counts.operations;
+		counts.consumed += Denormals_IsSubnormal(a.m_value) || Denormals_IsSubnormal(b.m_value);
+		counts.produced += Denormals_IsSubnormal(result);
+		return result;
+	}
+
+	float m_value;
+};
+
+// Counts the subnormal operations of the Vec3_DotProductBatch kernel for the given input.
+// Each dot product is 5 operations (3 multiplies, 2 adds) done in the same order as the kernel.
+SubnormalCounts Denormals_CountDotProducts(const float* xs, const float* ys, const float* zs, size_t count, vec3 normal);
@@ -0,0 +1,226 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatBits.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Building, taking apart and classifying floats and doubles through their IEEE754 bit fields
+//  (the layout is explained in FloatingPoint.cpp).
+// Reading a float's bits through a union or a pointer cast is undefined behaviour, and memcpy is not allowed in a
+//  constant expression. A bit cast (std::bit_cast in C++20, or the __builtin_bit_cast that GCC 11, Clang 9 and
+//  Visual Studio 2019 16.8 offer in C++17) is both well defined and constexpr, so with one of those compilers every
+//  function here is constexpr: thresholds and lookup tables written with them are computed by the compiler and
+//  stored in the program, instead of being built when it starts.
+// Older compilers fall back to memcpy. The functions then work the same way, but only at runtime;
+//  NUMBERS_CONSTEXPR_FLOAT_BITS is defined when they are constexpr.
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_bit_cast)
+#include <bit>
+#define NUMBERS_BIT_CAST(To, from) std::bit_cast<To>(from)
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_bit_cast)
+#define NUMBERS_BIT_CAST(To, from) __builtin_bit_cast(To, from)
+#endif
+#endif
+#if !defined(NUMBERS_BIT_CAST) && defined(_MSC_VER) && _MSC_VER >= 1928
+#define NUMBERS_BIT_CAST(To, from) __builtin_bit_cast(To, from)
+#endif
+
+#if defined(NUMBERS_BIT_CAST)
+#define NUMBERS_CONSTEXPR_FLOAT_BITS 1
+#define NUMBERS_FLOAT_BITS_CONSTEXPR constexpr
+#else
+#define NUMBERS_FLOAT_BITS_CONSTEXPR inline
+#endif
+
+// The categories are the rows and columns of the table in FloatingPoint.cpp:
+//  an exponent of all zeros is zero or subnormal, all ones is infinity or NaN, anything else is normal.
+enum class FloatCategory
+{
+	Zero,
+	Subnormal,
+	Normal,
+	Infinite,
+	NaN
+};
+
+namespace FloatBitsDetail
+{
+	template <typename UInt, int ExponentWidth, int SignificandWidth>
+	struct Layout
+	{
+		typedef UInt Bits;
+		static constexpr int ExponentBits = ExponentWidth;
+		static constexpr int SignificandBits = SignificandWidth;
+		static constexpr int Bias = (1 << (ExponentWidth - 1)) - 1;
+		// The all-ones biased exponent, used by infinities and NaNs.
+		static constexpr uint32_t MaxExponent = (1u << ExponentWidth) - 1;
+		static constexpr Bits SignMask = Bits(1) << (ExponentWidth + SignificandWidth);
+		static constexpr Bits AbsMask = SignMask - 1;
+		static constexpr Bits SignificandMask = (Bits(1) << SignificandWidth) - 1;
+		// With the sign bit cleared, the patterns order like the values: below MinNormal is zero or subnormal,
+		//  Infinity is the first pattern with the all-ones exponent, and everything above it is NaN.
+		static constexpr Bits MinNormal = Bits(1) << SignificandWidth;
+		static constexpr Bits Infinity = Bits(MaxExponent) << SignificandWidth;
+		// The highest significand bit; set in quiet NaNs.
+		static constexpr Bits QuietBit = Bits(1) << (SignificandWidth - 1);
+	};
+}
+
+// The bit layout of float and double; other types have no layout.
+template <typename T>
+struct FloatTraits;
+
+template <>
+struct FloatTraits<float> : FloatBitsDetail::Layout<uint32_t, 8, 23> {};
+
+template <>
+struct FloatTraits<double> : FloatBitsDetail::Layout<uint64_t, 11, 52> {};
+
+// The bit pattern of value, and the value of a bit pattern.
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR typename FloatTraits<T>::Bits Float_ToBits(T value)
+{
+#if defined(NUMBERS_BIT_CAST)
+	return NUMBERS_BIT_CAST(typename FloatTraits<T>::Bits, value);
+#else
+	typename FloatTraits<T>::Bits bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+#endif
+}
+
+// Float_FromBits<float>(0x3F800000) == 1.0f
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR T Float_FromBits(typename FloatTraits<T>::Bits bits)
+{
+#if defined(NUMBERS_BIT_CAST)
+	return NUMBERS_BIT_CAST(T, bits);
+#else
+	T value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+#endif
+}
+
+// The value with the given sign, biased exponent and significand (fraction bits only, without the implicit 1).
+// Fields wider than their place in the layout are cut to it. Float_FromFields<float>(false, 127 + 5, 0x280000) == 42.0f
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR T Float_FromFields(bool negative, uint32_t biasedExponent, typename FloatTraits<T>::Bits significand)
+{
+	typedef FloatTraits<T> L;
+	return Float_FromBits<T>((negative ? L::SignMask : 0) | (typename L::Bits(biasedExponent & L::MaxExponent) << L::SignificandBits)
+		| (significand & L::SignificandMask));
+}
+
+// The fields of value, as Float_FromFields takes them.
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR bool Float_SignBit(T value)
+{
+	return (Float_ToBits(value) & FloatTraits<T>::SignMask) != 0;
+}
+
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR uint32_t Float_BiasedExponent(T value)
+{
+	return static_cast<uint32_t>((Float_ToBits(value) & FloatTraits<T>::AbsMask) >> FloatTraits<T>::SignificandBits);
+}
+
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR typename FloatTraits<T>::Bits Float_Significand(T value)
+{
+	return Float_ToBits(value) & FloatTraits<T>::SignificandMask;
+}
+
+// 2^exponent exactly: a subnormal below the smallest normal power, 0 below the smallest subnormal,
+//  and infinity past the largest finite power. Float_Pow2<float>(-126) == FLT_MIN
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR T Float_Pow2(int exponent)
+{
+	typedef FloatTraits<T> L;
+	typedef typename L::Bits Bits;
+	return exponent > L::Bias ? Float_FromBits<T>(L::Infinity)
+		: exponent >= 1 - L::Bias ? Float_FromBits<T>(Bits(exponent + L::Bias) << L::SignificandBits)
+		: exponent >= 1 - L::Bias - L::SignificandBits ? Float_FromBits<T>(Bits(1) << (exponent - (1 - L::Bias - L::SignificandBits)))
+		: T(0);
+}
+
+// Classification by the bit pattern. Unlike std::fpclassify and std::isnan, these are constexpr.
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR FloatCategory Float_Classify(T value)
+{
+	typedef FloatTraits<T> L;
+	typename L::Bits magnitude = Float_ToBits(value) & L::AbsMask;
+	return magnitude == 0 ? FloatCategory::Zero
+		: magnitude < L::MinNormal ? FloatCategory::Subnormal
+		: magnitude < L::Infinity ? FloatCategory::Normal
+		: magnitude == L::Infinity ? FloatCategory::Infinite
+		: FloatCategory::NaN;
+}
+
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR bool Float_IsNaN(T value)
+{
+	return (Float_ToBits(value) & FloatTraits<T>::AbsMask) > FloatTraits<T>::Infinity;
+}
+
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR bool Float_IsInfinite(T value)
+{
+	return (Float_ToBits(value) & FloatTraits<T>::AbsMask) == FloatTraits<T>::Infinity;
+}
+
+// Zero, subnormal or normal.
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR bool Float_IsFinite(T value)
+{
+	return (Float_ToBits(value) & FloatTraits<T>::AbsMask) < FloatTraits<T>::Infinity;
+}
+
+// The next representable value above value (IEEE754 nextUp): the bit pattern one step away from zero for
+//  positive values and one step towards zero for negative ones. Both zeros step to the smallest subnormal,
+//  the largest finite value steps to infinity, and infinity and NaN stay as they are.
+// Float_NextUp(1.0f) == 1.0f + FLT_EPSILON
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR T Float_NextUp(T value)
+{
+	typedef FloatTraits<T> L;
+	typename L::Bits bits = Float_ToBits(value);
+	typename L::Bits magnitude = bits & L::AbsMask;
+	return magnitude > L::Infinity || bits == L::Infinity ? value
+		: magnitude == 0 ? Float_FromBits<T>(1)
+		: Float_FromBits<T>(bits == magnitude ? bits + 1 : bits - 1);
+}
+
+// The next representable value below value (IEEE754 nextDown), the mirror image of Float_NextUp.
+template <typename T>
+NUMBERS_FLOAT_BITS_CONSTEXPR T Float_NextDown(T value)
+{
+	return -Float_NextUp(-value);
+}
@@ -0,0 +1,192 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatCompare.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Comparing floating point results with a tolerance instead of ==.
+// A fixed tolerance such as FLT_EPSILON is the gap between 1.0f and the next float up, so it is far too strict for
+//  values in the thousands and far too loose for values near 1e-6 (see the plane example in FloatingPoint.cpp).
+// There are three tolerances that scale properly:
+//  - ulps: how many representable values lie between a and b. Because floats of the same sign order like their
+//    bit patterns, this is the difference of the bit patterns read as integers (with negative values mirrored),
+//    so it is exact and costs a few integer instructions. +0 and -0 are 0 ulps apart; the largest finite value
+//    is 1 ulp from infinity.
+//  - relative: |a - b| <= relative * max(|a|, |b|), the relative error defined in FloatingPoint.cpp.
+//  - absolute: |a - b| <= absolute. Neither of the others can accept anything near zero (1e-30f and 0 are
+//    over 200 million ulps apart, and infinitely far relatively), so results that should be zero need this one.
+// These compare two computed values with each other; FloatExhaustive_UlpError measures a float against an exact
+//  double reference instead.
+// Values are equal to themselves, infinities included. A NaN is equal to nothing and is as far as possible in ulps.
+// The scalar functions have no branches, so they are as fast on random data as on data that mostly matches.
+
+namespace FloatCompareDetail
+{
+	// The bit pattern as an integer that orders like the value: the magnitude bits, negated for negative values,
+	//  so that +0 and -0 are both 0.
+	inline int32_t OrderedBits(float value, bool& nan)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		int32_t magnitude = static_cast<int32_t>(bits & 0x7FFFFFFFu);
+		int32_t sign = -static_cast<int32_t>(bits >> 31);
+		nan = magnitude > 0x7F800000;
+		return (magnitude ^ sign) - sign;
+	}
+
+	inline int64_t OrderedBits(double value, bool& nan)
+	{
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		int64_t magnitude = static_cast<int64_t>(bits & 0x7FFFFFFFFFFFFFFFull);
+		int64_t sign = -static_cast<int64_t>(bits >> 63);
+		nan = magnitude > 0x7FF0000000000000ll;
+		return (magnitude ^ sign) - sign;
+	}
+
+	// |a - b| of two ordered patterns; it can exceed the signed range, but always fits the unsigned one.
+	template <typename Unsigned, typename Signed>
+	Unsigned Distance(Signed a, Signed b)
+	{
+		Unsigned forward = static_cast<Unsigned>(a) - static_cast<Unsigned>(b);
+		Unsigned backward = static_cast<Unsigned>(b) - static_cast<Unsigned>(a);
+		return a >= b ? forward : backward;
+	}
+}
+
+// The number of representable values between a and b: 0 when they are equal, 1 for neighbours.
+// The result is the largest value of the type when either is NaN.
+inline uint32_t Float_UlpDistance(float a, float b)
+{
+	bool nanA, nanB;
+	int32_t orderedA = FloatCompareDetail::OrderedBits(a, nanA), orderedB = FloatCompareDetail::OrderedBits(b, nanB);
+	return FloatCompareDetail::Distance<uint32_t>(orderedA, orderedB) | (0u - static_cast<uint32_t>(nanA | nanB));
+}
+
+inline uint64_t Float_UlpDistance(double a, double b)
+{
+	bool nanA, nanB;
+	int64_t orderedA = FloatCompareDetail::OrderedBits(a, nanA), orderedB = FloatCompareDetail::OrderedBits(b, nanB);
+	return FloatCompareDetail::Distance<uint64_t>(orderedA, orderedB) | (0u - static_cast<uint64_t>(nanA | nanB));
+}
+
+// True if a and b are at most maxUlps apart and neither is NaN.
+inline bool Float_NearlyEqualUlps(float a, float b, uint32_t maxUlps)
+{
+	bool nanA, nanB;
+	int32_t orderedA = FloatCompareDetail::OrderedBits(a, nanA), orderedB = FloatCompareDetail::OrderedBits(b, nanB);
+	return (FloatCompareDetail::Distance<uint32_t>(orderedA, orderedB) <= maxUlps) & !(nanA | nanB);
+}
+
+inline bool Float_NearlyEqualUlps(double a, double b, uint64_t maxUlps)
+{
+	bool nanA, nanB;
+	int64_t orderedA = FloatCompareDetail::OrderedBits(a, nanA), orderedB = FloatCompareDetail::OrderedBits(b, nanB);
+	return (FloatCompareDetail::Distance<uint64_t>(orderedA, orderedB) <= maxUlps) & !(nanA | nanB);
+}
+
+// True if |a - b| <= maxRelative * max(|a|, |b|).
+// The larger magnitude is capped at the largest finite value, so that no finite value counts as close to infinity.
+inline bool Float_NearlyEqualRelative(float a, float b, float maxRelative)
+{
+	float difference = std::fabs(a - b);
+	float largest = std::min(std::max(std::fabs(a), std::fabs(b)), FLT_MAX);
+	return (a == b) | (difference <= maxRelative * largest);
+}
+
+inline bool Float_NearlyEqualRelative(double a, double b, double maxRelative)
+{
+	double difference = std::fabs(a - b);
+	double largest = std::min(std::max(std::fabs(a), std::fabs(b)), DBL_MAX);
+	return (a == b) | (difference <= maxRelative * largest);
+}
+
+// True if |a - b| <= maxAbsolute or a and b are within maxRelative of each other as above:
+//  the absolute tolerance decides near zero and the relative one everywhere else.
+inline bool Float_NearlyEqual(float a, float b, float maxAbsolute, float maxRelative)
+{
+	return (std::fabs(a - b) <= maxAbsolute) | Float_NearlyEqualRelative(a, b, maxRelative);
+}
+
+inline bool Float_NearlyEqual(double a, double b, double maxAbsolute, double maxRelative)
+{
+	return (std::fabs(a - b) <= maxAbsolute) | Float_NearlyEqualRelative(a, b, maxRelative);
+}
+
+// Tolerances for comparing whole arrays: two elements match when they pass any one of the tests.
+// The defaults accept only equal values.
+struct FloatTolerance {
+	uint32_t ulps = 0;
+	float absolute = 0.0f;
+	float relative = 0.0f;
+	// When set, a NaN matches any other NaN, so that outputs with NaNs in the same places compare equal.
+	bool nanMatchesNaN = false;
+};
+
+struct DoubleTolerance {
+	uint64_t ulps = 0;
+	double absolute = 0.0;
+	double relative = 0.0;
+	bool nanMatchesNaN = false;
+};
+
+struct FloatArrayComparison {
+	// The number of elements that did not match.
+	uint64_t mismatches = 0;
+	// The largest ulp distance between two elements of which neither is NaN, and the first index where it occurs
+	//  (0 when every element is equal).
+	uint64_t maxUlps = 0;
+	size_t maxUlpsIndex = 0;
+	// How many indices were written to mismatchIndices: the smaller of mismatches and maxIndices.
+	size_t indicesStored = 0;
+
+	bool Equal() const { return mismatches == 0; }
+};
+
+// The instruction sets Float_CompareArrays can run on. There is no SSE2 kernel: SSE2 lacks the unsigned
+//  comparisons the ulp test needs.
+enum class FloatCompareKernel
+{
+	Auto,
+	Scalar,  // the comparators above, one element at a time
+	AVX2     // 8 floats or 4 doubles per step
+};
+
+// Returns true if the given kernel can run on this processor.
+bool Float_KernelSupported(FloatCompareKernel kernel);
+// Returns the kernel that will actually run: Auto becomes the widest supported kernel,
+//  and an unsupported kernel becomes Scalar.
+FloatCompareKernel Float_ResolveKernel(FloatCompareKernel kernel);
+
+// Compares a[i] with b[i] for count elements, for example an output buffer against a reference one.
+// The indices of the first maxIndices mismatches are written to mismatchIndices in increasing order
+//  (mismatchIndices may be null when maxIndices is 0). Every kernel gives the same result. With parallel set, blocks of elements are spread over
+//  all cores through ParallelFor, so multi-gigabyte buffers are limited by memory bandwidth.
+FloatArrayComparison Float_CompareArrays(const float* a, const float* b, size_t count, const FloatTolerance& tolerance,
+	size_t* mismatchIndices = nullptr, size_t maxIndices = 0, FloatCompareKernel kernel = FloatCompareKernel::Auto, bool parallel = true);
+FloatArrayComparison Float_CompareArrays(const double* a, const double* b, size_t count, const DoubleTolerance& tolerance,
+	size_t* mismatchIndices = nullptr, size_t maxIndices = 0, FloatCompareKernel kernel = FloatCompareKernel::Auto, bool parallel = true);
@@ -0,0 +1,64 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatDecode.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "FloatBits.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+// Bulk decoding of IEEE754 floats and doubles into their bit fields and categories
+//  (FloatCategory and the single-value Float_Classify are in FloatBits.h).
+// Values are reinterpreted with memcpy, never through a union or a pointer cast,
+//  so everything here is well defined under the strict aliasing rules.
+
+struct FloatCategoryCounts {
+	uint64_t zero = 0;
+	uint64_t subnormal = 0;
+	uint64_t normal = 0;
+	uint64_t infinite = 0;
+	uint64_t nan = 0;
+
+	uint64_t Total() const { return zero + subnormal + normal + infinite + nan; }
+	FloatCategoryCounts& operator+=(const FloatCategoryCounts& other);
+};
+
+// Splits count values into separate sign, biased exponent and significand (fraction bits only) streams,
+//  and adds the number of values in each category to counts.
+// Any of the output pointers may be null to skip that stream. Because counts is added to rather than
+//  overwritten, a large input can be processed one chunk at a time.
+// Large inputs are spread over all cores through ParallelFor.
+void FloatDecode_Split(const float* values, size_t count,
+	uint8_t* signs, uint8_t* exponents, uint32_t* significands, FloatCategoryCounts* counts);
+void FloatDecode_Split(const double* values, size_t count,
+	uint8_t* signs, uint16_t* exponents, uint64_t* significands, FloatCategoryCounts* counts);
+
+// Counts the values in each category.
+FloatCategoryCounts FloatDecode_Count(const float* values, size_t count);
+FloatCategoryCounts FloatDecode_Count(const double* values, size_t count);
+
+// Reads raw little-endian floats or doubles from a binary stream one fixed-size chunk at a time,
+//  so inputs far larger than memory can be audited, and adds their categories to counts.
+// Returns false if the stream ended in the middle of a value or a read error occurred.
+bool FloatDecode_CountFloatStream(std::istream& in, FloatCategoryCounts& counts);
+bool FloatDecode_CountDoubleStream(std::istream& in, FloatCategoryCounts& counts);
@@ -0,0 +1,151 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatExhaustive.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// Checks a property of every float.
+// There are only 2^32 float bit patterns (FloatingPoint.cpp builds a few of them by hand with Float_FromBits),
+//  so instead of sampling a function at random points it can be checked at all of them. The patterns are cut into
+//  blocks of 65536 and spread over all cores through ParallelFor, whose threads steal blocks from each other,
+//  so a full pass takes a few seconds per core for a cheap property instead of an overnight loop.
+// Results do not depend on the number of threads: the counterexamples kept are always the lowest failing patterns.
+
+struct FloatExhaustiveOptions
+{
+	// The bit patterns to check, first to last inclusive; the default is all of them.
+	uint32_t first = 0;
+	uint32_t last = 0xFFFFFFFFu;
+	// How many failing patterns to keep in FloatExhaustiveResult::counterexamples.
+	size_t maxCounterexamples = 16;
+};
+
+struct FloatExhaustiveResult
+{
+	uint64_t checked = 0;
+	uint64_t failures = 0;
+	// The lowest failing bit patterns, in increasing order.
+	std::vector<uint32_t> counterexamples;
+	// The largest error seen by FloatExhaustive_CheckUlp, in ulps, and the pattern where it occurred.
+	double maxUlp = 0;
+	uint32_t maxUlpBits = 0;
+	double seconds = 0;
+
+	bool Passed() const { return failures == 0; }
+	// Values checked per second.
+	double Throughput() const { return seconds > 0 ? checked / seconds : 0; }
+};
+
+// Collects the results for one block of patterns on one thread, so that threads only synchronize once per block.
+class FloatExhaustiveBlock
+{
+public:
+	explicit FloatExhaustiveBlock(size_t maxCounterexamples) : m_maxCounterexamples(maxCounterexamples) {}
+
+	void Fail(uint32_t bits)
+	{
+		if (m_result.counterexamples.size() < m_maxCounterexamples)
+			m_result.counterexamples.push_back(bits);
+		++m_result.failures;
+	}
+
+	void RecordUlp(uint32_t bits, double ulp)
+	{
+		// Written so that a NaN error counts as the largest.
+		if (!(ulp <= m_result.maxUlp))
+		{
+			m_result.maxUlp = ulp;
+			m_result.maxUlpBits = bits;
+		}
+	}
+
+	FloatExhaustiveResult& Result() { return m_result; }
+
+private:
+	size_t m_maxCounterexamples;
+	FloatExhaustiveResult m_result;
+};
+
+// Calls check(first, count, block) for consecutive runs of patterns, in increasing order within each run,
+//  on all cores, and merges the blocks into one result. check must report each failing pattern to block.Fail
+//  in increasing order. This is the engine behind the templates below; call it directly to check patterns in bulk
+//  (for example to run a SIMD kernel over a whole block at once and compare the outputs).
+FloatExhaustiveResult FloatExhaustive_Run(const std::function<void(uint32_t first, uint32_t count, FloatExhaustiveBlock& block)>& check,
+	const FloatExhaustiveOptions& options = FloatExhaustiveOptions());
+
+// Checks that property(value) returns true for every float.
+// property is called directly in the inner loop, so a lambda costs no more than hand-written code.
+template <typename Property>
+FloatExhaustiveResult FloatExhaustive_Check(Property property, const FloatExhaustiveOptions& options = FloatExhaustiveOptions())
+{
+	return FloatExhaustive_Run([&](uint32_t first, uint32_t count, FloatExhaustiveBlock& block) {
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t bits = first + i;
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			if (!property(value))
+				block.Fail(bits);
+		}
+	}, options);
+}
+
+// The error of result against the exact value reference, in units in the last place of a float near reference.
+// The ulp is that of the binade holding reference (subnormal spacing below FLT_MIN, and 2^104 past FLT_MAX).
+// Two NaNs, or an infinite reference matched exactly, are 0, as is an infinity of the right sign for a reference that
+//  overflows float; otherwise a NaN or infinity where the other side has none is infinite.
+double FloatExhaustive_UlpError(float result, double reference);
+
+// Checks that function(value) is within maxUlp of reference(value) for every float, where function returns float
+//  and reference returns a more precise double (for example the double version of the same function).
+// The result also reports the largest error found, even when it is within bounds.
+template <typename Function, typename Reference>
+FloatExhaustiveResult FloatExhaustive_CheckUlp(Function function, Reference reference, double maxUlp,
+	const FloatExhaustiveOptions& options = FloatExhaustiveOptions())
+{
+	return FloatExhaustive_Run([&](uint32_t first, uint32_t count, FloatExhaustiveBlock& block) {
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t bits = first + i;
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			double ulp = FloatExhaustive_UlpError(function(value), reference(value));
+			block.RecordUlp(bits, ulp);
+			if (!(ulp <= maxUlp))
+				block.Fail(bits);
+		}
+	}, options);
+}
+
+// Ready-made properties.
+// Formatting value with FloatFormat_Shortest and parsing the text with FloatFormat_Parse gives back the same bits
+//  (any NaN with the same sign for NaNs).
+bool FloatExhaustive_RoundTripsThroughText(float value);
+// Float_Classify agrees with std::fpclassify.
+bool FloatExhaustive_ClassifiesLikeStd(float value);
+
+// Prints a one-line summary with the throughput, and the counterexamples if there are any. Returns result.Passed().
+bool FloatExhaustive_Report(const char* name, const FloatExhaustiveResult& result);
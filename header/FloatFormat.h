@@ -0,0 +1,68 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatFormat.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+// Conversion between float/double and decimal text.
+// Formatting produces the shortest text that reads back as exactly the same value (the Ryu algorithm),
+//  laid out the way std::to_chars does without a format argument: fixed notation when that is not longer,
+//  scientific (1.5e+16) otherwise, "inf", "-inf", "nan" and "-nan" for the special values.
+// Parsing uses the Eisel-Lemire algorithm, so both directions work on integers instead of going through
+//  long division, and neither depends on the locale or allocates.
+// By contrast, std::cout << std::setprecision(10) << value may print too few digits to read a double back
+//  (17 can be needed) and too many for most floats.
+
+// Enough room for any float or double, e.g. "-2.2250738585072014e-308" or "-0.00012345678901234567".
+const size_t FloatFormat_MaxChars = 32;
+
+enum class FloatFormatStatus
+{
+	Ok,
+	Empty,       // no characters
+	Invalid,     // not a decimal number, "inf", "infinity" or "nan"
+	OutOfRange   // too large for the type; the value is set to infinity of the right sign
+};
+
+// Writes the shortest round-trip text for value and returns the number of characters written,
+//  or 0 if bufferSize is too small (FloatFormat_MaxChars is always enough). No '\0' is appended.
+size_t FloatFormat_Shortest(float value, char* buffer, size_t bufferSize);
+size_t FloatFormat_Shortest(double value, char* buffer, size_t bufferSize);
+
+// Parses [+-]digits[.digits][(e|E)[+-]digits], or inf, infinity or nan in any case.
+// The whole text must match; the result is correctly rounded (to nearest, ties to even).
+// value is only written when the result is Ok or OutOfRange.
+FloatFormatStatus FloatFormat_Parse(const char* text, size_t length, float& value);
+FloatFormatStatus FloatFormat_Parse(const char* text, size_t length, double& value);
+
+// Formatted text that can be streamed: std::cout << FloatFormat_Text(0.1f) prints 0.1.
+struct FloatText
+{
+	char chars[FloatFormat_MaxChars];
+	size_t length;
+};
+
+FloatText FloatFormat_Text(float value);
+FloatText FloatFormat_Text(double value);
+std::ostream& operator<<(std::ostream& stream, const FloatText& text);
@@ -0,0 +1,90 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatMath.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Vec3Batch.h"
+
+#include <cstddef>
+
+// Elementary functions over float arrays: 1/sqrt, sqrt, exp, log, sin and cos, four or eight values per instruction.
+// The C library computes one value per call and takes care to be within about half an ulp everywhere (an ulp is the
+//  gap between neighbouring floats, see FloatCompare.h). These give up a little of that for speed: each one is a
+//  short polynomial evaluated on every lane at once, and its largest error, in ulps against the exact value, is the
+//  constant below it. Numbers --check checks every bound against all 2^32 floats (FloatExhaustive.h).
+// Special values behave as in the C library: NaN in gives NaN out, log of a negative number is NaN and log(0) is
+//  -infinity, exp overflows to infinity and underflows through the subnormals to 0, and sin and cos of infinity are NaN.
+// For every function but FloatMath_Rsqrt the SSE2 and AVX2 kernels carry out the same operations in the same order
+//  as the scalar one (the build turns off contraction into FMA), so all kernels give bit-identical results.
+// In every function out may be values.
+
+enum class FloatMathKernel
+{
+	Auto,
+	Scalar,  // one value at a time
+	SSE2,    // 4 values per instruction
+	AVX2     // 8 values per instruction
+};
+
+// Returns true if the given kernel can run on this processor.
+bool FloatMath_KernelSupported(FloatMathKernel kernel);
+// Returns the kernel that will actually run: Auto becomes the widest supported kernel,
+//  and an unsupported kernel becomes Scalar.
+FloatMathKernel FloatMath_ResolveKernel(FloatMathKernel kernel);
+
+// 1/sqrt(x): the processor's 12-bit estimate (RSQRTPS) refined by one Newton step, y' = y + y * r/2 with
+//  r = 1 - x * y * y, extended by the next term of the series, + y * 3r^2/8, which triples the number of correct bits.
+// Subnormal inputs are scaled into the normal range first, since RSQRTPS treats them as zero.
+// The estimate differs between processor models, so unlike the other functions the results may too (always within
+//  the bound); the scalar kernel divides 1 by the correctly rounded square root.
+void FloatMath_Rsqrt(const float* values, size_t count, float* out, FloatMathKernel kernel = FloatMathKernel::Auto);
+const double FloatMath_RsqrtMaxUlp = 1.5;
+
+// sqrt(x), correctly rounded: SQRTPS is exact to the last bit, and pipelined well enough to need no approximation.
+void FloatMath_Sqrt(const float* values, size_t count, float* out, FloatMathKernel kernel = FloatMathKernel::Auto);
+const double FloatMath_SqrtMaxUlp = 0.5;
+
+// e^x = 2^n * e^r, with n the nearest integer to x / ln 2 and |r| <= ln 2 / 2; e^r is a degree 7 polynomial.
+void FloatMath_Exp(const float* values, size_t count, float* out, FloatMathKernel kernel = FloatMathKernel::Auto);
+const double FloatMath_ExpMaxUlp = 1.0;
+
+// log(x) = e * ln 2 + log(m), with x = m * 2^e and sqrt(1/2) <= m < sqrt(2); log(m) is a polynomial in m - 1.
+void FloatMath_Log(const float* values, size_t count, float* out, FloatMathKernel kernel = FloatMathKernel::Auto);
+const double FloatMath_LogMaxUlp = 1.0;
+
+// sin(x) and cos(x). x is reduced to r = x - j * pi/2 in double precision, which keeps every bit of r even when x is
+//  close to a multiple of pi/2, and sin(r) or cos(r) is a polynomial in r. Past |x| = 2^20 the reduction would need
+//  more bits of pi than a double holds, so those values (and infinities and NaNs) go through the double precision
+//  C library functions instead, one at a time. Rounding r to float costs up to half an ulp of its own, which is why
+//  the bound is larger than for exp and log.
+void FloatMath_Sin(const float* values, size_t count, float* out, FloatMathKernel kernel = FloatMathKernel::Auto);
+void FloatMath_Cos(const float* values, size_t count, float* out, FloatMathKernel kernel = FloatMathKernel::Auto);
+const double FloatMath_SinCosMaxUlp = 2.0;
+
+// Scales each vector { xs[i], ys[i], zs[i] } to length 1, in place: each component is multiplied by
+//  FloatMath_Rsqrt of x * x + y * y + z * z. That replaces a square root and three divisions per vector with one
+//  estimate, a Newton step and three multiplications.
+// Each component ends within FloatMath_NormalizeMaxUlp of the exact quotient. Zero vectors stay zero. The squared
+//  length must be finite, so components need to be below about 1e19 in magnitude, and vectors shorter than about
+//  1e-19 lose precision once it becomes subnormal.
+void Vec3_NormalizeBatch(float* xs, float* ys, float* zs, size_t count, FloatMathKernel kernel = FloatMathKernel::Auto);
+void Vec3_NormalizeBatch(vec3SoA& points, FloatMathKernel kernel = FloatMathKernel::Auto);
+const double FloatMath_NormalizeMaxUlp = 3.0;
@@ -0,0 +1,92 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: MiniFloat.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Conversion between float and the 16- and 8-bit floating point formats used to store large arrays compactly
+//  (model weights, sensor streams, textures). They have the same layout as the single-precision float described in
+//  FloatingPoint.cpp, with fewer exponent and significand bits:
+//
+//  Format    Sign  Exponent  Significand  Bias  Largest finite  Smallest normal  Infinity and NaN
+//  float       1       8         23        127    3.4e38          1.2e-38          as in FloatingPoint.cpp
+//  Half        1       5         10         15    65504           6.1e-5           exponent all ones, as in float
+//  BFloat16    1       8          7        127    3.4e38          1.2e-38          exponent all ones, as in float
+//  FP8E5M2     1       5          2         15    57344           6.1e-5           exponent all ones, as in float
+//  FP8E4M3     1       4          3          7    448             0.015625         no infinity; S.1111.111 is NaN
+//
+// Half is IEEE754 binary16. BFloat16 is the top half of a float: the same range with 8 bits of precision.
+// The FP8 formats are those of the OCP 8-bit floating point specification. E4M3 gives up infinities to
+//  gain one more binade; only the all-ones pattern is NaN.
+//
+// Converting from float rounds to the nearest representable value, ties to even, whatever the processor's
+//  rounding mode. Values too small for the format become subnormals and then signed zeros, exactly as in float;
+//  the MXCSR denormal flags (see Denormals.h) are never consulted. NaNs stay NaNs of the same sign, quiet, with the
+//  top bits of their payload (what the F16C instructions do). Converting to float is exact; NaNs come back quiet,
+//  except from BFloat16, which widens by a plain shift and so keeps a signaling NaN signaling.
+
+// The instruction sets the batch conversions can run on. Auto picks the widest one the processor supports.
+// Every kernel gives bit-identical results. AVX2 also needs F16C, which every AVX2 processor has.
+enum class MiniFloatKernel
+{
+	Auto,
+	Scalar,     // table driven, portable
+	AVX2,       // F16C for Half, AVX2 integer arithmetic and gathers for the others, 8 values per step
+	AVX512      // the same with AVX-512F, 16 values per step
+};
+
+// What a conversion to FP8 does with a finite value beyond the largest finite value of the format.
+enum class FP8Overflow
+{
+	NonFinite,  // infinity for E5M2 and NaN for E4M3, which has no infinity (the OCP default)
+	Saturate    // the largest finite value of the same sign; infinities saturate too
+};
+
+// Returns true if the given kernel can run on this processor.
+bool MiniFloat_KernelSupported(MiniFloatKernel kernel);
+// Returns the kernel that will actually run: Auto becomes the widest supported kernel,
+//  and an unsupported kernel becomes Scalar.
+MiniFloatKernel MiniFloat_ResolveKernel(MiniFloatKernel kernel);
+
+// Single values, always on the scalar kernel. The results are bit patterns: store them as they are,
+//  and reinterpret them only through the matching _ToFloat.
+uint16_t Half_FromFloat(float value);
+float Half_ToFloat(uint16_t bits);
+uint16_t BFloat16_FromFloat(float value);
+float BFloat16_ToFloat(uint16_t bits);
+uint8_t FP8E4M3_FromFloat(float value, FP8Overflow overflow = FP8Overflow::NonFinite);
+float FP8E4M3_ToFloat(uint8_t bits);
+uint8_t FP8E5M2_FromFloat(float value, FP8Overflow overflow = FP8Overflow::NonFinite);
+float FP8E5M2_ToFloat(uint8_t bits);
+
+// Converts count values. Input and output must not overlap.
+void Half_FromFloats(const float* values, size_t count, uint16_t* out, MiniFloatKernel kernel = MiniFloatKernel::Auto);
+void Half_ToFloats(const uint16_t* values, size_t count, float* out, MiniFloatKernel kernel = MiniFloatKernel::Auto);
+void BFloat16_FromFloats(const float* values, size_t count, uint16_t* out, MiniFloatKernel kernel = MiniFloatKernel::Auto);
+void BFloat16_ToFloats(const uint16_t* values, size_t count, float* out, MiniFloatKernel kernel = MiniFloatKernel::Auto);
+void FP8E4M3_FromFloats(const float* values, size_t count, uint8_t* out, FP8Overflow overflow = FP8Overflow::NonFinite,
+	MiniFloatKernel kernel = MiniFloatKernel::Auto);
+void FP8E4M3_ToFloats(const uint8_t* values, size_t count, float* out, MiniFloatKernel kernel = MiniFloatKernel::Auto);
+void FP8E5M2_FromFloats(const float* values, size_t count, uint8_t* out, FP8Overflow overflow = FP8Overflow::NonFinite,
+	MiniFloatKernel kernel = MiniFloatKernel::Auto);
+void FP8E5M2_ToFloats(const uint8_t* values, size_t count, float* out, MiniFloatKernel kernel = MiniFloatKernel::Auto);
@@ -0,0 +1,38 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: ParallelFor.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Splits the range [0, count) into chunks of grainSize items and calls body(begin, end) for each chunk,
+//  spreading the chunks over a pool of worker threads (one per hardware thread).
+// The calling thread works on chunks too, and ParallelFor returns once every chunk is done.
+// Each thread starts on its own contiguous slice of the chunks, which keeps neighbouring chunks on one core;
+//  a thread that runs out steals the back half of the fullest remaining slice, so slow chunks do not hold up the rest.
+// grainSize is raised if needed so that there are fewer than 2^32 chunks.
+// Workers run body with the calling thread's flush-to-zero/denormals-are-zero mode (see Denormals.h).
+// body must not throw. A ParallelFor issued from inside body runs serially on the calling thread.
+void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& body);
+
+// The number of threads ParallelFor spreads work over, including the calling thread.
+unsigned ParallelFor_ThreadCount();
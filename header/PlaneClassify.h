@@ -0,0 +1,91 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: PlaneClassify.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Vec3Batch.h"
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+// A plane is the set of points p for which Vec3_DotProduct(p, normal) + d == 0.
+// Points with a positive signed distance are in front of the plane, points with a negative one are behind it.
+struct plane {
+	vec3 normal;
+	float d;
+};
+
+enum class PlaneSide
+{
+	Back,
+	Front,
+	On
+};
+
+// Checking Vec3_DotProduct(position, normal) <= FLT_EPSILON only works for points close to the origin:
+//  the rounding error of a dot product grows with the size of its terms, so a point at (1000, 1000, 1000)
+//  lying exactly on a plane can easily produce a dot product of 1e-4.
+// Instead a point is on the plane when
+//   |dot + d| <= tolerance * (|x * n.x| + |y * n.y| + |z * n.z| + |d|)
+//  i.e. the tolerance is relative to the magnitude of the terms that were summed.
+// The default allows for the rounding of the four-term sum plus a few ulps of error in the inputs.
+const float Plane_DefaultTolerance = 4.0f * FLT_EPSILON;
+
+// Classifies a single point. Points with NaN coordinates are classified as Back.
+PlaneSide Plane_ClassifyPoint(vec3 point, const plane& p, float tolerance = Plane_DefaultTolerance);
+
+// The number of 64-bit words in the bitmask of one plane for count points.
+inline size_t Plane_BitmaskWords(size_t count) { return (count + 63) / 64; }
+
+// Classifies count points (in SoA form) against planeCount planes at once.
+// The results are packed bitmasks: bit (i % 64) of word (j * Plane_BitmaskWords(count) + i / 64) is set in
+//  frontBits if point i is in front of plane j, and in onBits if it lies on plane j. Points that are behind
+//  the plane have neither bit set. Unused bits in the last word of each plane are cleared.
+// Every kernel gives the same answer as Plane_ClassifyPoint. With parallel set, blocks of points are spread
+//  over all cores through ParallelFor.
+void Plane_ClassifyPoints(const float* xs, const float* ys, const float* zs, size_t count,
+	const plane* planes, size_t planeCount, uint64_t* frontBits, uint64_t* onBits,
+	float tolerance = Plane_DefaultTolerance, Vec3Kernel kernel = Vec3Kernel::Auto, bool parallel = true);
+
+// The result of classifying a point cloud against a set of planes, owning its bitmasks.
+struct PlaneClassification {
+	size_t pointCount = 0;
+	size_t planeCount = 0;
+	size_t wordsPerPlane = 0;
+	std::vector<uint64_t> frontBits;
+	std::vector<uint64_t> onBits;
+
+	// The bitmask words of plane j
+	const uint64_t* Front(size_t j) const { return frontBits.data() + j * wordsPerPlane; }
+	const uint64_t* On(size_t j) const { return onBits.data() + j * wordsPerPlane; }
+
+	PlaneSide Side(size_t point, size_t j) const
+	{
+		uint64_t bit = uint64_t(1) << (point % 64);
+		if (On(j)[point / 64] & bit)
+			return PlaneSide::On;
+		return (Front(j)[point / 64] & bit) ? PlaneSide::Front : PlaneSide::Back;
+	}
+};
+
+PlaneClassification Plane_ClassifyPoints(const vec3SoA& points, const plane* planes, size_t planeCount,
+	float tolerance = Plane_DefaultTolerance, Vec3Kernel kernel = Vec3Kernel::Auto, bool parallel = true);
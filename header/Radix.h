@@ -0,0 +1,114 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Radix.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Conversion between integers and text in any base from 2 to 36.
+// Digits above 9 are the letters a-z (or A-Z when formatting with uppercase; parsing accepts either).
+// Nothing here allocates: formatting writes into a caller-provided buffer and does not append a '\0',
+//  parsing reads exactly the characters it is given.
+
+// Enough room for any 64-bit integer in any base: 64 binary digits and a '-' sign.
+const size_t Radix_MaxChars = 65;
+
+enum class RadixStatus
+{
+	Ok,
+	Empty,          // no digits
+	InvalidDigit,   // a character that is not a digit of the base
+	OutOfRange,     // the value does not fit in the destination type
+	InvalidBase     // base outside 2..36
+};
+
+// The untyped cores of the templates below. magnitude is the absolute value of the integer.
+size_t Radix_FormatMagnitude(uint64_t magnitude, bool negative, unsigned base, char* buffer, size_t bufferSize,
+	bool uppercase);
+RadixStatus Radix_ParseMagnitude(const char* text, size_t length, unsigned base, bool allowSign,
+	uint64_t& magnitude, bool& negative);
+RadixStatus Radix_ParseLiteralMagnitude(const char* text, size_t length, bool allowSign,
+	uint64_t& magnitude, bool& negative);
+
+// Checks that a parsed magnitude fits in T and stores it in value if it does.
+template <typename T>
+RadixStatus Radix_StoreMagnitude(uint64_t magnitude, bool negative, T& value)
+{
+	typedef typename std::make_unsigned<T>::type U;
+	uint64_t limit = static_cast<uint64_t>(static_cast<U>(std::numeric_limits<T>::max())) + (negative ? 1 : 0);
+	if (magnitude > limit)
+		return RadixStatus::OutOfRange;
+	value = static_cast<T>(negative ? U(0) - static_cast<U>(magnitude) : static_cast<U>(magnitude));
+	return RadixStatus::Ok;
+}
+
+// Writes value in the given base into buffer and returns the number of characters written.
+// Returns 0 if the base is invalid or bufferSize is too small (Radix_MaxChars is always enough).
+template <typename T>
+size_t Radix_Format(T value, unsigned base, char* buffer, size_t bufferSize, bool uppercase = false)
+{
+	static_assert(std::is_integral<T>::value, "Radix_Format needs an integer type");
+	bool negative = std::is_signed<T>::value && value < T(0);
+	// Negating in unsigned arithmetic is well defined even for the minimum value of T.
+	uint64_t magnitude = negative ? uint64_t(0) - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+	return Radix_FormatMagnitude(magnitude, negative, base, buffer, bufferSize, uppercase);
+}
+
+// Parses text as an integer in the given base. Signed types accept a leading '+' or '-', unsigned types '+'.
+// value is only written when the result is RadixStatus::Ok.
+template <typename T>
+RadixStatus Radix_Parse(const char* text, size_t length, unsigned base, T& value)
+{
+	static_assert(std::is_integral<T>::value, "Radix_Parse needs an integer type");
+	uint64_t magnitude;
+	bool negative;
+	RadixStatus status = Radix_ParseMagnitude(text, length, base, std::is_signed<T>::value, magnitude, negative);
+	return status == RadixStatus::Ok ? Radix_StoreMagnitude(magnitude, negative, value) : status;
+}
+
+// Parses text written the way C++ writes integer literals (see Integers.cpp):
+//  0x or 0X for hexadecimal, 0b or 0B for binary, a leading 0 for octal, decimal otherwise.
+// The sign, if any, goes before the prefix: -0x1F.
+template <typename T>
+RadixStatus Radix_ParseLiteral(const char* text, size_t length, T& value)
+{
+	static_assert(std::is_integral<T>::value, "Radix_ParseLiteral needs an integer type");
+	uint64_t magnitude;
+	bool negative;
+	RadixStatus status = Radix_ParseLiteralMagnitude(text, length, std::is_signed<T>::value, magnitude, negative);
+	return status == RadixStatus::Ok ? Radix_StoreMagnitude(magnitude, negative, value) : status;
+}
+
+// Fixed-width hexadecimal for IDs and checksums: each value is exactly 16 digits, zero padded.
+// Radix_FormatHex64Batch writes 16 * count characters.
+// Radix_ParseHex64Batch reads 16 * count characters and returns how many values it parsed before
+//  the first field containing a non-hex character (count if all were valid).
+void Radix_FormatHex64Batch(const uint64_t* values, size_t count, char* out, bool uppercase = false);
+size_t Radix_ParseHex64Batch(const char* text, size_t count, uint64_t* values);
+
+// Returns true if every character is a digit of the base (an empty string counts as valid).
+// These check 8 characters per step with SWAR arithmetic, or 16 per step with SSE2.
+bool Radix_IsHexDigits(const char* text, size_t length);
+bool Radix_IsBinaryDigits(const char* text, size_t length);
+bool Radix_IsDecimalDigits(const char* text, size_t length);
@@ -0,0 +1,75 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Summation.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+// Summation of float arrays that does not lose small terms to large ones.
+// In float arithmetic 1000000.0f + 0.01f == 1000000.0f (see FloatingPoint.cpp): the sum has 24 bits of
+//  significand, and 0.01 lies below the last one. Adding many small readings to a large running total
+//  loses every one of them this way. The methods below trade a little speed for keeping them.
+// Every method spreads the terms over 16 lanes (term i goes to lane i % 16), which is what lets the
+//  SIMD kernels run the lanes side by side; the scalar kernel uses the same lanes, so all kernels
+//  give bit-identical results. Nothing here uses fused multiply-add.
+// The compensated methods rely on the compiler keeping floating point operations in source order:
+//  do not build this file with -ffast-math or /fp:fast.
+
+enum class SumMethod
+{
+	Naive,     // one float accumulator per lane: fastest, error grows with count / 16
+	Kahan,     // Kahan's compensated summation per lane: error about 2 ulp of the result, nearly independent of count
+	Neumaier,  // Neumaier's variant of Kahan, also correct when a term is larger than the running sum
+	Pairwise,  // naive sums of 1024-term blocks, then added in pairs: error grows with log2(count)
+	Cascaded   // each lane accumulates in double: error about count / 16 ulp of double, and the speed of Naive
+};
+
+// The instruction sets the methods can run on; Auto picks the widest one the processor supports.
+// Pairwise sums its blocks with the Naive kernel, so all five methods have all three.
+enum class SumKernel
+{
+	Auto,
+	Scalar,  // the 16 lanes one after another
+	SSE2,    // 4 lanes (2 for the doubles of Cascaded) per instruction
+	AVX2     // 8 lanes (4 for Cascaded) per instruction
+};
+
+// Returns true if the given kernel can run on this processor.
+bool Sum_KernelSupported(SumKernel kernel);
+// Returns the kernel that will actually run: Auto becomes the widest supported kernel,
+//  and an unsupported kernel becomes Scalar.
+SumKernel Sum_ResolveKernel(SumKernel kernel);
+
+// Returns the sum of count floats, accumulated with the given method. The result is a double because
+//  the accurate methods know the sum to more than float precision.
+double Sum_Floats(const float* values, size_t count, SumMethod method = SumMethod::Cascaded,
+	SumKernel kernel = SumKernel::Auto);
+
+// Returns the sum of a[i] * b[i]. The Cascaded method forms the products exactly in double;
+//  the others round each product to float before adding it.
+double Sum_DotProduct(const float* a, const float* b, size_t count, SumMethod method = SumMethod::Cascaded,
+	SumKernel kernel = SumKernel::Auto);
+
+// An upper bound on |computed - exact| for Sum_Floats (or Sum_DotProduct when dotProduct is set) over count terms
+//  whose magnitudes (|x[i]|, or |a[i] * b[i]|) add up to magnitudeSum. These are the textbook first-order bounds
+//  (Higham, "Accuracy and Stability of Numerical Algorithms", chapter 4) adapted to the 16-lane layout;
+//  actual errors are usually far smaller.
+double Sum_ErrorBound(SumMethod method, size_t count, double magnitudeSum, bool dotProduct = false);
@@ -0,0 +1,212 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: VarInt.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// Variable-length integers: small values take fewer bytes than large ones, so logs and messages made mostly of
+//  small counts, ids and differences shrink to a fraction of their fixed-width size.
+//  - LEB128 (as used by protobuf, DWARF and WebAssembly) stores 7 bits per byte, lowest first. The top bit of each
+//    byte says whether another byte follows, so values below 128 take 1 byte and a 64-bit value at most 10.
+//  - Stream VByte (Lemire, Kurz and Rupp, 2017) stores each 32-bit value in 1 to 4 bytes and keeps the lengths apart,
+//    2 bits per value, in control bytes at the start. One control byte describes four values, so a decoder can look
+//    up where all four lie at once and move them into place with a single byte shuffle (PSHUFB).
+// Both are for unsigned values: a small negative number in two's complement is all ones at the top (see the signed
+//  integers in Integers.cpp). Zigzag encoding interleaves the signs instead, 0, -1, 1, -2, 2 -> 0, 1, 2, 3, 4, so that
+//  small magnitudes of either sign stay small. The signed overloads below apply it on the way in and out.
+// Encoded data is little-endian and the same on every platform. Nothing here allocates except the stream classes:
+//  values and bytes go to and from buffers the caller owns.
+
+enum class VarIntStatus
+{
+	Ok,
+	Truncated,   // the input ended in the middle of a value, or before count values
+	Overflow,    // a LEB128 value does not fit in 64 bits, or a Stream VByte block claims more values than a block holds
+	StreamError  // reading or writing the stream failed
+};
+
+// The instruction sets Stream VByte decoding can run on. Auto picks the widest one the processor supports.
+// Every kernel gives the same results; encoding and LEB128 are scalar.
+enum class VarIntKernel
+{
+	Auto,
+	Scalar,  // one value at a time
+	SSSE3,   // four values per PSHUFB
+	AVX2     // eight values per VPSHUFB
+};
+
+// Returns true if the given kernel can run on this processor.
+bool VarInt_KernelSupported(VarIntKernel kernel);
+// Returns the kernel that will actually run: Auto becomes the widest supported kernel,
+//  and an unsupported kernel becomes Scalar.
+VarIntKernel VarInt_ResolveKernel(VarIntKernel kernel);
+
+// Zigzag encoding: (value << 1) ^ (value >> 31), written without shifting a negative number.
+constexpr uint32_t VarInt_ZigZagEncode(int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ (0u - (static_cast<uint32_t>(value) >> 31));
+}
+
+constexpr uint64_t VarInt_ZigZagEncode(int64_t value)
+{
+	return (static_cast<uint64_t>(value) << 1) ^ (0u - (static_cast<uint64_t>(value) >> 63));
+}
+
+constexpr int32_t VarInt_ZigZagDecode(uint32_t value)
+{
+	return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1)));
+}
+
+constexpr int64_t VarInt_ZigZagDecode(uint64_t value)
+{
+	return static_cast<int64_t>((value >> 1) ^ (0u - (value & 1)));
+}
+
+// The number of bytes LEB128 uses for value, and the most any 64-bit value uses.
+constexpr size_t VarInt_LEB128Size(uint64_t value)
+{
+	size_t size = 1;
+	while (value >= 0x80)
+	{
+		value >>= 7;
+		++size;
+	}
+	return size;
+}
+
+const size_t VarInt_LEB128MaxBytes = 10;
+
+// Writes count values to out as LEB128 and returns the number of bytes written.
+// out must have room for VarInt_LEB128MaxBytes * count bytes (or the sum of VarInt_LEB128Size over the values).
+size_t VarInt_EncodeLEB128(const uint64_t* values, size_t count, uint8_t* out);
+size_t VarInt_EncodeLEB128(const int64_t* values, size_t count, uint8_t* out);
+
+// Reads count LEB128 values from the size bytes at in. used, if not null, is set to the number of bytes read.
+// Longer encodings of a value than necessary (0x80 0x00 for 0) are accepted, as in protobuf.
+VarIntStatus VarInt_DecodeLEB128(const uint8_t* in, size_t size, uint64_t* values, size_t count, size_t* used = nullptr);
+VarIntStatus VarInt_DecodeLEB128(const uint8_t* in, size_t size, int64_t* values, size_t count, size_t* used = nullptr);
+
+// The most bytes Stream VByte uses for count values: one control byte per four values and 4 bytes per value.
+constexpr size_t VarInt_StreamVByteMaxBytes(size_t count)
+{
+	return (count + 3) / 4 + 4 * count;
+}
+
+// Writes count values to out as Stream VByte and returns the number of bytes written.
+// out must have room for VarInt_StreamVByteMaxBytes(count) bytes. The count itself is not stored.
+size_t VarInt_EncodeStreamVByte(const uint32_t* values, size_t count, uint8_t* out);
+size_t VarInt_EncodeStreamVByte(const int32_t* values, size_t count, uint8_t* out);
+
+// Reads count Stream VByte values from the size bytes at in. used, if not null, is set to the number of bytes read.
+// The SIMD kernels read up to 16 bytes past a value while the input has them, so no padding is needed after the data.
+VarIntStatus VarInt_DecodeStreamVByte(const uint8_t* in, size_t size, uint32_t* values, size_t count,
+	size_t* used = nullptr, VarIntKernel kernel = VarIntKernel::Auto);
+VarIntStatus VarInt_DecodeStreamVByte(const uint8_t* in, size_t size, int32_t* values, size_t count,
+	size_t* used = nullptr, VarIntKernel kernel = VarIntKernel::Auto);
+
+// Streams of values far larger than memory, written and read one buffer at a time.
+// A LEB128 stream is just the values one after another. A Stream VByte stream is a series of blocks of up to 65536
+//  values, each the number of values (4 bytes, little-endian) followed by the block encoded as above.
+// The writers keep values until a buffer is full; Flush (or the destructor) writes the rest. For signed values,
+//  apply VarInt_ZigZagEncode before writing and VarInt_ZigZagDecode after reading.
+
+class LEB128Writer
+{
+public:
+	explicit LEB128Writer(std::ostream& stream);
+	~LEB128Writer();
+	LEB128Writer(const LEB128Writer&) = delete;
+	LEB128Writer& operator=(const LEB128Writer&) = delete;
+
+	void Write(const uint64_t* values, size_t count);
+	void Write(uint64_t value) { Write(&value, 1); }
+	// Writes every value not yet written. Returns false if the stream has failed.
+	bool Flush();
+
+private:
+	std::ostream& m_stream;
+	std::vector<uint8_t> m_buffer;
+	size_t m_used;
+};
+
+class LEB128Reader
+{
+public:
+	explicit LEB128Reader(std::istream& stream);
+
+	// Reads up to maxCount values and returns how many were read. Fewer than maxCount means the stream has ended,
+	//  or that it is not valid (see Status).
+	size_t Read(uint64_t* values, size_t maxCount);
+	// Ok unless the stream has turned out not to be valid, and then Truncated, Overflow or StreamError.
+	VarIntStatus Status() const { return m_status; }
+
+private:
+	bool Refill();
+
+	std::istream& m_stream;
+	std::vector<uint8_t> m_buffer;
+	size_t m_begin, m_end;
+	bool m_eof;
+	VarIntStatus m_status;
+};
+
+class StreamVByteWriter
+{
+public:
+	explicit StreamVByteWriter(std::ostream& stream);
+	~StreamVByteWriter();
+	StreamVByteWriter(const StreamVByteWriter&) = delete;
+	StreamVByteWriter& operator=(const StreamVByteWriter&) = delete;
+
+	void Write(const uint32_t* values, size_t count);
+	void Write(uint32_t value) { Write(&value, 1); }
+	// Writes every value not yet written as a block. Returns false if the stream has failed.
+	bool Flush();
+
+private:
+	std::ostream& m_stream;
+	std::vector<uint32_t> m_values;
+	std::vector<uint8_t> m_encoded;
+};
+
+class StreamVByteReader
+{
+public:
+	explicit StreamVByteReader(std::istream& stream, VarIntKernel kernel = VarIntKernel::Auto);
+
+	// As LEB128Reader::Read.
+	size_t Read(uint32_t* values, size_t maxCount);
+	VarIntStatus Status() const { return m_status; }
+
+private:
+	bool NextBlock();
+
+	std::istream& m_stream;
+	VarIntKernel m_kernel;
+	std::vector<uint8_t> m_encoded;
+	std::vector<uint32_t> m_values;
+	size_t m_next;
+	VarIntStatus m_status;
+};
@@ -0,0 +1,72 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Vec3Batch.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// A 3D vector
+struct vec3 {
+	float x, y, z;
+};
+
+// Compute the dot product of two vec3s
+float Vec3_DotProduct(vec3 lhs, vec3 rhs);
+
+// A batch of 3D vectors stored as a structure of arrays (SoA).
+// An array of vec3s (AoS) interleaves x, y, z in memory, so a SIMD register loaded from it holds
+//  a mix of components. Keeping each component in its own array lets one register hold
+//  the x (or y, or z) of 4 or 8 consecutive points, which is what the batch kernels want.
+struct vec3SoA {
+	std::vector<float> x, y, z;
+
+	size_t size() const { return x.size(); }
+	void resize(size_t count) { x.resize(count); y.resize(count); z.resize(count); }
+};
+
+// The instruction sets Vec3_DotProductBatch can run on.
+// Auto picks the widest one supported by the running processor.
+enum class Vec3Kernel
+{
+	Auto,
+	Scalar,
+	SSE2,
+	AVX2
+};
+
+// Returns true if the given kernel can run on this processor.
+bool Vec3_KernelSupported(Vec3Kernel kernel);
+// Returns the kernel that will actually run: Auto becomes the widest supported kernel,
+//  and an unsupported kernel becomes Scalar.
+Vec3Kernel Vec3_ResolveKernel(Vec3Kernel kernel);
+
+// Transposes count points from AoS to SoA form. xs, ys and zs must each hold count floats.
+void Vec3_AoSToSoA(const vec3* points, size_t count, float* xs, float* ys, float* zs);
+vec3SoA Vec3_ToSoA(const vec3* points, size_t count);
+
+// Computes out[i] = Vec3_DotProduct({ xs[i], ys[i], zs[i] }, normal) for every i below count.
+// Every kernel evaluates (x * n.x + y * n.y) + z * n.z in that order with no fused multiply-add,
+//  so the SIMD kernels give bit-identical results to the scalar one and to Vec3_DotProduct.
+// Requesting a kernel the processor does not support falls back to the scalar kernel.
+void Vec3_DotProductBatch(const float* xs, const float* ys, const float* zs, size_t count,
+	vec3 normal, float* out, Vec3Kernel kernel = Vec3Kernel::Auto);
+void Vec3_DotProductBatch(const vec3SoA& points, vec3 normal, float* out, Vec3Kernel kernel = Vec3Kernel::Auto);
@@ -0,0 +1,601 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: WideInt.h
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "CheckedInt.h"
+#include "DecimalWideMath.h"
+#include "Radix.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-width integers wider than the built-in ones: UInt128, UInt256 and their signed counterparts.
+// A WideUInt is an array of 64-bit words, least significant first, and behaves like the built-in unsigned types:
+//  arithmetic wraps modulo 2^Bits. WideInt stores the same bits in two's complement, like int64_t.
+// Each 64 x 64 bit word product and 128 / 64 bit word division goes through DecimalWideMath (DecimalWideMath.h), which
+//  uses unsigned __int128 where the compiler has it. Division by a divisor of up to 64 bits runs one word division
+//  per word; wider divisors use shift-and-subtract, one quotient bit per step.
+// The overloads of Int_AddOverflow and friends at the end, with the IntTraits specializations, let
+//  Checked<UInt256>, Saturating<Int128> and Wrapping<...> work like they do for built-in types (see CheckedInt.h).
+
+// Loops over the words have a trip count known at compile time, but GCC at -O2 does not unroll them on its own,
+//  which leaves every word in memory and makes a 256-bit multiply about ten times slower.
+#if defined(__clang__)
+#define NUMBERS_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define NUMBERS_UNROLL _Pragma("GCC unroll 16")
+#else
+#define NUMBERS_UNROLL
+#endif
+
+template <unsigned Bits>
+class WideUInt
+{
+	static_assert(Bits >= 128 && Bits % 64 == 0, "WideUInt needs a multiple of 64 bits, at least 128");
+
+public:
+	static const unsigned Words = Bits / 64;
+
+	WideUInt() : m_words() {}
+	WideUInt(uint64_t value) : m_words() { m_words[0] = value; }
+
+	// Zero-extends or truncates a WideUInt of another width.
+	template <unsigned OtherBits>
+	explicit WideUInt(const WideUInt<OtherBits>& other) : m_words()
+	{
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words && i < WideUInt<OtherBits>::Words; ++i)
+			m_words[i] = other.Word(i);
+	}
+
+	static WideUInt Max()
+	{
+		WideUInt result;
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words; ++i)
+			result.m_words[i] = ~uint64_t(0);
+		return result;
+	}
+
+	// Word 0 is the least significant.
+	uint64_t Word(unsigned index) const { return m_words[index]; }
+	void SetWord(unsigned index, uint64_t value) { m_words[index] = value; }
+	bool Bit(unsigned index) const { return ((m_words[index / 64] >> (index % 64)) & 1) != 0; }
+
+	bool IsZero() const
+	{
+		uint64_t any = 0;
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words; ++i)
+			any |= m_words[i];
+		return any == 0;
+	}
+
+	explicit operator bool() const { return !IsZero(); }
+
+	// The number of significant bits: 0 for zero, Bits when the top bit is set.
+	unsigned BitLength() const
+	{
+		for (unsigned i = Words; i-- > 0;)
+			if (m_words[i] != 0)
+			{
+				// Binary search for the top set bit of the word.
+				unsigned length = 64 * i + 1;
+				uint64_t word = m_words[i];
+				for (unsigned step = 32; step != 0; step /= 2)
+					if (word >> step)
+					{
+						word >>= step;
+						length += step;
+					}
+				return length;
+			}
+		return 0;
+	}
+
+	// Adds other and returns the carry out of the top word.
+	bool AddWithCarry(const WideUInt& other)
+	{
+		uint64_t carry = 0;
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words; ++i)
+		{
+			uint64_t sum = m_words[i] + other.m_words[i];
+			uint64_t carryOut = sum < m_words[i];
+			m_words[i] = sum + carry;
+			carry = carryOut | (m_words[i] < sum);
+		}
+		return carry != 0;
+	}
+
+	// Subtracts other and returns the borrow out of the top word.
+	bool SubtractWithBorrow(const WideUInt& other)
+	{
+		uint64_t borrow = 0;
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words; ++i)
+		{
+			uint64_t difference = m_words[i] - other.m_words[i];
+			uint64_t borrowOut = m_words[i] < other.m_words[i];
+			m_words[i] = difference - borrow;
+			borrow = borrowOut | (difference < borrow);
+		}
+		return borrow != 0;
+	}
+
+	// Multiplies by factor, adds addend, and returns the word carried out of the top.
+	uint64_t MultiplyAddWord(uint64_t factor, uint64_t addend)
+	{
+		uint64_t carry = addend;
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words; ++i)
+		{
+			uint64_t high, low;
+			DecimalWideMath::Multiply(m_words[i], factor, high, low);
+			low += carry;
+			high += low < carry;
+			m_words[i] = low;
+			carry = high;
+		}
+		return carry;
+	}
+
+	// Divides by a single word in place and returns the remainder. divisor must not be zero.
+	uint64_t DivideWord(uint64_t divisor)
+	{
+		uint64_t remainder = 0;
+		NUMBERS_UNROLL
+		for (unsigned k = 1; k <= Words; ++k)
+			m_words[Words - k] = DecimalWideMath::Divide(remainder, m_words[Words - k], divisor, remainder);
+		return remainder;
+	}
+
+	// The full product a * b = high * 2^Bits + low.
+	static void MultiplyFull(const WideUInt& a, const WideUInt& b, WideUInt& high, WideUInt& low)
+	{
+		uint64_t product[2 * Words] = {};
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words; ++i)
+		{
+			uint64_t carry = 0;
+			NUMBERS_UNROLL
+			for (unsigned j = 0; j < Words; ++j)
+				product[i + j] = MultiplyAccumulate(a.m_words[i], b.m_words[j], product[i + j], carry);
+			product[i + Words] = carry;
+		}
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words; ++i)
+		{
+			low.m_words[i] = product[i];
+			high.m_words[i] = product[i + Words];
+		}
+	}
+
+	// Returns dividend / divisor and stores dividend % divisor in remainder. divisor must not be zero.
+	static WideUInt DivMod(const WideUInt& dividend, const WideUInt& divisor, WideUInt& remainder)
+	{
+		if (divisor.BitLength() <= 64)
+		{
+			WideUInt quotient = dividend;
+			remainder = WideUInt(quotient.DivideWord(divisor.m_words[0]));
+			return quotient;
+		}
+		WideUInt quotient, rest;
+		for (unsigned i = dividend.BitLength(); i-- > 0;)
+		{
+			// rest < divisor before the shift, so the bit shifted out of the top means rest > divisor after it.
+			bool top = rest.Bit(Bits - 1);
+			rest <<= 1;
+			rest.m_words[0] |= dividend.Bit(i) ? 1 : 0;
+			if (top || rest >= divisor)
+			{
+				rest -= divisor;
+				quotient.m_words[i / 64] |= uint64_t(1) << (i % 64);
+			}
+		}
+		remainder = rest;
+		return quotient;
+	}
+
+	// Returns -1, 0 or 1 as a is less than, equal to or greater than b.
+	static int Compare(const WideUInt& a, const WideUInt& b)
+	{
+		for (unsigned i = Words; i-- > 0;)
+			if (a.m_words[i] != b.m_words[i])
+				return a.m_words[i] < b.m_words[i] ? -1 : 1;
+		return 0;
+	}
+
+	WideUInt& operator+=(const WideUInt& other) { AddWithCarry(other); return *this; }
+	WideUInt& operator-=(const WideUInt& other) { SubtractWithBorrow(other); return *this; }
+
+	WideUInt& operator*=(const WideUInt& other)
+	{
+		// Only the words of the product below 2^Bits.
+		uint64_t product[Words] = {};
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words; ++i)
+		{
+			uint64_t carry = 0;
+			NUMBERS_UNROLL
+			for (unsigned j = 0; i + j < Words; ++j)
+				product[i + j] = MultiplyAccumulate(m_words[i], other.m_words[j], product[i + j], carry);
+		}
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words; ++i)
+			m_words[i] = product[i];
+		return *this;
+	}
+
+	// other must not be zero, as with the built-in operators.
+	WideUInt& operator/=(const WideUInt& other) { WideUInt remainder; *this = DivMod(*this, other, remainder); return *this; }
+	WideUInt& operator%=(const WideUInt& other) { DivMod(*this, other, *this); return *this; }
+
+	WideUInt& operator&=(const WideUInt& other) { for (unsigned i = 0; i < Words; ++i) m_words[i] &= other.m_words[i]; return *this; }
+	WideUInt& operator|=(const WideUInt& other) { for (unsigned i = 0; i < Words; ++i) m_words[i] |= other.m_words[i]; return *this; }
+	WideUInt& operator^=(const WideUInt& other) { for (unsigned i = 0; i < Words; ++i) m_words[i] ^= other.m_words[i]; return *this; }
+
+	// Shifts of Bits or more give zero (the built-in types leave that undefined).
+	WideUInt& operator<<=(unsigned shift)
+	{
+		unsigned wordShift = shift / 64, bitShift = shift % 64;
+		for (unsigned i = Words; i-- > 0;)
+		{
+			uint64_t word = i >= wordShift ? m_words[i - wordShift] << bitShift : 0;
+			if (bitShift != 0 && i > wordShift)
+				word |= m_words[i - wordShift - 1] >> (64 - bitShift);
+			m_words[i] = word;
+		}
+		return *this;
+	}
+
+	WideUInt& operator>>=(unsigned shift)
+	{
+		unsigned wordShift = shift / 64, bitShift = shift % 64;
+		NUMBERS_UNROLL
+		for (unsigned i = 0; i < Words; ++i)
+		{
+			uint64_t word = i + wordShift < Words ? m_words[i + wordShift] >> bitShift : 0;
+			if (bitShift != 0 && i + wordShift + 1 < Words)
+				word |= m_words[i + wordShift + 1] << (64 - bitShift);
+			m_words[i] = word;
+		}
+		return *this;
+	}
+
+	WideUInt operator~() const { WideUInt result; for (unsigned i = 0; i < Words; ++i) result.m_words[i] = ~m_words[i]; return result; }
+	WideUInt operator-() const { return WideUInt() - *this; }
+
+	friend WideUInt operator+(WideUInt a, const WideUInt& b) { return a += b; }
+	friend WideUInt operator-(WideUInt a, const WideUInt& b) { return a -= b; }
+	friend WideUInt operator*(WideUInt a, const WideUInt& b) { return a *= b; }
+	friend WideUInt operator/(WideUInt a, const WideUInt& b) { return a /= b; }
+	friend WideUInt operator%(WideUInt a, const WideUInt& b) { return a %= b; }
+	friend WideUInt operator&(WideUInt a, const WideUInt& b) { return a &= b; }
+	friend WideUInt operator|(WideUInt a, const WideUInt& b) { return a |= b; }
+	friend WideUInt operator^(WideUInt a, const WideUInt& b) { return a ^= b; }
+	friend WideUInt operator<<(WideUInt a, unsigned shift) { return a <<= shift; }
+	friend WideUInt operator>>(WideUInt a, unsigned shift) { return a >>= shift; }
+	friend bool operator==(const WideUInt& a, const WideUInt& b) { return Compare(a, b) == 0; }
+	friend bool operator!=(const WideUInt& a, const WideUInt& b) { return Compare(a, b) != 0; }
+	friend bool operator<(const WideUInt& a, const WideUInt& b) { return Compare(a, b) < 0; }
+	friend bool operator<=(const WideUInt& a, const WideUInt& b) { return Compare(a, b) <= 0; }
+	friend bool operator>(const WideUInt& a, const WideUInt& b) { return Compare(a, b) > 0; }
+	friend bool operator>=(const WideUInt& a, const WideUInt& b) { return Compare(a, b) >= 0; }
+
+private:
+	// Returns the low word of a * b + addend + carry and leaves the high word in carry. Cannot overflow:
+	//  (2^64 - 1)^2 + 2 (2^64 - 1) = 2^128 - 1.
+	static uint64_t MultiplyAccumulate(uint64_t a, uint64_t b, uint64_t addend, uint64_t& carry)
+	{
+		uint64_t high, low;
+		DecimalWideMath::Multiply(a, b, high, low);
+		low += addend;
+		high += low < addend;
+		low += carry;
+		high += low < carry;
+		carry = high;
+		return low;
+	}
+
+	uint64_t m_words[Words];
+};
+
+template <unsigned Bits>
+class WideInt
+{
+public:
+	WideInt() {}
+	WideInt(int64_t value) : m_bits(static_cast<uint64_t>(value))
+	{
+		if (value < 0)
+			for (unsigned i = 1; i < WideUInt<Bits>::Words; ++i)
+				m_bits.SetWord(i, ~uint64_t(0));
+	}
+
+	// The value whose two's complement representation is bits.
+	static WideInt FromBits(const WideUInt<Bits>& bits) { WideInt result; result.m_bits = bits; return result; }
+	static WideInt Max() { return FromBits(WideUInt<Bits>::Max() >> 1); }
+	static WideInt Min() { return FromBits(~(WideUInt<Bits>::Max() >> 1)); }
+
+	// The two's complement representation.
+	const WideUInt<Bits>& ToBits() const { return m_bits; }
+	bool IsNegative() const { return m_bits.Bit(Bits - 1); }
+	// |value|, exact even for Min().
+	WideUInt<Bits> Magnitude() const { return IsNegative() ? -m_bits : m_bits; }
+
+	static int Compare(const WideInt& a, const WideInt& b)
+	{
+		if (a.IsNegative() != b.IsNegative())
+			return a.IsNegative() ? -1 : 1;
+		return WideUInt<Bits>::Compare(a.m_bits, b.m_bits);
+	}
+
+	// Addition, subtraction and multiplication wrap; the bits are the same as for the unsigned type.
+	WideInt& operator+=(const WideInt& other) { m_bits += other.m_bits; return *this; }
+	WideInt& operator-=(const WideInt& other) { m_bits -= other.m_bits; return *this; }
+	WideInt& operator*=(const WideInt& other) { m_bits *= other.m_bits; return *this; }
+
+	// Division truncates toward zero and the remainder has the sign of the dividend, as for the built-in types.
+	// other must not be zero; Min() / -1 wraps to Min().
+	WideInt& operator/=(const WideInt& other)
+	{
+		WideUInt<Bits> remainder, quotient = WideUInt<Bits>::DivMod(Magnitude(), other.Magnitude(), remainder);
+		m_bits = IsNegative() != other.IsNegative() ? -quotient : quotient;
+		return *this;
+	}
+
+	WideInt& operator%=(const WideInt& other)
+	{
+		WideUInt<Bits> remainder;
+		WideUInt<Bits>::DivMod(Magnitude(), other.Magnitude(), remainder);
+		m_bits = IsNegative() ? -remainder : remainder;
+		return *this;
+	}
+
+	WideInt& operator<<=(unsigned shift) { m_bits <<= shift; return *this; }
+
+	// Arithmetic shift: the sign bit is copied into the vacated bits.
+	WideInt& operator>>=(unsigned shift)
+	{
+		bool negative = IsNegative();
+		m_bits >>= shift;
+		if (negative)
+			m_bits |= shift >= Bits ? WideUInt<Bits>::Max() : ~(WideUInt<Bits>::Max() >> shift);
+		return *this;
+	}
+
+	WideInt operator-() const { return FromBits(-m_bits); }
+
+	friend WideInt operator+(WideInt a, const WideInt& b) { return a += b; }
+	friend WideInt operator-(WideInt a, const WideInt& b) { return a -= b; }
+	friend WideInt operator*(WideInt a, const WideInt& b) { return a *= b; }
+	friend WideInt operator/(WideInt a, const WideInt& b) { return a /= b; }
+	friend WideInt operator%(WideInt a, const WideInt& b) { return a %= b; }
+	friend WideInt operator<<(WideInt a, unsigned shift) { return a <<= shift; }
+	friend WideInt operator>>(WideInt a, unsigned shift) { return a >>= shift; }
+	friend bool operator==(const WideInt& a, const WideInt& b) { return a.m_bits == b.m_bits; }
+	friend bool operator!=(const WideInt& a, const WideInt& b) { return a.m_bits != b.m_bits; }
+	friend bool operator<(const WideInt& a, const WideInt& b) { return Compare(a, b) < 0; }
+	friend bool operator<=(const WideInt& a, const WideInt& b) { return Compare(a, b) <= 0; }
+	friend bool operator>(const WideInt& a, const WideInt& b) { return Compare(a, b) > 0; }
+	friend bool operator>=(const WideInt& a, const WideInt& b) { return Compare(a, b) >= 0; }
+
+private:
+	WideUInt<Bits> m_bits;
+};
+
+typedef WideUInt<128> UInt128;
+typedef WideUInt<256> UInt256;
+typedef WideInt<128> Int128;
+typedef WideInt<256> Int256;
+
+// Enough room for WideInt_Format of a Bits-wide integer in any base: Bits binary digits and a '-' sign.
+template <unsigned Bits>
+struct WideInt_MaxChars
+{
+	static const size_t value = Bits + 1;
+};
+
+// Writes magnitude (with a leading '-' if negative) in the given base, like Radix_FormatMagnitude in Radix.h.
+// Returns the number of characters written, or 0 if the base is invalid or the buffer too small.
+template <unsigned Bits>
+size_t WideInt_FormatMagnitude(WideUInt<Bits> magnitude, bool negative, unsigned base, char* buffer, size_t bufferSize,
+	bool uppercase)
+{
+	if (base < 2 || base > 36)
+		return 0;
+	// Digits are peeled off a chunk at a time, with one division per word for each chunk:
+	//  a chunk is the largest power of base that fits in a word (10^19 for decimal).
+	uint64_t chunk = base;
+	unsigned chunkDigits = 1;
+	while (chunk <= ~uint64_t(0) / base)
+	{
+		chunk *= base;
+		++chunkDigits;
+	}
+	const char* alphabet = uppercase ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" : "0123456789abcdefghijklmnopqrstuvwxyz";
+	char reversed[Bits];
+	size_t count = 0;
+	do
+	{
+		uint64_t part = magnitude.DivideWord(chunk);
+		bool last = magnitude.IsZero();
+		// Inner chunks are zero padded; the last one stops at its leading digit.
+		for (unsigned digit = 0; digit < chunkDigits && !(last && part == 0 && digit > 0); ++digit)
+		{
+			reversed[count++] = alphabet[part % base];
+			part /= base;
+		}
+	} while (!magnitude.IsZero());
+
+	size_t length = count + (negative ? 1 : 0);
+	if (length > bufferSize)
+		return 0;
+	char* out = buffer;
+	if (negative)
+		*out++ = '-';
+	while (count > 0)
+		*out++ = reversed[--count];
+	return length;
+}
+
+template <unsigned Bits>
+size_t WideInt_Format(const WideUInt<Bits>& value, unsigned base, char* buffer, size_t bufferSize, bool uppercase = false)
+{
+	return WideInt_FormatMagnitude(value, false, base, buffer, bufferSize, uppercase);
+}
+
+template <unsigned Bits>
+size_t WideInt_Format(const WideInt<Bits>& value, unsigned base, char* buffer, size_t bufferSize, bool uppercase = false)
+{
+	return WideInt_FormatMagnitude(value.Magnitude(), value.IsNegative(), base, buffer, bufferSize, uppercase);
+}
+
+// Parses the digits of text in the given base into magnitude, with the same rules and statuses as Radix_ParseMagnitude.
+template <unsigned Bits>
+RadixStatus WideInt_ParseMagnitude(const char* text, size_t length, unsigned base, bool allowSign,
+	WideUInt<Bits>& magnitude, bool& negative)
+{
+	if (base < 2 || base > 36)
+		return RadixStatus::InvalidBase;
+	size_t i = 0;
+	negative = false;
+	if (i < length && (text[i] == '+' || (allowSign && text[i] == '-')))
+		negative = text[i++] == '-';
+	if (i == length)
+		return RadixStatus::Empty;
+
+	WideUInt<Bits> value;
+	bool overflow = false;
+	for (; i < length; ++i)
+	{
+		char c = text[i];
+		unsigned digit = c >= '0' && c <= '9' ? unsigned(c - '0')
+			: c >= 'a' && c <= 'z' ? unsigned(c - 'a' + 10)
+			: c >= 'A' && c <= 'Z' ? unsigned(c - 'A' + 10) : 36u;
+		if (digit >= base)
+			return RadixStatus::InvalidDigit;
+		// Keep reading after an overflow, so that a bad digit later on is still reported as such.
+		overflow |= value.MultiplyAddWord(base, digit) != 0;
+	}
+	if (overflow)
+		return RadixStatus::OutOfRange;
+	magnitude = value;
+	return RadixStatus::Ok;
+}
+
+// Parses text as an integer in the given base; value is only written when the result is RadixStatus::Ok.
+template <unsigned Bits>
+RadixStatus WideInt_Parse(const char* text, size_t length, unsigned base, WideUInt<Bits>& value)
+{
+	bool negative;
+	return WideInt_ParseMagnitude(text, length, base, false, value, negative);
+}
+
+template <unsigned Bits>
+RadixStatus WideInt_Parse(const char* text, size_t length, unsigned base, WideInt<Bits>& value)
+{
+	WideUInt<Bits> magnitude;
+	bool negative;
+	RadixStatus status = WideInt_ParseMagnitude(text, length, base, true, magnitude, negative);
+	if (status != RadixStatus::Ok)
+		return status;
+	WideUInt<Bits> limit = WideInt<Bits>::Max().ToBits() + WideUInt<Bits>(negative ? 1 : 0);
+	if (magnitude > limit)
+		return RadixStatus::OutOfRange;
+	value = WideInt<Bits>::FromBits(negative ? -magnitude : magnitude);
+	return RadixStatus::Ok;
+}
+
+// IntTraits and overflow detection for the policies in CheckedInt.h.
+template <unsigned Bits>
+struct IntTraits<WideUInt<Bits>>
+{
+	typedef WideUInt<Bits> Unsigned;
+	typedef WideUInt<Bits> Promoted;
+	static const bool isSigned = false;
+	static const int bits = Bits;
+	static WideUInt<Bits> Max() { return WideUInt<Bits>::Max(); }
+	static WideUInt<Bits> Min() { return WideUInt<Bits>(); }
+};
+
+template <unsigned Bits>
+struct IntTraits<WideInt<Bits>>
+{
+	typedef WideUInt<Bits> Unsigned;
+	typedef WideInt<Bits> Promoted;
+	static const bool isSigned = true;
+	static const int bits = Bits;
+	static WideInt<Bits> Max() { return WideInt<Bits>::Max(); }
+	static WideInt<Bits> Min() { return WideInt<Bits>::Min(); }
+};
+
+template <unsigned Bits>
+inline bool Int_AddOverflow(const WideUInt<Bits>& a, const WideUInt<Bits>& b, WideUInt<Bits>& result)
+{
+	result = a;
+	return result.AddWithCarry(b);
+}
+
+template <unsigned Bits>
+inline bool Int_SubOverflow(const WideUInt<Bits>& a, const WideUInt<Bits>& b, WideUInt<Bits>& result)
+{
+	result = a;
+	return result.SubtractWithBorrow(b);
+}
+
+template <unsigned Bits>
+inline bool Int_MulOverflow(const WideUInt<Bits>& a, const WideUInt<Bits>& b, WideUInt<Bits>& result)
+{
+	WideUInt<Bits> high;
+	WideUInt<Bits>::MultiplyFull(a, b, high, result);
+	return !high.IsZero();
+}
+
+// Signed overflow, as for the built-in types: the operands agree in sign and the result does not.
+template <unsigned Bits>
+inline bool Int_AddOverflow(const WideInt<Bits>& a, const WideInt<Bits>& b, WideInt<Bits>& result)
+{
+	bool aNegative = a.IsNegative(), bNegative = b.IsNegative();
+	result = a + b;
+	return aNegative == bNegative && result.IsNegative() != aNegative;
+}
+
+template <unsigned Bits>
+inline bool Int_SubOverflow(const WideInt<Bits>& a, const WideInt<Bits>& b, WideInt<Bits>& result)
+{
+	bool aNegative = a.IsNegative(), bNegative = b.IsNegative();
+	result = a - b;
+	return aNegative != bNegative && result.IsNegative() != aNegative;
+}
+
+template <unsigned Bits>
+inline bool Int_MulOverflow(const WideInt<Bits>& a, const WideInt<Bits>& b, WideInt<Bits>& result)
+{
+	bool negative = a.IsNegative() != b.IsNegative();
+	WideUInt<Bits> high, low;
+	WideUInt<Bits>::MultiplyFull(a.Magnitude(), b.Magnitude(), high, low);
+	WideUInt<Bits> limit = WideInt<Bits>::Max().ToBits() + WideUInt<Bits>(negative ? 1 : 0);
+	result = WideInt<Bits>::FromBits(negative ? -low : low);
+	return !high.IsZero() || low > limit;
+}
@@ -0,0 +1,1037 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Benchmarks.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/ClassDeclarations.h"
+#include "../header/Bits.h"
+#include "../header/CheckedInt.h"
+#include "../header/Decimal.h"
+#include "../header/Denormals.h"
+#include "../header/FloatCompare.h"
+#include "../header/FloatDecode.h"
+#include "../header/FloatFormat.h"
+#include "../header/FloatMath.h"
+#include "../header/MiniFloat.h"
+#include "../header/ParallelFor.h"
+#include "../header/PlaneClassify.h"
+#include "../header/Radix.h"
+#include "../header/Summation.h"
+#include "../header/VarInt.h"
+#include "../header/Vec3Batch.h"
+#include "../header/WideInt.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Runs body repeatedly and returns the fastest time in seconds.
+	// The fastest run is the one least disturbed by the rest of the system.
+	template <typename Body>
+	double BestOf(int repetitions, Body body)
+	{
+		double best = 1e300;
+		for (int r = 0; r < repetitions; ++r)
+		{
+			auto start = std::chrono::steady_clock::now();
+			body();
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			if (elapsed.count() < best)
+				best = elapsed.count();
+		}
+		return best;
+	}
+
+	void Report(const char* name, double seconds, size_t items)
+	{
+		std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << seconds * 1e9 / static_cast<double>(items) << " ns/item"
+			<< std::setw(12) << static_cast<double>(items) / seconds * 1e-6 << " Mitems/s\n";
+		std::cout.unsetf(std::ios::floatfield);
+	}
+
+	// Keeps the optimizer from discarding work whose result is otherwise unused.
+	volatile float g_sink;
+}
+
+void Benchmarks::RunAll()
+{
+	DotProductBenchmark();
+	PlaneClassifyBenchmark();
+	RadixBenchmark();
+	FloatDecodeBenchmark();
+	DenormalBenchmark();
+	DecimalBenchmark();
+	FloatFormatBenchmark();
+	SummationBenchmark();
+	CheckedIntBenchmark();
+	MiniFloatBenchmark();
+	FloatCompareBenchmark();
+	BitsBenchmark();
+	VarIntBenchmark();
+	FloatMathBenchmark();
+}
+
+void Benchmarks::DotProductBenchmark()
+{
+	std::cout << "\nDot product: per-call Vec3_DotProduct vs. SoA batch kernels\n";
+
+	const size_t count = 1 << 20;
+	const int repetitions = 20;
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+	std::vector<vec3> points(count);
+	for (vec3& p : points)
+		p = { coordinate(rng), coordinate(rng), coordinate(rng) };
+	vec3 normal = { 1.0f / sqrtf(3.0f), 1.0f / sqrtf(3.0f), 1.0f / sqrtf(3.0f) };
+
+	std::vector<float> reference(count);
+	Report("Vec3_DotProduct (AoS, per call)", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			reference[i] = Vec3_DotProduct(points[i], normal);
+	}), count);
+
+	vec3SoA soa;
+	soa.resize(count);
+	Report("Vec3_AoSToSoA", BestOf(repetitions, [&] {
+		Vec3_AoSToSoA(points.data(), count, soa.x.data(), soa.y.data(), soa.z.data());
+	}), count);
+
+	struct { const char* name; Vec3Kernel kernel; } kernels[] = {
+		{ "Vec3_DotProductBatch (scalar)", Vec3Kernel::Scalar },
+		{ "Vec3_DotProductBatch (SSE2)", Vec3Kernel::SSE2 },
+		{ "Vec3_DotProductBatch (AVX2)", Vec3Kernel::AVX2 },
+	};
+	std::vector<float> out(count);
+	for (const auto& k : kernels)
+	{
+		if (!Vec3_KernelSupported(k.kernel))
+		{
+			std::cout << k.name << ": not supported on this processor\n";
+			continue;
+		}
+		Report(k.name, BestOf(repetitions, [&] {
+			Vec3_DotProductBatch(soa, normal, out.data(), k.kernel);
+			g_sink = out[count - 1];
+		}), count);
+		if (std::memcmp(out.data(), reference.data(), count * sizeof(float)) != 0)
+			std::cout << "  MISMATCH: results differ from Vec3_DotProduct\n";
+	}
+}
+
+void Benchmarks::PlaneClassifyBenchmark()
+{
+	std::cout << "\nPlane classification: " << ParallelFor_ThreadCount() << " thread(s) available\n";
+
+	const size_t count = 1 << 20;
+	const int repetitions = 10;
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+	vec3SoA points;
+	points.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		points.x[i] = coordinate(rng);
+		points.y[i] = coordinate(rng);
+		points.z[i] = coordinate(rng);
+	}
+	// The six planes of a view frustum
+	const float s = 1.0f / sqrtf(2.0f);
+	plane planes[6] = {
+		{ { s, 0.0f, s }, 0.0f }, { { -s, 0.0f, s }, 0.0f },
+		{ { 0.0f, s, s }, 0.0f }, { { 0.0f, -s, s }, 0.0f },
+		{ { 0.0f, 0.0f, 1.0f }, -0.1f }, { { 0.0f, 0.0f, -1.0f }, 90.0f },
+	};
+	const size_t planeCount = 6;
+	const size_t tests = count * planeCount;
+
+	// The baseline: one scalar test per point and plane on one thread
+	size_t words = Plane_BitmaskWords(count);
+	std::vector<uint64_t> referenceFront(words * planeCount, 0), referenceOn(words * planeCount, 0);
+	Report("Plane_ClassifyPoint (per point)", BestOf(repetitions, [&] {
+		for (size_t j = 0; j < planeCount; ++j)
+		{
+			uint64_t* front = referenceFront.data() + j * words;
+			uint64_t* on = referenceOn.data() + j * words;
+			for (size_t i = 0; i < count; ++i)
+			{
+				PlaneSide side = Plane_ClassifyPoint({ points.x[i], points.y[i], points.z[i] }, planes[j]);
+				uint64_t bit = uint64_t(1) << (i % 64);
+				front[i / 64] = (front[i / 64] & ~bit) | (side == PlaneSide::Front ? bit : 0);
+				on[i / 64] = (on[i / 64] & ~bit) | (side == PlaneSide::On ? bit : 0);
+			}
+		}
+	}), tests);
+
+	struct { const char* name; Vec3Kernel kernel; bool parallel; } runs[] = {
+		{ "Plane_ClassifyPoints (scalar)", Vec3Kernel::Scalar, false },
+		{ "Plane_ClassifyPoints (SSE2)", Vec3Kernel::SSE2, false },
+		{ "Plane_ClassifyPoints (AVX2)", Vec3Kernel::AVX2, false },
+		{ "Plane_ClassifyPoints (AVX2, parallel)", Vec3Kernel::AVX2, true },
+	};
+	std::vector<uint64_t> front(words * planeCount), on(words * planeCount);
+	for (const auto& run : runs)
+	{
+		if (!Vec3_KernelSupported(run.kernel))
+		{
+			std::cout << run.name << ": not supported on this processor\n";
+			continue;
+		}
+		Report(run.name, BestOf(repetitions, [&] {
+			Plane_ClassifyPoints(points.x.data(), points.y.data(), points.z.data(), count, planes, planeCount,
+				front.data(), on.data(), Plane_DefaultTolerance, run.kernel, run.parallel);
+		}), tests);
+		if (front != referenceFront || on != referenceOn)
+			std::cout << "  MISMATCH: results differ from Plane_ClassifyPoint\n";
+	}
+}
+
+void Benchmarks::RadixBenchmark()
+{
+	std::cout << "\nInteger formatting and parsing\n";
+
+	const size_t count = 1 << 18;
+	const int repetitions = 10;
+	std::mt19937_64 rng(3);
+	std::vector<uint64_t> values(count);
+	for (uint64_t& v : values)
+		v = rng() >> (rng() % 64);
+
+	std::vector<char> text(count * Radix_MaxChars);
+	std::vector<size_t> lengths(count);
+	size_t checksum = 0;
+
+	Report("std::ostringstream << std::hex", BestOf(repetitions, [&] {
+		std::ostringstream stream;
+		for (size_t i = 0; i < count; ++i)
+			stream << std::hex << values[i] << ' ';
+		checksum += stream.str().size();
+	}), count);
+	Report("snprintf(\"%\" PRIx64)", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			lengths[i] = std::snprintf(&text[i * Radix_MaxChars], Radix_MaxChars, "%" PRIx64, values[i]);
+	}), count);
+	Report("Radix_Format (base 16)", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			lengths[i] = Radix_Format(values[i], 16, &text[i * Radix_MaxChars], Radix_MaxChars);
+	}), count);
+
+	Report("strtoull (base 16)", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+		{
+			text[i * Radix_MaxChars + lengths[i]] = '\0';
+			checksum += std::strtoull(&text[i * Radix_MaxChars], nullptr, 16);
+		}
+	}), count);
+	size_t parseErrors = 0;
+	Report("Radix_Parse (base 16)", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint64_t value;
+			if (Radix_Parse(&text[i * Radix_MaxChars], lengths[i], 16, value) != RadixStatus::Ok || value != values[i])
+				++parseErrors;
+		}
+	}), count);
+
+	Report("snprintf(\"%\" PRIu64)", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			lengths[i] = std::snprintf(&text[i * Radix_MaxChars], Radix_MaxChars, "%" PRIu64, values[i]);
+	}), count);
+	Report("Radix_Format (base 10)", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			lengths[i] = Radix_Format(values[i], 10, &text[i * Radix_MaxChars], Radix_MaxChars);
+	}), count);
+	Report("Radix_Parse (base 10)", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint64_t value;
+			if (Radix_Parse(&text[i * Radix_MaxChars], lengths[i], 10, value) != RadixStatus::Ok || value != values[i])
+				++parseErrors;
+		}
+	}), count);
+
+	std::vector<char> fixed(count * 16);
+	std::vector<uint64_t> parsed(count);
+	Report("Radix_FormatHex64Batch", BestOf(repetitions, [&] {
+		Radix_FormatHex64Batch(values.data(), count, fixed.data());
+	}), count);
+	Report("Radix_ParseHex64Batch", BestOf(repetitions, [&] {
+		checksum += Radix_ParseHex64Batch(fixed.data(), count, parsed.data());
+	}), count);
+	if (parseErrors != 0 || parsed != values)
+		std::cout << "  MISMATCH: parsed values differ from the originals\n";
+	g_sink = static_cast<float>(checksum);
+}
+
+void Benchmarks::FloatDecodeBenchmark()
+{
+	std::cout << "\nIEEE754 decoding\n";
+
+	const size_t count = 1 << 22;
+	const int repetitions = 10;
+	std::mt19937 rng(11);
+	std::vector<float> floats(count);
+	std::vector<double> doubles(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		// Mostly ordinary values, with some zeros, subnormals, infinities and NaNs mixed in
+		uint32_t bits = rng();
+		if (i % 16 == 0)
+			bits &= 0x807FFFFFu;
+		else if (i % 16 == 1)
+			bits |= 0x7F800000u;
+		std::memcpy(&floats[i], &bits, sizeof(bits));
+		doubles[i] = floats[i];
+	}
+
+	FloatCategoryCounts reference;
+	Report("std::fpclassify loop (float)", BestOf(repetitions, [&] {
+		reference = FloatCategoryCounts();
+		for (float f : floats)
+		{
+			switch (std::fpclassify(f))
+			{
+			case FP_ZERO: ++reference.zero; break;
+			case FP_SUBNORMAL: ++reference.subnormal; break;
+			case FP_NORMAL: ++reference.normal; break;
+			case FP_INFINITE: ++reference.infinite; break;
+			default: ++reference.nan; break;
+			}
+		}
+	}), count);
+
+	FloatCategoryCounts counts;
+	Report("FloatDecode_Count (float)", BestOf(repetitions, [&] {
+		counts = FloatDecode_Count(floats.data(), count);
+	}), count);
+	if (counts.nan != reference.nan || counts.subnormal != reference.subnormal || counts.Total() != count)
+		std::cout << "  MISMATCH: counts differ from std::fpclassify\n";
+
+	std::vector<uint8_t> signs(count), exponents(count);
+	std::vector<uint32_t> significands(count);
+	Report("FloatDecode_Split (float, all streams)", BestOf(repetitions, [&] {
+		FloatDecode_Split(floats.data(), count, signs.data(), exponents.data(), significands.data(), nullptr);
+	}), count);
+
+	Report("FloatDecode_Count (double)", BestOf(repetitions, [&] {
+		counts = FloatDecode_Count(doubles.data(), count);
+	}), count);
+	if (counts.nan != reference.nan || counts.Total() != count)
+		std::cout << "  MISMATCH: double counts differ from float counts\n";
+}
+
+void Benchmarks::DenormalBenchmark()
+{
+	std::cout << "\nDenormals: dot products of points near FLT_MIN, with and without FTZ/DAZ\n";
+
+	const size_t count = 1 << 18;
+	const int repetitions = 10;
+	std::mt19937 rng(13);
+	// Coordinates around FLT_MIN (~1.18e-38): some inputs are subnormal, and most products are.
+	std::uniform_real_distribution<float> coordinate(-2e-38f, 2e-38f);
+	std::vector<vec3> points(count);
+	for (vec3& p : points)
+		p = { coordinate(rng), coordinate(rng), coordinate(rng) };
+	vec3SoA soa = Vec3_ToSoA(points.data(), count);
+	vec3 normal = { 1.0f / sqrtf(3.0f), 1.0f / sqrtf(3.0f), 1.0f / sqrtf(3.0f) };
+	std::vector<float> out(count);
+
+	SubnormalCounts counts = Denormals_CountDotProducts(soa.x.data(), soa.y.data(), soa.z.data(), count, normal);
+	std::cout << counts.operations << " operations: " << counts.consumed << " consumed and "
+		<< counts.produced << " produced a subnormal\n";
+
+	DenormalMode flushMode;
+	flushMode.flushToZero = flushMode.denormalsAreZero = true;
+	for (int flush = 0; flush < 2; ++flush)
+	{
+		DenormalMode previous = Denormals_GetMode();
+		if (flush)
+			Denormals_SetMode(flushMode);
+		const char* perCall = flush ? "Vec3_DotProduct (FTZ/DAZ)" : "Vec3_DotProduct";
+		const char* batch = flush ? "Vec3_DotProductBatch (FTZ/DAZ)" : "Vec3_DotProductBatch";
+
+		Denormals_ClearFlags();
+		Report(perCall, BestOf(repetitions, [&] {
+			for (size_t i = 0; i < count; ++i)
+				out[i] = Vec3_DotProduct(points[i], normal);
+		}), count);
+		Report(batch, BestOf(repetitions, [&] {
+			Vec3_DotProductBatch(soa, normal, out.data());
+		}), count);
+		DenormalFlags flags = Denormals_ReadFlags();
+		std::cout << "  status flags: consumed " << (flags.consumed ? "yes" : "no")
+			<< ", produced " << (flags.produced ? "yes" : "no") << '\n';
+		Denormals_SetMode(previous);
+	}
+
+	{
+		ScopedFlushDenormals guard;
+		counts = Denormals_CountDotProducts(soa.x.data(), soa.y.data(), soa.z.data(), count, normal);
+	}
+	std::cout << "With ScopedFlushDenormals: " << counts.produced << " operations produced a subnormal\n";
+}
+
+void Benchmarks::DecimalBenchmark()
+{
+	std::cout << "\nDecimal: a ledger of Decimal64<2> amounts and prices\n";
+
+	typedef Decimal64<2> Money;
+	const size_t count = 1 << 20;
+	const int repetitions = 10;
+	std::mt19937 rng(17);
+	std::uniform_int_distribution<int64_t> cents(-10000000, 10000000);
+	std::uniform_int_distribution<int64_t> quantity(1, 100000);
+	std::vector<Money> amounts(count), quantities(count), products(count);
+	std::vector<double> amountsAsDouble(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		amounts[i] = Money::FromUnits(cents(rng));
+		quantities[i] = Money::FromUnits(quantity(rng));
+		amountsAsDouble[i] = amounts[i].ToDouble();
+	}
+
+	Money loopTotal, total;
+	Report("operator+ loop", BestOf(repetitions, [&] {
+		Money sum;
+		for (size_t i = 0; i < count; ++i)
+			sum += amounts[i];
+		loopTotal = sum;
+	}), count);
+	bool overflow = false;
+	Report("Decimal_Sum", BestOf(repetitions, [&] {
+		total = Decimal_Sum(amounts.data(), count, &overflow);
+	}), count);
+	double doubleTotal = 0.0;
+	Report("double sum (inexact)", BestOf(repetitions, [&] {
+		double sum = 0.0;
+		for (size_t i = 0; i < count; ++i)
+			sum += amountsAsDouble[i];
+		doubleTotal = sum;
+	}), count);
+	char text[48];
+	size_t length = total.Format(text, sizeof(text));
+	std::cout << "  Decimal total ";
+	std::cout.write(text, length) << ", double total " << std::setprecision(17) << doubleTotal
+		<< std::setprecision(6) << (overflow ? " (overflow)" : "") << (loopTotal == total ? "" : " (loop differs)") << '\n';
+
+	// The plain loop the batch kernels replace, then each kernel.
+	Report("Decimal_Multiply loop", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			products[i] = Decimal_Multiply(amounts[i], quantities[i]);
+	}), count);
+	std::vector<Money> loopProducts = products;
+	struct { const char* name; DecimalKernel kernel; } kernels[] = {
+		{ "Decimal_MultiplyBatch (scalar)", DecimalKernel::Scalar },
+		{ "Decimal_MultiplyBatch (AVX2)", DecimalKernel::AVX2 },
+	};
+	for (const auto& k : kernels)
+	{
+		if (!Decimal_KernelSupported(k.kernel))
+		{
+			std::cout << k.name << ": not supported on this processor\n";
+			continue;
+		}
+		Report(k.name, BestOf(repetitions, [&] {
+			Decimal_MultiplyBatch(amounts.data(), quantities.data(), products.data(), count, RoundingMode::HalfEven,
+				nullptr, k.kernel);
+		}), count);
+		if (products != loopProducts)
+			std::cout << "  MISMATCH against the loop\n";
+	}
+	Money rounded, exact;
+	Report("Decimal_MultiplyBatch + Decimal_Sum", BestOf(repetitions, [&] {
+		Decimal_MultiplyBatch(amounts.data(), quantities.data(), products.data(), count);
+		rounded = Decimal_Sum(products.data(), count);
+	}), count);
+	Report("Decimal_SumProducts", BestOf(repetitions, [&] {
+		exact = Decimal_SumProducts(amounts.data(), quantities.data(), count);
+	}), count);
+	length = exact.Format(text, sizeof(text));
+	std::cout << "  exact sum of products ";
+	std::cout.write(text, length) << ", rounding every product is off by ";
+	length = (rounded - exact).Format(text, sizeof(text));
+	std::cout.write(text, length) << '\n';
+
+	std::vector<char> formatted(count * 16);
+	std::vector<unsigned char> lengths(count);
+	Report("Format", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			lengths[i] = static_cast<unsigned char>(amounts[i].Format(&formatted[i * 16], 16));
+	}), count);
+	Report("Parse", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			Money::Parse(&formatted[i * 16], lengths[i], products[i]);
+	}), count);
+	std::cout << "  round trip " << (products == amounts ? "exact" : "MISMATCH") << '\n';
+}
+
+void Benchmarks::FloatFormatBenchmark()
+{
+	std::cout << "\nFloatFormat: doubles to shortest text and back\n";
+
+	const size_t count = 1 << 18;
+	const int repetitions = 5;
+	std::mt19937_64 rng(19);
+	// Metric-like values: a few significant digits over a wide range, plus arbitrary doubles.
+	std::uniform_real_distribution<double> mantissa(1.0, 10.0);
+	std::uniform_int_distribution<int> exponent(-12, 12);
+	std::vector<double> values(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (i % 2 == 0)
+		{
+			values[i] = std::round(mantissa(rng) * 1000.0) * std::pow(10.0, exponent(rng));
+		}
+		else
+		{
+			uint64_t bits = (rng() & 0x800FFFFFFFFFFFFFull) | (uint64_t(1023 - 60 + rng() % 120) << 52);
+			std::memcpy(&values[i], &bits, sizeof(bits));
+		}
+	}
+
+	const size_t stride = FloatFormat_MaxChars;
+	std::vector<char> text(count * stride);
+	std::vector<unsigned char> lengths(count);
+	Report("FloatFormat_Shortest", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			lengths[i] = static_cast<unsigned char>(FloatFormat_Shortest(values[i], &text[i * stride], stride));
+	}), count);
+	std::vector<char> scratch(count * stride);
+	Report("snprintf %.17g", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			std::snprintf(&scratch[i * stride], stride, "%.17g", values[i]);
+	}), count);
+	Report("ostringstream setprecision(17)", BestOf(1, [&] {
+		std::ostringstream stream;
+		stream << std::setprecision(17);
+		for (size_t i = 0; i < count; ++i)
+			stream << values[i] << ' ';
+		g_sink = static_cast<float>(stream.str().size());
+	}), count);
+
+	std::vector<double> parsed(count);
+	Report("FloatFormat_Parse", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			FloatFormat_Parse(&text[i * stride], lengths[i], parsed[i]);
+	}), count);
+	for (size_t i = 0; i < count; ++i)
+		text[i * stride + lengths[i]] = '\0';
+	Report("strtod", BestOf(repetitions, [&] {
+		for (size_t i = 0; i < count; ++i)
+			parsed[i] = std::strtod(&text[i * stride], nullptr);
+	}), count);
+	size_t mismatches = 0;
+	for (size_t i = 0; i < count; ++i)
+		mismatches += std::memcmp(&parsed[i], &values[i], sizeof(double)) != 0 ? 1 : 0;
+	std::cout << "  round trip " << (mismatches == 0 ? "exact" : "MISMATCH") << '\n';
+}
+
+void Benchmarks::SummationBenchmark()
+{
+	std::cout << "\nSummation: sensor readings (1000 +- 1) summed and dotted, error against a long double reference\n";
+
+	const SumMethod methods[] = { SumMethod::Naive, SumMethod::Kahan, SumMethod::Neumaier, SumMethod::Pairwise, SumMethod::Cascaded };
+	const char* names[] = { "Naive", "Kahan", "Neumaier", "Pairwise", "Cascaded" };
+	// One size that stays in cache and one that streams from memory
+	const size_t sizes[] = { size_t(1) << 14, size_t(1) << 24 };
+
+	std::mt19937 rng(23);
+	std::uniform_real_distribution<float> reading(999.0f, 1001.0f);
+	std::uniform_real_distribution<float> weight(-1.0f, 1.0f);
+	std::vector<float> values(sizes[1]), weights(sizes[1]);
+	for (size_t i = 0; i < sizes[1]; ++i)
+	{
+		values[i] = reading(rng);
+		weights[i] = weight(rng);
+	}
+
+	for (size_t count : sizes)
+	{
+		// long double has a 64-bit significand on x86 GCC and Clang, so its sums are good references.
+		//  With MSVC long double is double, which still beats every method but Cascaded.
+		long double referenceSum = 0.0L, referenceDot = 0.0L;
+		double magnitudeSum = 0.0, magnitudeDot = 0.0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			referenceSum += values[i];
+			referenceDot += static_cast<long double>(values[i]) * weights[i];
+			magnitudeSum += std::fabs(values[i]);
+			magnitudeDot += std::fabs(static_cast<double>(values[i]) * weights[i]);
+		}
+		const int repetitions = count < (size_t(1) << 20) ? 200 : 5;
+		std::cout << count << " floats:\n";
+		std::cout << std::left << std::setw(28) << "" << std::right << std::setw(10) << "GB/s"
+			<< std::setw(14) << "rel. error" << std::setw(14) << "rel. bound" << '\n';
+		for (int dot = 0; dot < 2; ++dot)
+		{
+			for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); ++m)
+			{
+				double result = 0.0;
+				double seconds = BestOf(repetitions, [&] {
+					result = dot ? Sum_DotProduct(values.data(), weights.data(), count, methods[m])
+						: Sum_Floats(values.data(), count, methods[m]);
+				});
+				long double reference = dot ? referenceDot : referenceSum;
+				double scale = std::fabs(static_cast<double>(reference));
+				double error = std::fabs(static_cast<double>(result - reference)) / scale;
+				double bound = Sum_ErrorBound(methods[m], count, dot ? magnitudeDot : magnitudeSum, dot != 0) / scale;
+				double bytes = static_cast<double>(count * sizeof(float) * (dot ? 2 : 1));
+				std::string name = std::string(dot ? "Sum_DotProduct " : "Sum_Floats ") + names[m];
+				std::cout << std::left << std::setw(28) << name << std::right
+					<< std::fixed << std::setprecision(2) << std::setw(10) << bytes / seconds * 1e-9
+					<< std::scientific << std::setprecision(2) << std::setw(14) << error << std::setw(14) << bound << '\n';
+				std::cout.unsetf(std::ios::floatfield);
+				std::cout << std::setprecision(6);
+			}
+		}
+	}
+}
+
+void Benchmarks::CheckedIntBenchmark()
+{
+	std::cout << "\nChecked integers: billing counters updated with overflow protection\n";
+
+	const size_t count = 1 << 20;
+	const int repetitions = 10;
+	std::mt19937_64 rng(23);
+	std::vector<uint64_t> charges(count), counters(count), out(count);
+	std::vector<int32_t> a32(count), b32(count), out32(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		charges[i] = rng() >> 20;
+		counters[i] = rng() >> 1;
+		a32[i] = static_cast<int32_t>(rng() >> 48) - 32768;
+		b32[i] = static_cast<int32_t>(rng() >> 49) - 16384;
+	}
+
+	// A running total: the policies should cost no more than the plain loop (Checked adds one OR per step).
+	uint64_t plain = 0;
+	Report("uint64_t total += charge", BestOf(repetitions, [&] {
+		uint64_t total = 0;
+		for (size_t i = 0; i < count; ++i)
+			total += charges[i];
+		plain = total;
+	}), count);
+	Saturating<uint64_t> saturated;
+	Report("Saturating<uint64_t> total += charge", BestOf(repetitions, [&] {
+		Saturating<uint64_t> total = 0;
+		for (size_t i = 0; i < count; ++i)
+			total += charges[i];
+		saturated = total;
+	}), count);
+	Checked<uint64_t> checked;
+	Report("Checked<uint64_t> total += charge", BestOf(repetitions, [&] {
+		Checked<uint64_t> total = 0;
+		for (size_t i = 0; i < count; ++i)
+			total += charges[i];
+		checked = total;
+	}), count);
+	if (saturated.Value() != plain || checked.Value() != plain || checked.Overflowed())
+		std::cout << "  MISMATCH: totals differ\n";
+
+	// A block of counters updated in place, half of them close enough to the top to saturate.
+	size_t reference = 0;
+	for (size_t i = 0; i < count; ++i)
+		reference += Int_SaturatingAdd(counters[i], charges[i] << 20) == ~uint64_t(0);
+	struct { const char* add64; const char* add32; const char* mul32; IntKernel kernel; } kernels[] = {
+		{ "Int_SaturatingAddBatch uint64 (scalar)", "Int_SaturatingAddBatch int32 (scalar)", "Int_SaturatingMulBatch int32 (scalar)", IntKernel::Scalar },
+		{ "Int_SaturatingAddBatch uint64 (AVX2)", "Int_SaturatingAddBatch int32 (AVX2)", "Int_SaturatingMulBatch int32 (AVX2)", IntKernel::AVX2 },
+	};
+	std::vector<uint64_t> shifted(count);
+	for (size_t i = 0; i < count; ++i)
+		shifted[i] = charges[i] << 20;
+	for (const auto& k : kernels)
+	{
+		if (!Int_KernelSupported(k.kernel))
+		{
+			std::cout << k.add64 << ": not supported on this processor\n";
+			continue;
+		}
+		size_t clamped = 0;
+		Report(k.add64, BestOf(repetitions, [&] {
+			clamped = Int_SaturatingAddBatch(counters.data(), shifted.data(), out.data(), count, k.kernel);
+		}), count);
+		if (clamped != reference)
+			std::cout << "  MISMATCH: " << clamped << " clamped, expected " << reference << '\n';
+		Report(k.add32, BestOf(repetitions, [&] {
+			Int_SaturatingAddBatch(a32.data(), b32.data(), out32.data(), count, k.kernel);
+		}), count);
+		Report(k.mul32, BestOf(repetitions, [&] {
+			Int_SaturatingMulBatch(a32.data(), b32.data(), out32.data(), count, k.kernel);
+		}), count);
+	}
+
+	// Wide integers: 256-bit products of the counters, reduced back modulo a 64-bit prime.
+	const size_t wideCount = count / 16;
+	UInt256 wideTotal;
+	Report("UInt256 multiply-add", BestOf(repetitions, [&] {
+		UInt256 total;
+		for (size_t i = 0; i < wideCount; ++i)
+			total += UInt256(counters[i]) * UInt256(charges[i]) * UInt256(counters[i + 1]);
+		wideTotal = total;
+	}), wideCount);
+	Report("UInt256 % 64-bit divisor", BestOf(repetitions, [&] {
+		UInt256 total;
+		for (size_t i = 0; i < wideCount; ++i)
+			total += (wideTotal + UInt256(counters[i])) % UInt256(0xFFFFFFFFFFFFFFC5ull);
+		g_sink = static_cast<float>(total.Word(0));
+	}), wideCount);
+}
+
+void Benchmarks::MiniFloatBenchmark()
+{
+	std::cout << "\nMiniFloat: sensor readings compressed to 16- and 8-bit floats and expanded again\n";
+
+	const size_t count = 1 << 20;
+	const int repetitions = 10;
+	std::mt19937 rng(29);
+	std::normal_distribution<float> reading(0.0f, 20.0f);
+	std::vector<float> values(count), back(count);
+	for (float& value : values)
+		value = reading(rng);
+	std::vector<uint16_t> half(count), bfloat16(count), sixteen(count);
+	std::vector<uint8_t> e4m3(count), e5m2(count), eight(count);
+	// Every kernel must give the scalar kernel's bits.
+	Half_FromFloats(values.data(), count, half.data(), MiniFloatKernel::Scalar);
+	BFloat16_FromFloats(values.data(), count, bfloat16.data(), MiniFloatKernel::Scalar);
+	FP8E4M3_FromFloats(values.data(), count, e4m3.data(), FP8Overflow::Saturate, MiniFloatKernel::Scalar);
+	FP8E5M2_FromFloats(values.data(), count, e5m2.data(), FP8Overflow::Saturate, MiniFloatKernel::Scalar);
+
+	const struct { const char* name; MiniFloatKernel kernel; } kernels[] = {
+		{ "scalar", MiniFloatKernel::Scalar },
+		{ "AVX2", MiniFloatKernel::AVX2 },
+		{ "AVX-512", MiniFloatKernel::AVX512 },
+	};
+	for (const auto& k : kernels)
+	{
+		std::string suffix = std::string(" (") + k.name + ")";
+		if (!MiniFloat_KernelSupported(k.kernel))
+		{
+			std::cout << "MiniFloat" << suffix << ": not supported on this processor\n";
+			continue;
+		}
+		bool same = true;
+		Report(("Half_FromFloats" + suffix).c_str(), BestOf(repetitions, [&] {
+			Half_FromFloats(values.data(), count, sixteen.data(), k.kernel);
+		}), count);
+		same = same && sixteen == half;
+		Report(("Half_ToFloats" + suffix).c_str(), BestOf(repetitions, [&] {
+			Half_ToFloats(half.data(), count, back.data(), k.kernel);
+		}), count);
+		Report(("BFloat16_FromFloats" + suffix).c_str(), BestOf(repetitions, [&] {
+			BFloat16_FromFloats(values.data(), count, sixteen.data(), k.kernel);
+		}), count);
+		same = same && sixteen == bfloat16;
+		Report(("BFloat16_ToFloats" + suffix).c_str(), BestOf(repetitions, [&] {
+			BFloat16_ToFloats(bfloat16.data(), count, back.data(), k.kernel);
+		}), count);
+		Report(("FP8E4M3_FromFloats" + suffix).c_str(), BestOf(repetitions, [&] {
+			FP8E4M3_FromFloats(values.data(), count, eight.data(), FP8Overflow::Saturate, k.kernel);
+		}), count);
+		same = same && eight == e4m3;
+		Report(("FP8E4M3_ToFloats" + suffix).c_str(), BestOf(repetitions, [&] {
+			FP8E4M3_ToFloats(e4m3.data(), count, back.data(), k.kernel);
+		}), count);
+		Report(("FP8E5M2_FromFloats" + suffix).c_str(), BestOf(repetitions, [&] {
+			FP8E5M2_FromFloats(values.data(), count, eight.data(), FP8Overflow::Saturate, k.kernel);
+		}), count);
+		same = same && eight == e5m2;
+		Report(("FP8E5M2_ToFloats" + suffix).c_str(), BestOf(repetitions, [&] {
+			FP8E5M2_ToFloats(e5m2.data(), count, back.data(), k.kernel);
+		}), count);
+		if (!same)
+			std::cout << "  MISMATCH: results differ from the scalar kernel\n";
+	}
+	g_sink = back[count / 2];
+}
+
+void Benchmarks::FloatCompareBenchmark()
+{
+	std::cout << "\nFloatCompare: a regression output diffed against its reference, a few ulps off in places\n";
+
+	const size_t count = 1 << 22;
+	const int repetitions = 10;
+	std::mt19937 rng(31);
+	std::uniform_real_distribution<float> value(-1000.0f, 1000.0f);
+	std::vector<float> reference(count), output(count);
+	std::vector<double> referenceDoubles(count), outputDoubles(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		reference[i] = value(rng);
+		referenceDoubles[i] = reference[i];
+		// One element in 16 is a neighbour instead, and one in 4096 is far off.
+		bool neighbour = rng() % 16 == 0, far = rng() % 4096 == 0;
+		output[i] = neighbour ? std::nextafter(reference[i], 0.0f) : reference[i];
+		outputDoubles[i] = neighbour ? std::nextafter(referenceDoubles[i], 0.0) : referenceDoubles[i];
+		if (far)
+		{
+			output[i] *= 1.5f;
+			outputDoubles[i] *= 1.5;
+		}
+	}
+	FloatTolerance tolerance;
+	tolerance.ulps = 2;
+	DoubleTolerance doubleTolerance;
+	doubleTolerance.ulps = 2;
+	std::vector<size_t> indices(100);
+
+	// What the comparison replaces: one element at a time, with a branch on each.
+	uint64_t naiveMismatches = 0;
+	Report("element by element (float)", BestOf(repetitions, [&] {
+		naiveMismatches = 0;
+		for (size_t i = 0; i < count; ++i)
+			if (!Float_NearlyEqualUlps(output[i], reference[i], tolerance.ulps))
+				++naiveMismatches;
+	}), count);
+
+	const struct { const char* name; FloatCompareKernel kernel; bool parallel; } kernels[] = {
+		{ "scalar", FloatCompareKernel::Scalar, false },
+		{ "AVX2", FloatCompareKernel::AVX2, false },
+		{ "AVX2, all cores", FloatCompareKernel::AVX2, true },
+	};
+	for (const auto& k : kernels)
+	{
+		std::string suffix = std::string(" (") + k.name + ")";
+		if (!Float_KernelSupported(k.kernel))
+		{
+			std::cout << "Float_CompareArrays" << suffix << ": not supported on this processor\n";
+			continue;
+		}
+		FloatArrayComparison floats, doubles;
+		Report(("CompareArrays float" + suffix).c_str(), BestOf(repetitions, [&] {
+			floats = Float_CompareArrays(output.data(), reference.data(), count, tolerance, indices.data(), indices.size(), k.kernel, k.parallel);
+		}), count);
+		Report(("CompareArrays double" + suffix).c_str(), BestOf(repetitions, [&] {
+			doubles = Float_CompareArrays(outputDoubles.data(), referenceDoubles.data(), count, doubleTolerance,
+				indices.data(), indices.size(), k.kernel, k.parallel);
+		}), count);
+		if (floats.mismatches != naiveMismatches || doubles.mismatches != naiveMismatches)
+			std::cout << "  MISMATCH: the kernels disagree on the number of mismatches\n";
+	}
+	g_sink = static_cast<float>(naiveMismatches);
+}
+
+void Benchmarks::BitsBenchmark()
+{
+	std::cout << "\nBits: a bitmap index of 2^24 rows scanned, intersected and repacked\n";
+
+	const size_t words = 1 << 18;
+	const int repetitions = 10;
+	std::mt19937_64 rng(37);
+	std::vector<uint64_t> rows(words), other(words), out(words);
+	for (size_t i = 0; i < words; ++i)
+	{
+		rows[i] = rng() & rng();
+		other[i] = rng();
+	}
+	// One row in 64 matches a selective predicate.
+	std::vector<uint64_t> selective(words);
+	for (size_t i = 0; i < words; ++i)
+		selective[i] = uint64_t(1) << (rng() % 64);
+	std::vector<uint64_t> positions(words);
+	const uint64_t mask = 0x00FF00FF00FF00FFull;
+
+	const struct { const char* name; BitsCountKernel kernel; } countKernels[] = {
+		{ "portable", BitsCountKernel::Portable },
+		{ "POPCNT", BitsCountKernel::Hardware },
+		{ "AVX2", BitsCountKernel::AVX2 },
+	};
+	uint64_t expected = Bits_PopCountArray(rows.data(), words, BitsCountKernel::Portable), count = 0;
+	for (const auto& k : countKernels)
+	{
+		std::string suffix = std::string(" (") + k.name + ")";
+		if (!Bits_KernelSupported(k.kernel))
+		{
+			std::cout << "Bits_PopCount" << suffix << ": not supported on this processor\n";
+			continue;
+		}
+		Report(("Bits_PopCountArray" + suffix).c_str(), BestOf(repetitions, [&] {
+			count = Bits_PopCountArray(rows.data(), words, k.kernel);
+		}), words);
+		if (count != expected)
+			std::cout << "  MISMATCH: the count differs from the portable kernel\n";
+		Report(("Bits_PopCountAnd" + suffix).c_str(), BestOf(repetitions, [&] {
+			count = Bits_PopCountAnd(rows.data(), other.data(), words, k.kernel);
+		}), words);
+	}
+	const struct { const char* name; BitsDepositKernel kernel; } depositKernels[] = {
+		{ "portable", BitsDepositKernel::Portable },
+		{ "BMI2", BitsDepositKernel::Hardware },
+	};
+	for (const auto& k : depositKernels)
+	{
+		std::string suffix = std::string(" (") + k.name + ")";
+		if (!Bits_KernelSupported(k.kernel))
+		{
+			std::cout << "Bits_Deposit" << suffix << ": not supported on this processor\n";
+			continue;
+		}
+		Report(("Bits_ExtractArray" + suffix).c_str(), BestOf(repetitions, [&] {
+			Bits_ExtractArray(rows.data(), words, mask, out.data(), k.kernel);
+		}), words);
+		Report(("Bits_DepositArray" + suffix).c_str(), BestOf(repetitions, [&] {
+			Bits_DepositArray(rows.data(), words, mask, out.data(), k.kernel);
+		}), words);
+	}
+	size_t found = 0;
+	Report("Bits_SetPositions (1 row in 64)", BestOf(repetitions, [&] {
+		found = Bits_SetPositions(selective.data(), words, positions.data());
+	}), words);
+	g_sink = static_cast<float>(count + found + out[words / 2]);
+}
+
+void Benchmarks::VarIntBenchmark()
+{
+	std::cout << "\nVarInt: 2^20 event log fields, mostly small\n";
+
+	// 70% of the values fit in 7 bits, 20% in 14, 9% in 21 and 1% need all 32.
+	const size_t count = 1 << 20;
+	const int repetitions = 10;
+	std::mt19937 rng(41);
+	std::vector<uint32_t> values(count), decoded(count);
+	std::vector<uint64_t> wide(count), wideDecoded(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t pick = rng() % 100;
+		int bits = pick < 70 ? 7 : pick < 90 ? 14 : pick < 99 ? 21 : 32;
+		values[i] = static_cast<uint32_t>(rng() >> (32 - bits));
+		wide[i] = values[i];
+	}
+	std::vector<uint8_t> leb(VarInt_LEB128MaxBytes * count), svb(VarInt_StreamVByteMaxBytes(count));
+	size_t lebBytes = 0, svbBytes = 0;
+
+	Report("VarInt_EncodeLEB128", BestOf(repetitions, [&] {
+		lebBytes = VarInt_EncodeLEB128(wide.data(), count, leb.data());
+	}), count);
+	Report("VarInt_DecodeLEB128", BestOf(repetitions, [&] {
+		VarInt_DecodeLEB128(leb.data(), lebBytes, wideDecoded.data(), count);
+	}), count);
+	Report("VarInt_EncodeStreamVByte", BestOf(repetitions, [&] {
+		svbBytes = VarInt_EncodeStreamVByte(values.data(), count, svb.data());
+	}), count);
+
+	const struct { const char* name; VarIntKernel kernel; } kernels[] = {
+		{ "scalar", VarIntKernel::Scalar },
+		{ "SSSE3", VarIntKernel::SSSE3 },
+		{ "AVX2", VarIntKernel::AVX2 },
+	};
+	for (const auto& k : kernels)
+	{
+		std::string name = std::string("VarInt_DecodeStreamVByte (") + k.name + ")";
+		if (!VarInt_KernelSupported(k.kernel))
+		{
+			std::cout << name << ": not supported on this processor\n";
+			continue;
+		}
+		Report(name.c_str(), BestOf(repetitions, [&] {
+			VarInt_DecodeStreamVByte(svb.data(), svbBytes, decoded.data(), count, nullptr, k.kernel);
+		}), count);
+		if (decoded != values)
+			std::cout << "  MISMATCH: the decoded values differ\n";
+	}
+	std::cout << "Bytes per value: 4 fixed, " << static_cast<double>(lebBytes) / count << " LEB128, "
+		<< static_cast<double>(svbBytes) / count << " Stream VByte\n";
+	g_sink = static_cast<float>(wideDecoded[count / 2] + decoded[count / 3]);
+}
+
+void Benchmarks::FloatMathBenchmark()
+{
+	std::cout << "\nFloatMath: 2^20 floats through the C library and the batch kernels, and 2^20 normals normalized\n";
+
+	const size_t count = 1 << 20;
+	const int repetitions = 10;
+	std::mt19937 rng(41);
+	std::uniform_real_distribution<float> positive(0.001f, 1000.0f), angle(-10.0f, 10.0f), exponent(-80.0f, 80.0f);
+	std::vector<float> positives(count), angles(count), exponents(count), out(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		positives[i] = positive(rng);
+		angles[i] = angle(rng);
+		exponents[i] = exponent(rng);
+	}
+
+	const struct
+	{
+		const char* name;
+		void (*batch)(const float*, size_t, float*, FloatMathKernel);
+		float (*library)(float);
+		const std::vector<float>& in;
+	} functions[] = {
+		{ "Rsqrt", FloatMath_Rsqrt, [](float x) { return 1.0f / std::sqrt(x); }, positives },
+		{ "Sqrt", FloatMath_Sqrt, [](float x) { return std::sqrt(x); }, positives },
+		{ "Exp", FloatMath_Exp, [](float x) { return std::exp(x); }, exponents },
+		{ "Log", FloatMath_Log, [](float x) { return std::log(x); }, positives },
+		{ "Sin", FloatMath_Sin, [](float x) { return std::sin(x); }, angles },
+		{ "Cos", FloatMath_Cos, [](float x) { return std::cos(x); }, angles },
+	};
+	const struct { const char* name; FloatMathKernel kernel; } kernels[] = {
+		{ "scalar", FloatMathKernel::Scalar },
+		{ "SSE2", FloatMathKernel::SSE2 },
+		{ "AVX2", FloatMathKernel::AVX2 },
+	};
+	for (const auto& f : functions)
+	{
+		Report((std::string("C library ") + f.name).c_str(), BestOf(repetitions, [&] {
+			for (size_t i = 0; i < count; ++i)
+				out[i] = f.library(f.in[i]);
+		}), count);
+		g_sink = out[count - 1];
+		for (const auto& k : kernels)
+			if (FloatMath_KernelSupported(k.kernel))
+				Report((std::string("FloatMath_") + f.name + " (" + k.name + ")").c_str(), BestOf(repetitions, [&] {
+					f.batch(f.in.data(), count, out.data(), k.kernel);
+				}), count);
+	}
+
+	// Normals of all lengths, normalized in place: each repetition starts over from a copy.
+	vec3SoA normals, work;
+	normals.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		normals.x[i] = angle(rng);
+		normals.y[i] = angle(rng);
+		normals.z[i] = angle(rng);
+	}
+	Report("sqrtf and three divisions", BestOf(repetitions, [&] {
+		work = normals;
+		for (size_t i = 0; i < count; ++i)
+		{
+			float length = std::sqrt(work.x[i] * work.x[i] + work.y[i] * work.y[i] + work.z[i] * work.z[i]);
+			work.x[i] /= length;
+			work.y[i] /= length;
+			work.z[i] /= length;
+		}
+	}), count);
+	for (const auto& k : kernels)
+		if (FloatMath_KernelSupported(k.kernel))
+			Report((std::string("Vec3_NormalizeBatch (") + k.name + ")").c_str(), BestOf(repetitions, [&] {
+				work = normals;
+				Vec3_NormalizeBatch(work, k.kernel);
+			}), count);
+	g_sink = work.x[count - 1];
+}
@@ -0,0 +1,293 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Bits.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/Bits.h"
+#include "../header/CpuFeatures.h"
+
+#include <algorithm>
+
+// POPCNT, PDEP and PEXT on 64-bit words only exist in 64-bit mode.
+#if defined(NUMBERS_X86) && (defined(__x86_64__) || defined(_M_X64))
+#define NUMBERS_BITS_HARDWARE 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	template <bool And>
+	inline uint64_t WordAt(const uint64_t* a, const uint64_t* b, size_t i)
+	{
+		return And ? a[i] & b[i] : a[i];
+	}
+
+	// b is only read when And is set.
+	template <bool And>
+	uint64_t PopCountPortable(const uint64_t* a, const uint64_t* b, size_t begin, size_t count)
+	{
+		uint64_t total = 0;
+		for (size_t i = begin; i < count; ++i)
+			total += BitsDetail::PopCount(WordAt<And>(a, b, i));
+		return total;
+	}
+
+#if defined(NUMBERS_BITS_HARDWARE)
+	template <bool And>
+	NUMBERS_TARGET("popcnt")
+	uint64_t PopCountHardware(const uint64_t* a, const uint64_t* b, size_t begin, size_t count)
+	{
+		// Four running sums, so that each POPCNT does not wait for the addition of the one before.
+		uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+		size_t i = begin;
+		for (; i + 4 <= count; i += 4)
+		{
+			s0 += _mm_popcnt_u64(WordAt<And>(a, b, i));
+			s1 += _mm_popcnt_u64(WordAt<And>(a, b, i + 1));
+			s2 += _mm_popcnt_u64(WordAt<And>(a, b, i + 2));
+			s3 += _mm_popcnt_u64(WordAt<And>(a, b, i + 3));
+		}
+		for (; i < count; ++i)
+			s0 += _mm_popcnt_u64(WordAt<And>(a, b, i));
+		return s0 + s1 + s2 + s3;
+	}
+
+	// The counts of the bytes of v: each nibble looks up its own count in a 16-entry table (VPSHUFB),
+	//  and the two counts of each byte are added.
+	NUMBERS_TARGET("avx2")
+	inline __m256i PopCountBytesAVX2(__m256i v)
+	{
+		const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+		__m256i low = _mm256_and_si256(v, lowNibbles);
+		__m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibbles);
+		return _mm256_add_epi8(_mm256_shuffle_epi8(table, low), _mm256_shuffle_epi8(table, high));
+	}
+
+	template <bool And>
+	NUMBERS_TARGET("avx2,popcnt")
+	uint64_t PopCountAVX2(const uint64_t* a, const uint64_t* b, size_t count)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i total = zero;
+		size_t i = 0;
+		while (i + 4 <= count)
+		{
+			// A byte count grows by at most 8 per step, so 31 steps fit in a byte (248);
+			//  then VPSADBW adds each group of 8 bytes into a 64-bit lane of the total.
+			__m256i bytes = zero;
+			size_t steps = std::min<size_t>((count - i) / 4, 31);
+			for (size_t step = 0; step < steps; ++step, i += 4)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+				if (And)
+					v = _mm256_and_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+				bytes = _mm256_add_epi8(bytes, PopCountBytesAVX2(v));
+			}
+			total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, zero));
+		}
+		alignas(32) uint64_t lanes[4];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+		return lanes[0] + lanes[1] + lanes[2] + lanes[3] + PopCountHardware<And>(a, b, i, count);
+	}
+
+	NUMBERS_TARGET("bmi2")
+	void DepositHardware(const uint64_t* values, size_t count, uint64_t mask, uint64_t* out)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = _pdep_u64(values[i], mask);
+	}
+
+	NUMBERS_TARGET("bmi2")
+	void ExtractHardware(const uint64_t* values, size_t count, uint64_t mask, uint64_t* out)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = _pext_u64(values[i], mask);
+	}
+#endif
+
+	// A mask as runs of consecutive set bits. Extracting moves each run down by the number of clear bits below it,
+	//  and depositing moves it back up, so an array costs one mask and shift per run instead of one step per bit.
+	struct MaskRuns
+	{
+		int count = 0;
+		uint64_t masks[32] = {};
+		int shifts[32] = {};
+
+		explicit MaskRuns(uint64_t mask)
+		{
+			for (int kept = 0; mask != 0; ++count)
+			{
+				// Adding the lowest set bit carries through the lowest run and clears it.
+				uint64_t run = mask & ~(mask + (mask & (0 - mask)));
+				masks[count] = run;
+				shifts[count] = Bits_CountTrailingZeros(run) - kept;
+				kept += Bits_PopCount(run);
+				mask &= ~run;
+			}
+		}
+	};
+
+	void DepositPortable(const uint64_t* values, size_t count, uint64_t mask, uint64_t* out)
+	{
+		const MaskRuns runs(mask);
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint64_t value = values[i], result = 0;
+			for (int r = 0; r < runs.count; ++r)
+				result |= (value << runs.shifts[r]) & runs.masks[r];
+			out[i] = result;
+		}
+	}
+
+	void ExtractPortable(const uint64_t* values, size_t count, uint64_t mask, uint64_t* out)
+	{
+		const MaskRuns runs(mask);
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint64_t value = values[i], result = 0;
+			for (int r = 0; r < runs.count; ++r)
+				result |= (value & runs.masks[r]) >> runs.shifts[r];
+			out[i] = result;
+		}
+	}
+
+	template <bool And>
+	uint64_t PopCount(const uint64_t* a, const uint64_t* b, size_t count, BitsCountKernel kernel)
+	{
+		switch (Bits_ResolveKernel(kernel))
+		{
+#if defined(NUMBERS_BITS_HARDWARE)
+		case BitsCountKernel::AVX2:
+			return PopCountAVX2<And>(a, b, count);
+		case BitsCountKernel::Hardware:
+			return PopCountHardware<And>(a, b, 0, count);
+#endif
+		default:
+			return PopCountPortable<And>(a, b, 0, count);
+		}
+	}
+}
+
+bool Bits_KernelSupported(BitsCountKernel kernel)
+{
+	switch (kernel)
+	{
+	case BitsCountKernel::Auto:
+	case BitsCountKernel::Portable:
+		return true;
+#if defined(NUMBERS_BITS_HARDWARE)
+	case BitsCountKernel::Hardware:
+		return CpuFeatures::HasPOPCNT();
+	case BitsCountKernel::AVX2:
+		// The words left over after the last 4 are counted with POPCNT.
+		return CpuFeatures::HasAVX2() && CpuFeatures::HasPOPCNT();
+#endif
+	default:
+		return false;
+	}
+}
+
+bool Bits_KernelSupported(BitsDepositKernel kernel)
+{
+	switch (kernel)
+	{
+	case BitsDepositKernel::Auto:
+	case BitsDepositKernel::Portable:
+		return true;
+#if defined(NUMBERS_BITS_HARDWARE)
+	case BitsDepositKernel::Hardware:
+		return CpuFeatures::HasBMI2();
+#endif
+	default:
+		return false;
+	}
+}
+
+BitsCountKernel Bits_ResolveKernel(BitsCountKernel kernel)
+{
+	if (kernel == BitsCountKernel::Auto)
+	{
+		if (Bits_KernelSupported(BitsCountKernel::AVX2))
+			return BitsCountKernel::AVX2;
+		if (Bits_KernelSupported(BitsCountKernel::Hardware))
+			return BitsCountKernel::Hardware;
+		return BitsCountKernel::Portable;
+	}
+	return Bits_KernelSupported(kernel) ? kernel : BitsCountKernel::Portable;
+}
+
+BitsDepositKernel Bits_ResolveKernel(BitsDepositKernel kernel)
+{
+	if (kernel == BitsDepositKernel::Auto)
+	{
+#if defined(NUMBERS_BITS_HARDWARE)
+		if (CpuFeatures::HasFastBMI2())
+			return BitsDepositKernel::Hardware;
+#endif
+		return BitsDepositKernel::Portable;
+	}
+	return Bits_KernelSupported(kernel) ? kernel : BitsDepositKernel::Portable;
+}
+
+uint64_t Bits_PopCountArray(const uint64_t* words, size_t count, BitsCountKernel kernel)
+{
+	return PopCount<false>(words, nullptr, count, kernel);
+}
+
+uint64_t Bits_PopCountAnd(const uint64_t* a, const uint64_t* b, size_t count, BitsCountKernel kernel)
+{
+	return PopCount<true>(a, b, count, kernel);
+}
+
+void Bits_DepositArray(const uint64_t* values, size_t count, uint64_t mask, uint64_t* out, BitsDepositKernel kernel)
+{
+#if defined(NUMBERS_BITS_HARDWARE)
+	if (Bits_ResolveKernel(kernel) == BitsDepositKernel::Hardware)
+	{
+		DepositHardware(values, count, mask, out);
+		return;
+	}
+#endif
+	DepositPortable(values, count, mask, out);
+}
+
+void Bits_ExtractArray(const uint64_t* values, size_t count, uint64_t mask, uint64_t* out, BitsDepositKernel kernel)
+{
+#if defined(NUMBERS_BITS_HARDWARE)
+	if (Bits_ResolveKernel(kernel) == BitsDepositKernel::Hardware)
+	{
+		ExtractHardware(values, count, mask, out);
+		return;
+	}
+#endif
+	ExtractPortable(values, count, mask, out);
+}
+
+size_t Bits_SetPositions(const uint64_t* words, size_t count, uint64_t* positions)
+{
+	// Each step finds the lowest set bit and clears it, so the time follows the number of set bits,
+	//  and an all-zero word costs one test.
+	size_t written = 0;
+	for (size_t i = 0; i < count; ++i)
+		for (uint64_t word = words[i]; word != 0; word &= word - 1)
+			positions[written++] = 64 * static_cast<uint64_t>(i) + static_cast<uint64_t>(Bits_CountTrailingZeros(word));
+	return written;
+}
@@ -0,0 +1,281 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: CheckedInt.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/CheckedInt.h"
+#include "../header/CpuFeatures.h"
+
+#if defined(NUMBERS_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// The scalar kernels also finish the tails of the SIMD kernels, starting at begin.
+	template <typename T>
+	size_t SaturatingAddScalar(const T* a, const T* b, T* out, size_t begin, size_t count)
+	{
+		size_t clamped = 0;
+		for (size_t i = begin; i < count; ++i)
+		{
+			T sum;
+			bool overflow = Int_AddOverflow(a[i], b[i], sum);
+			T limit = IntTraits<T>::isSigned && b[i] < T(0) ? IntTraits<T>::Min() : IntTraits<T>::Max();
+			out[i] = overflow ? limit : sum;
+			clamped += overflow;
+		}
+		return clamped;
+	}
+
+	template <typename T>
+	size_t SaturatingMulScalar(const T* a, const T* b, T* out, size_t begin, size_t count)
+	{
+		size_t clamped = 0;
+		for (size_t i = begin; i < count; ++i)
+		{
+			T product;
+			bool overflow = Int_MulOverflow(a[i], b[i], product);
+			T limit = IntTraits<T>::isSigned && ((a[i] < T(0)) != (b[i] < T(0))) ? IntTraits<T>::Min() : IntTraits<T>::Max();
+			out[i] = overflow ? limit : product;
+			clamped += overflow;
+		}
+		return clamped;
+	}
+
+#if defined(NUMBERS_X86)
+	// Counts the set bits of a lane mask from movemask (at most 8 bits). AVX2 does not imply POPCNT, so no intrinsic.
+	inline size_t CountLanes(int mask)
+	{
+		unsigned bits = static_cast<unsigned>(mask);
+		bits = bits - ((bits >> 1) & 0x55);
+		bits = (bits & 0x33) + ((bits >> 2) & 0x33);
+		return (bits + (bits >> 4)) & 0x0F;
+	}
+
+	NUMBERS_TARGET("avx2")
+	inline size_t CountLanes32(__m256i mask) { return CountLanes(_mm256_movemask_ps(_mm256_castsi256_ps(mask))); }
+
+	NUMBERS_TARGET("avx2")
+	inline size_t CountLanes64(__m256i mask) { return CountLanes(_mm256_movemask_pd(_mm256_castsi256_pd(mask))); }
+
+	// Signed addition overflows when both operands differ in sign from the sum: the sign bit of (a ^ sum) & (b ^ sum).
+	// The clamp value is Max for a non-negative a and Min for a negative one: (a >> 31) ^ Max.
+	NUMBERS_TARGET("avx2")
+	size_t SaturatingAddAVX2(const int32_t* a, const int32_t* b, int32_t* out, size_t count)
+	{
+		const __m256i max = _mm256_set1_epi32(INT32_MAX);
+		size_t clamped = 0, i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			__m256i sum = _mm256_add_epi32(x, y);
+			__m256i overflow = _mm256_srai_epi32(_mm256_and_si256(_mm256_xor_si256(x, sum), _mm256_xor_si256(y, sum)), 31);
+			__m256i limit = _mm256_xor_si256(_mm256_srai_epi32(x, 31), max);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_blendv_epi8(sum, limit, overflow));
+			clamped += CountLanes32(overflow);
+		}
+		return clamped + SaturatingAddScalar(a, b, out, i, count);
+	}
+
+	// Unsigned addition overflows when the sum wraps below an operand; the clamp value (all ones) is then the mask itself.
+	NUMBERS_TARGET("avx2")
+	size_t SaturatingAddAVX2(const uint32_t* a, const uint32_t* b, uint32_t* out, size_t count)
+	{
+		size_t clamped = 0, i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			__m256i sum = _mm256_add_epi32(x, y);
+			__m256i overflow = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(sum, x), sum), _mm256_set1_epi32(-1));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_or_si256(sum, overflow));
+			clamped += CountLanes32(overflow);
+		}
+		return clamped + SaturatingAddScalar(a, b, out, i, count);
+	}
+
+	// AVX2 has no 64-bit arithmetic shift, so the sign masks come from a comparison with zero.
+	NUMBERS_TARGET("avx2")
+	size_t SaturatingAddAVX2(const int64_t* a, const int64_t* b, int64_t* out, size_t count)
+	{
+		const __m256i max = _mm256_set1_epi64x(INT64_MAX);
+		const __m256i zero = _mm256_setzero_si256();
+		size_t clamped = 0, i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			__m256i sum = _mm256_add_epi64(x, y);
+			__m256i overflow = _mm256_cmpgt_epi64(zero, _mm256_and_si256(_mm256_xor_si256(x, sum), _mm256_xor_si256(y, sum)));
+			__m256i limit = _mm256_xor_si256(_mm256_cmpgt_epi64(zero, x), max);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_blendv_epi8(sum, limit, overflow));
+			clamped += CountLanes64(overflow);
+		}
+		return clamped + SaturatingAddScalar(a, b, out, i, count);
+	}
+
+	// AVX2 only compares signed 64-bit lanes; flipping the top bits turns the unsigned comparison sum < a into a signed one.
+	NUMBERS_TARGET("avx2")
+	size_t SaturatingAddAVX2(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t count)
+	{
+		const __m256i flip = _mm256_set1_epi64x(INT64_MIN);
+		size_t clamped = 0, i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			__m256i sum = _mm256_add_epi64(x, y);
+			__m256i overflow = _mm256_cmpgt_epi64(_mm256_xor_si256(x, flip), _mm256_xor_si256(sum, flip));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_or_si256(sum, overflow));
+			clamped += CountLanes64(overflow);
+		}
+		return clamped + SaturatingAddScalar(a, b, out, i, count);
+	}
+
+	// The 32 x 32 bit multiplies give 64-bit products of the even lanes; the odd lanes are shifted down and multiplied
+	//  separately. The low halves of the products are the wrapped results and the high halves tell whether they fit.
+	NUMBERS_TARGET("avx2")
+	size_t SaturatingMulAVX2(const int32_t* a, const int32_t* b, int32_t* out, size_t count)
+	{
+		const __m256i max = _mm256_set1_epi32(INT32_MAX);
+		size_t clamped = 0, i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			__m256i even = _mm256_mul_epi32(x, y);
+			__m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32));
+			__m256i low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+			__m256i high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+			// A signed product fits when its high half is the sign extension of its low half.
+			__m256i overflow = _mm256_xor_si256(_mm256_cmpeq_epi32(high, _mm256_srai_epi32(low, 31)), _mm256_set1_epi32(-1));
+			__m256i limit = _mm256_xor_si256(_mm256_srai_epi32(_mm256_xor_si256(x, y), 31), max);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_blendv_epi8(low, limit, overflow));
+			clamped += CountLanes32(overflow);
+		}
+		return clamped + SaturatingMulScalar(a, b, out, i, count);
+	}
+
+	NUMBERS_TARGET("avx2")
+	size_t SaturatingMulAVX2(const uint32_t* a, const uint32_t* b, uint32_t* out, size_t count)
+	{
+		size_t clamped = 0, i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			__m256i even = _mm256_mul_epu32(x, y);
+			__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32));
+			__m256i low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+			__m256i high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+			__m256i overflow = _mm256_xor_si256(_mm256_cmpeq_epi32(high, _mm256_setzero_si256()), _mm256_set1_epi32(-1));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_or_si256(low, overflow));
+			clamped += CountLanes32(overflow);
+		}
+		return clamped + SaturatingMulScalar(a, b, out, i, count);
+	}
+#endif
+
+	template <typename T>
+	size_t SaturatingAdd(const T* a, const T* b, T* out, size_t count, IntKernel kernel)
+	{
+#if defined(NUMBERS_X86)
+		if (Int_ResolveKernel(kernel) == IntKernel::AVX2)
+			return SaturatingAddAVX2(a, b, out, count);
+#endif
+		(void)kernel;
+		return SaturatingAddScalar(a, b, out, 0, count);
+	}
+
+	template <typename T>
+	size_t SaturatingMul(const T* a, const T* b, T* out, size_t count, IntKernel kernel)
+	{
+#if defined(NUMBERS_X86)
+		if (Int_ResolveKernel(kernel) == IntKernel::AVX2)
+			return SaturatingMulAVX2(a, b, out, count);
+#endif
+		(void)kernel;
+		return SaturatingMulScalar(a, b, out, 0, count);
+	}
+}
+
+bool Int_KernelSupported(IntKernel kernel)
+{
+	switch (kernel)
+	{
+	case IntKernel::Auto:
+	case IntKernel::Scalar:
+		return true;
+#if defined(NUMBERS_X86)
+	case IntKernel::AVX2:
+		return CpuFeatures::HasAVX2();
+#endif
+	default:
+		return false;
+	}
+}
+
+IntKernel Int_ResolveKernel(IntKernel kernel)
+{
+	if (kernel == IntKernel::Auto)
+		return Int_KernelSupported(IntKernel::AVX2) ? IntKernel::AVX2 : IntKernel::Scalar;
+	return Int_KernelSupported(kernel) ? kernel : IntKernel::Scalar;
+}
+
+size_t Int_SaturatingAddBatch(const int32_t* a, const int32_t* b, int32_t* out, size_t count, IntKernel kernel)
+{
+	return SaturatingAdd(a, b, out, count, kernel);
+}
+
+size_t Int_SaturatingAddBatch(const uint32_t* a, const uint32_t* b, uint32_t* out, size_t count, IntKernel kernel)
+{
+	return SaturatingAdd(a, b, out, count, kernel);
+}
+
+size_t Int_SaturatingAddBatch(const int64_t* a, const int64_t* b, int64_t* out, size_t count, IntKernel kernel)
+{
+	return SaturatingAdd(a, b, out, count, kernel);
+}
+
+size_t Int_SaturatingAddBatch(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t count, IntKernel kernel)
+{
+	return SaturatingAdd(a, b, out, count, kernel);
+}
+
+size_t Int_SaturatingMulBatch(const int32_t* a, const int32_t* b, int32_t* out, size_t count, IntKernel kernel)
+{
+	return SaturatingMul(a, b, out, count, kernel);
+}
+
+size_t Int_SaturatingMulBatch(const uint32_t* a, const uint32_t* b, uint32_t* out, size_t count, IntKernel kernel)
+{
+	return SaturatingMul(a, b, out, count, kernel);
+}
+
+size_t Int_SaturatingMulBatch(const int64_t* a, const int64_t* b, int64_t* out, size_t count, IntKernel)
+{
+	return SaturatingMulScalar(a, b, out, 0, count);
+}
+
+size_t Int_SaturatingMulBatch(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t count, IntKernel)
+{
+	return SaturatingMulScalar(a, b, out, 0, count);
+}
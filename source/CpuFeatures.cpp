@@ -0,0 +1,129 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: CpuFeatures.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/CpuFeatures.h"
+
+#include <cstdint>
+
+#if defined(NUMBERS_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace
+{
+	// The feature bits are read once, the first time any of them is asked for.
+	struct FeatureBits
+	{
+		bool sse2 = false;
+		bool ssse3 = false;
+		bool popcnt = false;
+		bool avx = false;
+		bool avx2 = false;
+		bool f16c = false;
+		bool avx512f = false;
+		bool bmi2 = false;
+		bool fastBmi2 = false;
+
+		FeatureBits()
+		{
+#if defined(NUMBERS_X86)
+			uint32_t leaf1[4] = {};
+			uint32_t leaf7[4] = {};
+			uint32_t maxLeaf = Cpuid(0, 0, leaf1);
+			// The vendor string is EBX, EDX, ECX: "Auth" "enti" "cAMD", or "Hygo" "nGen" "uine".
+			bool amd = (leaf1[1] == 0x68747541 && leaf1[3] == 0x69746E65 && leaf1[2] == 0x444D4163)
+				|| (leaf1[1] == 0x6F677948 && leaf1[3] == 0x6E65476E && leaf1[2] == 0x656E6975);
+			Cpuid(1, 0, leaf1);
+			if (maxLeaf >= 7)
+				Cpuid(7, 0, leaf7);
+
+			sse2 = (leaf1[3] & (1u << 26)) != 0;
+			ssse3 = (leaf1[2] & (1u << 9)) != 0;
+			popcnt = (leaf1[2] & (1u << 23)) != 0;
+			// BMI2 works on general purpose registers, so it needs no operating system support.
+			bmi2 = (leaf7[1] & (1u << 8)) != 0;
+			// AMD families before 0x19 (Zen 3) run PDEP and PEXT as microcode, one step per set bit of the mask.
+			uint32_t family = (leaf1[0] >> 8) & 0xF;
+			if (family == 0xF)
+				family += (leaf1[0] >> 20) & 0xFF;
+			fastBmi2 = bmi2 && !(amd && family < 0x19);
+
+			// AVX needs both the CPU (AVX + OSXSAVE bits) and the operating system
+			//  (XMM and YMM state enabled in XCR0) to agree before the wide registers may be used.
+			bool osxsave = (leaf1[2] & (1u << 27)) != 0;
+			bool ymmEnabled = osxsave && (ReadXcr0() & 0x6) == 0x6;
+			avx = ymmEnabled && (leaf1[2] & (1u << 28)) != 0;
+			avx2 = avx && (leaf7[1] & (1u << 5)) != 0;
+			f16c = avx && (leaf1[2] & (1u << 29)) != 0;
+			// AVX-512 also needs the opmask and upper ZMM register state enabled (XCR0 bits 5 to 7).
+			bool zmmEnabled = ymmEnabled && (ReadXcr0() & 0xE0) == 0xE0;
+			avx512f = zmmEnabled && (leaf7[1] & (1u << 16)) != 0;
+#endif
+		}
+
+#if defined(NUMBERS_X86)
+		// Fills regs with EAX, EBX, ECX, EDX for the given leaf and returns EAX.
+		static uint32_t Cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+		{
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+			for (int i = 0; i < 4; ++i)
+				regs[i] = static_cast<uint32_t>(info[i]);
+#else
+			__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+			return regs[0];
+		}
+
+		static uint64_t ReadXcr0()
+		{
+#if defined(_MSC_VER)
+			return _xgetbv(0);
+#else
+			uint32_t lo, hi;
+			__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+			return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+		}
+#endif
+	};
+
+	const FeatureBits& Features()
+	{
+		static const FeatureBits bits;
+		return bits;
+	}
+}
+
+bool CpuFeatures::HasSSE2() { return Features().sse2; }
+bool CpuFeatures::HasSSSE3() { return Features().ssse3; }
+bool CpuFeatures::HasPOPCNT() { return Features().popcnt; }
+bool CpuFeatures::HasAVX() { return Features().avx; }
+bool CpuFeatures::HasAVX2() { return Features().avx2; }
+bool CpuFeatures::HasF16C() { return Features().f16c; }
+bool CpuFeatures::HasAVX512F() { return Features().avx512f; }
+bool CpuFeatures::HasBMI2() { return Features().bmi2; }
+bool CpuFeatures::HasFastBMI2() { return Features().fastBmi2; }
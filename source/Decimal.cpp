@@ -0,0 +1,195 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Decimal.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/Decimal.h"
+#include "../header/CpuFeatures.h"
+
+#if defined(NUMBERS_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// ---------------------------------------------------------------- scalar
+
+	template <int Scale>
+	void MultiplyScalar(const int64_t* a, const int64_t* b, int64_t* out, size_t count, RoundingMode mode, bool* overflow)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = Decimal64<Scale>::Multiply(Decimal64<Scale>::FromUnits(a[i]), Decimal64<Scale>::FromUnits(b[i]),
+				mode, overflow).Units();
+	}
+
+	// The scale is only known at run time here, so every Decimal64 scale has its scalar kernel in a table.
+	typedef void (*ScalarKernel)(const int64_t*, const int64_t*, int64_t*, size_t, RoundingMode, bool*);
+	const ScalarKernel ScalarKernels[] = {
+		MultiplyScalar<0>, MultiplyScalar<1>, MultiplyScalar<2>, MultiplyScalar<3>, MultiplyScalar<4>,
+		MultiplyScalar<5>, MultiplyScalar<6>, MultiplyScalar<7>, MultiplyScalar<8>, MultiplyScalar<9>,
+		MultiplyScalar<10>, MultiplyScalar<11>, MultiplyScalar<12>, MultiplyScalar<13>, MultiplyScalar<14>,
+		MultiplyScalar<15>, MultiplyScalar<16>, MultiplyScalar<17>, MultiplyScalar<18>
+	};
+	static_assert(sizeof(ScalarKernels) / sizeof(ScalarKernels[0]) == DecimalRep<int64_t>::maxScale + 1,
+		"a scalar kernel for every scale");
+
+	// ---------------------------------------------------------------- AVX2
+
+#if defined(NUMBERS_X86)
+	// The vector kernel works on magnitudes below 2^51 in double precision, where they are exact. The unit must be
+	//  below that too, so that quotient * unit is exact: 10^15 is the largest power of ten that is.
+	const int VectorMaxScale = 15;
+
+	// Adding 1.5 * 2^52 moves an integer of magnitude below 2^51 into the low bits of a double's significand,
+	//  which converts between int64 and double lanes without AVX-512.
+	const int64_t MagnitudeBits = 0x4338000000000000;
+	const double MagnitudeDouble = 6755399441055744.0;
+
+	// Products whose operands both fit in 32 bits and whose magnitude is below 2^51 are computed 4 at a time:
+	//  VPMULDQ forms the exact product, a multiplication by the reciprocal of the unit estimates the quotient, and the
+	//  exact remainder (every value involved is an integer below 2^53) corrects it by one where the estimate was off.
+	// Lanes outside that range are left for the scalar kernel. Returns the number of values done.
+	template <RoundingMode Mode>
+	NUMBERS_TARGET("avx2")
+	size_t MultiplyAVX2(const int64_t* a, const int64_t* b, int64_t* out, size_t count, int scale, bool* overflow)
+	{
+		uint64_t unit = 1;
+		for (int i = 0; i < scale; ++i)
+			unit *= 10;
+		const __m256d unitD = _mm256_set1_pd(static_cast<double>(unit));
+		const __m256d reciprocal = _mm256_set1_pd(1.0 / static_cast<double>(unit));
+		const __m256d oneD = _mm256_set1_pd(1.0);
+		const __m256d zeroD = _mm256_setzero_pd();
+		const __m256d magicD = _mm256_set1_pd(MagnitudeDouble);
+		const __m256i magicI = _mm256_set1_epi64x(MagnitudeBits);
+		const __m256i unitI = _mm256_set1_epi64x(static_cast<int64_t>(unit));
+		const __m256i bias32 = _mm256_set1_epi64x(int64_t(1) << 31);
+		const __m256i bias51 = _mm256_set1_epi64x(int64_t(1) << 51);
+		const __m256i one = _mm256_set1_epi64x(1);
+		const __m256i zero = _mm256_setzero_si256();
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			// x fits in 32 bits when x + 2^31 has nothing above bit 31, and |p| < 2^51 when p + 2^51 has nothing above bit 51.
+			__m256i wide = _mm256_or_si256(_mm256_srli_epi64(_mm256_add_epi64(va, bias32), 32),
+				_mm256_srli_epi64(_mm256_add_epi64(vb, bias32), 32));
+			__m256i product = _mm256_mul_epi32(va, vb);
+			wide = _mm256_or_si256(wide, _mm256_srli_epi64(_mm256_add_epi64(product, bias51), 52));
+			__m256i sign = _mm256_cmpgt_epi64(zero, product);
+			__m256i magnitude = _mm256_sub_epi64(_mm256_xor_si256(product, sign), sign);
+
+			__m256d m = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(magnitude, magicI)), magicD);
+			__m256d q = _mm256_floor_pd(_mm256_mul_pd(m, reciprocal));
+			__m256d r = _mm256_sub_pd(m, _mm256_mul_pd(q, unitD));
+			__m256d low = _mm256_cmp_pd(r, zeroD, _CMP_LT_OQ);
+			__m256d high = _mm256_cmp_pd(r, unitD, _CMP_GE_OQ);
+			q = _mm256_add_pd(q, _mm256_sub_pd(_mm256_and_pd(high, oneD), _mm256_and_pd(low, oneD)));
+			r = _mm256_add_pd(r, _mm256_sub_pd(_mm256_and_pd(low, unitD), _mm256_and_pd(high, unitD)));
+			__m256i quotient = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(q, magicD)), magicI);
+			__m256i remainder = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(r, magicD)), magicI);
+
+			// DecimalWideMath::RoundUp with lane masks, which are -1 where true.
+			__m256i rest = _mm256_sub_epi64(unitI, remainder);
+			__m256i above = _mm256_cmpgt_epi64(remainder, rest);
+			__m256i half = _mm256_cmpeq_epi64(remainder, rest);
+			__m256i exact = _mm256_cmpeq_epi64(remainder, zero);
+			__m256i odd = _mm256_cmpeq_epi64(_mm256_and_si256(quotient, one), one);
+			__m256i up;
+			switch (Mode)
+			{
+			case RoundingMode::HalfEven: up = _mm256_or_si256(above, _mm256_and_si256(half, odd)); break;
+			case RoundingMode::HalfAwayFromZero: up = _mm256_or_si256(above, half); break;
+			case RoundingMode::Floor: up = _mm256_andnot_si256(exact, sign); break;
+			case RoundingMode::Ceiling: up = _mm256_andnot_si256(_mm256_or_si256(exact, sign), _mm256_set1_epi64x(-1)); break;
+			default: up = zero; break;
+			}
+			quotient = _mm256_sub_epi64(quotient, up);
+			quotient = _mm256_sub_epi64(_mm256_xor_si256(quotient, sign), sign);
+
+			unsigned fallback = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(
+				_mm256_cmpeq_epi64(wide, zero)))) ^ 0xFu;
+			if (fallback == 0)
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), quotient);
+				continue;
+			}
+			// out may be a or b, so the operands of the lanes left over are kept aside before the store.
+			int64_t keptA[4], keptB[4];
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(keptA), va);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(keptB), vb);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), quotient);
+			for (unsigned lane = 0; lane < 4; ++lane)
+				if (fallback & (1u << lane))
+					ScalarKernels[scale](keptA + lane, keptB + lane, out + i + lane, 1, Mode, overflow);
+		}
+		return i;
+	}
+#endif
+}
+
+bool Decimal_KernelSupported(DecimalKernel kernel)
+{
+	switch (kernel)
+	{
+	case DecimalKernel::Auto:
+	case DecimalKernel::Scalar:
+		return true;
+#if defined(NUMBERS_X86)
+	case DecimalKernel::AVX2:
+		return CpuFeatures::HasAVX2();
+#endif
+	default:
+		return false;
+	}
+}
+
+DecimalKernel Decimal_ResolveKernel(DecimalKernel kernel)
+{
+	if (kernel == DecimalKernel::Auto)
+		return Decimal_KernelSupported(DecimalKernel::AVX2) ? DecimalKernel::AVX2 : DecimalKernel::Scalar;
+	return Decimal_KernelSupported(kernel) ? kernel : DecimalKernel::Scalar;
+}
+
+void Decimal_MultiplyUnitsBatch(const int64_t* a, const int64_t* b, int64_t* out, size_t count, int scale,
+	RoundingMode mode, bool* overflow, DecimalKernel kernel)
+{
+	if (scale < 0 || scale > DecimalRep<int64_t>::maxScale)
+	{
+		if (overflow)
+			*overflow = true;
+		return;
+	}
+	size_t done = 0;
+#if defined(NUMBERS_X86)
+	if (Decimal_ResolveKernel(kernel) == DecimalKernel::AVX2 && scale <= VectorMaxScale)
+	{
+		switch (mode)
+		{
+		case RoundingMode::HalfEven: done = MultiplyAVX2<RoundingMode::HalfEven>(a, b, out, count, scale, overflow); break;
+		case RoundingMode::HalfAwayFromZero: done = MultiplyAVX2<RoundingMode::HalfAwayFromZero>(a, b, out, count, scale, overflow); break;
+		case RoundingMode::Floor: done = MultiplyAVX2<RoundingMode::Floor>(a, b, out, count, scale, overflow); break;
+		case RoundingMode::Ceiling: done = MultiplyAVX2<RoundingMode::Ceiling>(a, b, out, count, scale, overflow); break;
+		default: done = MultiplyAVX2<RoundingMode::TowardZero>(a, b, out, count, scale, overflow); break;
+		}
+	}
+#endif
+	ScalarKernels[scale](a + done, b + done, out + done, count - done, mode, overflow);
+}
@@ -0,0 +1,140 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Denormals.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/Denormals.h"
+#include "../header/CpuFeatures.h"
+
+#if defined(NUMBERS_X86)
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+#if defined(NUMBERS_X86)
+	const unsigned MxcsrDenormalFlag = 1u << 1;     // DE: a subnormal operand was read
+	const unsigned MxcsrUnderflowFlag = 1u << 4;    // UE: a result underflowed
+	const unsigned MxcsrDenormalsAreZero = 1u << 6; // DAZ
+	const unsigned MxcsrFlushToZero = 1u << 15;     // FTZ
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+	const uint64_t FpcrFlushToZero = uint64_t(1) << 24;
+
+	uint64_t ReadFpcr()
+	{
+		uint64_t fpcr;
+		__asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+		return fpcr;
+	}
+
+	void WriteFpcr(uint64_t fpcr)
+	{
+		__asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+	}
+#endif
+}
+
+bool Denormals_ModeSupported()
+{
+#if defined(NUMBERS_X86) || (defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__)))
+	return true;
+#else
+	return false;
+#endif
+}
+
+DenormalMode Denormals_GetMode()
+{
+	DenormalMode mode;
+#if defined(NUMBERS_X86)
+	unsigned mxcsr = _mm_getcsr();
+	mode.flushToZero = (mxcsr & MxcsrFlushToZero) != 0;
+	mode.denormalsAreZero = (mxcsr & MxcsrDenormalsAreZero) != 0;
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+	mode.flushToZero = mode.denormalsAreZero = (ReadFpcr() & FpcrFlushToZero) != 0;
+#endif
+	return mode;
+}
+
+void Denormals_SetMode(DenormalMode mode)
+{
+#if defined(NUMBERS_X86)
+	unsigned mxcsr = _mm_getcsr() & ~(MxcsrFlushToZero | MxcsrDenormalsAreZero);
+	if (mode.flushToZero)
+		mxcsr |= MxcsrFlushToZero;
+	if (mode.denormalsAreZero)
+		mxcsr |= MxcsrDenormalsAreZero;
+	_mm_setcsr(mxcsr);
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+	uint64_t fpcr = ReadFpcr() & ~FpcrFlushToZero;
+	if (mode.flushToZero || mode.denormalsAreZero)
+		fpcr |= FpcrFlushToZero;
+	WriteFpcr(fpcr);
+#else
+	(void)mode;
+#endif
+}
+
+ScopedFlushDenormals::ScopedFlushDenormals()
+	: m_previous(Denormals_GetMode())
+{
+	DenormalMode flush;
+	flush.flushToZero = true;
+	flush.denormalsAreZero = true;
+	Denormals_SetMode(flush);
+}
+
+ScopedFlushDenormals::~ScopedFlushDenormals()
+{
+	Denormals_SetMode(m_previous);
+}
+
+void Denormals_ClearFlags()
+{
+#if defined(NUMBERS_X86)
+	_mm_setcsr(_mm_getcsr() & ~(MxcsrDenormalFlag | MxcsrUnderflowFlag));
+#endif
+}
+
+DenormalFlags Denormals_ReadFlags()
+{
+	DenormalFlags flags;
+#if defined(NUMBERS_X86)
+	unsigned mxcsr = _mm_getcsr();
+	flags.consumed = (mxcsr & MxcsrDenormalFlag) != 0;
+	flags.produced = (mxcsr & MxcsrUnderflowFlag) != 0;
+#endif
+	return flags;
+}
+
+SubnormalCounts Denormals_CountDotProducts(const float* xs, const float* ys, const float* zs, size_t count, vec3 normal)
+{
+	SubnormalCounts before = CountedFloat::Counts();
+	for (size_t i = 0; i < count; ++i)
+	{
+		CountedFloat dot = CountedFloat(xs[i]) * normal.x + CountedFloat(ys[i]) * normal.y + CountedFloat(zs[i]) * normal.z;
+		(void)dot;
+	}
+	SubnormalCounts after = CountedFloat::Counts();
+	SubnormalCounts counts;
+	counts.operations = after.operations - before.operations;
+	counts.consumed = after.consumed - before.consumed;
+	counts.produced = after.produced - before.produced;
+	return counts;
+}
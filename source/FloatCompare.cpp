@@ -0,0 +1,300 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatCompare.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/FloatCompare.h"
+#include "../header/CpuFeatures.h"
+#include "../header/ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#if defined(NUMBERS_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// Each ParallelFor chunk compares this many elements. Small enough that the SIMD kernels can keep
+	//  the positions of their largest distances as 32-bit offsets into the chunk.
+	const size_t ElementsPerChunk = 1 << 16;
+
+	// The comparison of one chunk, merged into the final result in order of begin.
+	struct ChunkResult
+	{
+		size_t begin = 0;
+		uint64_t mismatches = 0;
+		uint64_t maxUlps = 0;
+		size_t maxUlpsIndex = 0;
+		// The first maxIndices mismatches of the chunk
+		std::vector<size_t> indices;
+	};
+
+	inline void RecordMismatch(size_t index, size_t maxIndices, ChunkResult& result)
+	{
+		++result.mismatches;
+		if (result.indices.size() < maxIndices)
+			result.indices.push_back(index);
+	}
+
+	// Keeps the largest distance and, among equal ones, the lowest index. The SIMD kernels track one maximum
+	//  per lane, so candidates do not always arrive in index order.
+	inline void RecordUlps(uint64_t ulps, size_t index, ChunkResult& result)
+	{
+		if (ulps > result.maxUlps || (ulps == result.maxUlps && ulps != 0 && index < result.maxUlpsIndex))
+		{
+			result.maxUlps = ulps;
+			result.maxUlpsIndex = index;
+		}
+	}
+
+	// The SIMD kernels below make the same tests with the same arithmetic lane by lane.
+	template <typename T, typename Tolerance>
+	void CompareScalar(const T* a, const T* b, size_t begin, size_t end, const Tolerance& tolerance,
+		size_t maxIndices, ChunkResult& result)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			bool nanA = std::isnan(a[i]), nanB = std::isnan(b[i]);
+			bool match = Float_NearlyEqualUlps(a[i], b[i], tolerance.ulps)
+				| Float_NearlyEqual(a[i], b[i], tolerance.absolute, tolerance.relative)
+				| (nanA & nanB & tolerance.nanMatchesNaN);
+			if (!match)
+				RecordMismatch(i, maxIndices, result);
+			if (!(nanA | nanB))
+				RecordUlps(Float_UlpDistance(a[i], b[i]), i, result);
+		}
+	}
+
+#if defined(NUMBERS_X86)
+	inline void RecordMismatches(unsigned mask, size_t first, size_t maxIndices, ChunkResult& result)
+	{
+		for (size_t lane = 0; mask != 0; ++lane, mask >>= 1)
+			if (mask & 1)
+				RecordMismatch(first + lane, maxIndices, result);
+	}
+
+	NUMBERS_TARGET("avx2")
+	void CompareAVX2(const float* a, const float* b, size_t begin, size_t end, const FloatTolerance& tolerance,
+		size_t maxIndices, ChunkResult& result)
+	{
+		const __m256i allOnes = _mm256_set1_epi32(-1);
+		const __m256i absMask = _mm256_set1_epi32(0x7FFFFFFF);
+		const __m256i infinity = _mm256_set1_epi32(0x7F800000);
+		const __m256i maxUlps = _mm256_set1_epi32(static_cast<int>(tolerance.ulps));
+		const __m256i nanMatchesNaN = tolerance.nanMatchesNaN ? allOnes : _mm256_setzero_si256();
+		const __m256 magnitudeMask = _mm256_castsi256_ps(absMask);
+		const __m256 absolute = _mm256_set1_ps(tolerance.absolute);
+		const __m256 relative = _mm256_set1_ps(tolerance.relative);
+		const __m256 largestFinite = _mm256_set1_ps(std::numeric_limits<float>::max());
+		// The largest distance seen in each lane, and its offset from begin.
+		__m256i laneMax = _mm256_setzero_si256(), laneOffset = _mm256_setzero_si256();
+		__m256i offset = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		size_t i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(a + i), y = _mm256_loadu_ps(b + i);
+			__m256i xBits = _mm256_castps_si256(x), yBits = _mm256_castps_si256(y);
+
+			// The ordered patterns of FloatCompareDetail: the magnitude, negated where the sign bit is set.
+			__m256i xMagnitude = _mm256_and_si256(xBits, absMask), yMagnitude = _mm256_and_si256(yBits, absMask);
+			__m256i xNaN = _mm256_cmpgt_epi32(xMagnitude, infinity), yNaN = _mm256_cmpgt_epi32(yMagnitude, infinity);
+			__m256i nan = _mm256_or_si256(xNaN, yNaN);
+			__m256i xSign = _mm256_srai_epi32(xBits, 31), ySign = _mm256_srai_epi32(yBits, 31);
+			__m256i xOrdered = _mm256_sub_epi32(_mm256_xor_si256(xMagnitude, xSign), xSign);
+			__m256i yOrdered = _mm256_sub_epi32(_mm256_xor_si256(yMagnitude, ySign), ySign);
+			__m256i distance = _mm256_blendv_epi8(_mm256_sub_epi32(yOrdered, xOrdered), _mm256_sub_epi32(xOrdered, yOrdered),
+				_mm256_cmpgt_epi32(xOrdered, yOrdered));
+			distance = _mm256_andnot_si256(nan, distance);
+			__m256i ulpMatch = _mm256_andnot_si256(nan, _mm256_cmpeq_epi32(_mm256_max_epu32(distance, maxUlps), maxUlps));
+
+			__m256 difference = _mm256_and_ps(_mm256_sub_ps(x, y), magnitudeMask);
+			__m256 largest = _mm256_min_ps(_mm256_max_ps(_mm256_and_ps(x, magnitudeMask), _mm256_and_ps(y, magnitudeMask)), largestFinite);
+			__m256 valueMatch = _mm256_or_ps(_mm256_cmp_ps(x, y, _CMP_EQ_OQ), _mm256_or_ps(
+				_mm256_cmp_ps(difference, absolute, _CMP_LE_OQ),
+				_mm256_cmp_ps(difference, _mm256_mul_ps(relative, largest), _CMP_LE_OQ)));
+
+			__m256i match = _mm256_or_si256(_mm256_or_si256(ulpMatch, _mm256_castps_si256(valueMatch)),
+				_mm256_and_si256(_mm256_and_si256(xNaN, yNaN), nanMatchesNaN));
+			unsigned mismatch = ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(match))) & 0xFFu;
+			if (mismatch != 0)
+				RecordMismatches(mismatch, i, maxIndices, result);
+
+			__m256i greater = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(laneMax, distance), laneMax), allOnes);
+			laneMax = _mm256_max_epu32(laneMax, distance);
+			laneOffset = _mm256_blendv_epi8(laneOffset, offset, greater);
+			offset = _mm256_add_epi32(offset, _mm256_set1_epi32(8));
+		}
+
+		alignas(32) uint32_t maxima[8];
+		alignas(32) uint32_t offsets[8];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(maxima), laneMax);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(offsets), laneOffset);
+		for (size_t lane = 0; lane < 8; ++lane)
+			RecordUlps(maxima[lane], begin + offsets[lane], result);
+		CompareScalar(a, b, i, end, tolerance, maxIndices, result);
+	}
+
+	NUMBERS_TARGET("avx2")
+	void CompareAVX2(const double* a, const double* b, size_t begin, size_t end, const DoubleTolerance& tolerance,
+		size_t maxIndices, ChunkResult& result)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i allOnes = _mm256_set1_epi32(-1);
+		const __m256i absMask = _mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFll);
+		const __m256i infinity = _mm256_set1_epi64x(0x7FF0000000000000ll);
+		// AVX2 only compares 64-bit lanes as signed numbers; flipping the top bit of both sides
+		//  turns an unsigned comparison into a signed one.
+		const __m256i flip = _mm256_set1_epi64x(INT64_MIN);
+		const __m256i maxUlps = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(tolerance.ulps)), flip);
+		const __m256i nanMatchesNaN = tolerance.nanMatchesNaN ? allOnes : zero;
+		const __m256d magnitudeMask = _mm256_castsi256_pd(absMask);
+		const __m256d absolute = _mm256_set1_pd(tolerance.absolute);
+		const __m256d relative = _mm256_set1_pd(tolerance.relative);
+		const __m256d largestFinite = _mm256_set1_pd(std::numeric_limits<double>::max());
+		// The largest distance seen in each lane (flipped), and its offset from begin.
+		__m256i laneMax = flip, laneOffset = zero;
+		__m256i offset = _mm256_setr_epi64x(0, 1, 2, 3);
+		size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m256d x = _mm256_loadu_pd(a + i), y = _mm256_loadu_pd(b + i);
+			__m256i xBits = _mm256_castpd_si256(x), yBits = _mm256_castpd_si256(y);
+
+			__m256i xMagnitude = _mm256_and_si256(xBits, absMask), yMagnitude = _mm256_and_si256(yBits, absMask);
+			__m256i xNaN = _mm256_cmpgt_epi64(xMagnitude, infinity), yNaN = _mm256_cmpgt_epi64(yMagnitude, infinity);
+			__m256i nan = _mm256_or_si256(xNaN, yNaN);
+			__m256i xSign = _mm256_cmpgt_epi64(zero, xBits), ySign = _mm256_cmpgt_epi64(zero, yBits);
+			__m256i xOrdered = _mm256_sub_epi64(_mm256_xor_si256(xMagnitude, xSign), xSign);
+			__m256i yOrdered = _mm256_sub_epi64(_mm256_xor_si256(yMagnitude, ySign), ySign);
+			__m256i distance = _mm256_blendv_epi8(_mm256_sub_epi64(yOrdered, xOrdered), _mm256_sub_epi64(xOrdered, yOrdered),
+				_mm256_cmpgt_epi64(xOrdered, yOrdered));
+			__m256i flipped = _mm256_xor_si256(_mm256_andnot_si256(nan, distance), flip);
+			__m256i ulpMatch = _mm256_andnot_si256(_mm256_or_si256(nan, _mm256_cmpgt_epi64(flipped, maxUlps)), allOnes);
+
+			__m256d difference = _mm256_and_pd(_mm256_sub_pd(x, y), magnitudeMask);
+			__m256d largest = _mm256_min_pd(_mm256_max_pd(_mm256_and_pd(x, magnitudeMask), _mm256_and_pd(y, magnitudeMask)), largestFinite);
+			__m256d valueMatch = _mm256_or_pd(_mm256_cmp_pd(x, y, _CMP_EQ_OQ), _mm256_or_pd(
+				_mm256_cmp_pd(difference, absolute, _CMP_LE_OQ),
+				_mm256_cmp_pd(difference, _mm256_mul_pd(relative, largest), _CMP_LE_OQ)));
+
+			__m256i match = _mm256_or_si256(_mm256_or_si256(ulpMatch, _mm256_castpd_si256(valueMatch)),
+				_mm256_and_si256(_mm256_and_si256(xNaN, yNaN), nanMatchesNaN));
+			unsigned mismatch = ~static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(match))) & 0xFu;
+			if (mismatch != 0)
+				RecordMismatches(mismatch, i, maxIndices, result);
+
+			__m256i greater = _mm256_cmpgt_epi64(flipped, laneMax);
+			laneMax = _mm256_blendv_epi8(laneMax, flipped, greater);
+			laneOffset = _mm256_blendv_epi8(laneOffset, offset, greater);
+			offset = _mm256_add_epi64(offset, _mm256_set1_epi64x(4));
+		}
+
+		alignas(32) uint64_t maxima[4];
+		alignas(32) uint64_t offsets[4];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(maxima), _mm256_xor_si256(laneMax, flip));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(offsets), laneOffset);
+		for (size_t lane = 0; lane < 4; ++lane)
+			RecordUlps(maxima[lane], begin + static_cast<size_t>(offsets[lane]), result);
+		CompareScalar(a, b, i, end, tolerance, maxIndices, result);
+	}
+#endif
+
+	template <typename T, typename Tolerance>
+	FloatArrayComparison CompareArrays(const T* a, const T* b, size_t count, const Tolerance& tolerance,
+		size_t* mismatchIndices, size_t maxIndices, FloatCompareKernel kernel, bool parallel)
+	{
+		kernel = Float_ResolveKernel(kernel);
+		std::mutex mutex;
+		std::vector<ChunkResult> chunks;
+		auto compareChunk = [&](size_t begin, size_t end) {
+			ChunkResult local;
+			local.begin = begin;
+#if defined(NUMBERS_X86)
+			if (kernel == FloatCompareKernel::AVX2)
+				CompareAVX2(a, b, begin, end, tolerance, maxIndices, local);
+			else
+#endif
+				CompareScalar(a, b, begin, end, tolerance, maxIndices, local);
+			std::lock_guard<std::mutex> lock(mutex);
+			chunks.push_back(std::move(local));
+		};
+		if (parallel)
+			ParallelFor(count, ElementsPerChunk, compareChunk);
+		else
+			for (size_t begin = 0; begin < count; begin += ElementsPerChunk)
+				compareChunk(begin, std::min(count, begin + ElementsPerChunk));
+
+		// In index order, the first chunk with the largest distance holds its first occurrence,
+		//  and the first mismatches come from the first chunks.
+		std::sort(chunks.begin(), chunks.end(), [](const ChunkResult& x, const ChunkResult& y) { return x.begin < y.begin; });
+		FloatArrayComparison result;
+		for (const ChunkResult& chunk : chunks)
+		{
+			result.mismatches += chunk.mismatches;
+			if (chunk.maxUlps > result.maxUlps)
+			{
+				result.maxUlps = chunk.maxUlps;
+				result.maxUlpsIndex = chunk.maxUlpsIndex;
+			}
+			for (size_t j = 0; j < chunk.indices.size() && result.indicesStored < maxIndices; ++j)
+				mismatchIndices[result.indicesStored++] = chunk.indices[j];
+		}
+		return result;
+	}
+}
+
+bool Float_KernelSupported(FloatCompareKernel kernel)
+{
+	switch (kernel)
+	{
+	case FloatCompareKernel::Auto:
+	case FloatCompareKernel::Scalar:
+		return true;
+#if defined(NUMBERS_X86)
+	case FloatCompareKernel::AVX2:
+		return CpuFeatures::HasAVX2();
+#endif
+	default:
+		return false;
+	}
+}
+
+FloatCompareKernel Float_ResolveKernel(FloatCompareKernel kernel)
+{
+	if (kernel == FloatCompareKernel::Auto)
+		return Float_KernelSupported(FloatCompareKernel::AVX2) ? FloatCompareKernel::AVX2 : FloatCompareKernel::Scalar;
+	return Float_KernelSupported(kernel) ? kernel : FloatCompareKernel::Scalar;
+}
+
+FloatArrayComparison Float_CompareArrays(const float* a, const float* b, size_t count, const FloatTolerance& tolerance,
+	size_t* mismatchIndices, size_t maxIndices, FloatCompareKernel kernel, bool parallel)
+{
+	return CompareArrays(a, b, count, tolerance, mismatchIndices, maxIndices, kernel, parallel);
+}
+
+FloatArrayComparison Float_CompareArrays(const double* a, const double* b, size_t count, const DoubleTolerance& tolerance,
+	size_t* mismatchIndices, size_t maxIndices, FloatCompareKernel kernel, bool parallel)
+{
+	return CompareArrays(a, b, count, tolerance, mismatchIndices, maxIndices, kernel, parallel);
+}
@@ -0,0 +1,310 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatDecode.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/FloatDecode.h"
+#include "../header/CpuFeatures.h"
+#include "../header/ParallelFor.h"
+
+#include <cstring>
+#include <istream>
+#include <mutex>
+#include <vector>
+
+#if defined(NUMBERS_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// Large inputs are split into chunks of this many values, each decoded by one thread.
+	const size_t ValuesPerChunk = 1 << 16;
+
+	typedef FloatTraits<float> FloatLayout;
+	typedef FloatTraits<double> DoubleLayout;
+	const uint32_t FloatAbsMask = FloatLayout::AbsMask;
+	const uint32_t FloatMinNormal = FloatLayout::MinNormal;
+	const uint32_t FloatInfinity = FloatLayout::Infinity;
+	const uint32_t FloatSignificandMask = FloatLayout::SignificandMask;
+	const uint64_t DoubleAbsMask = DoubleLayout::AbsMask;
+	const uint64_t DoubleMinNormal = DoubleLayout::MinNormal;
+	const uint64_t DoubleInfinity = DoubleLayout::Infinity;
+	const uint64_t DoubleSignificandMask = DoubleLayout::SignificandMask;
+
+	// Adds the category of one value to the counters without branching; normal is derived at the end.
+	template <typename Bits>
+	void CountBits(Bits magnitude, Bits minNormal, Bits infinity, FloatCategoryCounts& counts)
+	{
+		counts.zero += magnitude == 0;
+		counts.subnormal += Bits(magnitude - 1) < Bits(minNormal - 1);
+		counts.infinite += magnitude == infinity;
+		counts.nan += magnitude > infinity;
+	}
+
+	void FinishCounts(size_t count, FloatCategoryCounts& counts)
+	{
+		counts.normal = count - counts.zero - counts.subnormal - counts.infinite - counts.nan;
+	}
+
+	void SplitFloatScalar(const float* values, size_t begin, size_t end,
+		uint8_t* signs, uint8_t* exponents, uint32_t* significands, FloatCategoryCounts& counts)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			uint32_t bits = Float_ToBits(values[i]);
+			if (signs)
+				signs[i] = static_cast<uint8_t>(bits >> 31);
+			if (exponents)
+				exponents[i] = static_cast<uint8_t>(bits >> 23);
+			if (significands)
+				significands[i] = bits & FloatSignificandMask;
+			CountBits(bits & FloatAbsMask, FloatMinNormal, FloatInfinity, counts);
+		}
+	}
+
+	void SplitDoubleScalar(const double* values, size_t begin, size_t end,
+		uint8_t* signs, uint16_t* exponents, uint64_t* significands, FloatCategoryCounts& counts)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			uint64_t bits = Float_ToBits(values[i]);
+			if (signs)
+				signs[i] = static_cast<uint8_t>(bits >> 63);
+			if (exponents)
+				exponents[i] = static_cast<uint16_t>((bits >> 52) & 0x7FF);
+			if (significands)
+				significands[i] = bits & DoubleSignificandMask;
+			CountBits(bits & DoubleAbsMask, DoubleMinNormal, DoubleInfinity, counts);
+		}
+	}
+
+#if defined(NUMBERS_X86)
+	NUMBERS_TARGET("avx2")
+	uint64_t SumLanes32(__m256i v)
+	{
+		alignas(32) uint32_t lanes[8];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+		uint64_t sum = 0;
+		for (uint32_t lane : lanes)
+			sum += lane;
+		return sum;
+	}
+
+	NUMBERS_TARGET("avx2")
+	uint64_t SumLanes64(__m256i v)
+	{
+		alignas(32) uint64_t lanes[4];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+		return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+
+	// 8 floats per vector, 32 per iteration. The category tests are compares whose all-ones results are
+	//  subtracted from per-lane counters (subtracting -1 adds one). The sign and exponent streams are narrowed
+	//  to bytes with two packs and a permute that undoes the per-128-bit-lane order of the packs.
+	NUMBERS_TARGET("avx2")
+	void SplitFloatAVX2(const float* values, size_t begin, size_t end,
+		uint8_t* signs, uint8_t* exponents, uint32_t* significands, FloatCategoryCounts& counts)
+	{
+		const __m256i absMask = _mm256_set1_epi32(static_cast<int>(FloatAbsMask));
+		const __m256i minNormal = _mm256_set1_epi32(static_cast<int>(FloatMinNormal));
+		const __m256i infinity = _mm256_set1_epi32(static_cast<int>(FloatInfinity));
+		const __m256i significandMask = _mm256_set1_epi32(static_cast<int>(FloatSignificandMask));
+		const __m256i packOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i zeros = zero, subnormals = zero, infinities = zero, nans = zero;
+
+		size_t i = begin;
+		for (; i + 32 <= end; i += 32)
+		{
+			__m256i bits[4], signBits[4], exponentBits[4];
+			for (int k = 0; k < 4; ++k)
+			{
+				bits[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 8 * k));
+				__m256i magnitude = _mm256_and_si256(bits[k], absMask);
+				__m256i isZero = _mm256_cmpeq_epi32(magnitude, zero);
+				zeros = _mm256_sub_epi32(zeros, isZero);
+				subnormals = _mm256_sub_epi32(subnormals, _mm256_andnot_si256(isZero, _mm256_cmpgt_epi32(minNormal, magnitude)));
+				infinities = _mm256_sub_epi32(infinities, _mm256_cmpeq_epi32(magnitude, infinity));
+				nans = _mm256_sub_epi32(nans, _mm256_cmpgt_epi32(magnitude, infinity));
+				signBits[k] = _mm256_srli_epi32(bits[k], 31);
+				exponentBits[k] = _mm256_srli_epi32(magnitude, 23);
+			}
+			if (signs)
+			{
+				__m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(signBits[0], signBits[1]),
+					_mm256_packs_epi32(signBits[2], signBits[3]));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(signs + i), _mm256_permutevar8x32_epi32(packed, packOrder));
+			}
+			if (exponents)
+			{
+				__m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(exponentBits[0], exponentBits[1]),
+					_mm256_packs_epi32(exponentBits[2], exponentBits[3]));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(exponents + i), _mm256_permutevar8x32_epi32(packed, packOrder));
+			}
+			if (significands)
+			{
+				for (int k = 0; k < 4; ++k)
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(significands + i + 8 * k),
+						_mm256_and_si256(bits[k], significandMask));
+			}
+		}
+
+		FloatCategoryCounts tail;
+		SplitFloatScalar(values, i, end, signs, exponents, significands, tail);
+		counts.zero = SumLanes32(zeros) + tail.zero;
+		counts.subnormal = SumLanes32(subnormals) + tail.subnormal;
+		counts.infinite = SumLanes32(infinities) + tail.infinite;
+		counts.nan = SumLanes32(nans) + tail.nan;
+	}
+
+	// Counting only; the double streams are narrow enough that the scalar loop keeps up with memory.
+	NUMBERS_TARGET("avx2")
+	void CountDoubleAVX2(const double* values, size_t begin, size_t end, FloatCategoryCounts& counts)
+	{
+		const __m256i absMask = _mm256_set1_epi64x(static_cast<long long>(DoubleAbsMask));
+		const __m256i minNormal = _mm256_set1_epi64x(static_cast<long long>(DoubleMinNormal));
+		const __m256i infinity = _mm256_set1_epi64x(static_cast<long long>(DoubleInfinity));
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i zeros = zero, subnormals = zero, infinities = zero, nans = zero;
+
+		size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m256i magnitude = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)), absMask);
+			__m256i isZero = _mm256_cmpeq_epi64(magnitude, zero);
+			zeros = _mm256_sub_epi64(zeros, isZero);
+			subnormals = _mm256_sub_epi64(subnormals, _mm256_andnot_si256(isZero, _mm256_cmpgt_epi64(minNormal, magnitude)));
+			infinities = _mm256_sub_epi64(infinities, _mm256_cmpeq_epi64(magnitude, infinity));
+			nans = _mm256_sub_epi64(nans, _mm256_cmpgt_epi64(magnitude, infinity));
+		}
+
+		FloatCategoryCounts tail;
+		SplitDoubleScalar(values, i, end, nullptr, nullptr, nullptr, tail);
+		counts.zero = SumLanes64(zeros) + tail.zero;
+		counts.subnormal = SumLanes64(subnormals) + tail.subnormal;
+		counts.infinite = SumLanes64(infinities) + tail.infinite;
+		counts.nan = SumLanes64(nans) + tail.nan;
+	}
+#endif
+
+	// Runs decodeChunk(begin, end, counts) over the input in parallel and adds up the per-chunk counts.
+	template <typename DecodeChunk>
+	FloatCategoryCounts DecodeInChunks(size_t count, DecodeChunk decodeChunk)
+	{
+		std::mutex mutex;
+		FloatCategoryCounts total;
+		ParallelFor(count, ValuesPerChunk, [&](size_t begin, size_t end) {
+			FloatCategoryCounts local;
+			decodeChunk(begin, end, local);
+			FinishCounts(end - begin, local);
+			std::lock_guard<std::mutex> lock(mutex);
+			total += local;
+		});
+		return total;
+	}
+
+	// Reads the stream into a fixed buffer, carrying any partial value over to the next read.
+	template <typename T>
+	bool CountStream(std::istream& in, FloatCategoryCounts& counts)
+	{
+		const size_t bufferValues = 1 << 18;
+		std::vector<T> buffer(bufferValues);
+		char* bytes = reinterpret_cast<char*>(buffer.data());
+		size_t carried = 0;
+		while (in)
+		{
+			in.read(bytes + carried, static_cast<std::streamsize>(bufferValues * sizeof(T) - carried));
+			size_t available = carried + static_cast<size_t>(in.gcount());
+			size_t whole = available / sizeof(T);
+			counts += FloatDecode_Count(buffer.data(), whole);
+			carried = available - whole * sizeof(T);
+			std::memmove(bytes, bytes + whole * sizeof(T), carried);
+		}
+		return carried == 0 && in.eof() && !in.bad();
+	}
+}
+
+FloatCategoryCounts& FloatCategoryCounts::operator+=(const FloatCategoryCounts& other)
+{
+	zero += other.zero;
+	subnormal += other.subnormal;
+	normal += other.normal;
+	infinite += other.infinite;
+	nan += other.nan;
+	return *this;
+}
+
+void FloatDecode_Split(const float* values, size_t count,
+	uint8_t* signs, uint8_t* exponents, uint32_t* significands, FloatCategoryCounts* counts)
+{
+	void (*split)(const float*, size_t, size_t, uint8_t*, uint8_t*, uint32_t*, FloatCategoryCounts&) = SplitFloatScalar;
+#if defined(NUMBERS_X86)
+	if (CpuFeatures::HasAVX2())
+		split = SplitFloatAVX2;
+#endif
+	FloatCategoryCounts total = DecodeInChunks(count, [&](size_t begin, size_t end, FloatCategoryCounts& local) {
+		split(values, begin, end, signs, exponents, significands, local);
+	});
+	if (counts)
+		*counts += total;
+}
+
+void FloatDecode_Split(const double* values, size_t count,
+	uint8_t* signs, uint16_t* exponents, uint64_t* significands, FloatCategoryCounts* counts)
+{
+	bool countOnly = !signs && !exponents && !significands;
+	FloatCategoryCounts total = DecodeInChunks(count, [&](size_t begin, size_t end, FloatCategoryCounts& local) {
+#if defined(NUMBERS_X86)
+		if (countOnly && CpuFeatures::HasAVX2())
+		{
+			CountDoubleAVX2(values, begin, end, local);
+			return;
+		}
+#endif
+		(void)countOnly;
+		SplitDoubleScalar(values, begin, end, signs, exponents, significands, local);
+	});
+	if (counts)
+		*counts += total;
+}
+
+FloatCategoryCounts FloatDecode_Count(const float* values, size_t count)
+{
+	FloatCategoryCounts counts;
+	FloatDecode_Split(values, count, nullptr, nullptr, nullptr, &counts);
+	return counts;
+}
+
+FloatCategoryCounts FloatDecode_Count(const double* values, size_t count)
+{
+	FloatCategoryCounts counts;
+	FloatDecode_Split(values, count, nullptr, nullptr, nullptr, &counts);
+	return counts;
+}
+
+bool FloatDecode_CountFloatStream(std::istream& in, FloatCategoryCounts& counts)
+{
+	return CountStream<float>(in, counts);
+}
+
+bool FloatDecode_CountDoubleStream(std::istream& in, FloatCategoryCounts& counts)
+{
+	return CountStream<double>(in, counts);
+}
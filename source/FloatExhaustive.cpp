@@ -0,0 +1,169 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatExhaustive.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/FloatExhaustive.h"
+#include "../header/FloatDecode.h"
+#include "../header/FloatFormat.h"
+#include "../header/ParallelFor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+
+namespace
+{
+	// Patterns are checked in blocks of 2^16: enough blocks to balance the threads, and few enough that merging is cheap.
+	const uint32_t BlockBits = 16;
+
+	// Adds one block's results into the total. The largest error keeps the lowest pattern among equal errors,
+	//  so the total does not depend on the order in which blocks finish.
+	void Merge(FloatExhaustiveResult& total, FloatExhaustiveResult& block, size_t maxCounterexamples)
+	{
+		total.failures += block.failures;
+		total.checked += block.checked;
+		if (!block.counterexamples.empty())
+		{
+			total.counterexamples.insert(total.counterexamples.end(), block.counterexamples.begin(), block.counterexamples.end());
+			std::sort(total.counterexamples.begin(), total.counterexamples.end());
+			if (total.counterexamples.size() > maxCounterexamples)
+				total.counterexamples.resize(maxCounterexamples);
+		}
+		bool blockNaN = std::isnan(block.maxUlp), totalNaN = std::isnan(total.maxUlp);
+		bool larger = blockNaN ? !totalNaN : !totalNaN && block.maxUlp > total.maxUlp;
+		bool equal = blockNaN ? totalNaN : block.maxUlp == total.maxUlp;
+		if (larger || (equal && block.maxUlpBits < total.maxUlpBits))
+		{
+			total.maxUlp = block.maxUlp;
+			total.maxUlpBits = block.maxUlpBits;
+		}
+	}
+}
+
+FloatExhaustiveResult FloatExhaustive_Run(const std::function<void(uint32_t first, uint32_t count, FloatExhaustiveBlock& block)>& check,
+	const FloatExhaustiveOptions& options)
+{
+	FloatExhaustiveResult total;
+	if (options.first > options.last)
+		return total;
+
+	auto start = std::chrono::steady_clock::now();
+	// 64 bits, because the full range holds 2^32 patterns.
+	const uint64_t patternCount = uint64_t(options.last) - options.first + 1;
+	const size_t blockCount = static_cast<size_t>(((patternCount - 1) >> BlockBits) + 1);
+	std::mutex mutex;
+	ParallelFor(blockCount, 1, [&](size_t begin, size_t end) {
+		for (size_t index = begin; index < end; ++index)
+		{
+			uint64_t offset = uint64_t(index) << BlockBits;
+			uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(patternCount - offset, uint64_t(1) << BlockBits));
+			FloatExhaustiveBlock block(options.maxCounterexamples);
+			check(static_cast<uint32_t>(options.first + offset), count, block);
+			block.Result().checked = count;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			Merge(total, block.Result(), options.maxCounterexamples);
+		}
+	});
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	total.seconds = elapsed.count();
+	return total;
+}
+
+double FloatExhaustive_UlpError(float result, double reference)
+{
+	if (std::isnan(result) || std::isnan(reference))
+		return std::isnan(result) && std::isnan(reference) ? 0 : HUGE_VAL;
+	if (std::isinf(reference))
+		return static_cast<double>(result) == reference ? 0 : HUGE_VAL;
+
+	// The spacing of floats around reference: 2^-149 for subnormals, up to 2^104 for the top binade.
+	int exponent = -126;
+	if (reference != 0)
+	{
+		std::frexp(reference, &exponent);
+		exponent = std::min(std::max(exponent - 1, -126), 127);
+	}
+	double ulp = std::ldexp(1.0, exponent - 23);
+	// A float infinity is exact for a reference beyond the float range (an overflow), and otherwise stands
+	//  for the value one ulp past FLT_MAX, 2^128, so that a reference that rounds to infinity is within half an ulp of it.
+	const double floatRangeEnd = std::ldexp(1.0, 128);
+	if (std::isinf(result) && std::fabs(reference) >= floatRangeEnd)
+		return std::signbit(result) == std::signbit(reference) ? 0 : HUGE_VAL;
+	double value = std::isinf(result) ? std::copysign(floatRangeEnd, result) : result;
+	return std::fabs(value - reference) / ulp;
+}
+
+bool FloatExhaustive_RoundTripsThroughText(float value)
+{
+	char text[FloatFormat_MaxChars];
+	size_t length = FloatFormat_Shortest(value, text, sizeof(text));
+	float back;
+	if (FloatFormat_Parse(text, length, back) != FloatFormatStatus::Ok)
+		return false;
+	if (std::isnan(value))
+		return std::isnan(back) && std::signbit(back) == std::signbit(value);
+	return std::memcmp(&value, &back, sizeof(value)) == 0;
+}
+
+bool FloatExhaustive_ClassifiesLikeStd(float value)
+{
+	switch (std::fpclassify(value))
+	{
+	case FP_ZERO:
+		return Float_Classify(value) == FloatCategory::Zero;
+	case FP_SUBNORMAL:
+		return Float_Classify(value) == FloatCategory::Subnormal;
+	case FP_NORMAL:
+		return Float_Classify(value) == FloatCategory::Normal;
+	case FP_INFINITE:
+		return Float_Classify(value) == FloatCategory::Infinite;
+	case FP_NAN:
+		return Float_Classify(value) == FloatCategory::NaN;
+	default:
+		return false;
+	}
+}
+
+bool FloatExhaustive_Report(const char* name, const FloatExhaustiveResult& result)
+{
+	std::cout << name << ": " << result.checked << " floats in " << result.seconds << " s ("
+		<< result.Throughput() / 1e6 << " M/s), " << result.failures << (result.failures == 1 ? " failure" : " failures");
+	if (result.maxUlp > 0 || std::isnan(result.maxUlp))
+	{
+		float worst;
+		std::memcpy(&worst, &result.maxUlpBits, sizeof(worst));
+		std::cout << ", max error " << result.maxUlp << " ulp at " << FloatFormat_Text(worst);
+	}
+	std::cout << '\n';
+	for (uint32_t bits : result.counterexamples)
+	{
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		char hex[9];
+		for (int i = 0; i < 8; ++i)
+			hex[i] = "0123456789abcdef"[(bits >> (28 - 4 * i)) & 0xF];
+		hex[8] = '\0';
+		std::cout << "  0x" << hex << " (" << FloatFormat_Text(value) << ")\n";
+	}
+	return result.Passed();
+}
@@ -0,0 +1,996 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatFormat.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/FloatFormat.h"
+
+#include <cfloat>
+#include <cstring>
+#include <ostream>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Both algorithms work with 128-bit approximations of powers of five:
+//  Ryu (Ulf Adams, "Ryu: fast float-to-string conversion", PLDI 2018) finds the shortest decimal in the
+//   interval of reals that round to the value, using 5^i and 2^k / 5^i scaled to 125 bits.
+//  Eisel-Lemire (Daniel Lemire, "Number Parsing at a Gigabyte per Second", 2021) multiplies the decimal
+//   significand by 5^q scaled to 128 bits and can almost always round from the high half of the product.
+// Both tables are computed at compile time from exact multi-word powers of five.
+
+namespace
+{
+	///////////////////////////////
+	// Wide integer arithmetic //
+	///////////////////////////////
+
+	// Returns the low half of a * b and stores the high half.
+	uint64_t Multiply64(uint64_t a, uint64_t b, uint64_t& high)
+	{
+#if defined(__SIZEOF_INT128__)
+		unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+		high = static_cast<uint64_t>(product >> 64);
+		return static_cast<uint64_t>(product);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return _umul128(a, b, &high);
+#else
+		uint64_t a0 = a & 0xFFFFFFFF, a1 = a >> 32, b0 = b & 0xFFFFFFFF, b1 = b >> 32;
+		uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+		uint64_t middle = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+		high = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+		return (p00 & 0xFFFFFFFF) | (middle << 32);
+#endif
+	}
+
+	unsigned CountLeadingZeros(uint64_t value)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return 63 - index;
+#elif defined(__GNUC__) || defined(__clang__)
+		return static_cast<unsigned>(__builtin_clzll(value));
+#else
+		unsigned count = 0;
+		for (uint64_t bit = uint64_t(1) << 63; (value & bit) == 0; bit >>= 1)
+			++count;
+		return count;
+#endif
+	}
+
+	struct UInt128
+	{
+		uint64_t high, low;
+	};
+
+	// An unsigned integer of WordCount 32-bit words, least significant word first. The compiler builds the tables
+	//  with 1024 bits, so everything here is constexpr; parsing more than 19 digits compares with 4096 bits on the stack.
+	template <int WordCount>
+	struct BigInteger
+	{
+		static constexpr int Words = WordCount;
+		uint32_t words[Words];
+
+		constexpr explicit BigInteger(uint32_t value) : words()
+		{
+			words[0] = value;
+		}
+
+		constexpr void MultiplySmall(uint32_t factor)
+		{
+			uint64_t carry = 0;
+			for (int i = 0; i < Words; ++i)
+			{
+				carry += static_cast<uint64_t>(words[i]) * factor;
+				words[i] = static_cast<uint32_t>(carry);
+				carry >>= 32;
+			}
+		}
+
+		constexpr void AddSmall(uint32_t value)
+		{
+			uint64_t carry = value;
+			for (int i = 0; i < Words && carry != 0; ++i)
+			{
+				carry += words[i];
+				words[i] = static_cast<uint32_t>(carry);
+				carry >>= 32;
+			}
+		}
+
+		// Multiplies by 5^exponent, 5^13 (the largest power below 2^32) at a time.
+		constexpr void MultiplyPow5(int exponent)
+		{
+			for (; exponent >= 13; exponent -= 13)
+				MultiplySmall(1220703125);
+			uint32_t factor = 1;
+			for (; exponent > 0; --exponent)
+				factor *= 5;
+			MultiplySmall(factor);
+		}
+
+		constexpr void ShiftLeft(int bits)
+		{
+			int wordShift = bits / 32, bitShift = bits % 32;
+			for (int i = Words - 1; i >= 0; --i)
+			{
+				uint32_t word = i >= wordShift ? words[i - wordShift] << bitShift : 0;
+				if (bitShift != 0 && i > wordShift)
+					word |= words[i - wordShift - 1] >> (32 - bitShift);
+				words[i] = word;
+			}
+		}
+
+		// -1, 0 or 1 as this is below, equal to or above other.
+		constexpr int Compare(const BigInteger& other) const
+		{
+			for (int i = Words - 1; i >= 0; --i)
+				if (words[i] != other.words[i])
+					return words[i] < other.words[i] ? -1 : 1;
+			return 0;
+		}
+
+		// Divides by divisor, rounding down.
+		constexpr void DivideSmall(uint32_t divisor)
+		{
+			uint64_t remainder = 0;
+			for (int i = Words - 1; i >= 0; --i)
+			{
+				uint64_t current = (remainder << 32) | words[i];
+				words[i] = static_cast<uint32_t>(current / divisor);
+				remainder = current % divisor;
+			}
+		}
+
+		constexpr int BitLength() const
+		{
+			for (int i = Words - 1; i >= 0; --i)
+				if (words[i] != 0)
+					for (int bit = 31; ; --bit)
+						if ((words[i] >> bit) & 1)
+							return i * 32 + bit + 1;
+			return 0;
+		}
+
+		// The 32 bits from bit start upwards, with zeros for positions below bit 0.
+		constexpr uint64_t Bits32(int start) const
+		{
+			if (start <= -32)
+				return 0;
+			if (start < 0)
+				return static_cast<uint32_t>(words[0] << -start);
+			int word = start / 32, shift = start % 32;
+			uint64_t bits = words[word] >> shift;
+			if (shift != 0 && word + 1 < Words)
+				bits |= static_cast<uint32_t>(words[word + 1] << (32 - shift));
+			return bits;
+		}
+
+		// The 128 bits below bit length, truncated.
+		constexpr UInt128 TopBits(int length) const
+		{
+			UInt128 result = { (Bits32(length - 32) << 32) | Bits32(length - 64), (Bits32(length - 96) << 32) | Bits32(length - 128) };
+			return result;
+		}
+	};
+
+	/////////////////////
+	// Power-of-five tables //
+	/////////////////////
+
+	const int LemireSmallestPower = -342;
+	const int LemireLargestPower = 308;
+	const int RyuPow5Count = 326;
+	const int RyuInversePow5Count = 342;
+	const int RyuPow5Bits = 125;
+	const int RyuInversePow5Bits = 125;
+
+	struct PowerTables
+	{
+		// 5^q with its most significant bit moved to bit 127 (truncated), for q in [-342, 308].
+		// Negative powers are 2^b / 5^-q rounded up when they have at most 128 significant bits, truncated otherwise.
+		UInt128 lemire[LemireLargestPower - LemireSmallestPower + 1];
+		// 5^i truncated to 125 bits, and 2^b / 5^i rounded up to 125 bits, stored {low, high} as Ryu expects.
+		uint64_t ryuPow5[RyuPow5Count][2];
+		uint64_t ryuInversePow5[RyuInversePow5Count][2];
+	};
+
+	constexpr UInt128 ShiftRight3(UInt128 value)
+	{
+		UInt128 result = { value.high >> 3, (value.low >> 3) | (value.high << 61) };
+		return result;
+	}
+
+	constexpr UInt128 Increment(UInt128 value)
+	{
+		UInt128 result = { value.high + (value.low == ~uint64_t(0) ? 1 : 0), value.low + 1 };
+		return result;
+	}
+
+	// The inverse powers need floor(2^(length + 127) / 5^k), where length is the bit length of 5^k: the 128 leading
+	//  bits of 2^b / 5^k for any large enough b. They all come from one dividend, 2^1023, divided by 5 once per power
+	//  (rounding down after each division gives the same quotient as dividing by 5^k at once), and 1023 leaves at least
+	//  128 quotient bits for 5^342, which has 795 bits.
+	const int InverseDividendBit = 1023;
+
+	constexpr PowerTables BuildTables()
+	{
+		PowerTables tables = {};
+		BigInteger<32> power(1);
+		BigInteger<32> inverse(0);
+		inverse.words[InverseDividendBit / 32] = uint32_t(1) << (InverseDividendBit % 32);
+		int largest = RyuPow5Count - 1 > LemireLargestPower ? RyuPow5Count - 1 : LemireLargestPower;
+		int smallest = RyuInversePow5Count - 1 > -LemireSmallestPower ? RyuInversePow5Count - 1 : -LemireSmallestPower;
+		for (int k = 0; k <= (largest > smallest ? largest : smallest); ++k)
+		{
+			UInt128 top = power.TopBits(power.BitLength());
+			if (k <= LemireLargestPower)
+				tables.lemire[k - LemireSmallestPower] = top;
+			if (k < RyuPow5Count)
+			{
+				UInt128 ryu = ShiftRight3(top);
+				tables.ryuPow5[k][0] = ryu.low;
+				tables.ryuPow5[k][1] = ryu.high;
+			}
+			if (k > 0)
+			{
+				inverse.DivideSmall(5);
+				UInt128 quotient = inverse.TopBits(inverse.BitLength());
+				// Powers that fit in 128 bits are rounded up; for the rest the truncation is provably the same
+				//  as rounding a wider quotient up and then truncating.
+				if (k <= -LemireSmallestPower)
+					tables.lemire[-k - LemireSmallestPower] = k <= 27 ? Increment(quotient) : quotient;
+				if (k < RyuInversePow5Count)
+				{
+					UInt128 ryu = Increment(ShiftRight3(quotient));
+					tables.ryuInversePow5[k][0] = ryu.low;
+					tables.ryuInversePow5[k][1] = ryu.high;
+				}
+			}
+			power.MultiplySmall(5);
+		}
+		// floor(2^125 / 5^0) + 1
+		tables.ryuInversePow5[0][0] = 1;
+		tables.ryuInversePow5[0][1] = uint64_t(1) << 61;
+		return tables;
+	}
+
+	// Computed by the compiler and stored in the program (about 21 KB), so that the first conversion in a process
+	//  does not have to build them.
+	constexpr PowerTables Powers = BuildTables();
+
+	/////////
+	// Ryu //
+	/////////
+
+	// ceil(log2(5^e)), or 1 for e = 0
+	int Pow5Bits(int e)
+	{
+		return static_cast<int>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+	}
+
+	// floor(log10(2^e)) and floor(log10(5^e)) for the exponent ranges used here
+	uint32_t Log10Pow2(int e)
+	{
+		return (static_cast<uint32_t>(e) * 78913) >> 18;
+	}
+
+	uint32_t Log10Pow5(int e)
+	{
+		return (static_cast<uint32_t>(e) * 732923) >> 20;
+	}
+
+	bool MultipleOfPowerOf5(uint64_t value, uint32_t p)
+	{
+		uint32_t count = 0;
+		for (; value % 5 == 0; value /= 5)
+			++count;
+		return count >= p;
+	}
+
+	bool MultipleOfPowerOf2(uint64_t value, uint32_t p)
+	{
+		return (value & ((uint64_t(1) << p) - 1)) == 0;
+	}
+
+	// (m * mul) >> j, where mul is 125 bits and 64 < j < 128
+	uint64_t MulShift(uint64_t m, const uint64_t* mul, int j)
+	{
+		uint64_t high0;
+		Multiply64(m, mul[0], high0);
+		uint64_t high1;
+		uint64_t low1 = Multiply64(m, mul[1], high1);
+		uint64_t sum = low1 + high0;
+		high1 += sum < low1 ? 1 : 0;
+		int shift = j - 64;
+		return (high1 << (64 - shift)) | (sum >> shift);
+	}
+
+	// value = digits * 10^exponent
+	struct DecimalValue
+	{
+		uint64_t digits;
+		int exponent;
+	};
+
+	// The shortest decimal in the rounding interval of m2 * 2^e2. mmShift is set unless the value is a power of two
+	//  above the smallest normal exponent, where the gap to the next smaller value is half as wide.
+	// This is Ryu's d2d written once for both float and double: the double tables are precise enough for floats.
+	DecimalValue ShortestDecimal(uint64_t m2, int e2, bool mmShift)
+	{
+		const PowerTables& tables = Powers;
+		e2 -= 2;
+		const bool acceptBounds = (m2 & 1) == 0;
+		const uint64_t mv = 4 * m2;
+		const uint64_t mmShiftBit = mmShift ? 1 : 0;
+		uint64_t vr, vp, vm;
+		int e10;
+		bool vmIsTrailingZeros = false, vrIsTrailingZeros = false;
+		if (e2 >= 0)
+		{
+			const uint32_t q = Log10Pow2(e2) - (e2 > 3 ? 1 : 0);
+			e10 = static_cast<int>(q);
+			const int k = RyuInversePow5Bits + Pow5Bits(static_cast<int>(q)) - 1;
+			const int i = -e2 + static_cast<int>(q) + k;
+			const uint64_t* mul = tables.ryuInversePow5[q];
+			vr = MulShift(4 * m2, mul, i);
+			vp = MulShift(4 * m2 + 2, mul, i);
+			vm = MulShift(4 * m2 - 1 - mmShiftBit, mul, i);
+			if (q <= 21)
+			{
+				// Only one of mp, mv and mm can be a multiple of 5, if any.
+				if (mv % 5 == 0)
+					vrIsTrailingZeros = MultipleOfPowerOf5(mv, q);
+				else if (acceptBounds)
+					vmIsTrailingZeros = MultipleOfPowerOf5(mv - 1 - mmShiftBit, q);
+				else
+					vp -= MultipleOfPowerOf5(mv + 2, q) ? 1 : 0;
+			}
+		}
+		else
+		{
+			const uint32_t q = Log10Pow5(-e2) - (-e2 > 1 ? 1 : 0);
+			e10 = static_cast<int>(q) + e2;
+			const int i = -e2 - static_cast<int>(q);
+			const int k = Pow5Bits(i) - RyuPow5Bits;
+			const int j = static_cast<int>(q) - k;
+			const uint64_t* mul = tables.ryuPow5[i];
+			vr = MulShift(4 * m2, mul, j);
+			vp = MulShift(4 * m2 + 2, mul, j);
+			vm = MulShift(4 * m2 - 1 - mmShiftBit, mul, j);
+			if (q <= 1)
+			{
+				// mv has at least q trailing zero bits, so vr is exact.
+				vrIsTrailingZeros = true;
+				if (acceptBounds)
+					vmIsTrailingZeros = mmShift;
+				else
+					--vp;
+			}
+			else if (q < 63)
+			{
+				vrIsTrailingZeros = MultipleOfPowerOf2(mv, q);
+			}
+		}
+
+		// Remove digits while the interval [vm, vp] still contains a shorter number.
+		int removed = 0;
+		uint64_t output;
+		if (vmIsTrailingZeros || vrIsTrailingZeros)
+		{
+			// The rare general case: track whether the removed digits were all zero, for exact ties.
+			uint32_t lastRemovedDigit = 0;
+			for (; vp / 10 > vm / 10; ++removed)
+			{
+				vmIsTrailingZeros &= vm % 10 == 0;
+				vrIsTrailingZeros &= lastRemovedDigit == 0;
+				lastRemovedDigit = static_cast<uint32_t>(vr % 10);
+				vr /= 10;
+				vp /= 10;
+				vm /= 10;
+			}
+			if (vmIsTrailingZeros)
+			{
+				for (; vm % 10 == 0; ++removed)
+				{
+					vrIsTrailingZeros &= lastRemovedDigit == 0;
+					lastRemovedDigit = static_cast<uint32_t>(vr % 10);
+					vr /= 10;
+					vp /= 10;
+					vm /= 10;
+				}
+			}
+			// Round an exact half to even.
+			if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0)
+				lastRemovedDigit = 4;
+			output = vr + (((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5) ? 1 : 0);
+		}
+		else
+		{
+			// The common case: no exact ties are possible.
+			bool roundUp = false;
+			if (vp / 100 > vm / 100)
+			{
+				roundUp = vr % 100 >= 50;
+				vr /= 100;
+				vp /= 100;
+				vm /= 100;
+				removed += 2;
+			}
+			for (; vp / 10 > vm / 10; ++removed)
+			{
+				roundUp = vr % 10 >= 5;
+				vr /= 10;
+				vp /= 10;
+				vm /= 10;
+			}
+			output = vr + ((vr == vm || roundUp) ? 1 : 0);
+		}
+		DecimalValue result = { output, e10 + removed };
+		return result;
+	}
+
+	////////////////
+	// Formatting //
+	////////////////
+
+	const char DecimalPairs[] =
+		"0001020304050607080910111213141516171819"
+		"2021222324252627282930313233343536373839"
+		"4041424344454647484950515253545556575859"
+		"6061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	const uint64_t PowersOf10[] = { 1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+		100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+		100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+		1000000000000000000ull, 10000000000000000000ull };
+
+	// The number of decimal digits in value, from its bit length: 1233 / 4096 ~ log10(2)
+	int DecimalLength(uint64_t value)
+	{
+		int bits = 64 - static_cast<int>(CountLeadingZeros(value | 1));
+		int guess = (bits * 1233) >> 12;
+		return guess + 1 - (value < PowersOf10[guess] ? 1 : 0);
+	}
+
+	// Writes the length digits of value so that the last one lands just before end.
+	void WriteDigits(uint64_t value, char* end, int length)
+	{
+		for (; length >= 2; length -= 2, value /= 100)
+		{
+			end -= 2;
+			std::memcpy(end, DecimalPairs + (value % 100) * 2, 2);
+		}
+		if (length == 1)
+			end[-1] = static_cast<char>('0' + value);
+	}
+
+	// Writes the integer high * 2^64 + low and returns the number of characters.
+	int WriteInteger(uint64_t high, uint64_t low, char* out)
+	{
+		// Peel off base-10^9 chunks with 64-by-32-bit divisions on 32-bit limbs.
+		uint32_t limbs[4] = { static_cast<uint32_t>(low), static_cast<uint32_t>(low >> 32),
+			static_cast<uint32_t>(high), static_cast<uint32_t>(high >> 32) };
+		uint32_t chunks[5];
+		int chunkCount = 0;
+		for (;;)
+		{
+			uint64_t remainder = 0;
+			bool nonZero = false;
+			for (int i = 3; i >= 0; --i)
+			{
+				uint64_t current = (remainder << 32) | limbs[i];
+				limbs[i] = static_cast<uint32_t>(current / 1000000000);
+				remainder = current % 1000000000;
+				nonZero |= limbs[i] != 0;
+			}
+			chunks[chunkCount++] = static_cast<uint32_t>(remainder);
+			if (!nonZero)
+				break;
+		}
+		int length = DecimalLength(chunks[chunkCount - 1]);
+		WriteDigits(chunks[chunkCount - 1], out + length, length);
+		for (int i = chunkCount - 2; i >= 0; --i)
+		{
+			WriteDigits(chunks[i], out + length + 9, 9);
+			length += 9;
+		}
+		return length;
+	}
+
+	// Lays out digits * 10^exponent like std::to_chars. m2 * 2^e2 is the exact binary value, which is printed
+	//  in full when fixed notation calls for trailing zeros: to_chars then shows the exact integer.
+	size_t WriteShortest(bool negative, DecimalValue value, uint64_t m2, int e2, char* buffer, size_t bufferSize)
+	{
+		char text[FloatFormat_MaxChars + 8];
+		char* p = text;
+		if (negative)
+			*p++ = '-';
+		const int length = DecimalLength(value.digits);
+		const int exponent = value.exponent;
+		// Fixed notation is used where it is no longer than scientific, e.g. 0.001 (vs 1e-03) and 123400000 (vs 1.234e+08).
+		const int lower = length == 1 ? -3 : -(length + 3);
+		const int upper = length == 1 ? 4 : 5;
+		if (exponent >= lower && exponent <= upper)
+		{
+			if (exponent > 0)
+			{
+				uint64_t high = 0, low = m2;
+				if (e2 >= 0)
+				{
+					high = e2 == 0 ? 0 : m2 >> (64 - e2);
+					low = m2 << e2;
+				}
+				else
+				{
+					low = m2 >> -e2;
+				}
+				p += WriteInteger(high, low, p);
+			}
+			else if (length + exponent > 0)
+			{
+				// 17.29: the digits with a point inserted
+				int whole = length + exponent;
+				WriteDigits(value.digits, p + length + 1, length);
+				std::memmove(p, p + 1, whole);
+				p[whole] = '.';
+				p += exponent == 0 ? whole : length + 1;
+			}
+			else
+			{
+				// 0.001729
+				int zeros = -(length + exponent);
+				*p++ = '0';
+				*p++ = '.';
+				std::memset(p, '0', zeros);
+				p += zeros;
+				WriteDigits(value.digits, p + length, length);
+				p += length;
+			}
+		}
+		else
+		{
+			// 1.729e+08: the first digit, then a point and the rest if there is a rest
+			WriteDigits(value.digits, p + length + 1, length);
+			p[0] = p[1];
+			if (length > 1)
+			{
+				p[1] = '.';
+				p += length + 1;
+			}
+			else
+			{
+				p += 1;
+			}
+			int scientific = exponent + length - 1;
+			*p++ = 'e';
+			*p++ = scientific < 0 ? '-' : '+';
+			unsigned magnitude = static_cast<unsigned>(scientific < 0 ? -scientific : scientific);
+			if (magnitude >= 100)
+			{
+				*p++ = static_cast<char>('0' + magnitude / 100);
+				magnitude %= 100;
+			}
+			std::memcpy(p, DecimalPairs + magnitude * 2, 2);
+			p += 2;
+		}
+		size_t written = static_cast<size_t>(p - text);
+		if (written > bufferSize)
+			return 0;
+		std::memcpy(buffer, text, written);
+		return written;
+	}
+
+	size_t WriteSpecial(const char* text, size_t length, char* buffer, size_t bufferSize)
+	{
+		if (length > bufferSize)
+			return 0;
+		std::memcpy(buffer, text, length);
+		return length;
+	}
+
+	/////////////
+	// Parsing //
+	/////////////
+
+	// A decimal number as read from the text: mantissa * 10^exponent.
+	// At most 19 significant digits fit in the mantissa; truncated is set when non-zero digits were dropped.
+	struct ParsedDecimal
+	{
+		uint64_t mantissa;
+		int64_t exponent;
+		bool negative;
+		bool truncated;
+		bool infinity;
+		bool nan;
+	};
+
+	bool MatchesIgnoringCase(const char* text, size_t length, const char* lowercase)
+	{
+		size_t expected = std::strlen(lowercase);
+		if (length != expected)
+			return false;
+		for (size_t i = 0; i < length; ++i)
+			if ((text[i] | 0x20) != lowercase[i])
+				return false;
+		return true;
+	}
+
+	FloatFormatStatus ScanDecimal(const char* text, size_t length, ParsedDecimal& number)
+	{
+		if (length == 0)
+			return FloatFormatStatus::Empty;
+		number.mantissa = 0;
+		number.exponent = 0;
+		number.negative = false;
+		number.truncated = false;
+		number.infinity = false;
+		number.nan = false;
+		size_t i = 0;
+		if (text[0] == '-' || text[0] == '+')
+		{
+			number.negative = text[0] == '-';
+			++i;
+		}
+		if (i < length && (text[i] < '0' || text[i] > '9') && text[i] != '.')
+		{
+			if (MatchesIgnoringCase(text + i, length - i, "inf") || MatchesIgnoringCase(text + i, length - i, "infinity"))
+				number.infinity = true;
+			else if (MatchesIgnoringCase(text + i, length - i, "nan"))
+				number.nan = true;
+			else
+				return FloatFormatStatus::Invalid;
+			return FloatFormatStatus::Ok;
+		}
+
+		int significant = 0;
+		bool anyDigit = false;
+		// Leading zeros carry no information.
+		for (; i < length && text[i] == '0'; ++i)
+			anyDigit = true;
+		for (; i < length && text[i] >= '0' && text[i] <= '9'; ++i)
+		{
+			anyDigit = true;
+			unsigned digit = static_cast<unsigned>(text[i] - '0');
+			if (significant < 19)
+			{
+				number.mantissa = number.mantissa * 10 + digit;
+				++significant;
+			}
+			else
+			{
+				++number.exponent;
+				number.truncated |= digit != 0;
+			}
+		}
+		if (i < length && text[i] == '.')
+		{
+			++i;
+			if (significant == 0)
+			{
+				for (; i < length && text[i] == '0'; ++i)
+				{
+					anyDigit = true;
+					--number.exponent;
+				}
+			}
+			for (; i < length && text[i] >= '0' && text[i] <= '9'; ++i)
+			{
+				anyDigit = true;
+				unsigned digit = static_cast<unsigned>(text[i] - '0');
+				if (significant < 19)
+				{
+					number.mantissa = number.mantissa * 10 + digit;
+					++significant;
+					--number.exponent;
+				}
+				else
+				{
+					number.truncated |= digit != 0;
+				}
+			}
+		}
+		if (!anyDigit)
+			return FloatFormatStatus::Invalid;
+		if (i < length && (text[i] == 'e' || text[i] == 'E'))
+		{
+			++i;
+			bool negativeExponent = false;
+			if (i < length && (text[i] == '-' || text[i] == '+'))
+				negativeExponent = text[i++] == '-';
+			if (i == length)
+				return FloatFormatStatus::Invalid;
+			int64_t exponent = 0;
+			for (; i < length && text[i] >= '0' && text[i] <= '9'; ++i)
+			{
+				// Anything past a million is zero or infinity anyway.
+				if (exponent < 1000000)
+					exponent = exponent * 10 + (text[i] - '0');
+			}
+			number.exponent += negativeExponent ? -exponent : exponent;
+		}
+		return i == length ? FloatFormatStatus::Ok : FloatFormatStatus::Invalid;
+	}
+
+	// The parameters of a binary interchange format that Eisel-Lemire depends on.
+	struct BinaryFormat
+	{
+		int mantissaBits;        // explicitly stored significand bits
+		int minimumExponent;     // -bias
+		int infinitePower;       // the biased exponent of infinity
+		int smallestPowerOfTen;  // below this every significand rounds to zero
+		int largestPowerOfTen;   // above this every non-zero significand overflows
+		int minRoundToEven;      // the range of powers of ten where a product can be an exact tie
+		int maxRoundToEven;
+		uint64_t maxFastMantissa;  // largest exactly representable integer
+		int maxFastPower;        // largest exactly representable power of ten
+	};
+
+	const BinaryFormat Binary32 = { 23, -127, 0xFF, -65, 38, -17, 10, uint64_t(1) << 24, 10 };
+	const BinaryFormat Binary64 = { 52, -1023, 0x7FF, -342, 308, -4, 23, uint64_t(1) << 53, 22 };
+
+	// Returns the bit pattern (without the sign) of the value nearest to w * 10^q.
+	uint64_t EiselLemire(uint64_t w, int64_t q, const BinaryFormat& format)
+	{
+		if (w == 0 || q < format.smallestPowerOfTen)
+			return 0;
+		if (q > format.largestPowerOfTen)
+			return static_cast<uint64_t>(format.infinitePower) << format.mantissaBits;
+
+		const UInt128& power = Powers.lemire[q - LemireSmallestPower];
+		int leadingZeros = static_cast<int>(CountLeadingZeros(w));
+		w <<= leadingZeros;
+
+		// Only as many product bits as the rounding needs: if they are not all ones, a lower-order
+		//  correction cannot carry into them and the second multiplication is skipped.
+		const int precision = format.mantissaBits + 3;
+		const uint64_t precisionMask = ~uint64_t(0) >> precision;
+		uint64_t high;
+		uint64_t low = Multiply64(w, power.high, high);
+		if ((high & precisionMask) == precisionMask)
+		{
+			uint64_t secondHigh;
+			Multiply64(w, power.low, secondHigh);
+			low += secondHigh;
+			high += secondHigh > low ? 1 : 0;
+		}
+
+		int upperBit = static_cast<int>(high >> 63);
+		int shift = upperBit + 64 - format.mantissaBits - 3;
+		uint64_t mantissa = high >> shift;
+		// floor(log2(10^q)) + 63, via 217706 / 2^16 ~ log2(10)
+		int power2 = static_cast<int>(((217706 * q) >> 16) + 63) + upperBit - leadingZeros - format.minimumExponent;
+
+		if (power2 <= 0)
+		{
+			// Subnormal: shift so that the exponent is 1, then round.
+			if (-power2 + 1 >= 64)
+				return 0;
+			mantissa >>= -power2 + 1;
+			mantissa += mantissa & 1;
+			mantissa >>= 1;
+			// Rounding up can carry into the smallest normal exponent; or-ing keeps the bit pattern right.
+			power2 = mantissa < (uint64_t(1) << format.mantissaBits) ? 0 : 1;
+			return mantissa | (static_cast<uint64_t>(power2) << format.mantissaBits);
+		}
+
+		// A product that is exactly half way between two values rounds to even; that can only
+		//  happen for small powers of ten, when the low bits are zero.
+		if (low <= 1 && q >= format.minRoundToEven && q <= format.maxRoundToEven && (mantissa & 3) == 1
+			&& (mantissa << shift) == high)
+			mantissa &= ~uint64_t(1);
+
+		mantissa += mantissa & 1;
+		mantissa >>= 1;
+		if (mantissa >= (uint64_t(2) << format.mantissaBits))
+		{
+			mantissa = uint64_t(1) << format.mantissaBits;
+			++power2;
+		}
+		mantissa &= ~(uint64_t(1) << format.mantissaBits);
+		if (power2 >= format.infinitePower)
+			return static_cast<uint64_t>(format.infinitePower) << format.mantissaBits;
+		return mantissa | (static_cast<uint64_t>(power2) << format.mantissaBits);
+	}
+
+	// More significant digits than any halfway point between two doubles has (767); digits past these can only
+	//  break an exact tie.
+	const int SlowParseDigits = 768;
+
+	// Correct rounding of more than 19 significant digits needs all of them; the truncated mantissa only decides
+	//  the result when it and the next mantissa up round to the same value. Otherwise the value is candidate (the
+	//  rounding of the truncated mantissa) or the next one up, and the exact comparison of all the digits with the
+	//  halfway point between the two decides. This does not depend on the locale and does not allocate.
+	uint64_t ParseSlowly(const char* text, size_t length, const ParsedDecimal& number, const BinaryFormat& format,
+		uint64_t candidate)
+	{
+		// digits * 10^exponent, from the first 768 significant digits
+		BigInteger<128> digits(0);
+		int taken = 0;
+		bool dropped = false;
+		uint32_t chunk = 0, chunkScale = 1;
+		for (size_t i = 0; i < length && text[i] != 'e' && text[i] != 'E'; ++i)
+		{
+			if (text[i] < '0' || text[i] > '9' || (taken == 0 && text[i] == '0'))
+				continue;
+			if (taken == SlowParseDigits)
+			{
+				dropped |= text[i] != '0';
+				continue;
+			}
+			chunk = chunk * 10 + static_cast<uint32_t>(text[i] - '0');
+			chunkScale *= 10;
+			++taken;
+			if (chunkScale == 1000000000)
+			{
+				digits.MultiplySmall(chunkScale);
+				digits.AddSmall(chunk);
+				chunk = 0;
+				chunkScale = 1;
+			}
+		}
+		digits.MultiplySmall(chunkScale);
+		digits.AddSmall(chunk);
+		// ScanDecimal kept 19 of the digits.
+		const int exponent = static_cast<int>(number.exponent) + 19 - taken;
+
+		// The halfway point above candidate: (2 * significand + 1) * 2^(binaryExponent - 1)
+		const int biasedExponent = static_cast<int>(candidate >> format.mantissaBits);
+		const uint64_t significand = biasedExponent == 0 ? candidate : (candidate & ((uint64_t(1) << format.mantissaBits) - 1))
+			| (uint64_t(1) << format.mantissaBits);
+		const int binaryExponent = (biasedExponent == 0 ? 1 : biasedExponent) + format.minimumExponent - format.mantissaBits - 1;
+		const uint64_t halfwaySignificand = 2 * significand + 1;
+		BigInteger<128> halfway(static_cast<uint32_t>(halfwaySignificand));
+		halfway.words[1] = static_cast<uint32_t>(halfwaySignificand >> 32);
+
+		// Compare digits * 5^exponent * 2^exponent with halfway * 2^binaryExponent, both scaled to integers.
+		if (exponent >= 0)
+			digits.MultiplyPow5(exponent);
+		else
+			halfway.MultiplyPow5(-exponent);
+		if (exponent > binaryExponent)
+			digits.ShiftLeft(exponent - binaryExponent);
+		else
+			halfway.ShiftLeft(binaryExponent - exponent);
+		int order = digits.Compare(halfway);
+		if (order == 0)
+			order = dropped ? 1 : static_cast<int>(candidate & 1) * 2 - 1;
+		return order > 0 ? candidate + 1 : candidate;
+	}
+
+	template <typename T, typename Bits>
+	FloatFormatStatus Parse(const char* text, size_t length, const BinaryFormat& format, T& value)
+	{
+		ParsedDecimal number;
+		FloatFormatStatus status = ScanDecimal(text, length, number);
+		if (status != FloatFormatStatus::Ok)
+			return status;
+		const Bits signBit = Bits(1) << (sizeof(Bits) * 8 - 1);
+		const Bits infinity = static_cast<Bits>(format.infinitePower) << format.mantissaBits;
+		Bits bits;
+		if (number.nan)
+		{
+			bits = infinity | (Bits(1) << (format.mantissaBits - 1));
+		}
+		else if (number.infinity)
+		{
+			bits = infinity;
+		}
+		else
+		{
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+			// Clinger's fast path: when both the mantissa and the power of ten are exact in T,
+			//  a single correctly rounded multiplication or division gives the answer.
+			if (!number.truncated && number.mantissa <= format.maxFastMantissa
+				&& number.exponent >= -format.maxFastPower && number.exponent <= format.maxFastPower)
+			{
+				static const T powers[] = { T(1e0), T(1e1), T(1e2), T(1e3), T(1e4), T(1e5), T(1e6), T(1e7), T(1e8),
+					T(1e9), T(1e10), T(1e11), T(1e12), T(1e13), T(1e14), T(1e15), T(1e16), T(1e17), T(1e18), T(1e19),
+					T(1e20), T(1e21), T(1e22) };
+				T result = static_cast<T>(number.mantissa);
+				result = number.exponent < 0 ? result / powers[-number.exponent] : result * powers[number.exponent];
+				value = number.negative ? -result : result;
+				return FloatFormatStatus::Ok;
+			}
+#endif
+			bits = static_cast<Bits>(EiselLemire(number.mantissa, number.exponent, format));
+			if (number.truncated && bits != static_cast<Bits>(EiselLemire(number.mantissa + 1, number.exponent, format)))
+				bits = static_cast<Bits>(ParseSlowly(text, length, number, format, bits));
+		}
+		if (number.negative)
+			bits |= signBit;
+		std::memcpy(&value, &bits, sizeof(value));
+		return !number.infinity && (bits & ~signBit) == infinity ? FloatFormatStatus::OutOfRange : FloatFormatStatus::Ok;
+	}
+}
+
+size_t FloatFormat_Shortest(float value, char* buffer, size_t bufferSize)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	const bool negative = (bits >> 31) != 0;
+	const uint32_t mantissa = bits & 0x7FFFFF;
+	const int exponent = static_cast<int>((bits >> 23) & 0xFF);
+	if (exponent == 0xFF)
+	{
+		if (mantissa != 0)
+			return negative ? WriteSpecial("-nan", 4, buffer, bufferSize) : WriteSpecial("nan", 3, buffer, bufferSize);
+		return negative ? WriteSpecial("-inf", 4, buffer, bufferSize) : WriteSpecial("inf", 3, buffer, bufferSize);
+	}
+	if (exponent == 0 && mantissa == 0)
+		return negative ? WriteSpecial("-0", 2, buffer, bufferSize) : WriteSpecial("0", 1, buffer, bufferSize);
+	// value = m2 * 2^e2
+	const uint64_t m2 = exponent == 0 ? mantissa : (mantissa | (uint32_t(1) << 23));
+	const int e2 = (exponent == 0 ? 1 : exponent) - 127 - 23;
+	DecimalValue decimal = ShortestDecimal(m2, e2, mantissa != 0 || exponent <= 1);
+	return WriteShortest(negative, decimal, m2, e2, buffer, bufferSize);
+}
+
+size_t FloatFormat_Shortest(double value, char* buffer, size_t bufferSize)
+{
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	const bool negative = (bits >> 63) != 0;
+	const uint64_t mantissa = bits & ((uint64_t(1) << 52) - 1);
+	const int exponent = static_cast<int>((bits >> 52) & 0x7FF);
+	if (exponent == 0x7FF)
+	{
+		if (mantissa != 0)
+			return negative ? WriteSpecial("-nan", 4, buffer, bufferSize) : WriteSpecial("nan", 3, buffer, bufferSize);
+		return negative ? WriteSpecial("-inf", 4, buffer, bufferSize) : WriteSpecial("inf", 3, buffer, bufferSize);
+	}
+	if (exponent == 0 && mantissa == 0)
+		return negative ? WriteSpecial("-0", 2, buffer, bufferSize) : WriteSpecial("0", 1, buffer, bufferSize);
+	const uint64_t m2 = exponent == 0 ? mantissa : (mantissa | (uint64_t(1) << 52));
+	const int e2 = (exponent == 0 ? 1 : exponent) - 1023 - 52;
+	DecimalValue decimal = ShortestDecimal(m2, e2, mantissa != 0 || exponent <= 1);
+	return WriteShortest(negative, decimal, m2, e2, buffer, bufferSize);
+}
+
+FloatFormatStatus FloatFormat_Parse(const char* text, size_t length, float& value)
+{
+	return Parse<float, uint32_t>(text, length, Binary32, value);
+}
+
+FloatFormatStatus FloatFormat_Parse(const char* text, size_t length, double& value)
+{
+	return Parse<double, uint64_t>(text, length, Binary64, value);
+}
+
+FloatText FloatFormat_Text(float value)
+{
+	FloatText text;
+	text.length = FloatFormat_Shortest(value, text.chars, sizeof(text.chars));
+	return text;
+}
+
+FloatText FloatFormat_Text(double value)
+{
+	FloatText text;
+	text.length = FloatFormat_Shortest(value, text.chars, sizeof(text.chars));
+	return text;
+}
+
+std::ostream& operator<<(std::ostream& stream, const FloatText& text)
+{
+	return stream.write(text.chars, static_cast<std::streamsize>(text.length));
+}
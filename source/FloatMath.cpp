@@ -0,0 +1,665 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: FloatMath.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/FloatMath.h"
+#include "../header/CpuFeatures.h"
+#include "../header/FloatBits.h"
+
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+#if defined(NUMBERS_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// Each function is a struct holding the same computation three times: Scalar on one float, SSE2 on 4 and AVX2
+	//  on 8, operation for operation. The batch loops at the end are templates over these structs.
+	// Lanes that the vector code cannot handle (only sin and cos have any) are flagged by Exceptions,
+	//  and then recomputed by Scalar.
+
+	const float Infinity = std::numeric_limits<float>::infinity();
+	const float QuietNaN = std::numeric_limits<float>::quiet_NaN();
+	// Adding and subtracting 1.5 * 2^23 rounds a float below 2^22 in magnitude to the nearest integer, ties to even,
+	//  without leaving floating point registers. RoundDouble does the same for doubles below 2^51.
+	const float RoundFloat = 12582912.0f;
+	const double RoundDouble = 6755399441055744.0;
+	// Below this magnitude e^x rounds to 1 and sin x to x, but squaring x would give a subnormal, which costs a
+	//  hundred cycles or more on most processors (see Denormals.h). Such values skip the polynomials instead.
+	const float Negligible = 9.31322574615478515625e-10f;  // 2^-30
+
+#if defined(NUMBERS_X86)
+	NUMBERS_TARGET("sse2")
+	inline __m128 SelectSSE2(__m128 mask, __m128 ifTrue, __m128 ifFalse)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+	}
+#endif
+
+	// ---------------------------------------------------------------- 1/sqrt and sqrt
+
+	// RSQRTPS reads subnormals as zero. Scaling them by 2^24 makes them normal, and scaling the result by 2^12
+	//  makes up for it.
+	const float RsqrtScaleIn = 16777216.0f;
+	const float RsqrtScaleOut = 4096.0f;
+
+	struct Rsqrt
+	{
+		static float Scalar(float x)
+		{
+			return 1.0f / std::sqrt(x);
+		}
+
+#if defined(NUMBERS_X86)
+		NUMBERS_TARGET("sse2")
+		static __m128 SSE2(__m128 x)
+		{
+			__m128 tiny = _mm_cmplt_ps(x, _mm_set1_ps(FLT_MIN));
+			__m128 scaled = SelectSSE2(tiny, _mm_mul_ps(x, _mm_set1_ps(RsqrtScaleIn)), x);
+			__m128 estimate = _mm_rsqrt_ps(scaled);
+			// With r = 1 - x * y * y, the exact value is y * (1 - r)^(-1/2) = y * (1 + r/2 + 3r^2/8 + ...). The Newton
+			//  step keeps r/2, leaving an error of about 1.5e^2 for a relative error e in y: over 3 ulps from the 2^-12
+			//  of RSQRTPS. The r^2 term costs one multiply-add more and leaves only rounding error.
+			__m128 h = _mm_mul_ps(scaled, estimate);
+			__m128 residual = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(h, estimate));
+			__m128 series = _mm_mul_ps(residual, _mm_add_ps(_mm_set1_ps(0.5f), _mm_mul_ps(_mm_set1_ps(0.375f), residual)));
+			__m128 refined = _mm_add_ps(estimate, _mm_mul_ps(estimate, series));
+			// The estimates for 0 and infinity are exact, but the step would turn them into NaN (0 * infinity).
+			__m128 exact = _mm_or_ps(_mm_cmpeq_ps(scaled, _mm_setzero_ps()), _mm_cmpeq_ps(scaled, _mm_set1_ps(Infinity)));
+			__m128 y = SelectSSE2(exact, estimate, refined);
+			return SelectSSE2(tiny, _mm_mul_ps(y, _mm_set1_ps(RsqrtScaleOut)), y);
+		}
+
+		NUMBERS_TARGET("avx2")
+		static __m256 AVX2(__m256 x)
+		{
+			__m256 tiny = _mm256_cmp_ps(x, _mm256_set1_ps(FLT_MIN), _CMP_LT_OQ);
+			__m256 scaled = _mm256_blendv_ps(x, _mm256_mul_ps(x, _mm256_set1_ps(RsqrtScaleIn)), tiny);
+			__m256 estimate = _mm256_rsqrt_ps(scaled);
+			__m256 h = _mm256_mul_ps(scaled, estimate);
+			__m256 residual = _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(h, estimate));
+			__m256 series = _mm256_mul_ps(residual, _mm256_add_ps(_mm256_set1_ps(0.5f), _mm256_mul_ps(_mm256_set1_ps(0.375f), residual)));
+			__m256 refined = _mm256_add_ps(estimate, _mm256_mul_ps(estimate, series));
+			__m256 exact = _mm256_or_ps(_mm256_cmp_ps(scaled, _mm256_setzero_ps(), _CMP_EQ_OQ),
+				_mm256_cmp_ps(scaled, _mm256_set1_ps(Infinity), _CMP_EQ_OQ));
+			__m256 y = _mm256_blendv_ps(refined, estimate, exact);
+			return _mm256_blendv_ps(y, _mm256_mul_ps(y, _mm256_set1_ps(RsqrtScaleOut)), tiny);
+		}
+
+		static int Exceptions(__m128) { return 0; }
+		NUMBERS_TARGET("avx2")
+		static int Exceptions(__m256) { return 0; }
+#endif
+	};
+
+	struct Sqrt
+	{
+		static float Scalar(float x)
+		{
+			return std::sqrt(x);
+		}
+
+#if defined(NUMBERS_X86)
+		NUMBERS_TARGET("sse2")
+		static __m128 SSE2(__m128 x)
+		{
+			return _mm_sqrt_ps(x);
+		}
+
+		NUMBERS_TARGET("avx2")
+		static __m256 AVX2(__m256 x)
+		{
+			return _mm256_sqrt_ps(x);
+		}
+
+		static int Exceptions(__m128) { return 0; }
+		NUMBERS_TARGET("avx2")
+		static int Exceptions(__m256) { return 0; }
+#endif
+	};
+
+	// ---------------------------------------------------------------- exp
+
+	// Below -104, e^x is less than half the smallest subnormal, and above 89 it is past FLT_MAX. Such values are set
+	//  to 0 and infinity by selection rather than by underflowing or overflowing arithmetic, which is as slow as
+	//  arithmetic on subnormals. Between them n lies within [-150, 128], where 2^n is the product of two normal floats.
+	const float ExpLow = -104.0f;
+	const float ExpHigh = 89.0f;
+	const float Log2E = 1.44269504088896341f;
+	// ln 2 in two parts (Cody and Waite). The first has only 9 significant bits, so n * ExpLn2High is exact
+	//  and r = x - n * ln 2 loses nothing to cancellation.
+	const float ExpLn2High = 0.693359375f;
+	const float ExpLn2Low = -2.12194440e-4f;
+	// e^r = 1 + r + r^2 * P(r) on [-ln 2 / 2, ln 2 / 2] (Moshier, Cephes).
+	const float ExpP[6] = { 1.9875691500e-4f, 1.3981999507e-3f, 8.3334519073e-3f, 4.1665795894e-2f, 1.6666665459e-1f, 5.0000001201e-1f };
+
+	struct Exp
+	{
+		static float Scalar(float x)
+		{
+			if (x != x)
+				return x;
+			if (x < ExpLow)
+				return 0.0f;
+			if (x > ExpHigh)
+				return Infinity;
+			float clamped = std::fabs(x) < Negligible ? 0.0f : x;
+			float n = (clamped * Log2E + RoundFloat) - RoundFloat;
+			float r = clamped - n * ExpLn2High;
+			r = r - n * ExpLn2Low;
+			float z = r * r;
+			float p = ExpP[0];
+			for (int i = 1; i < 6; ++i)
+				p = p * r + ExpP[i];
+			float e = (p * z + r) + 1.0f;
+			// 2^n as 2^(n/2) * 2^(n - n/2), so that the result is rounded once, even when it is subnormal.
+			int32_t half = static_cast<int32_t>(n) >> 1;
+			int32_t rest = static_cast<int32_t>(n) - half;
+			return (e * Float_FromBits<float>(static_cast<uint32_t>(half + 127) << 23))
+				* Float_FromBits<float>(static_cast<uint32_t>(rest + 127) << 23);
+		}
+
+#if defined(NUMBERS_X86)
+		NUMBERS_TARGET("sse2")
+		static __m128 SSE2(__m128 x)
+		{
+			__m128 underflow = _mm_cmplt_ps(x, _mm_set1_ps(ExpLow));
+			__m128 overflow = _mm_cmpgt_ps(x, _mm_set1_ps(ExpHigh));
+			__m128 magnitude = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+			__m128 zero = _mm_or_ps(_mm_or_ps(underflow, overflow), _mm_cmplt_ps(magnitude, _mm_set1_ps(Negligible)));
+			__m128 clamped = _mm_andnot_ps(zero, x);
+			__m128 round = _mm_set1_ps(RoundFloat);
+			__m128 n = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(Log2E)), round), round);
+			__m128 r = _mm_sub_ps(clamped, _mm_mul_ps(n, _mm_set1_ps(ExpLn2High)));
+			r = _mm_sub_ps(r, _mm_mul_ps(n, _mm_set1_ps(ExpLn2Low)));
+			__m128 z = _mm_mul_ps(r, r);
+			__m128 p = _mm_set1_ps(ExpP[0]);
+			for (int i = 1; i < 6; ++i)
+				p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(ExpP[i]));
+			__m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p, z), r), _mm_set1_ps(1.0f));
+			__m128i ni = _mm_cvttps_epi32(n);
+			__m128i half = _mm_srai_epi32(ni, 1);
+			__m128i rest = _mm_sub_epi32(ni, half);
+			__m128i bias = _mm_set1_epi32(127);
+			e = _mm_mul_ps(e, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(half, bias), 23)));
+			e = _mm_mul_ps(e, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(rest, bias), 23)));
+			e = _mm_andnot_ps(underflow, e);
+			e = SelectSSE2(overflow, _mm_set1_ps(Infinity), e);
+			return SelectSSE2(_mm_cmpunord_ps(x, x), x, e);
+		}
+
+		NUMBERS_TARGET("avx2")
+		static __m256 AVX2(__m256 x)
+		{
+			__m256 underflow = _mm256_cmp_ps(x, _mm256_set1_ps(ExpLow), _CMP_LT_OQ);
+			__m256 overflow = _mm256_cmp_ps(x, _mm256_set1_ps(ExpHigh), _CMP_GT_OQ);
+			__m256 magnitude = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+			__m256 zero = _mm256_or_ps(_mm256_or_ps(underflow, overflow), _mm256_cmp_ps(magnitude, _mm256_set1_ps(Negligible), _CMP_LT_OQ));
+			__m256 clamped = _mm256_andnot_ps(zero, x);
+			__m256 round = _mm256_set1_ps(RoundFloat);
+			__m256 n = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(clamped, _mm256_set1_ps(Log2E)), round), round);
+			__m256 r = _mm256_sub_ps(clamped, _mm256_mul_ps(n, _mm256_set1_ps(ExpLn2High)));
+			r = _mm256_sub_ps(r, _mm256_mul_ps(n, _mm256_set1_ps(ExpLn2Low)));
+			__m256 z = _mm256_mul_ps(r, r);
+			__m256 p = _mm256_set1_ps(ExpP[0]);
+			for (int i = 1; i < 6; ++i)
+				p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(ExpP[i]));
+			__m256 e = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(p, z), r), _mm256_set1_ps(1.0f));
+			__m256i ni = _mm256_cvttps_epi32(n);
+			__m256i half = _mm256_srai_epi32(ni, 1);
+			__m256i rest = _mm256_sub_epi32(ni, half);
+			__m256i bias = _mm256_set1_epi32(127);
+			e = _mm256_mul_ps(e, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(half, bias), 23)));
+			e = _mm256_mul_ps(e, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(rest, bias), 23)));
+			e = _mm256_andnot_ps(underflow, e);
+			e = _mm256_blendv_ps(e, _mm256_set1_ps(Infinity), overflow);
+			return _mm256_blendv_ps(e, x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+		}
+
+		static int Exceptions(__m128) { return 0; }
+		NUMBERS_TARGET("avx2")
+		static int Exceptions(__m256) { return 0; }
+#endif
+	};
+
+	// ---------------------------------------------------------------- log
+
+	// Subnormals are scaled by 2^23 to become normal, and 23 taken off their exponent.
+	const float LogScale = 8388608.0f;
+	const float SqrtHalf = 0.707106781186547524f;
+	// log(1 + m) = m - m^2 / 2 + m^3 * P(m) on [sqrt(1/2) - 1, sqrt(2) - 1] (Moshier, Cephes).
+	const float LogP[9] = { 7.0376836292e-2f, -1.1514610310e-1f, 1.1676998740e-1f, -1.2420140846e-1f, 1.4249322787e-1f,
+		-1.6668057665e-1f, 2.0000714765e-1f, -2.4999993993e-1f, 3.3333331174e-1f };
+
+	struct Log
+	{
+		static float Scalar(float x)
+		{
+			if (x != x)
+				return x;
+			if (x < 0)
+				return QuietNaN;
+			if (x == 0)
+				return -Infinity;
+			if (x == Infinity)
+				return Infinity;
+			bool tiny = x < FLT_MIN;
+			uint32_t bits = Float_ToBits(tiny ? x * LogScale : x);
+			// x = m * 2^e with 1/2 <= m < 1, then m doubled and e lowered by one if m is below sqrt(1/2).
+			float e = static_cast<float>(static_cast<int32_t>(bits >> 23) - 126);
+			e = e - (tiny ? 23.0f : 0.0f);
+			float m = Float_FromBits<float>((bits & 0x007FFFFFu) | 0x3F000000u);
+			bool low = m < SqrtHalf;
+			e = e - (low ? 1.0f : 0.0f);
+			m = (m + (low ? m : 0.0f)) - 1.0f;
+			float z = m * m;
+			float p = LogP[0];
+			for (int i = 1; i < 9; ++i)
+				p = p * m + LogP[i];
+			float y = (p * m) * z;
+			y = y + e * ExpLn2Low;
+			y = y - 0.5f * z;
+			return (m + y) + e * ExpLn2High;
+		}
+
+#if defined(NUMBERS_X86)
+		NUMBERS_TARGET("sse2")
+		static __m128 SSE2(__m128 x)
+		{
+			__m128 tiny = _mm_cmplt_ps(x, _mm_set1_ps(FLT_MIN));
+			__m128i bits = _mm_castps_si128(SelectSSE2(tiny, _mm_mul_ps(x, _mm_set1_ps(LogScale)), x));
+			__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+			e = _mm_sub_ps(e, _mm_and_ps(tiny, _mm_set1_ps(23.0f)));
+			__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F000000)));
+			__m128 low = _mm_cmplt_ps(m, _mm_set1_ps(SqrtHalf));
+			e = _mm_sub_ps(e, _mm_and_ps(low, _mm_set1_ps(1.0f)));
+			m = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(low, m)), _mm_set1_ps(1.0f));
+			__m128 z = _mm_mul_ps(m, m);
+			__m128 p = _mm_set1_ps(LogP[0]);
+			for (int i = 1; i < 9; ++i)
+				p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(LogP[i]));
+			__m128 y = _mm_mul_ps(_mm_mul_ps(p, m), z);
+			y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(ExpLn2Low)));
+			y = _mm_sub_ps(y, _mm_mul_ps(_mm_set1_ps(0.5f), z));
+			__m128 result = _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(e, _mm_set1_ps(ExpLn2High)));
+			result = SelectSSE2(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_set1_ps(QuietNaN), result);
+			result = SelectSSE2(_mm_cmpeq_ps(x, _mm_setzero_ps()), _mm_set1_ps(-Infinity), result);
+			result = SelectSSE2(_mm_cmpeq_ps(x, _mm_set1_ps(Infinity)), x, result);
+			return SelectSSE2(_mm_cmpunord_ps(x, x), x, result);
+		}
+
+		NUMBERS_TARGET("avx2")
+		static __m256 AVX2(__m256 x)
+		{
+			__m256 tiny = _mm256_cmp_ps(x, _mm256_set1_ps(FLT_MIN), _CMP_LT_OQ);
+			__m256i bits = _mm256_castps_si256(_mm256_blendv_ps(x, _mm256_mul_ps(x, _mm256_set1_ps(LogScale)), tiny));
+			__m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+			e = _mm256_sub_ps(e, _mm256_and_ps(tiny, _mm256_set1_ps(23.0f)));
+			__m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)),
+				_mm256_set1_epi32(0x3F000000)));
+			__m256 low = _mm256_cmp_ps(m, _mm256_set1_ps(SqrtHalf), _CMP_LT_OQ);
+			e = _mm256_sub_ps(e, _mm256_and_ps(low, _mm256_set1_ps(1.0f)));
+			m = _mm256_sub_ps(_mm256_add_ps(m, _mm256_and_ps(low, m)), _mm256_set1_ps(1.0f));
+			__m256 z = _mm256_mul_ps(m, m);
+			__m256 p = _mm256_set1_ps(LogP[0]);
+			for (int i = 1; i < 9; ++i)
+				p = _mm256_add_ps(_mm256_mul_ps(p, m), _mm256_set1_ps(LogP[i]));
+			__m256 y = _mm256_mul_ps(_mm256_mul_ps(p, m), z);
+			y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(ExpLn2Low)));
+			y = _mm256_sub_ps(y, _mm256_mul_ps(_mm256_set1_ps(0.5f), z));
+			__m256 result = _mm256_add_ps(_mm256_add_ps(m, y), _mm256_mul_ps(e, _mm256_set1_ps(ExpLn2High)));
+			result = _mm256_blendv_ps(result, _mm256_set1_ps(QuietNaN), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+			result = _mm256_blendv_ps(result, _mm256_set1_ps(-Infinity), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ));
+			result = _mm256_blendv_ps(result, x, _mm256_cmp_ps(x, _mm256_set1_ps(Infinity), _CMP_EQ_OQ));
+			return _mm256_blendv_ps(result, x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+		}
+
+		static int Exceptions(__m128) { return 0; }
+		NUMBERS_TARGET("avx2")
+		static int Exceptions(__m256) { return 0; }
+#endif
+	};
+
+	// ---------------------------------------------------------------- sin and cos
+
+	// The largest |x| reduced in double precision. j = round(x * 2/pi) is then below 2^20, and PiOver2High has 33
+	//  significant bits, so j * PiOver2High is exact and so is x minus it (fdlibm's split of pi/2).
+	const float SinCosLimit = 1048576.0f;
+	const double TwoOverPi = 0.636619772367581343076;
+	const double PiOver2High = 1.57079632673412561417e+00;
+	const double PiOver2Low = 6.07710050650619224932e-11;
+	// sin(r) = r + r^3 * S(r^2) and cos(r) = 1 - r^2 / 2 + r^4 * C(r^2) on [-pi/4, pi/4] (Moshier, Cephes).
+	const float SinP[3] = { -1.9515295891e-4f, 8.3321608736e-3f, -1.6666654611e-1f };
+	const float CosP[3] = { 2.443315711809948e-5f, -1.388731625493765e-3f, 4.166664568298827e-2f };
+
+	// Cos is Sin a quarter turn on: the quadrant j + 1.
+	template <int Quarter>
+	struct SinCos
+	{
+		static float Scalar(float x)
+		{
+			if (!(std::fabs(x) <= SinCosLimit))
+				return static_cast<float>(Quarter == 0 ? std::sin(static_cast<double>(x)) : std::cos(static_cast<double>(x)));
+			double j = (static_cast<double>(x) * TwoOverPi + RoundDouble) - RoundDouble;
+			float r = static_cast<float>((static_cast<double>(x) - j * PiOver2High) - j * PiOver2Low);
+			int32_t quadrant = static_cast<int32_t>(j) + Quarter;
+			float z = std::fabs(r) < Negligible ? 0.0f : r * r;
+			float s = ((((SinP[0] * z + SinP[1]) * z + SinP[2]) * z) * r) + r;
+			float c = (((CosP[0] * z + CosP[1]) * z + CosP[2]) * z) * z;
+			c = (c - 0.5f * z) + 1.0f;
+			// sin, cos, -sin, -cos in the four quadrants.
+			float y = (quadrant & 1) ? c : s;
+			return Float_FromBits<float>(Float_ToBits(y) ^ (static_cast<uint32_t>(quadrant & 2) << 30));
+		}
+
+#if defined(NUMBERS_X86)
+		NUMBERS_TARGET("sse2")
+		static __m128d ReduceSSE2(__m128d x, __m128i& quadrant)
+		{
+			__m128d round = _mm_set1_pd(RoundDouble);
+			__m128d j = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(TwoOverPi)), round), round);
+			quadrant = _mm_cvtpd_epi32(j);
+			return _mm_sub_pd(_mm_sub_pd(x, _mm_mul_pd(j, _mm_set1_pd(PiOver2High))), _mm_mul_pd(j, _mm_set1_pd(PiOver2Low)));
+		}
+
+		NUMBERS_TARGET("sse2")
+		static __m128 SSE2(__m128 x)
+		{
+			// Each half of x is reduced as two doubles.
+			__m128i q0, q1;
+			__m128d r0 = ReduceSSE2(_mm_cvtps_pd(x), q0);
+			__m128d r1 = ReduceSSE2(_mm_cvtps_pd(_mm_movehl_ps(x, x)), q1);
+			__m128 r = _mm_movelh_ps(_mm_cvtpd_ps(r0), _mm_cvtpd_ps(r1));
+			__m128i quadrant = _mm_add_epi32(_mm_unpacklo_epi64(q0, q1), _mm_set1_epi32(Quarter));
+			__m128 z = _mm_andnot_ps(_mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), r), _mm_set1_ps(Negligible)), _mm_mul_ps(r, r));
+			__m128 s = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(SinP[0])), _mm_set1_ps(SinP[1])), z), _mm_set1_ps(SinP[2]));
+			s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), r), r);
+			__m128 c = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(CosP[0])), _mm_set1_ps(CosP[1])), z), _mm_set1_ps(CosP[2]));
+			c = _mm_mul_ps(_mm_mul_ps(c, z), z);
+			c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_set1_ps(1.0f));
+			__m128 odd = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+			__m128 sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+			return _mm_xor_ps(SelectSSE2(odd, c, s), sign);
+		}
+
+		NUMBERS_TARGET("avx2")
+		static __m256d ReduceAVX2(__m256d x, __m128i& quadrant)
+		{
+			__m256d round = _mm256_set1_pd(RoundDouble);
+			__m256d j = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(TwoOverPi)), round), round);
+			quadrant = _mm256_cvtpd_epi32(j);
+			return _mm256_sub_pd(_mm256_sub_pd(x, _mm256_mul_pd(j, _mm256_set1_pd(PiOver2High))), _mm256_mul_pd(j, _mm256_set1_pd(PiOver2Low)));
+		}
+
+		NUMBERS_TARGET("avx2")
+		static __m256 AVX2(__m256 x)
+		{
+			__m128i q0, q1;
+			__m256d r0 = ReduceAVX2(_mm256_cvtps_pd(_mm256_castps256_ps128(x)), q0);
+			__m256d r1 = ReduceAVX2(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), q1);
+			__m256 r = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(r0)), _mm256_cvtpd_ps(r1), 1);
+			__m256i quadrant = _mm256_add_epi32(_mm256_inserti128_si256(_mm256_castsi128_si256(q0), q1, 1), _mm256_set1_epi32(Quarter));
+			__m256 z = _mm256_andnot_ps(_mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), r), _mm256_set1_ps(Negligible), _CMP_LT_OQ),
+				_mm256_mul_ps(r, r));
+			__m256 s = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(SinP[0])), _mm256_set1_ps(SinP[1])), z),
+				_mm256_set1_ps(SinP[2]));
+			s = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, z), r), r);
+			__m256 c = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(CosP[0])), _mm256_set1_ps(CosP[1])), z),
+				_mm256_set1_ps(CosP[2]));
+			c = _mm256_mul_ps(_mm256_mul_ps(c, z), z);
+			c = _mm256_add_ps(_mm256_sub_ps(c, _mm256_mul_ps(_mm256_set1_ps(0.5f), z)), _mm256_set1_ps(1.0f));
+			__m256i odd = _mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1));
+			__m256 sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+			return _mm256_xor_ps(_mm256_blendv_ps(s, c, _mm256_castsi256_ps(odd)), sign);
+		}
+
+		// The lanes past SinCosLimit, infinite or NaN.
+		NUMBERS_TARGET("sse2")
+		static int Exceptions(__m128 x)
+		{
+			__m128 magnitude = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+			return _mm_movemask_ps(_mm_cmpnle_ps(magnitude, _mm_set1_ps(SinCosLimit)));
+		}
+
+		NUMBERS_TARGET("avx2")
+		static int Exceptions(__m256 x)
+		{
+			__m256 magnitude = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+			return _mm256_movemask_ps(_mm256_cmp_ps(magnitude, _mm256_set1_ps(SinCosLimit), _CMP_NLE_UQ));
+		}
+#endif
+	};
+
+	// ---------------------------------------------------------------- the batch loops
+
+	template <typename Function>
+	void MapScalar(const float* values, size_t begin, size_t count, float* out)
+	{
+		for (size_t i = begin; i < count; ++i)
+			out[i] = Function::Scalar(values[i]);
+	}
+
+	// Lanes flagged by Exceptions are recomputed from the saved inputs, since out may be values.
+	template <typename Function>
+	void Recompute(const float* saved, int lanes, float* out)
+	{
+		for (int lane = 0; lanes != 0; ++lane, lanes >>= 1)
+			if (lanes & 1)
+				out[lane] = Function::Scalar(saved[lane]);
+	}
+
+#if defined(NUMBERS_X86)
+	template <typename Function>
+	NUMBERS_TARGET("sse2")
+	void MapSSE2(const float* values, size_t count, float* out)
+	{
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(values + i);
+			_mm_storeu_ps(out + i, Function::SSE2(x));
+			if (int lanes = Function::Exceptions(x))
+			{
+				alignas(16) float saved[4];
+				_mm_store_ps(saved, x);
+				Recompute<Function>(saved, lanes, out + i);
+			}
+		}
+		MapScalar<Function>(values, i, count, out);
+	}
+
+	template <typename Function>
+	NUMBERS_TARGET("avx2")
+	void MapAVX2(const float* values, size_t count, float* out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(values + i);
+			_mm256_storeu_ps(out + i, Function::AVX2(x));
+			if (int lanes = Function::Exceptions(x))
+			{
+				alignas(32) float saved[8];
+				_mm256_store_ps(saved, x);
+				Recompute<Function>(saved, lanes, out + i);
+			}
+		}
+		// The compiler leaves out VZEROUPPER before a tail call, and without it every SSE instruction that follows,
+		//  here and in the caller, waits on the upper halves of the YMM registers.
+		_mm256_zeroupper();
+		MapScalar<Function>(values, i, count, out);
+	}
+#endif
+
+	template <typename Function>
+	void Map(const float* values, size_t count, float* out, FloatMathKernel kernel)
+	{
+		switch (FloatMath_ResolveKernel(kernel))
+		{
+#if defined(NUMBERS_X86)
+		case FloatMathKernel::AVX2:
+			MapAVX2<Function>(values, count, out);
+			return;
+		case FloatMathKernel::SSE2:
+			MapSSE2<Function>(values, count, out);
+			return;
+#endif
+		default:
+			MapScalar<Function>(values, 0, count, out);
+			return;
+		}
+	}
+
+	// ---------------------------------------------------------------- normalization
+
+	void NormalizeScalar(float* xs, float* ys, float* zs, size_t begin, size_t count)
+	{
+		for (size_t i = begin; i < count; ++i)
+		{
+			float squared = (xs[i] * xs[i] + ys[i] * ys[i]) + zs[i] * zs[i];
+			float scale = squared == 0.0f ? 0.0f : Rsqrt::Scalar(squared);
+			xs[i] *= scale;
+			ys[i] *= scale;
+			zs[i] *= scale;
+		}
+	}
+
+#if defined(NUMBERS_X86)
+	NUMBERS_TARGET("sse2")
+	void NormalizeSSE2(float* xs, float* ys, float* zs, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(xs + i), y = _mm_loadu_ps(ys + i), z = _mm_loadu_ps(zs + i);
+			__m128 squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+			__m128 scale = _mm_andnot_ps(_mm_cmpeq_ps(squared, _mm_setzero_ps()), Rsqrt::SSE2(squared));
+			_mm_storeu_ps(xs + i, _mm_mul_ps(x, scale));
+			_mm_storeu_ps(ys + i, _mm_mul_ps(y, scale));
+			_mm_storeu_ps(zs + i, _mm_mul_ps(z, scale));
+		}
+		NormalizeScalar(xs, ys, zs, i, count);
+	}
+
+	NUMBERS_TARGET("avx2")
+	void NormalizeAVX2(float* xs, float* ys, float* zs, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(xs + i), y = _mm256_loadu_ps(ys + i), z = _mm256_loadu_ps(zs + i);
+			__m256 squared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+			__m256 scale = _mm256_andnot_ps(_mm256_cmp_ps(squared, _mm256_setzero_ps(), _CMP_EQ_OQ), Rsqrt::AVX2(squared));
+			_mm256_storeu_ps(xs + i, _mm256_mul_ps(x, scale));
+			_mm256_storeu_ps(ys + i, _mm256_mul_ps(y, scale));
+			_mm256_storeu_ps(zs + i, _mm256_mul_ps(z, scale));
+		}
+		_mm256_zeroupper();
+		NormalizeScalar(xs, ys, zs, i, count);
+	}
+#endif
+}
+
+bool FloatMath_KernelSupported(FloatMathKernel kernel)
+{
+	switch (kernel)
+	{
+	case FloatMathKernel::Auto:
+	case FloatMathKernel::Scalar:
+		return true;
+#if defined(NUMBERS_X86)
+	case FloatMathKernel::SSE2:
+		return CpuFeatures::HasSSE2();
+	case FloatMathKernel::AVX2:
+		return CpuFeatures::HasAVX2();
+#endif
+	default:
+		return false;
+	}
+}
+
+FloatMathKernel FloatMath_ResolveKernel(FloatMathKernel kernel)
+{
+	if (kernel == FloatMathKernel::Auto)
+	{
+		if (FloatMath_KernelSupported(FloatMathKernel::AVX2))
+			return FloatMathKernel::AVX2;
+		if (FloatMath_KernelSupported(FloatMathKernel::SSE2))
+			return FloatMathKernel::SSE2;
+		return FloatMathKernel::Scalar;
+	}
+	return FloatMath_KernelSupported(kernel) ? kernel : FloatMathKernel::Scalar;
+}
+
+void FloatMath_Rsqrt(const float* values, size_t count, float* out, FloatMathKernel kernel)
+{
+	Map<Rsqrt>(values, count, out, kernel);
+}
+
+void FloatMath_Sqrt(const float* values, size_t count, float* out, FloatMathKernel kernel)
+{
+	Map<Sqrt>(values, count, out, kernel);
+}
+
+void FloatMath_Exp(const float* values, size_t count, float* out, FloatMathKernel kernel)
+{
+	Map<Exp>(values, count, out, kernel);
+}
+
+void FloatMath_Log(const float* values, size_t count, float* out, FloatMathKernel kernel)
+{
+	Map<Log>(values, count, out, kernel);
+}
+
+void FloatMath_Sin(const float* values, size_t count, float* out, FloatMathKernel kernel)
+{
+	Map<SinCos<0>>(values, count, out, kernel);
+}
+
+void FloatMath_Cos(const float* values, size_t count, float* out, FloatMathKernel kernel)
+{
+	Map<SinCos<1>>(values, count, out, kernel);
+}
+
+void Vec3_NormalizeBatch(float* xs, float* ys, float* zs, size_t count, FloatMathKernel kernel)
+{
+	switch (FloatMath_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case FloatMathKernel::AVX2:
+		NormalizeAVX2(xs, ys, zs, count);
+		return;
+	case FloatMathKernel::SSE2:
+		NormalizeSSE2(xs, ys, zs, count);
+		return;
+#endif
+	default:
+		NormalizeScalar(xs, ys, zs, 0, count);
+		return;
+	}
+}
+
+void Vec3_NormalizeBatch(vec3SoA& points, FloatMathKernel kernel)
+{
+	Vec3_NormalizeBatch(points.x.data(), points.y.data(), points.z.data(), points.size(), kernel);
+}
@@ -20,33 +20,32 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "../header/ClassDeclarations.h"
-
-// Create a union of a floating point number and an integer.
-// In this way we can set the bits of a floating point number manually.
-//  (Floating point numbers do not allow bitwise operations.)
-// If you don't know what the union keyword does, see [core-keywords].
-union FloatOrUInt32
-{
-	uint32_t i;
-	float f;
-};
-
-// The following structure and function will be useful in the last part of the example, but must be defined here.
-// A 3D vector
-struct vec3 {
-	float x, y, z;
-};
-
-// Compute the dot product of two vec3s
-float Vec3_DotProduct(vec3 lhs, vec3 rhs)
-{
-	return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
-}
+#include "../header/Decimal.h"
+#include "../header/FloatBits.h"
+#include "../header/FloatCompare.h"
+#include "../header/FloatFormat.h"
+#include "../header/MiniFloat.h"
+#include "../header/Vec3Batch.h"
+
+#include <cfloat>
+#include <cmath>
+
+// To set the bits of a floating point number manually (floating point numbers do not allow bitwise operations),
+//  the examples below use Float_FromBits and Float_FromFields from FloatBits.h.
+// The classic trick is a union of a float and an integer: write the integer, read the float. C++ only allows reading
+//  the union member that was last written, though, so that is undefined behaviour, and it is not allowed in a
+//  constant expression. Float_FromBits is a bit cast instead, so it is well defined, and with a recent compiler it is
+//  constexpr: the values below are computed while compiling.
+
+// The vec3 structure and the Vec3_DotProduct function used in the last part of the example are declared in Vec3Batch.h,
+//  next to batch versions of the dot product that process many points at once.
 
 void FloatingPoint::FloatingPointExample()
 {
 	std::cout << "\nFloating Point\n--------------\n";
-	std::cout << std::setprecision(10);
+	// Values are printed with FloatFormat_Text (FloatFormat.h): the shortest text that reads back as exactly the same
+	//  float or double. A fixed std::setprecision shows either too few digits to tell neighbouring values apart
+	//  or noise digits that were never part of the value.
 	// The following exposition follows that of Bishop and Verth in "Essential Mathematics for Games."
 
 	////////////////////////////////
@@ -109,6 +108,7 @@ void FloatingPoint::FloatingPointExample()
 	// |0x01..0xFE|         normalized value             |
 	// |   0xFF   |  inf or -inf  |          NaN         |
 	// +-------------------------------------------------+
+	// Float_Classify and FloatDecode_Split in FloatDecode.h apply this table to single values and to whole arrays.
 
 	////////////////////////////////////////////////////////
 	// Example: manually creating a floating point number //
@@ -124,8 +124,11 @@ void FloatingPoint::FloatingPointExample()
 	//  -Remember that IEEE754 subtracts 127 from the given exponent to get the actual exponent
 	//  -Leading 1 is implicit
 
-	FloatOrUInt32 fortytwo = { 0x42280000 }; // This is the hexadecimal form of the bitfield above.
-	std::cout << "Forty two as a float is " << fortytwo.f << '\n';
+	const float fortytwo = Float_FromBits<float>(0x42280000); // This is the hexadecimal form of the bitfield above.
+	std::cout << "Forty two as a float is " << FloatFormat_Text(fortytwo) << '\n';
+	// The same value from its three fields: positive, exponent 127 + 5, and the significand bits after the implicit 1.
+	if (Float_FromFields<float>(false, 127 + 5, 0x280000) == fortytwo)
+		std::cout << "Built from its fields, it is the same number.\n";
 
 	// Example 2
 	// A slightly more difficult example: -34.75
@@ -135,8 +138,8 @@ void FloatingPoint::FloatingPointExample()
 	// 1|100_0010_0|000_1011_0000_0000_0000_0000
 	//  -Only major difference from the last one is the sign is negative
 
-	FloatOrUInt32 negativethirtyfourpointsevenfive = { 0xC20B0000 };
-	std::cout << "Negative thirty four point seven five as a float is " << negativethirtyfourpointsevenfive.f << '\n';
+	const float negativethirtyfourpointsevenfive = Float_FromBits<float>(0xC20B0000);
+	std::cout << "Negative thirty four point seven five as a float is " << FloatFormat_Text(negativethirtyfourpointsevenfive) << '\n';
 
 	// Example 3
 	// The previous two examples were "easy" in that the numbers could be exactly represented.
@@ -150,13 +153,17 @@ void FloatingPoint::FloatingPointExample()
 	// So what we have so far is
 	// 0|011_1101_1|100_1100_1100_1100_1100_1100|_1100...
 	// At this point there are two options: the computer can either truncate all the rest, at which point the result is
-	FloatOrUInt32 slightlylessthanzeropointone = { 0x3DCCCCCC };
-	std::cout << "Truncating rounding gives 0.1f = " << slightlylessthanzeropointone.f << '\n';
+	const float slightlylessthanzeropointone = Float_FromBits<float>(0x3DCCCCCC);
+	std::cout << "Truncating rounding gives 0.1f = " << FloatFormat_Text(slightlylessthanzeropointone) << '\n';
 
 	// Alternatively the computer can look at the next four actual digits (1100) and round up the last digit to be
-	FloatOrUInt32 slightlygreaterthanzeropointone = { 0x3DCCCCCD };
-	if (0.1f == slightlygreaterthanzeropointone.f)
-		std::cout << "Rounding up gives 0.1f = " << slightlygreaterthanzeropointone.f << '\n';
+	const float slightlygreaterthanzeropointone = Float_FromBits<float>(0x3DCCCCCD);
+	if (0.1f == slightlygreaterthanzeropointone)
+		std::cout << "Rounding up gives 0.1f = " << FloatFormat_Text(slightlygreaterthanzeropointone) << '\n';
+	// The two candidates are neighbours: no float lies between them. Float_NextUp and Float_NextDown step from a float
+	//  to its neighbours by adding or subtracting one from the bit pattern.
+	if (Float_NextUp(slightlylessthanzeropointone) == slightlygreaterthanzeropointone)
+		std::cout << "The next float up from the truncated value is the rounded one.\n";
 
 	// Rounding up has a lower relative error, so the computer chooses that route.
 	// (By relative error, I mean if the actual number is A, RelErr_A = abs((Repr(A)-A)/A).)
@@ -164,6 +171,27 @@ void FloatingPoint::FloatingPointExample()
 	// This is why 0.1 + 0.2 is not exactly 0.3.  This is a big problem for things like financial transations,
 	//  and is the motivation behind the Decimal type.  For most purposes however, floating point is accurate enough.
 	// You can find more information on the decimal type at <https://en.wikipedia.org/wiki/Decimal_data_type>.
+	// Decimal.h has a fixed-point version: Decimal64<2> stores 0.10 as the integer 10, so the sum below is exact.
+	Decimal64<2> dime, twentyCents;
+	Decimal64<2>::Parse("0.1", 3, dime);
+	Decimal64<2>::Parse("0.2", 3, twentyCents);
+	char decimalText[32];
+	size_t decimalLength = (dime + twentyCents).Format(decimalText, sizeof(decimalText));
+	std::cout << "With Decimal64<2>, 0.1 + 0.2 = ";
+	std::cout.write(decimalText, decimalLength) << '\n';
+
+	// Example 4
+	// Nothing above depends on there being exactly 8 exponent and 23 significand bits. Smaller formats store big arrays
+	//  (machine learning weights, sensor logs, textures) in half or a quarter of the memory, at the cost of precision:
+	//  - half (IEEE754 binary16): 1 sign, 5 exponent (bias 15) and 10 significand bits
+	//  - bfloat16: 1 sign, 8 exponent (bias 127) and 7 significand bits, which is just the top half of a float
+	//  - FP8 E4M3 and E5M2: 8 bits in all, with 4 or 5 exponent bits and 3 or 2 significand bits
+	// Rounding 0.1f to bfloat16 by hand: the top 16 bits of 0x3DCCCCCD are 0x3DCC, and the 16 bits dropped (0xCCCD) are more
+	//  than half of the last bit kept, so it rounds up to 0x3DCD. MiniFloat.h does this for whole arrays and all four formats.
+	std::cout << "0.1f rounded to bfloat16 is " << FloatFormat_Text(BFloat16_ToFloat(BFloat16_FromFloat(0.1f)))
+		<< ", to half " << FloatFormat_Text(Half_ToFloat(Half_FromFloat(0.1f)))
+		<< ", to FP8 E4M3 " << FloatFormat_Text(FP8E4M3_ToFloat(FP8E4M3_FromFloat(0.1f)))
+		<< " and to FP8 E5M2 " << FloatFormat_Text(FP8E5M2_ToFloat(FP8E5M2_FromFloat(0.1f))) << '\n';
 
 	//////////////////////////////
 	// Limitations in precision //
@@ -186,18 +214,25 @@ void FloatingPoint::FloatingPointExample()
 	// Much as with integers, since floating point numbers have a fixed length, they can only represent a finite set of values.
 	// The standard doesn't refers to the least representable value (at least in C++11) as lowest.
 	// Minimum is instead reserved for the minimum normalized positive value of the type.
-	std::cout << "Single-precision float - Lowest: " << -FLT_MAX << " Maximum: " 
-		<< FLT_MAX << " Smallest non-zero: " << FLT_MIN << '\n';
-	std::cout << "Double-precision float - Lowest: " << -DBL_MAX << " Maximum: " 
-		<< DBL_MAX << " Smallest non-zero: " << DBL_MIN << '\n';
+	std::cout << "Single-precision float - Lowest: " << FloatFormat_Text(-FLT_MAX) << " Maximum: " 
+		<< FloatFormat_Text(FLT_MAX) << " Smallest non-zero: " << FloatFormat_Text(FLT_MIN) << '\n';
+	std::cout << "Double-precision float - Lowest: " << FloatFormat_Text(-DBL_MAX) << " Maximum: " 
+		<< FloatFormat_Text(DBL_MAX) << " Smallest non-zero: " << FloatFormat_Text(DBL_MIN) << '\n';
+	// FloatFormat only handles float and double; max_digits10 is the precision that round-trips a long double.
+	std::streamsize precision = std::cout.precision(std::numeric_limits<long double>::max_digits10);
 	std::cout << "Extended-precision float - Lowest: " << -LDBL_MAX << " Maximum: " 
 		<< LDBL_MAX << " Smallest non-zero: " << LDBL_MIN << '\n';
+	std::cout.precision(precision);
 
 	// As mentioned above briefly, IEEE754 supports "denormal" numbers. These extend the range, but at a loss of precision.
 	// The minimum positive denormal numbers are
-	std::cout << "Single-precision float - Smallest denormal: " << FLT_TRUE_MIN << '\n';
-	std::cout << "Double-precision float - Smallest denormal: " << DBL_TRUE_MIN << '\n';
+	std::cout << "Single-precision float - Smallest denormal: " << FloatFormat_Text(FLT_TRUE_MIN) << '\n';
+	std::cout << "Double-precision float - Smallest denormal: " << FloatFormat_Text(DBL_TRUE_MIN) << '\n';
+	precision = std::cout.precision(std::numeric_limits<long double>::max_digits10);
 	std::cout << "Extended-precision float - Smallest denormal: " << LDBL_TRUE_MIN << '\n';
+	std::cout.precision(precision);
+	// On many processors arithmetic that reads or produces a denormal is much slower than usual.
+	//  Denormals.h shows how to measure that and how to switch denormals off (flush them to zero) where speed matters more.
 
 	///////////////////////////////////////////
 	// Application: Epsilon and dot products //
@@ -212,6 +247,8 @@ void FloatingPoint::FloatingPointExample()
 	// Say we have a plane defined by the normal
 	vec3 normal = { 1.0f / sqrtf(3.0f), 1.0f / sqrtf(3.0f), 1.0f / sqrtf(3.0f) };
 	// that intersects the origin.
+	// Dividing by a square root is fine for one vector. To normalize thousands, Vec3_NormalizeBatch in FloatMath.h
+	//  multiplies each one by the processor's estimate of 1/sqrt instead, refined to within a few ulps of the exact result.
 	// We want to check if the position
 	vec3 position = { 0.78063f, 0.984654f, -1.765284f };
 	// is on the plane.
@@ -224,10 +261,23 @@ void FloatingPoint::FloatingPointExample()
 	// Instead we need
 	if (Vec3_DotProduct(position, normal) <= FLT_EPSILON)
 		std::cout << "This will get printed, because Vec3_DotProduct(position, normal) actually returns "
-			<< Vec3_DotProduct(position, normal) << '\n';
+			<< FloatFormat_Text(Vec3_DotProduct(position, normal)) << '\n';
+	// FLT_EPSILON is the gap between 1.0f and the next float up, so it only suits values near 1.
+	// It works here because the answer should be zero, which is what an absolute tolerance is for.
+	// To compare two results that should be equal, measure how far apart they are in ulps (how many floats or doubles
+	//  lie between them) or relative to their size instead; FloatCompare.h has both, and Float_NearlyEqual combines
+	//  an absolute tolerance for values near zero with a relative one for the rest.
+	double sum = 0.1 + 0.2;
+	std::cout << "0.1 + 0.2 == 0.3 is " << (sum == 0.3 ? "true" : "false") << ", but they are only "
+		<< Float_UlpDistance(sum, 0.3) << " ulp apart, so Float_NearlyEqual(0.1 + 0.2, 0.3, 0.0, 4 * DBL_EPSILON) is "
+		<< (Float_NearlyEqual(sum, 0.3, 0.0, 4 * DBL_EPSILON) ? "true" : "false") << '\n';
 
 	// Don't worry if you don't know how this code relates to the geometric interpretation of a plane.
 	// What you need to know now is how the dot product is calculated:
 	//  as the multiplication and addition of floating point numbers.
 	// This example shows how floating point representations of most real numbers is not exact.
+	// (When the same test has to be run against many points, Vec3_DotProductBatch in Vec3Batch.h computes
+	//  the dot products for a whole array of points at once using SIMD instructions,
+	//  and Plane_ClassifyPoints in PlaneClassify.h sorts whole point clouds into front/back/on-plane
+	//  using a tolerance that grows with the size of the numbers involved instead of a fixed FLT_EPSILON.)
 }
@@ -20,6 +20,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "../header/ClassDeclarations.h"
+#include "../header/Bits.h"
+#include "../header/CheckedInt.h"
+#include "../header/Radix.h"
+#include "../header/VarInt.h"
+#include "../header/WideInt.h"
+
+#include <climits>
 
 void Integers::IntegersExample()
 {
@@ -60,6 +67,14 @@ void Integers::IntegersExample()
 	// As you can see, as the radix (base number) increases, the amount of information encoded in one digit increases,
 	//  so the total length of the string representing the value decreases.
 	// Conversely, as the radix decreases, so does the amount of information encoded in one digit, so the length increases.
+	// Radix_Format and Radix_Parse in Radix.h convert between integers and text in any base from 2 to 36:
+	char text[Radix_MaxChars];
+	std::cout << "4095 is ";
+	std::cout.write(text, Radix_Format(myNum1, 16, text, sizeof(text))) << " in hexadecimal, ";
+	std::cout.write(text, Radix_Format(myNum2, 8, text, sizeof(text))) << " in octal and ";
+	std::cout.write(text, Radix_Format(myNum3, 2, text, sizeof(text))) << " in binary.\n";
+	if (Radix_ParseLiteral("0xFFF", 5, myNum0) == RadixStatus::Ok && myNum0 == myNum1)
+		std::cout << "Radix_ParseLiteral reads \"0xFFF\" the same way the compiler reads 0xFFF.\n";
 
 	// So that's how computers represent integers! As a series of 0s and 1s in base 2.
 
@@ -116,6 +131,21 @@ void Integers::IntegersExample()
 		std::cout << "This is how two's complement avoids two representations of zero.\n";
 	// N.B. In the last line, the ^ is the XOR operator. By XORing with a mask of all 1s, we invert every bit.
 
+	// Since an integer is just a row of bits, a few questions about that row come up again and again:
+	//  how many bits are set, where the highest and lowest set bits are, or the bits and bytes in reverse order.
+	// Processors answer each of these in one instruction, and Bits.h provides them for any unsigned type.
+	// 231 is 11100111 in binary: six bits are set, and as a 32-bit integer it has 24 zero bits above the highest one.
+	std::cout << "231 has " << Bits_PopCount(231u) << " set bits and " << Bits_CountLeadingZeros(231u) << " leading zeros\n";
+	// Reversed, 11100111 reads the same, but 00000110 (6) becomes 01100000 (96).
+	std::cout << "6 reversed as 8 bits: " << int(Bits_Reverse(uint8_t(6))) << '\n';
+	// Swapping the bytes converts between little-endian (lowest byte first in memory, as on x86) and big-endian.
+	std::cout << "0x12345678 with its bytes swapped: 0x" << std::hex << Bits_ByteSwap(0x12345678u) << std::dec << '\n';
+	// Most integers a program stores are small, yet a fixed-width type spends the same bytes on 3 as on 3 billion.
+	//  Variable-length encodings (VarInt.h) spend fewer bytes on smaller values: LEB128 keeps 7 bits per byte, so 300
+	//  takes 2 bytes instead of 4. A small negative number is all ones at the top in two's complement, so signed values
+	//  are first zigzag encoded, which maps -1 to 1, 1 to 2, -2 to 3 and so on.
+	std::cout << "-3 zigzag encoded: " << VarInt_ZigZagEncode(-3) << ", and 300 as LEB128 takes " << VarInt_LEB128Size(300) << " bytes\n";
+
 	////////////////////////////////
 	// Maximum and minimum values //
 	////////////////////////////////
@@ -130,4 +160,27 @@ void Integers::IntegersExample()
 	std::cout << "Signed Int - Minimum: " << INT_MIN << " Maximum: " << INT_MAX << '\n';
 	std::cout << "Signed Long - Minimum: " << LONG_MIN << " Maximum: " << LONG_MAX << '\n';
 	std::cout << "Signed Long Long - Minimum: " << LLONG_MIN << " Maximum: " << LLONG_MAX << '\n';
+
+	//////////////
+	// Overflow //
+	//////////////
+
+	// Going past these limits wraps around: UINT_MAX + 1 is 0, just like the two's complement of zero above.
+	// For signed types it is worse: the C++ standard leaves signed overflow undefined, so the compiler may assume it never happens.
+	// CheckedInt.h makes the choice explicit. Wrapping<T> wraps on purpose, Saturating<T> sticks at the limit,
+	//  and Checked<T> wraps but remembers that it did, so a whole computation can be checked once at the end.
+	Wrapping<int> wrapped = INT_MAX;
+	wrapped += 1;
+	Saturating<int> saturated = INT_MAX;
+	saturated += 1;
+	Checked<int> checked = INT_MAX;
+	checked += 1;
+	std::cout << "INT_MAX + 1: wrapping gives " << wrapped.Value() << ", saturating gives " << saturated.Value()
+		<< ", checked reports " << (checked.Overflowed() ? "an overflow" : "no overflow") << '\n';
+
+	// When 64 bits are not enough, WideInt.h has 128- and 256-bit integers built from 64-bit words.
+	UInt128 square = UInt128(ULLONG_MAX) * UInt128(ULLONG_MAX);
+	char wideText[WideInt_MaxChars<128>::value];
+	std::cout << "ULLONG_MAX * ULLONG_MAX = ";
+	std::cout.write(wideText, WideInt_Format(square, 10, wideText, sizeof(wideText))) << '\n';
 }
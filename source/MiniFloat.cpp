@@ -0,0 +1,725 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: MiniFloat.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/MiniFloat.h"
+#include "../header/CpuFeatures.h"
+#include "../header/FloatBits.h"
+
+#if defined(NUMBERS_X86)
+// GCC 12 warns about the deliberately undefined registers inside its own AVX-512 intrinsics (GCC bug 105593).
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+namespace
+{
+	// The shape of a small format: E exponent bits and M significand bits, with or without infinities.
+	template <int ExponentBits, int SignificandBits, bool Infinities>
+	struct Layout
+	{
+		static constexpr int E = ExponentBits;
+		static constexpr int M = SignificandBits;
+		static constexpr bool HasInfinity = Infinities;
+		static constexpr int Bias = (1 << (E - 1)) - 1;
+		static constexpr uint32_t InfinityBits = ((1u << E) - 1) << M;
+		// E4M3 keeps the all-ones exponent for finite values; only the all-ones pattern is NaN.
+		static constexpr uint32_t MaxFinite = Infinities ? InfinityBits - 1 : (1u << (E + M)) - 2;
+		static constexpr uint32_t NaNBits = Infinities ? InfinityBits | (1u << (M - 1)) : (1u << (E + M)) - 1;
+		static constexpr uint32_t OverflowBits = Infinities ? InfinityBits : NaNBits;
+	};
+
+	typedef Layout<5, 10, true> HalfLayout;
+	typedef Layout<8, 7, true> BFloat16Layout;
+	typedef Layout<4, 3, false> E4M3Layout;
+	typedef Layout<5, 2, true> E5M2Layout;
+
+	// ---------------------------------------------------------------- float to small format
+
+	// Narrowing is driven by the float's biased exponent. Every float with exponent e becomes
+	//  base[e] + (significand with its implicit bit, shifted right by shift[e] and rounded to nearest even).
+	// In the normal range of the small format the shift drops the extra significand bits and base re-biases the exponent
+	//  (one less than the target exponent, because the implicit bit lands on the exponent's lowest bit). Below it the
+	//  shift grows by one per binade, which produces the subnormals, and a carry out of the significand rounds up into
+	//  the next binade exactly as it should. Anything that lands above MaxFinite has overflowed.
+	struct NarrowTable
+	{
+		uint16_t base[256];
+		uint8_t shift[256];
+	};
+
+	template <typename L>
+	constexpr NarrowTable MakeNarrowTable()
+	{
+		NarrowTable table = {};
+		for (int exponent = 0; exponent < 256; ++exponent)
+		{
+			// Float subnormals have the scale of the smallest normal floats, without the implicit bit.
+			int e = exponent > 0 ? exponent : 1;
+			if (e - 127 >= 1 - L::Bias)
+			{
+				// The cap keeps huge exponents in a uint16_t; they overflow either way.
+				int base = (e - 128 + L::Bias) << L::M;
+				table.base[exponent] = static_cast<uint16_t>(base < (1 << (L::E + L::M)) ? base : 1 << (L::E + L::M));
+				table.shift[exponent] = static_cast<uint8_t>(23 - L::M);
+			}
+			else
+			{
+				// A shift of 25 leaves nothing of a 24-bit significand, not even a rounding carry: zero.
+				int shift = 151 - L::Bias - L::M - e;
+				table.shift[exponent] = static_cast<uint8_t>(shift < 25 ? shift : 25);
+			}
+		}
+		return table;
+	}
+
+	constexpr NarrowTable HalfNarrow = MakeNarrowTable<HalfLayout>();
+	constexpr NarrowTable BFloat16Narrow = MakeNarrowTable<BFloat16Layout>();
+	constexpr NarrowTable E4M3Narrow = MakeNarrowTable<E4M3Layout>();
+	constexpr NarrowTable E5M2Narrow = MakeNarrowTable<E5M2Layout>();
+
+	template <typename L>
+	uint32_t Narrow(uint32_t bits, const NarrowTable& table, FP8Overflow overflow)
+	{
+		uint32_t sign = (bits >> 31) << (L::E + L::M);
+		uint32_t exponent = (bits >> 23) & 0xFF;
+		uint32_t significand = bits & 0x7FFFFF;
+		if (exponent == 0xFF && significand != 0)
+			return sign | L::NaNBits | (L::HasInfinity ? significand >> (23 - L::M) : 0);
+
+		uint32_t m = significand | (exponent != 0 ? 0x800000u : 0u);
+		uint32_t shift = table.shift[exponent];
+		uint32_t rounded = (m + (1u << (shift - 1)) - 1 + ((m >> shift) & 1)) >> shift;
+		uint32_t result = table.base[exponent] + rounded;
+		// Infinities take this path too: their exponent is past every format's range.
+		if (result > L::MaxFinite)
+			result = overflow == FP8Overflow::Saturate ? L::MaxFinite : L::OverflowBits;
+		return sign | result;
+	}
+
+	// ---------------------------------------------------------------- small format to float
+
+	// Half to float uses the three tables of J. van der Zijp, "Fast Half Float Conversions" (2008):
+	//  bits = mantissa[offset[h >> 10] + (h & 0x3FF)] + exponent[h >> 10].
+	// The mantissa table holds normalized subnormals (offset 0), normals (offset 1024) and, added here,
+	//  infinity and quiet NaNs (offset 2048), so that NaNs come back quiet like they do from F16C.
+	struct HalfWidenTables
+	{
+		uint32_t mantissa[3072];
+		uint32_t exponent[64];
+		uint16_t offset[64];
+	};
+
+	constexpr HalfWidenTables MakeHalfWidenTables()
+	{
+		HalfWidenTables tables = {};
+		for (uint32_t i = 1; i < 1024; ++i)
+		{
+			// i * 2^-24, normalized.
+			uint32_t m = i;
+			int32_t e = -14;
+			while ((m & 0x400) == 0)
+			{
+				m <<= 1;
+				--e;
+			}
+			tables.mantissa[i] = (static_cast<uint32_t>(e + 127) << 23) | ((m & 0x3FF) << 13);
+		}
+		for (uint32_t i = 0; i < 1024; ++i)
+		{
+			tables.mantissa[1024 + i] = 0x38000000 + (i << 13);
+			tables.mantissa[2048 + i] = (0x38000000 + (i << 13)) | (i != 0 ? 0x400000u : 0u);
+		}
+		for (uint32_t i = 0; i < 32; ++i)
+		{
+			tables.exponent[i] = i == 31 ? 0x47800000u : i << 23;
+			tables.exponent[32 + i] = 0x80000000u | tables.exponent[i];
+			tables.offset[i] = tables.offset[32 + i] = static_cast<uint16_t>(i == 0 ? 0 : i == 31 ? 2048 : 1024);
+		}
+		return tables;
+	}
+
+	constexpr HalfWidenTables HalfWiden = MakeHalfWidenTables();
+
+	// The 8-bit formats have few enough values to list every one.
+	struct FP8WidenTable
+	{
+		uint32_t bits[256];
+	};
+
+	template <typename L>
+	constexpr FP8WidenTable MakeFP8WidenTable()
+	{
+		FP8WidenTable table = {};
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			uint32_t sign = (i >> 7) << 31;
+			uint32_t exponent = (i >> L::M) & ((1u << L::E) - 1);
+			uint32_t m = i & ((1u << L::M) - 1);
+			uint32_t bits = 0;
+			if ((i & 0x7F) == L::NaNBits || (L::HasInfinity && exponent == (1u << L::E) - 1 && m != 0))
+				bits = 0x7FC00000 | (L::HasInfinity ? m << (23 - L::M) : 0);
+			else if (L::HasInfinity && exponent == (1u << L::E) - 1)
+				bits = 0x7F800000;
+			else if (exponent != 0)
+				bits = ((exponent - L::Bias + 127) << 23) | (m << (23 - L::M));
+			else if (m != 0)
+			{
+				// m * 2^(1 - Bias - M), normalized.
+				int32_t e = 1 - L::Bias;
+				while ((m & (1u << L::M)) == 0)
+				{
+					m <<= 1;
+					--e;
+				}
+				bits = (static_cast<uint32_t>(e + 127) << 23) | ((m & ((1u << L::M) - 1)) << (23 - L::M));
+			}
+			table.bits[i] = sign | bits;
+		}
+		return table;
+	}
+
+	constexpr FP8WidenTable E4M3Widen = MakeFP8WidenTable<E4M3Layout>();
+	constexpr FP8WidenTable E5M2Widen = MakeFP8WidenTable<E5M2Layout>();
+
+	uint32_t HalfToBits(uint32_t h)
+	{
+		return HalfWiden.mantissa[HalfWiden.offset[h >> 10] + (h & 0x3FF)] + HalfWiden.exponent[h >> 10];
+	}
+
+	// ---------------------------------------------------------------- scalar kernels
+	// They also finish the tails of the SIMD kernels, starting at begin.
+
+	void HalfFromFloatsScalar(const float* values, size_t begin, size_t count, uint16_t* out)
+	{
+		for (size_t i = begin; i < count; ++i)
+			out[i] = static_cast<uint16_t>(Narrow<HalfLayout>(Float_ToBits(values[i]), HalfNarrow, FP8Overflow::NonFinite));
+	}
+
+	void HalfToFloatsScalar(const uint16_t* values, size_t begin, size_t count, float* out)
+	{
+		for (size_t i = begin; i < count; ++i)
+			out[i] = Float_FromBits<float>(HalfToBits(values[i]));
+	}
+
+	void BFloat16FromFloatsScalar(const float* values, size_t begin, size_t count, uint16_t* out)
+	{
+		for (size_t i = begin; i < count; ++i)
+			out[i] = static_cast<uint16_t>(Narrow<BFloat16Layout>(Float_ToBits(values[i]), BFloat16Narrow, FP8Overflow::NonFinite));
+	}
+
+	void BFloat16ToFloatsScalar(const uint16_t* values, size_t begin, size_t count, float* out)
+	{
+		for (size_t i = begin; i < count; ++i)
+			out[i] = Float_FromBits<float>(static_cast<uint32_t>(values[i]) << 16);
+	}
+
+	template <typename L>
+	void FP8FromFloatsScalar(const float* values, size_t begin, size_t count, uint8_t* out, const NarrowTable& table,
+		FP8Overflow overflow)
+	{
+		for (size_t i = begin; i < count; ++i)
+			out[i] = static_cast<uint8_t>(Narrow<L>(Float_ToBits(values[i]), table, overflow));
+	}
+
+	void FP8ToFloatsScalar(const uint8_t* values, size_t begin, size_t count, float* out, const FP8WidenTable& table)
+	{
+		for (size_t i = begin; i < count; ++i)
+			out[i] = Float_FromBits<float>(table.bits[values[i]]);
+	}
+
+#if defined(NUMBERS_X86)
+	// ---------------------------------------------------------------- AVX2 kernels
+
+	// F16C converts 8 values per instruction. The rounding is given in the instruction, so MXCSR does not matter.
+	NUMBERS_TARGET("avx2,f16c")
+	void HalfFromFloatsAVX2(const float* values, size_t count, uint16_t* out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT));
+		HalfFromFloatsScalar(values, i, count, out);
+	}
+
+	NUMBERS_TARGET("avx2,f16c")
+	void HalfToFloatsAVX2(const uint16_t* values, size_t count, float* out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+			_mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i))));
+		HalfToFloatsScalar(values, i, count, out);
+	}
+
+	// BFloat16 is the top half of the float, so rounding is a single integer add of 0x7FFF plus the lowest kept bit;
+	//  a carry out of the significand moves to the next exponent, and past the largest float to infinity.
+	// NaNs skip the add (it could carry a NaN into infinity) and get the quiet bit instead.
+	// (AVX-512 BF16 has VCVTNEPS2BF16, but it flushes subnormal inputs to zero.)
+	NUMBERS_TARGET("avx2")
+	__m256i BFloat16FromBitsAVX2(__m256i bits)
+	{
+		__m256i odd = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+		__m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(bits, _mm256_add_epi32(odd, _mm256_set1_epi32(0x7FFF))), 16);
+		__m256i quiet = _mm256_or_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x40));
+		__m256i nan = _mm256_cmpgt_epi32(_mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFFFF)), _mm256_set1_epi32(0x7F800000));
+		return _mm256_blendv_epi8(rounded, quiet, nan);
+	}
+
+	NUMBERS_TARGET("avx2")
+	void BFloat16FromFloatsAVX2(const float* values, size_t count, uint16_t* out)
+	{
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m256i low = BFloat16FromBitsAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+			__m256i high = BFloat16FromBitsAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 8)));
+			// packus works within 128-bit halves; the permute puts the four groups of four back in order.
+			__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+		}
+		BFloat16FromFloatsScalar(values, i, count, out);
+	}
+
+	NUMBERS_TARGET("avx2")
+	void BFloat16ToFloatsAVX2(const uint16_t* values, size_t count, float* out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_slli_epi32(wide, 16));
+		}
+		BFloat16ToFloatsScalar(values, i, count, out);
+	}
+
+	// Narrow<L> for 8 lanes: the table entries are computed instead of looked up, and the variable shifts
+	//  of AVX2 shift each lane by its own amount.
+	template <typename L>
+	NUMBERS_TARGET("avx2")
+	__m256i FP8FromBitsAVX2(__m256i bits, __m256i overflowBits)
+	{
+		const __m256i one = _mm256_set1_epi32(1);
+		__m256i absolute = _mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFFFF));
+		__m256i exponent = _mm256_srli_epi32(absolute, 23);
+		__m256i significand = _mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFF));
+
+		__m256i normal = _mm256_cmpgt_epi32(exponent, _mm256_set1_epi32(127 - L::Bias));
+		__m256i subnormalShift = _mm256_min_epi32(_mm256_set1_epi32(25),
+			_mm256_sub_epi32(_mm256_set1_epi32(151 - L::Bias - L::M), _mm256_max_epi32(exponent, one)));
+		__m256i shift = _mm256_blendv_epi8(subnormalShift, _mm256_set1_epi32(23 - L::M), normal);
+		__m256i base = _mm256_and_si256(normal, _mm256_slli_epi32(_mm256_sub_epi32(exponent, _mm256_set1_epi32(128 - L::Bias)), L::M));
+
+		__m256i hidden = _mm256_andnot_si256(_mm256_cmpeq_epi32(exponent, _mm256_setzero_si256()), _mm256_set1_epi32(0x800000));
+		__m256i m = _mm256_or_si256(significand, hidden);
+		__m256i halfMinusOne = _mm256_sub_epi32(_mm256_sllv_epi32(one, _mm256_sub_epi32(shift, one)), one);
+		__m256i odd = _mm256_and_si256(_mm256_srlv_epi32(m, shift), one);
+		__m256i rounded = _mm256_srlv_epi32(_mm256_add_epi32(_mm256_add_epi32(m, halfMinusOne), odd), shift);
+		__m256i result = _mm256_add_epi32(base, rounded);
+
+		__m256i overflow = _mm256_cmpgt_epi32(result, _mm256_set1_epi32(L::MaxFinite));
+		result = _mm256_blendv_epi8(result, overflowBits, overflow);
+		__m256i nanBits = _mm256_set1_epi32(L::NaNBits);
+		if (L::HasInfinity)
+			nanBits = _mm256_or_si256(nanBits, _mm256_srli_epi32(significand, 23 - L::M));
+		__m256i nan = _mm256_cmpgt_epi32(absolute, _mm256_set1_epi32(0x7F800000));
+		result = _mm256_blendv_epi8(result, nanBits, nan);
+		return _mm256_or_si256(result, _mm256_slli_epi32(_mm256_srli_epi32(bits, 31), 7));
+	}
+
+	template <typename L>
+	NUMBERS_TARGET("avx2")
+	void FP8FromFloatsAVX2(const float* values, size_t count, uint8_t* out, const NarrowTable& table, FP8Overflow overflow)
+	{
+		const __m256i overflowBits = _mm256_set1_epi32(overflow == FP8Overflow::Saturate ? L::MaxFinite : L::OverflowBits);
+		const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		size_t i = 0;
+		for (; i + 32 <= count; i += 32)
+		{
+			// One call site, so that the compiler inlines the conversion.
+			const __m256i* in = reinterpret_cast<const __m256i*>(values + i);
+			__m256i r[4];
+			for (int k = 0; k < 4; ++k)
+				r[k] = FP8FromBitsAVX2<L>(_mm256_loadu_si256(in + k), overflowBits);
+			// Each 128-bit half now holds r0[0-3] r1[0-3] r2[0-3] r3[0-3] (low) and r0[4-7] ... r3[4-7] (high);
+			//  the permute interleaves the 4-byte groups back into order.
+			__m256i bytes = _mm256_packus_epi16(_mm256_packus_epi32(r[0], r[1]), _mm256_packus_epi32(r[2], r[3]));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permutevar8x32_epi32(bytes, order));
+		}
+		FP8FromFloatsScalar<L>(values, i, count, out, table, overflow);
+	}
+
+	NUMBERS_TARGET("avx2")
+	void FP8ToFloatsAVX2(const uint8_t* values, size_t count, float* out, const FP8WidenTable& table)
+	{
+		const int* bits = reinterpret_cast<const int*>(table.bits);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(values + i)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_i32gather_epi32(bits, index, 4));
+		}
+		FP8ToFloatsScalar(values, i, count, out, table);
+	}
+
+	// E5M2 is the top byte of a half, so F16C widens it without a table lookup.
+	NUMBERS_TARGET("avx2,f16c")
+	void E5M2ToFloatsAVX2(const uint8_t* values, size_t count, float* out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i half = _mm_slli_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(values + i))), 8);
+			_mm256_storeu_ps(out + i, _mm256_cvtph_ps(half));
+		}
+		FP8ToFloatsScalar(values, i, count, out, E5M2Widen);
+	}
+
+	// ---------------------------------------------------------------- AVX-512 kernels
+	// The same algorithms 16 lanes at a time, with mask registers in place of the blends,
+	//  and the down-converting moves (VPMOVDW, VPMOVDB) in place of the pack and permute.
+
+	NUMBERS_TARGET("avx512f")
+	void HalfFromFloatsAVX512(const float* values, size_t count, uint16_t* out)
+	{
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm512_cvtps_ph(_mm512_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT));
+		HalfFromFloatsScalar(values, i, count, out);
+	}
+
+	NUMBERS_TARGET("avx512f")
+	void HalfToFloatsAVX512(const uint16_t* values, size_t count, float* out)
+	{
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+			_mm512_storeu_ps(out + i, _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i))));
+		HalfToFloatsScalar(values, i, count, out);
+	}
+
+	NUMBERS_TARGET("avx512f")
+	void BFloat16FromFloatsAVX512(const float* values, size_t count, uint16_t* out)
+	{
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m512i bits = _mm512_loadu_si512(values + i);
+			__m512i odd = _mm512_and_si512(_mm512_srli_epi32(bits, 16), _mm512_set1_epi32(1));
+			__m512i rounded = _mm512_srli_epi32(_mm512_add_epi32(bits, _mm512_add_epi32(odd, _mm512_set1_epi32(0x7FFF))), 16);
+			__m512i quiet = _mm512_or_si512(_mm512_srli_epi32(bits, 16), _mm512_set1_epi32(0x40));
+			__mmask16 nan = _mm512_cmpgt_epi32_mask(_mm512_and_si512(bits, _mm512_set1_epi32(0x7FFFFFFF)), _mm512_set1_epi32(0x7F800000));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm512_cvtepi32_epi16(_mm512_mask_blend_epi32(nan, rounded, quiet)));
+		}
+		BFloat16FromFloatsScalar(values, i, count, out);
+	}
+
+	NUMBERS_TARGET("avx512f")
+	void BFloat16ToFloatsAVX512(const uint16_t* values, size_t count, float* out)
+	{
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m512i wide = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+			_mm512_storeu_si512(out + i, _mm512_slli_epi32(wide, 16));
+		}
+		BFloat16ToFloatsScalar(values, i, count, out);
+	}
+
+	template <typename L>
+	NUMBERS_TARGET("avx512f")
+	void FP8FromFloatsAVX512(const float* values, size_t count, uint8_t* out, const NarrowTable& table, FP8Overflow overflow)
+	{
+		const __m512i one = _mm512_set1_epi32(1);
+		const __m512i overflowBits = _mm512_set1_epi32(overflow == FP8Overflow::Saturate ? L::MaxFinite : L::OverflowBits);
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m512i bits = _mm512_loadu_si512(values + i);
+			__m512i absolute = _mm512_and_si512(bits, _mm512_set1_epi32(0x7FFFFFFF));
+			__m512i exponent = _mm512_srli_epi32(absolute, 23);
+			__m512i significand = _mm512_and_si512(bits, _mm512_set1_epi32(0x7FFFFF));
+
+			__mmask16 normal = _mm512_cmpgt_epi32_mask(exponent, _mm512_set1_epi32(127 - L::Bias));
+			__m512i subnormalShift = _mm512_min_epi32(_mm512_set1_epi32(25),
+				_mm512_sub_epi32(_mm512_set1_epi32(151 - L::Bias - L::M), _mm512_max_epi32(exponent, one)));
+			__m512i shift = _mm512_mask_blend_epi32(normal, subnormalShift, _mm512_set1_epi32(23 - L::M));
+			__m512i base = _mm512_maskz_mov_epi32(normal, _mm512_slli_epi32(_mm512_sub_epi32(exponent, _mm512_set1_epi32(128 - L::Bias)), L::M));
+
+			__m512i m = _mm512_mask_or_epi32(significand, _mm512_test_epi32_mask(exponent, exponent), significand, _mm512_set1_epi32(0x800000));
+			__m512i halfMinusOne = _mm512_sub_epi32(_mm512_sllv_epi32(one, _mm512_sub_epi32(shift, one)), one);
+			__m512i odd = _mm512_and_si512(_mm512_srlv_epi32(m, shift), one);
+			__m512i rounded = _mm512_srlv_epi32(_mm512_add_epi32(_mm512_add_epi32(m, halfMinusOne), odd), shift);
+			__m512i result = _mm512_add_epi32(base, rounded);
+
+			result = _mm512_mask_blend_epi32(_mm512_cmpgt_epi32_mask(result, _mm512_set1_epi32(L::MaxFinite)), result, overflowBits);
+			__m512i nanBits = _mm512_set1_epi32(L::NaNBits);
+			if (L::HasInfinity)
+				nanBits = _mm512_or_si512(nanBits, _mm512_srli_epi32(significand, 23 - L::M));
+			result = _mm512_mask_blend_epi32(_mm512_cmpgt_epi32_mask(absolute, _mm512_set1_epi32(0x7F800000)), result, nanBits);
+			result = _mm512_or_si512(result, _mm512_slli_epi32(_mm512_srli_epi32(bits, 31), 7));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm512_cvtepi32_epi8(result));
+		}
+		FP8FromFloatsScalar<L>(values, i, count, out, table, overflow);
+	}
+
+	NUMBERS_TARGET("avx512f")
+	void FP8ToFloatsAVX512(const uint8_t* values, size_t count, float* out, const FP8WidenTable& table)
+	{
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m512i index = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+			_mm512_storeu_si512(out + i, _mm512_i32gather_epi32(index, table.bits, 4));
+		}
+		FP8ToFloatsScalar(values, i, count, out, table);
+	}
+
+	NUMBERS_TARGET("avx512f")
+	void E5M2ToFloatsAVX512(const uint8_t* values, size_t count, float* out)
+	{
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m256i half = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i))), 8);
+			_mm512_storeu_ps(out + i, _mm512_cvtph_ps(half));
+		}
+		FP8ToFloatsScalar(values, i, count, out, E5M2Widen);
+	}
+#endif
+}
+
+bool MiniFloat_KernelSupported(MiniFloatKernel kernel)
+{
+	switch (kernel)
+	{
+	case MiniFloatKernel::Auto:
+	case MiniFloatKernel::Scalar:
+		return true;
+#if defined(NUMBERS_X86)
+	case MiniFloatKernel::AVX2:
+		return CpuFeatures::HasAVX2() && CpuFeatures::HasF16C();
+	case MiniFloatKernel::AVX512:
+		return CpuFeatures::HasAVX512F() && CpuFeatures::HasF16C();
+#endif
+	default:
+		return false;
+	}
+}
+
+MiniFloatKernel MiniFloat_ResolveKernel(MiniFloatKernel kernel)
+{
+	if (kernel == MiniFloatKernel::Auto)
+	{
+		if (MiniFloat_KernelSupported(MiniFloatKernel::AVX512))
+			return MiniFloatKernel::AVX512;
+		if (MiniFloat_KernelSupported(MiniFloatKernel::AVX2))
+			return MiniFloatKernel::AVX2;
+		return MiniFloatKernel::Scalar;
+	}
+	return MiniFloat_KernelSupported(kernel) ? kernel : MiniFloatKernel::Scalar;
+}
+
+uint16_t Half_FromFloat(float value)
+{
+	return static_cast<uint16_t>(Narrow<HalfLayout>(Float_ToBits(value), HalfNarrow, FP8Overflow::NonFinite));
+}
+
+float Half_ToFloat(uint16_t bits)
+{
+	return Float_FromBits<float>(HalfToBits(bits));
+}
+
+uint16_t BFloat16_FromFloat(float value)
+{
+	return static_cast<uint16_t>(Narrow<BFloat16Layout>(Float_ToBits(value), BFloat16Narrow, FP8Overflow::NonFinite));
+}
+
+float BFloat16_ToFloat(uint16_t bits)
+{
+	return Float_FromBits<float>(static_cast<uint32_t>(bits) << 16);
+}
+
+uint8_t FP8E4M3_FromFloat(float value, FP8Overflow overflow)
+{
+	return static_cast<uint8_t>(Narrow<E4M3Layout>(Float_ToBits(value), E4M3Narrow, overflow));
+}
+
+float FP8E4M3_ToFloat(uint8_t bits)
+{
+	return Float_FromBits<float>(E4M3Widen.bits[bits]);
+}
+
+uint8_t FP8E5M2_FromFloat(float value, FP8Overflow overflow)
+{
+	return static_cast<uint8_t>(Narrow<E5M2Layout>(Float_ToBits(value), E5M2Narrow, overflow));
+}
+
+float FP8E5M2_ToFloat(uint8_t bits)
+{
+	return Float_FromBits<float>(E5M2Widen.bits[bits]);
+}
+
+void Half_FromFloats(const float* values, size_t count, uint16_t* out, MiniFloatKernel kernel)
+{
+	switch (MiniFloat_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case MiniFloatKernel::AVX512:
+		HalfFromFloatsAVX512(values, count, out);
+		return;
+	case MiniFloatKernel::AVX2:
+		HalfFromFloatsAVX2(values, count, out);
+		return;
+#endif
+	default:
+		HalfFromFloatsScalar(values, 0, count, out);
+		return;
+	}
+}
+
+void Half_ToFloats(const uint16_t* values, size_t count, float* out, MiniFloatKernel kernel)
+{
+	switch (MiniFloat_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case MiniFloatKernel::AVX512:
+		HalfToFloatsAVX512(values, count, out);
+		return;
+	case MiniFloatKernel::AVX2:
+		HalfToFloatsAVX2(values, count, out);
+		return;
+#endif
+	default:
+		HalfToFloatsScalar(values, 0, count, out);
+		return;
+	}
+}
+
+void BFloat16_FromFloats(const float* values, size_t count, uint16_t* out, MiniFloatKernel kernel)
+{
+	switch (MiniFloat_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case MiniFloatKernel::AVX512:
+		BFloat16FromFloatsAVX512(values, count, out);
+		return;
+	case MiniFloatKernel::AVX2:
+		BFloat16FromFloatsAVX2(values, count, out);
+		return;
+#endif
+	default:
+		BFloat16FromFloatsScalar(values, 0, count, out);
+		return;
+	}
+}
+
+void BFloat16_ToFloats(const uint16_t* values, size_t count, float* out, MiniFloatKernel kernel)
+{
+	switch (MiniFloat_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case MiniFloatKernel::AVX512:
+		BFloat16ToFloatsAVX512(values, count, out);
+		return;
+	case MiniFloatKernel::AVX2:
+		BFloat16ToFloatsAVX2(values, count, out);
+		return;
+#endif
+	default:
+		BFloat16ToFloatsScalar(values, 0, count, out);
+		return;
+	}
+}
+
+void FP8E4M3_FromFloats(const float* values, size_t count, uint8_t* out, FP8Overflow overflow, MiniFloatKernel kernel)
+{
+	switch (MiniFloat_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case MiniFloatKernel::AVX512:
+		FP8FromFloatsAVX512<E4M3Layout>(values, count, out, E4M3Narrow, overflow);
+		return;
+	case MiniFloatKernel::AVX2:
+		FP8FromFloatsAVX2<E4M3Layout>(values, count, out, E4M3Narrow, overflow);
+		return;
+#endif
+	default:
+		FP8FromFloatsScalar<E4M3Layout>(values, 0, count, out, E4M3Narrow, overflow);
+		return;
+	}
+}
+
+void FP8E4M3_ToFloats(const uint8_t* values, size_t count, float* out, MiniFloatKernel kernel)
+{
+	switch (MiniFloat_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case MiniFloatKernel::AVX512:
+		FP8ToFloatsAVX512(values, count, out, E4M3Widen);
+		return;
+	case MiniFloatKernel::AVX2:
+		FP8ToFloatsAVX2(values, count, out, E4M3Widen);
+		return;
+#endif
+	default:
+		FP8ToFloatsScalar(values, 0, count, out, E4M3Widen);
+		return;
+	}
+}
+
+void FP8E5M2_FromFloats(const float* values, size_t count, uint8_t* out, FP8Overflow overflow, MiniFloatKernel kernel)
+{
+	switch (MiniFloat_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case MiniFloatKernel::AVX512:
+		FP8FromFloatsAVX512<E5M2Layout>(values, count, out, E5M2Narrow, overflow);
+		return;
+	case MiniFloatKernel::AVX2:
+		FP8FromFloatsAVX2<E5M2Layout>(values, count, out, E5M2Narrow, overflow);
+		return;
+#endif
+	default:
+		FP8FromFloatsScalar<E5M2Layout>(values, 0, count, out, E5M2Narrow, overflow);
+		return;
+	}
+}
+
+void FP8E5M2_ToFloats(const uint8_t* values, size_t count, float* out, MiniFloatKernel kernel)
+{
+	switch (MiniFloat_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case MiniFloatKernel::AVX512:
+		E5M2ToFloatsAVX512(values, count, out);
+		return;
+	case MiniFloatKernel::AVX2:
+		E5M2ToFloatsAVX2(values, count, out);
+		return;
+#endif
+	default:
+		FP8ToFloatsScalar(values, 0, count, out, E5M2Widen);
+		return;
+	}
+}
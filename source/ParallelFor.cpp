@@ -0,0 +1,256 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: ParallelFor.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/ParallelFor.h"
+#include "../header/Denormals.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// A contiguous range of chunk indices [begin, end), packed into one atomic word so that the owner
+	//  taking a chunk from the front and a thief taking the back half never both get the same chunk.
+	struct alignas(64) Share
+	{
+		std::atomic<uint64_t> range;
+	};
+
+	inline uint64_t PackRange(uint64_t begin, uint64_t end) { return begin | (end << 32); }
+	inline uint32_t RangeBegin(uint64_t range) { return static_cast<uint32_t>(range); }
+	inline uint32_t RangeEnd(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+
+	struct Job
+	{
+		size_t count;
+		size_t grainSize;
+		const std::function<void(size_t, size_t)>* body;
+		// One share per thread; thread t starts on the t-th contiguous slice of the chunks.
+		std::unique_ptr<Share[]> shares;
+		unsigned shareCount;
+		// The calling thread's FTZ/DAZ mode, which the workers adopt while they run the job
+		DenormalMode denormalMode;
+	};
+
+	// Set on pool threads, and on the calling thread while it helps with a job,
+	//  so that a nested ParallelFor runs inline instead of waiting on itself.
+	thread_local bool t_insideJob = false;
+
+	// Takes the first chunk of a share, or returns false if the share is empty.
+	bool TakeChunk(Share& share, uint32_t& chunk)
+	{
+		uint64_t range = share.range.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			if (RangeBegin(range) >= RangeEnd(range))
+				return false;
+			if (share.range.compare_exchange_weak(range, PackRange(RangeBegin(range) + 1, RangeEnd(range)),
+				std::memory_order_relaxed))
+			{
+				chunk = RangeBegin(range);
+				return true;
+			}
+		}
+	}
+
+	// Moves the back half of the fullest other share into share `self`. Returns false once every share is empty.
+	bool Steal(Job& job, unsigned self)
+	{
+		for (;;)
+		{
+			unsigned victim = self;
+			uint32_t most = 0;
+			for (unsigned i = 0; i < job.shareCount; ++i)
+			{
+				uint64_t range = job.shares[i].range.load(std::memory_order_relaxed);
+				uint32_t remaining = RangeBegin(range) < RangeEnd(range) ? RangeEnd(range) - RangeBegin(range) : 0;
+				if (i != self && remaining > most)
+				{
+					most = remaining;
+					victim = i;
+				}
+			}
+			if (victim == self)
+				return false;
+
+			uint64_t range = job.shares[victim].range.load(std::memory_order_relaxed);
+			uint32_t begin = RangeBegin(range), end = RangeEnd(range);
+			if (begin >= end)
+				continue;
+			// Leave the victim the front half, which is next to what it is working on; a single chunk is taken whole.
+			uint32_t middle = begin + (end - begin) / 2;
+			if (job.shares[victim].range.compare_exchange_strong(range, PackRange(begin, middle), std::memory_order_relaxed))
+			{
+				job.shares[self].range.store(PackRange(middle, end), std::memory_order_relaxed);
+				return true;
+			}
+		}
+	}
+
+	void RunChunks(Job& job, unsigned self)
+	{
+		do
+		{
+			uint32_t chunk;
+			while (TakeChunk(job.shares[self], chunk))
+			{
+				size_t begin = chunk * job.grainSize;
+				(*job.body)(begin, std::min(job.count, begin + job.grainSize));
+			}
+		} while (Steal(job, self));
+	}
+
+	class ThreadPool
+	{
+	public:
+		ThreadPool()
+		{
+			unsigned hardware = std::thread::hardware_concurrency();
+			unsigned workerCount = hardware > 1 ? hardware - 1 : 0;
+			for (unsigned i = 0; i < workerCount; ++i)
+				m_workers.emplace_back([this, i] { WorkerLoop(i + 1); });
+		}
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_all();
+			for (std::thread& worker : m_workers)
+				worker.join();
+		}
+
+		unsigned ThreadCount() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+		void Run(Job& job)
+		{
+			// One job at a time; concurrent callers queue up here.
+			std::lock_guard<std::mutex> submitLock(m_submitMutex);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_job = &job;
+				m_busyWorkers = m_workers.size();
+				++m_generation;
+			}
+			m_wake.notify_all();
+
+			t_insideJob = true;
+			RunChunks(job, 0);
+			t_insideJob = false;
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done.wait(lock, [this] { return m_busyWorkers == 0; });
+			m_job = nullptr;
+		}
+
+	private:
+		// Worker `self` works on share `self` of each job; share 0 belongs to the calling thread.
+		void WorkerLoop(unsigned self)
+		{
+			t_insideJob = true;
+			uint64_t seenGeneration = 0;
+			for (;;)
+			{
+				Job* job;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_wake.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+					if (m_stop)
+						return;
+					seenGeneration = m_generation;
+					job = m_job;
+				}
+
+				DenormalMode previousMode = Denormals_GetMode();
+				Denormals_SetMode(job->denormalMode);
+				RunChunks(*job, self);
+				Denormals_SetMode(previousMode);
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (--m_busyWorkers == 0)
+					m_done.notify_one();
+			}
+		}
+
+		std::vector<std::thread> m_workers;
+		std::mutex m_submitMutex;
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_done;
+		Job* m_job = nullptr;
+		size_t m_busyWorkers = 0;
+		uint64_t m_generation = 0;
+		bool m_stop = false;
+	};
+
+	ThreadPool& Pool()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+}
+
+void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& body)
+{
+	if (count == 0)
+		return;
+	if (grainSize == 0)
+		grainSize = 1;
+
+	// Not worth waking the pool for a single chunk, and a nested call must not wait on the pool it runs in.
+	if (count <= grainSize || t_insideJob || Pool().ThreadCount() == 1)
+	{
+		for (size_t begin = 0; begin < count; begin += grainSize)
+			body(begin, std::min(count, begin + grainSize));
+		return;
+	}
+
+	// Chunk indices are 32 bits wide; larger ranges get larger chunks.
+	const size_t maxChunks = 0xFFFFFFFFu;
+	if ((count - 1) / grainSize >= maxChunks)
+		grainSize = (count - 1) / maxChunks + 1;
+	uint64_t chunkCount = (count - 1) / grainSize + 1;
+
+	Job job;
+	job.count = count;
+	job.grainSize = grainSize;
+	job.body = &body;
+	job.shareCount = Pool().ThreadCount();
+	job.shares.reset(new Share[job.shareCount]);
+	for (unsigned i = 0; i < job.shareCount; ++i)
+		job.shares[i].range.store(PackRange(chunkCount * i / job.shareCount, chunkCount * (i + 1) / job.shareCount),
+			std::memory_order_relaxed);
+	job.denormalMode = Denormals_GetMode();
+	Pool().Run(job);
+}
+
+unsigned ParallelFor_ThreadCount()
+{
+	return Pool().ThreadCount();
+}
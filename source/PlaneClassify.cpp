@@ -0,0 +1,219 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: PlaneClassify.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/PlaneClassify.h"
+#include "../header/CpuFeatures.h"
+#include "../header/ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(NUMBERS_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// Each ParallelFor chunk covers this many points. A multiple of 64, so that no two threads
+	//  ever write to the same bitmask word.
+	const size_t PointsPerChunk = 64 * 256;
+
+	// The SIMD kernels below perform exactly these operations in exactly this order,
+	//  which is what keeps every kernel in agreement with Plane_ClassifyPoint.
+	inline void ClassifyScalar(float x, float y, float z, const plane& p, float tolerance, bool& front, bool& on)
+	{
+		float tx = x * p.normal.x;
+		float ty = y * p.normal.y;
+		float tz = z * p.normal.z;
+		float distance = tx + ty + tz + p.d;
+		float limit = tolerance * (std::fabs(tx) + std::fabs(ty) + std::fabs(tz) + std::fabs(p.d));
+		front = distance > limit;
+		on = std::fabs(distance) <= limit;
+	}
+
+	struct ClassifyArgs
+	{
+		const float* xs;
+		const float* ys;
+		const float* zs;
+		const plane* planes;
+		size_t planeCount;
+		float tolerance;
+		uint64_t* frontBits;
+		uint64_t* onBits;
+		size_t wordsPerPlane;
+	};
+
+	// Classifies the points [begin, end); begin must be a multiple of 64.
+	void ClassifyRangeScalar(const ClassifyArgs& a, size_t begin, size_t end)
+	{
+		for (size_t j = 0; j < a.planeCount; ++j)
+		{
+			for (size_t word = begin / 64; word * 64 < end; ++word)
+			{
+				uint64_t front = 0, on = 0;
+				size_t last = std::min(end, word * 64 + 64);
+				for (size_t i = word * 64; i < last; ++i)
+				{
+					bool isFront, isOn;
+					ClassifyScalar(a.xs[i], a.ys[i], a.zs[i], a.planes[j], a.tolerance, isFront, isOn);
+					front |= uint64_t(isFront) << (i % 64);
+					on |= uint64_t(isOn) << (i % 64);
+				}
+				a.frontBits[j * a.wordsPerPlane + word] = front;
+				a.onBits[j * a.wordsPerPlane + word] = on;
+			}
+		}
+	}
+
+#if defined(NUMBERS_X86)
+	NUMBERS_TARGET("sse2")
+	void ClassifyRangeSSE2(const ClassifyArgs& a, size_t begin, size_t end)
+	{
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		const __m128 tolerance = _mm_set1_ps(a.tolerance);
+		size_t fullEnd = begin + (end - begin) / 64 * 64;
+		for (size_t block = begin; block < fullEnd; block += 64)
+		{
+			for (size_t j = 0; j < a.planeCount; ++j)
+			{
+				const plane& p = a.planes[j];
+				const __m128 nx = _mm_set1_ps(p.normal.x);
+				const __m128 ny = _mm_set1_ps(p.normal.y);
+				const __m128 nz = _mm_set1_ps(p.normal.z);
+				const __m128 d = _mm_set1_ps(p.d);
+				const __m128 absD = _mm_set1_ps(std::fabs(p.d));
+				uint64_t front = 0, on = 0;
+				for (size_t k = 0; k < 64; k += 4)
+				{
+					__m128 tx = _mm_mul_ps(_mm_loadu_ps(a.xs + block + k), nx);
+					__m128 ty = _mm_mul_ps(_mm_loadu_ps(a.ys + block + k), ny);
+					__m128 tz = _mm_mul_ps(_mm_loadu_ps(a.zs + block + k), nz);
+					__m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(tx, ty), tz), d);
+					__m128 magnitude = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_and_ps(tx, absMask), _mm_and_ps(ty, absMask)),
+						_mm_and_ps(tz, absMask)), absD);
+					__m128 limit = _mm_mul_ps(tolerance, magnitude);
+					front |= uint64_t(_mm_movemask_ps(_mm_cmpgt_ps(distance, limit))) << k;
+					on |= uint64_t(_mm_movemask_ps(_mm_cmple_ps(_mm_and_ps(distance, absMask), limit))) << k;
+				}
+				a.frontBits[j * a.wordsPerPlane + block / 64] = front;
+				a.onBits[j * a.wordsPerPlane + block / 64] = on;
+			}
+		}
+		if (fullEnd < end)
+			ClassifyRangeScalar(a, fullEnd, end);
+	}
+
+	NUMBERS_TARGET("avx2")
+	void ClassifyRangeAVX2(const ClassifyArgs& a, size_t begin, size_t end)
+	{
+		const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+		const __m256 tolerance = _mm256_set1_ps(a.tolerance);
+		size_t fullEnd = begin + (end - begin) / 64 * 64;
+		// One block of 64 points (768 bytes) stays in L1 while it is tested against every plane.
+		for (size_t block = begin; block < fullEnd; block += 64)
+		{
+			for (size_t j = 0; j < a.planeCount; ++j)
+			{
+				const plane& p = a.planes[j];
+				const __m256 nx = _mm256_set1_ps(p.normal.x);
+				const __m256 ny = _mm256_set1_ps(p.normal.y);
+				const __m256 nz = _mm256_set1_ps(p.normal.z);
+				const __m256 d = _mm256_set1_ps(p.d);
+				const __m256 absD = _mm256_set1_ps(std::fabs(p.d));
+				uint64_t front = 0, on = 0;
+				for (size_t k = 0; k < 64; k += 8)
+				{
+					__m256 tx = _mm256_mul_ps(_mm256_loadu_ps(a.xs + block + k), nx);
+					__m256 ty = _mm256_mul_ps(_mm256_loadu_ps(a.ys + block + k), ny);
+					__m256 tz = _mm256_mul_ps(_mm256_loadu_ps(a.zs + block + k), nz);
+					__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(tx, ty), tz), d);
+					__m256 magnitude = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_and_ps(tx, absMask),
+						_mm256_and_ps(ty, absMask)), _mm256_and_ps(tz, absMask)), absD);
+					__m256 limit = _mm256_mul_ps(tolerance, magnitude);
+					front |= uint64_t(_mm256_movemask_ps(_mm256_cmp_ps(distance, limit, _CMP_GT_OQ))) << k;
+					on |= uint64_t(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_and_ps(distance, absMask), limit, _CMP_LE_OQ))) << k;
+				}
+				a.frontBits[j * a.wordsPerPlane + block / 64] = front;
+				a.onBits[j * a.wordsPerPlane + block / 64] = on;
+			}
+		}
+		if (fullEnd < end)
+			ClassifyRangeScalar(a, fullEnd, end);
+	}
+#endif
+}
+
+PlaneSide Plane_ClassifyPoint(vec3 point, const plane& p, float tolerance)
+{
+	bool front, on;
+	ClassifyScalar(point.x, point.y, point.z, p, tolerance, front, on);
+	if (on)
+		return PlaneSide::On;
+	return front ? PlaneSide::Front : PlaneSide::Back;
+}
+
+void Plane_ClassifyPoints(const float* xs, const float* ys, const float* zs, size_t count,
+	const plane* planes, size_t planeCount, uint64_t* frontBits, uint64_t* onBits,
+	float tolerance, Vec3Kernel kernel, bool parallel)
+{
+	if (count == 0 || planeCount == 0)
+		return;
+
+	ClassifyArgs args = { xs, ys, zs, planes, planeCount, tolerance, frontBits, onBits, Plane_BitmaskWords(count) };
+	void (*classifyRange)(const ClassifyArgs&, size_t, size_t) = ClassifyRangeScalar;
+	switch (Vec3_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case Vec3Kernel::AVX2:
+		classifyRange = ClassifyRangeAVX2;
+		break;
+	case Vec3Kernel::SSE2:
+		classifyRange = ClassifyRangeSSE2;
+		break;
+#endif
+	default:
+		break;
+	}
+
+	if (!parallel)
+	{
+		classifyRange(args, 0, count);
+		return;
+	}
+	ParallelFor(count, PointsPerChunk, [&](size_t begin, size_t end) {
+		classifyRange(args, begin, end);
+	});
+}
+
+PlaneClassification Plane_ClassifyPoints(const vec3SoA& points, const plane* planes, size_t planeCount,
+	float tolerance, Vec3Kernel kernel, bool parallel)
+{
+	PlaneClassification result;
+	result.pointCount = points.size();
+	result.planeCount = planeCount;
+	result.wordsPerPlane = Plane_BitmaskWords(points.size());
+	result.frontBits.resize(result.wordsPerPlane * planeCount);
+	result.onBits.resize(result.wordsPerPlane * planeCount);
+	Plane_ClassifyPoints(points.x.data(), points.y.data(), points.z.data(), points.size(), planes, planeCount,
+		result.frontBits.data(), result.onBits.data(), tolerance, kernel, parallel);
+	return result;
+}
@@ -0,0 +1,603 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Radix.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/Radix.h"
+#include "../header/CpuFeatures.h"
+
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(NUMBERS_X86)
+#include <emmintrin.h>
+#endif
+
+// The SWAR ("SIMD within a register") routines below load 8 characters into one uint64_t and work on all
+//  8 bytes at once with ordinary integer arithmetic. They assume a little-endian machine, so that the
+//  first character ends up in the lowest byte; every target this project builds for is little-endian.
+
+namespace
+{
+	const char LowerDigits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+	const char UpperDigits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+	// Two characters per lookup: the digits of 00..99 in decimal and 00..ff in hexadecimal
+	const char DecimalPairs[] =
+		"0001020304050607080910111213141516171819"
+		"2021222324252627282930313233343536373839"
+		"4041424344454647484950515253545556575859"
+		"6061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+	const char LowerHexPairs[] =
+		"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+		"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+		"404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+		"606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+		"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+		"a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+		"c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+		"e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+	const char UpperHexPairs[] =
+		"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+		"202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+		"404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+		"606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+		"808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+		"A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+		"C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+		"E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+	// The value of each character as a digit (letters in either case), or 255 if it is not a digit in any base
+	const uint8_t DigitValues[256] = {
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 255, 255, 255, 255, 255, 255,
+		255, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+		25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 255, 255, 255, 255, 255,
+		255, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+		25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	};
+
+	const uint64_t Ones = 0x0101010101010101ULL;
+	const uint64_t HighBits = 0x8080808080808080ULL;
+
+	unsigned CountLeadingZeros(uint64_t value)
+	{
+		if (value == 0)
+			return 64;
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return 63 - index;
+#elif defined(__GNUC__) || defined(__clang__)
+		return static_cast<unsigned>(__builtin_clzll(value));
+#else
+		unsigned count = 0;
+		for (uint64_t bit = uint64_t(1) << 63; (value & bit) == 0; bit >>= 1)
+			++count;
+		return count;
+#endif
+	}
+
+	uint64_t Load8(const char* text)
+	{
+		uint64_t word;
+		std::memcpy(&word, text, 8);
+		return word;
+	}
+
+	////////////////
+	// Formatting //
+	////////////////
+
+	size_t DecimalLength(uint64_t value)
+	{
+		static const uint64_t PowersOf10[20] = {
+			1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+			1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+			100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+			1000000000000000000ULL, 10000000000000000000ULL
+		};
+		// log10(2) ~= 1233 / 4096 turns the bit length into a digit count that is at most one too small.
+		// Zero has one digit, like one; setting the low bit never changes the digit count otherwise.
+		value |= 1;
+		unsigned bits = 64 - CountLeadingZeros(value);
+		unsigned guess = (bits * 1233) >> 12;
+		return guess + 1 - (value < PowersOf10[guess] ? 1 : 0);
+	}
+
+	// Writes the digits of value so that the last one lands just before end.
+	void WriteDecimal(uint64_t value, char* end)
+	{
+		while (value >= 100)
+		{
+			unsigned pair = static_cast<unsigned>(value % 100) * 2;
+			value /= 100;
+			end -= 2;
+			std::memcpy(end, DecimalPairs + pair, 2);
+		}
+		if (value >= 10)
+			std::memcpy(end - 2, DecimalPairs + value * 2, 2);
+		else
+			end[-1] = static_cast<char>('0' + value);
+	}
+
+	void WriteHex(uint64_t value, char* end, size_t length, const char* pairs)
+	{
+		for (; length >= 2; length -= 2, value >>= 8)
+		{
+			end -= 2;
+			std::memcpy(end, pairs + (value & 0xFF) * 2, 2);
+		}
+		if (length == 1)
+			end[-1] = pairs[(value & 0xF) * 2 + 1];
+	}
+
+	// Spreads the 8 bits of a byte over 8 characters '0'/'1', most significant bit first.
+	uint64_t BinaryDigits8(uint64_t byte)
+	{
+		// Byte k of the spread value keeps only bit 7-k; adding 0x7F sets the top bit of the byte if it was set.
+		uint64_t bits = (byte * Ones) & 0x0102040810204080ULL;
+		return (((bits + 0x7F * Ones) & HighBits) >> 7) + '0' * Ones;
+	}
+
+	void WriteBinary(uint64_t value, char* end, size_t length)
+	{
+		for (; length >= 8; length -= 8, value >>= 8)
+		{
+			end -= 8;
+			uint64_t digits = BinaryDigits8(value & 0xFF);
+			std::memcpy(end, &digits, 8);
+		}
+		for (; length > 0; --length, value >>= 1)
+			*--end = static_cast<char>('0' + (value & 1));
+	}
+
+	// Bases 4, 8 and 32: every digit is a fixed group of bits.
+	size_t WritePowerOfTwo(uint64_t value, unsigned shift, char* end, const char* digits)
+	{
+		uint64_t mask = (uint64_t(1) << shift) - 1;
+		char* p = end;
+		do
+		{
+			*--p = digits[value & mask];
+			value >>= shift;
+		} while (value != 0);
+		return static_cast<size_t>(end - p);
+	}
+
+	// Any other base: one 64-bit division yields two digits.
+	size_t WriteGeneric(uint64_t value, unsigned base, char* end, const char* digits)
+	{
+		const unsigned baseSquared = base * base;
+		char* p = end;
+		while (value >= baseSquared)
+		{
+			unsigned pair = static_cast<unsigned>(value % baseSquared);
+			value /= baseSquared;
+			*--p = digits[pair % base];
+			*--p = digits[pair / base];
+		}
+		unsigned rest = static_cast<unsigned>(value);
+		if (rest >= base)
+		{
+			*--p = digits[rest % base];
+			rest /= base;
+		}
+		*--p = digits[rest];
+		return static_cast<size_t>(end - p);
+	}
+
+	/////////////
+	// Parsing //
+	/////////////
+
+	// Bit 7 of each byte is set if that byte lies in [lo, hi]. Every byte of word must be below 0x80,
+	//  which keeps the additions from carrying into the next byte.
+	uint64_t BytesInRange(uint64_t word, unsigned lo, unsigned hi)
+	{
+		return (word + (0x80 - lo) * Ones) & ~(word + (0x7F - hi) * Ones) & HighBits;
+	}
+
+	bool IsDecimal8(uint64_t word)
+	{
+		return ((word & 0xF0F0F0F0F0F0F0F0ULL) | (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+			== 0x3333333333333333ULL;
+	}
+
+	bool IsBinary8(uint64_t word)
+	{
+		return (word & (0xFE * Ones)) == '0' * Ones;
+	}
+
+	// Returns false if word is not all hex digits; otherwise sets the high bit of every letter byte in letters.
+	bool HexLetters8(uint64_t word, uint64_t& letters)
+	{
+		if (word & HighBits)
+			return false;
+		uint64_t digits = BytesInRange(word, '0', '9');
+		letters = BytesInRange(word | (0x20 * Ones), 'a', 'f');
+		return (digits | letters) == HighBits;
+	}
+
+	// 8 decimal digits to their value: pairs, then quads, then all eight, with one multiply per step.
+	uint32_t DecimalValue8(uint64_t word)
+	{
+		word = ((word & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+		word = ((word & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+		return static_cast<uint32_t>(((word & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32);
+	}
+
+	// 8 hex digits to their value. Each byte becomes its nibble, then neighbouring nibbles, bytes and
+	//  halfwords are merged, the first character ending up most significant.
+	bool HexValue8(const char* text, uint32_t& value)
+	{
+		uint64_t word = Load8(text);
+		uint64_t letters;
+		if (!HexLetters8(word, letters))
+			return false;
+		uint64_t nibbles = (word & (0x0F * Ones)) + (letters >> 7) * 9;
+		nibbles = ((nibbles << 4) | (nibbles >> 8)) & 0x00FF00FF00FF00FFULL;
+		nibbles = ((nibbles << 8) | (nibbles >> 16)) & 0x0000FFFF0000FFFFULL;
+		value = static_cast<uint32_t>((nibbles << 16) | (nibbles >> 32));
+		return true;
+	}
+
+	// 8 binary digits to their value: the multiply gathers the low bit of every byte into the top byte.
+	uint32_t BinaryValue8(uint64_t word)
+	{
+		return static_cast<uint32_t>(((word & Ones) * 0x8040201008040201ULL) >> 56);
+	}
+
+	bool AllDigits(const char* text, size_t length, unsigned base)
+	{
+		for (size_t i = 0; i < length; ++i)
+			if (DigitValues[static_cast<unsigned char>(text[i])] >= base)
+				return false;
+		return true;
+	}
+
+	// Once the number has too many significant digits to fit, the answer depends on whether they are all digits.
+	RadixStatus TooLong(const char* text, size_t length, unsigned base)
+	{
+		return AllDigits(text, length, base) ? RadixStatus::OutOfRange : RadixStatus::InvalidDigit;
+	}
+
+	RadixStatus ParseDecimal(const char* text, size_t length, uint64_t& value)
+	{
+		// Any 19 digits fit in 64 bits; the 20th needs an overflow check.
+		if (length > 20)
+			return TooLong(text, length, 10);
+		uint64_t result = 0;
+		size_t i = 0;
+		for (; length - i >= 8 && i + 8 <= 19; i += 8)
+		{
+			uint64_t word = Load8(text + i);
+			if (!IsDecimal8(word))
+				return RadixStatus::InvalidDigit;
+			result = result * 100000000 + DecimalValue8(word);
+		}
+		for (; i < length; ++i)
+		{
+			unsigned digit = static_cast<unsigned char>(text[i]) - '0';
+			if (digit > 9)
+				return RadixStatus::InvalidDigit;
+			if (i == 19 && result > (UINT64_MAX - digit) / 10)
+				return RadixStatus::OutOfRange;
+			result = result * 10 + digit;
+		}
+		value = result;
+		return RadixStatus::Ok;
+	}
+
+	RadixStatus ParseHex(const char* text, size_t length, uint64_t& value)
+	{
+		if (length > 16)
+			return TooLong(text, length, 16);
+		uint64_t result = 0;
+		size_t i = 0;
+		for (; length - i >= 8; i += 8)
+		{
+			uint32_t chunk;
+			if (!HexValue8(text + i, chunk))
+				return RadixStatus::InvalidDigit;
+			result = (result << 32) | chunk;
+		}
+		for (; i < length; ++i)
+		{
+			unsigned digit = DigitValues[static_cast<unsigned char>(text[i])];
+			if (digit >= 16)
+				return RadixStatus::InvalidDigit;
+			result = (result << 4) | digit;
+		}
+		value = result;
+		return RadixStatus::Ok;
+	}
+
+	RadixStatus ParseBinary(const char* text, size_t length, uint64_t& value)
+	{
+		if (length > 64)
+			return TooLong(text, length, 2);
+		uint64_t result = 0;
+		size_t i = 0;
+		for (; length - i >= 8; i += 8)
+		{
+			uint64_t word = Load8(text + i);
+			if (!IsBinary8(word))
+				return RadixStatus::InvalidDigit;
+			result = (result << 8) | BinaryValue8(word);
+		}
+		for (; i < length; ++i)
+		{
+			unsigned digit = static_cast<unsigned char>(text[i]) - '0';
+			if (digit > 1)
+				return RadixStatus::InvalidDigit;
+			result = (result << 1) | digit;
+		}
+		value = result;
+		return RadixStatus::Ok;
+	}
+
+	// The number of digits in the given base that always fit in 64 bits.
+	struct SafeDigitTable
+	{
+		unsigned digits[37];
+	};
+
+	constexpr SafeDigitTable MakeSafeDigitTable()
+	{
+		SafeDigitTable table = {};
+		for (unsigned base = 2; base <= 36; ++base)
+		{
+			unsigned count = 0;
+			for (uint64_t power = 1; power <= UINT64_MAX / base; power *= base)
+				++count;
+			table.digits[base] = count;
+		}
+		return table;
+	}
+
+	constexpr SafeDigitTable SafeDigits = MakeSafeDigitTable();
+
+	RadixStatus ParseGeneric(const char* text, size_t length, unsigned base, uint64_t& value)
+	{
+		const size_t safeDigits = SafeDigits.digits[base];
+		if (length > safeDigits + 1)
+			return TooLong(text, length, base);
+
+		// Two digits per step halve the length of the multiply-add dependency chain.
+		const uint64_t baseSquared = uint64_t(base) * base;
+		size_t fastDigits = length < safeDigits ? length : safeDigits;
+		uint64_t result = 0;
+		size_t i = 0;
+		for (; i + 2 <= fastDigits; i += 2)
+		{
+			unsigned high = DigitValues[static_cast<unsigned char>(text[i])];
+			unsigned low = DigitValues[static_cast<unsigned char>(text[i + 1])];
+			if (high >= base || low >= base)
+				return RadixStatus::InvalidDigit;
+			result = result * baseSquared + high * base + low;
+		}
+		for (; i < length; ++i)
+		{
+			unsigned digit = DigitValues[static_cast<unsigned char>(text[i])];
+			if (digit >= base)
+				return RadixStatus::InvalidDigit;
+			if (i == safeDigits && result > (UINT64_MAX - digit) / base)
+				return RadixStatus::OutOfRange;
+			result = result * base + digit;
+		}
+		value = result;
+		return RadixStatus::Ok;
+	}
+
+	RadixStatus ParseDigits(const char* text, size_t length, unsigned base, uint64_t& value)
+	{
+		if (length == 0)
+			return RadixStatus::Empty;
+		// Leading zeros do not count towards the digits that must fit in 64 bits.
+		while (length > 1 && text[0] == '0')
+			++text, --length;
+		switch (base)
+		{
+		case 10: return ParseDecimal(text, length, value);
+		case 16: return ParseHex(text, length, value);
+		case 2: return ParseBinary(text, length, value);
+		default: return ParseGeneric(text, length, base, value);
+		}
+	}
+
+	// Consumes an optional sign. A '-' is only accepted for signed destinations.
+	bool ParseSign(const char*& text, size_t& length, bool allowSign, bool& negative)
+	{
+		negative = false;
+		if (length == 0 || (text[0] != '-' && text[0] != '+'))
+			return true;
+		if (text[0] == '-')
+		{
+			if (!allowSign)
+				return false;
+			negative = true;
+		}
+		++text, --length;
+		return true;
+	}
+
+#if defined(NUMBERS_X86)
+	// 16 characters per step. Bytes of 0x80 and above are negative as signed chars, so they fail every range.
+	NUMBERS_TARGET("sse2")
+	bool IsDigitsSSE2(const char* text, size_t length, int kind)
+	{
+		const __m128i zeroMinus1 = _mm_set1_epi8('0' - 1), nine1 = _mm_set1_epi8('9' + 1);
+		const __m128i aMinus1 = _mm_set1_epi8('a' - 1), f1 = _mm_set1_epi8('f' + 1);
+		const __m128i lowerCase = _mm_set1_epi8(0x20), binaryMask = _mm_set1_epi8(static_cast<char>(0xFE));
+		const __m128i zero = _mm_set1_epi8('0');
+		size_t i = 0;
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+			__m128i ok;
+			if (kind == 2)
+				ok = _mm_cmpeq_epi8(_mm_and_si128(c, binaryMask), zero);
+			else
+			{
+				ok = _mm_and_si128(_mm_cmpgt_epi8(c, zeroMinus1), _mm_cmplt_epi8(c, nine1));
+				if (kind == 16)
+				{
+					__m128i folded = _mm_or_si128(c, lowerCase);
+					ok = _mm_or_si128(ok, _mm_and_si128(_mm_cmpgt_epi8(folded, aMinus1), _mm_cmplt_epi8(folded, f1)));
+				}
+			}
+			if (_mm_movemask_epi8(ok) != 0xFFFF)
+				return false;
+		}
+		return AllDigits(text + i, length - i, static_cast<unsigned>(kind));
+	}
+#endif
+
+	bool IsDigits(const char* text, size_t length, unsigned base)
+	{
+#if defined(NUMBERS_X86)
+		if (CpuFeatures::HasSSE2())
+			return IsDigitsSSE2(text, length, static_cast<int>(base));
+#endif
+		size_t i = 0;
+		for (; i + 8 <= length; i += 8)
+		{
+			uint64_t word = Load8(text + i);
+			uint64_t letters;
+			bool ok = base == 2 ? IsBinary8(word) : base == 10 ? IsDecimal8(word) : HexLetters8(word, letters);
+			if (!ok)
+				return false;
+		}
+		return AllDigits(text + i, length - i, base);
+	}
+}
+
+size_t Radix_FormatMagnitude(uint64_t magnitude, bool negative, unsigned base, char* buffer, size_t bufferSize,
+	bool uppercase)
+{
+	if (base < 2 || base > 36)
+		return 0;
+	const char* digits = uppercase ? UpperDigits : LowerDigits;
+	size_t sign = negative ? 1 : 0;
+
+	size_t length;
+	switch (base)
+	{
+	case 10:
+		length = DecimalLength(magnitude);
+		if (sign + length > bufferSize)
+			return 0;
+		WriteDecimal(magnitude, buffer + sign + length);
+		break;
+	case 16:
+		length = (64 - CountLeadingZeros(magnitude | 1) + 3) / 4;
+		if (sign + length > bufferSize)
+			return 0;
+		WriteHex(magnitude, buffer + sign + length, length, uppercase ? UpperHexPairs : LowerHexPairs);
+		break;
+	case 2:
+		length = 64 - CountLeadingZeros(magnitude | 1);
+		if (sign + length > bufferSize)
+			return 0;
+		WriteBinary(magnitude, buffer + sign + length, length);
+		break;
+	default:
+	{
+		// The length is not known up front, so write to the end of a scratch buffer and copy.
+		char scratch[64];
+		char* end = scratch + sizeof(scratch);
+		if (base == 4 || base == 8 || base == 32)
+			length = WritePowerOfTwo(magnitude, base == 4 ? 2 : base == 8 ? 3 : 5, end, digits);
+		else
+			length = WriteGeneric(magnitude, base, end, digits);
+		if (sign + length > bufferSize)
+			return 0;
+		std::memcpy(buffer + sign, end - length, length);
+		break;
+	}
+	}
+	if (negative)
+		buffer[0] = '-';
+	return sign + length;
+}
+
+RadixStatus Radix_ParseMagnitude(const char* text, size_t length, unsigned base, bool allowSign,
+	uint64_t& magnitude, bool& negative)
+{
+	if (base < 2 || base > 36)
+		return RadixStatus::InvalidBase;
+	if (!ParseSign(text, length, allowSign, negative))
+		return RadixStatus::InvalidDigit;
+	return ParseDigits(text, length, base, magnitude);
+}
+
+RadixStatus Radix_ParseLiteralMagnitude(const char* text, size_t length, bool allowSign,
+	uint64_t& magnitude, bool& negative)
+{
+	if (!ParseSign(text, length, allowSign, negative))
+		return RadixStatus::InvalidDigit;
+	unsigned base = 10;
+	if (length >= 2 && text[0] == '0')
+	{
+		if (text[1] == 'x' || text[1] == 'X')
+			base = 16, text += 2, length -= 2;
+		else if (text[1] == 'b' || text[1] == 'B')
+			base = 2, text += 2, length -= 2;
+		else
+			base = 8, text += 1, length -= 1;
+	}
+	return ParseDigits(text, length, base, magnitude);
+}
+
+void Radix_FormatHex64Batch(const uint64_t* values, size_t count, char* out, bool uppercase)
+{
+	const char* pairs = uppercase ? UpperHexPairs : LowerHexPairs;
+	for (size_t i = 0; i < count; ++i, out += 16)
+		WriteHex(values[i], out + 16, 16, pairs);
+}
+
+size_t Radix_ParseHex64Batch(const char* text, size_t count, uint64_t* values)
+{
+	for (size_t i = 0; i < count; ++i, text += 16)
+	{
+		uint32_t high, low;
+		if (!HexValue8(text, high) || !HexValue8(text + 8, low))
+			return i;
+		values[i] = (uint64_t(high) << 32) | low;
+	}
+	return count;
+}
+
+bool Radix_IsHexDigits(const char* text, size_t length) { return IsDigits(text, length, 16); }
+bool Radix_IsBinaryDigits(const char* text, size_t length) { return IsDigits(text, length, 2); }
+bool Radix_IsDecimalDigits(const char* text, size_t length) { return IsDigits(text, length, 10); }
@@ -0,0 +1,1792 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: SelfChecks.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/ClassDeclarations.h"
+#include "../header/Bits.h"
+#include "../header/CheckedInt.h"
+#include "../header/Decimal.h"
+#include "../header/FloatBits.h"
+#include "../header/FloatCompare.h"
+#include "../header/FloatExhaustive.h"
+#include "../header/FloatFormat.h"
+#include "../header/FloatMath.h"
+#include "../header/MiniFloat.h"
+#include "../header/ParallelFor.h"
+#include "../header/Radix.h"
+#include "../header/Summation.h"
+#include "../header/VarInt.h"
+#include "../header/WideInt.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__has_include)
+#if __has_include(<charconv>) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#include <charconv>
+#endif
+#endif
+
+namespace
+{
+	// Collects failures from many threads, keeping the first few as examples.
+	class FailureLog
+	{
+	public:
+		FailureLog() : m_count(0) {}
+
+		void Add(const std::string& description)
+		{
+			if (m_count.fetch_add(1) < 10)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_examples.push_back(description);
+			}
+		}
+
+		bool Report(const char* name, uint64_t checked, double seconds)
+		{
+			uint64_t failures = m_count.load();
+			std::cout << name << ": " << checked << " values in " << seconds << " s, "
+				<< failures << (failures == 1 ? " failure\n" : " failures\n");
+			for (const std::string& example : m_examples)
+				std::cout << "  " << example << '\n';
+			return failures == 0;
+		}
+
+	private:
+		std::atomic<uint64_t> m_count;
+		std::mutex m_mutex;
+		std::vector<std::string> m_examples;
+	};
+
+	// The Bits_ functions are usable in constant expressions.
+	static_assert(Bits_PopCount(uint8_t(0xFF)) == 8 && Bits_PopCount(0x8000000000000001ull) == 2, "Bits_PopCount");
+	static_assert(Bits_CountLeadingZeros(uint16_t(1)) == 15 && Bits_CountLeadingZeros(0u) == 32, "Bits_CountLeadingZeros");
+	static_assert(Bits_CountTrailingZeros(0x80u) == 7 && Bits_CountTrailingZeros(uint8_t(0)) == 8, "Bits_CountTrailingZeros");
+	static_assert(Bits_Width(0u) == 0 && Bits_Width(255u) == 8 && Bits_Width(256u) == 9, "Bits_Width");
+	static_assert(Bits_Reverse(uint8_t(1)) == 0x80 && Bits_ByteSwap(0x11223344u) == 0x44332211u, "Bits_Reverse, Bits_ByteSwap");
+	static_assert(Bits_Deposit(0x5u, 0x1Au) == 0x12u && Bits_Extract(0x12u, 0x1Au) == 0x5u, "Bits_Deposit, Bits_Extract");
+
+#if defined(NUMBERS_CONSTEXPR_FLOAT_BITS)
+	// So are the FloatBits.h functions, when the compiler has a constexpr bit cast.
+	static_assert(Float_ToBits(1.0f) == 0x3F800000u && Float_FromBits<double>(0x4045000000000000ull) == 42.0, "Float_ToBits, Float_FromBits");
+	static_assert(Float_FromFields<float>(true, 127 + 5, 0x0B0000) == -34.75f && Float_BiasedExponent(-34.75f) == 132, "Float_FromFields");
+	static_assert(Float_Pow2<float>(-126) == FLT_MIN && Float_Pow2<double>(-1074) == 4.9406564584124654e-324
+		&& Float_Pow2<float>(128) > FLT_MAX && Float_Pow2<float>(-150) == 0, "Float_Pow2");
+	static_assert(Float_NextUp(1.0f) == 1.0f + FLT_EPSILON && Float_NextDown(0.0) == -Float_Pow2<double>(-1074)
+		&& Float_NextUp(-Float_Pow2<float>(-149)) == 0 && Float_SignBit(Float_NextUp(-Float_Pow2<float>(-149))), "Float_NextUp, Float_NextDown");
+	static_assert(Float_Classify(FLT_MIN / 2) == FloatCategory::Subnormal && Float_IsNaN(Float_FromBits<float>(0x7FC00000u))
+		&& Float_IsInfinite(Float_NextUp(DBL_MAX)) && !Float_IsFinite(Float_NextUp(FLT_MAX)), "Float_Classify");
+#endif
+
+	// Float_NextUp and Float_NextDown against std::nextafter, and taking value apart into its fields and back.
+	template <typename T>
+	bool CheckFloatBits(T value)
+	{
+		const T up = Float_NextUp(value), down = Float_NextDown(value);
+		const T expectedUp = std::nextafter(value, std::numeric_limits<T>::infinity());
+		const T expectedDown = std::nextafter(value, -std::numeric_limits<T>::infinity());
+		if (std::isnan(value))
+			return std::isnan(up) && std::isnan(down) && Float_IsNaN(value) && !Float_IsFinite(value);
+		return Float_ToBits(up) == Float_ToBits(expectedUp) && Float_ToBits(down) == Float_ToBits(expectedDown)
+			&& Float_ToBits(Float_FromFields<T>(Float_SignBit(value), Float_BiasedExponent(value), Float_Significand(value))) == Float_ToBits(value)
+			&& Float_SignBit(value) == std::signbit(value) && Float_IsInfinite(value) == std::isinf(value)
+			&& Float_IsFinite(value) == std::isfinite(value) && !Float_IsNaN(value);
+	}
+
+	static_assert(VarInt_ZigZagEncode(0) == 0 && VarInt_ZigZagEncode(-1) == 1 && VarInt_ZigZagEncode(1) == 2
+		&& VarInt_ZigZagEncode(INT32_MIN) == UINT32_MAX && VarInt_ZigZagDecode(UINT64_MAX) == INT64_MIN, "VarInt_ZigZag");
+	static_assert(VarInt_LEB128Size(127) == 1 && VarInt_LEB128Size(128) == 2 && VarInt_LEB128Size(UINT64_MAX) == 10, "VarInt_LEB128Size");
+
+	// LEB128 one byte at a time, as the format is usually described.
+	void NaiveLEB128(uint64_t value, std::vector<uint8_t>& out)
+	{
+		do
+		{
+			uint8_t byte = value & 0x7F;
+			value >>= 7;
+			out.push_back(static_cast<uint8_t>(byte | (value != 0 ? 0x80 : 0)));
+		} while (value != 0);
+	}
+
+	// Bit-by-bit references for the Bits_ functions.
+	uint64_t NaiveDeposit(uint64_t value, uint64_t mask)
+	{
+		uint64_t result = 0;
+		for (int bit = 0, next = 0; bit < 64; ++bit)
+			if ((mask >> bit) & 1)
+				result |= ((value >> next++) & 1) << bit;
+		return result;
+	}
+
+	uint64_t NaiveExtract(uint64_t value, uint64_t mask)
+	{
+		uint64_t result = 0;
+		for (int bit = 0, next = 0; bit < 64; ++bit)
+			if ((mask >> bit) & 1)
+				result |= ((value >> bit) & 1) << next++;
+		return result;
+	}
+
+	template <typename T>
+	bool CheckBitsOf(T value, T mask)
+	{
+		const int width = static_cast<int>(sizeof(T) * 8);
+		int popCount = 0, leadingZeros = width, trailingZeros = width;
+		uint64_t reversed = 0, swapped = 0;
+		for (int bit = 0; bit < width; ++bit)
+			if ((value >> bit) & 1)
+			{
+				++popCount;
+				leadingZeros = width - 1 - bit;
+				trailingZeros = std::min(trailingZeros, bit);
+				reversed |= uint64_t(1) << (width - 1 - bit);
+			}
+		for (int byte = 0; byte < width / 8; ++byte)
+			swapped |= ((uint64_t(value) >> (8 * byte)) & 0xFF) << (width - 8 - 8 * byte);
+		return Bits_PopCount(value) == popCount && Bits_CountLeadingZeros(value) == leadingZeros
+			&& Bits_CountTrailingZeros(value) == trailingZeros && Bits_Width(value) == width - leadingZeros
+			&& Bits_Reverse(value) == reversed && Bits_ByteSwap(value) == swapped
+			&& Bits_Deposit(value, mask) == NaiveDeposit(value, mask) && Bits_Extract(value, mask) == NaiveExtract(value, mask);
+	}
+
+	// Float_CompareArrays against a loop over the scalar comparators, for every kernel, with and without
+	//  ParallelFor, on pairs that are equal, a few ulps apart, slightly or completely different, or special.
+	template <typename T, typename Bits, typename Tolerance>
+	uint64_t CheckCompareArrays(const std::vector<Tolerance>& tolerances, FailureLog& failures)
+	{
+		typedef std::numeric_limits<T> Limits;
+		const T specials[] = { T(0), -T(0), T(1), Limits::denorm_min(), Limits::max(), Limits::infinity(), -Limits::infinity(), Limits::quiet_NaN() };
+		std::mt19937_64 rng(sizeof(T));
+		std::uniform_real_distribution<T> moderate(T(-1000), T(1000));
+		uint64_t checked = 0;
+		for (size_t count : { 0, 1, 7, 61, 200000 })
+		{
+			std::vector<T> a(count), b(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				Bits bits = static_cast<Bits>(rng());
+				std::memcpy(&a[i], &bits, sizeof(bits));
+				if (rng() & 1)
+					a[i] = moderate(rng);
+				switch (rng() % 8)
+				{
+				case 0: a[i] = specials[rng() % 8]; b[i] = specials[rng() % 8]; break;
+				case 1: b[i] = a[i]; break;
+				case 2: case 3: std::memcpy(&bits, &a[i], sizeof(bits)); bits += static_cast<Bits>(rng() % 9) - 4;
+					std::memcpy(&b[i], &bits, sizeof(bits)); break;
+				case 4: b[i] = a[i] * (T(1) + T(1e-5) * moderate(rng) / T(1000)); break;
+				case 5: a[i] = T(1e-6) * moderate(rng) / T(1000); b[i] = T(0); break;
+				default: b[i] = moderate(rng); break;
+				}
+			}
+			for (const Tolerance& tolerance : tolerances)
+			{
+				std::vector<size_t> expected;
+				uint64_t maxUlps = 0;
+				size_t maxUlpsIndex = 0;
+				for (size_t i = 0; i < count; ++i)
+				{
+					bool nan = std::isnan(a[i]) || std::isnan(b[i]);
+					bool match = Float_NearlyEqualUlps(a[i], b[i], tolerance.ulps) || Float_NearlyEqual(a[i], b[i], tolerance.absolute, tolerance.relative)
+						|| (std::isnan(a[i]) && std::isnan(b[i]) && tolerance.nanMatchesNaN);
+					if (!match)
+						expected.push_back(i);
+					if (!nan && Float_UlpDistance(a[i], b[i]) > maxUlps)
+					{
+						maxUlps = Float_UlpDistance(a[i], b[i]);
+						maxUlpsIndex = i;
+					}
+				}
+				for (FloatCompareKernel kernel : { FloatCompareKernel::Scalar, FloatCompareKernel::AVX2 })
+					for (bool parallel : { false, true })
+						for (size_t maxIndices : { size_t(0), size_t(3), count })
+						{
+							std::vector<size_t> indices(maxIndices);
+							FloatArrayComparison result = Float_CompareArrays(a.data(), b.data(), count, tolerance,
+								indices.data(), maxIndices, kernel, parallel);
+							size_t stored = std::min(maxIndices, expected.size());
+							if (result.mismatches != expected.size() || result.maxUlps != maxUlps || result.maxUlpsIndex != maxUlpsIndex
+								|| result.indicesStored != stored || !std::equal(expected.begin(), expected.begin() + stored, indices.begin()))
+								failures.Add(std::string(sizeof(T) == 4 ? "float" : "double") + " arrays of " + std::to_string(count)
+									+ ", kernel " + std::to_string(static_cast<int>(kernel)) + (parallel ? ", parallel" : ""));
+						}
+				checked += count;
+			}
+		}
+		return checked;
+	}
+
+	// Checks every pair of 8-bit operands against the exact result computed in int.
+	template <typename T>
+	void CheckSmallIntPairs(FailureLog& failures)
+	{
+		const int min = IntTraits<T>::Min(), max = IntTraits<T>::Max();
+		auto clamp = [&](int exact) { return T(exact < min ? min : exact > max ? max : exact); };
+		for (int x = min; x <= max; ++x)
+			for (int y = min; y <= max; ++y)
+			{
+				T a = T(x), b = T(y), sum, difference, product;
+				bool ok = Int_AddOverflow(a, b, sum) == (clamp(x + y) != x + y) && sum == T(x + y)
+					&& Int_SubOverflow(a, b, difference) == (clamp(x - y) != x - y) && difference == T(x - y)
+					&& Int_MulOverflow(a, b, product) == (clamp(x * y) != x * y) && product == T(x * y)
+					&& Int_SaturatingAdd(a, b) == clamp(x + y) && Int_SaturatingSub(a, b) == clamp(x - y)
+					&& Int_SaturatingMul(a, b) == clamp(x * y) && (y == 0 || Int_SaturatingDiv(a, b) == clamp(x / y));
+				if (!ok)
+					failures.Add(std::string(IntTraits<T>::isSigned ? "int8 " : "uint8 ") + std::to_string(x) + ", " + std::to_string(y));
+			}
+	}
+
+	// Returns whether value formats like std::to_chars and parses back, adding a description to failures if given.
+	template <typename T, typename Bits>
+	bool CheckFloatFormat(T value, FailureLog* failures)
+	{
+		char text[FloatFormat_MaxChars];
+		size_t length = FloatFormat_Shortest(value, text, sizeof(text));
+		T back;
+		FloatFormatStatus status = FloatFormat_Parse(text, length, back);
+		Bits bits, backBits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		std::memcpy(&backBits, &back, sizeof(backBits));
+		bool ok = status == FloatFormatStatus::Ok
+			&& (std::isnan(value) ? std::isnan(back) && std::signbit(back) == std::signbit(value) : bits == backBits);
+#if defined(__cpp_lib_to_chars)
+		// std::to_chars is the reference for both the digits and the layout (its NaN spelling varies).
+		if (ok && !std::isnan(value))
+		{
+			char expected[FloatFormat_MaxChars];
+			std::to_chars_result result = std::to_chars(expected, expected + sizeof(expected), value);
+			ok = result.ptr - expected == static_cast<std::ptrdiff_t>(length) && std::memcmp(expected, text, length) == 0;
+		}
+#endif
+		if (!ok && failures)
+		{
+			char hex[2 * sizeof(Bits) + 1];
+			for (size_t i = 0; i < 2 * sizeof(Bits); ++i)
+				hex[i] = "0123456789abcdef"[(bits >> (4 * (2 * sizeof(Bits) - 1 - i))) & 0xF];
+			hex[2 * sizeof(Bits)] = '\0';
+			failures->Add(std::string("0x") + hex + " formats as " + std::string(text, length));
+		}
+		return ok;
+	}
+
+	// Parses the exact halfway point between value and the next T up, the points one unit below and above it in the
+	//  last digit, and the halfway point followed by 800 zeros and a 1: with more than 19 digits only the slow path of
+	//  FloatFormat_Parse can tell them apart. value must be positive, normal and below 2^900.
+	template <typename T, typename Bits>
+	void CheckHalfwayParse(T value, FailureLog& failures)
+	{
+		typedef WideUInt<1024> Digits;
+		const int significandBits = std::numeric_limits<T>::digits;
+		int exponent;
+		T fraction = std::frexp(value, &exponent);
+		// halfway = (2 * significand + 1) * 2^(exponent - significandBits - 1), as digits * 10^-point
+		Digits halfway(2 * static_cast<uint64_t>(std::ldexp(fraction, significandBits)) + 1);
+		int binaryExponent = exponent - significandBits - 1;
+		unsigned point = 0;
+		if (binaryExponent >= 0)
+			halfway <<= static_cast<unsigned>(binaryExponent);
+		for (; binaryExponent < 0; ++binaryExponent, ++point)
+			halfway *= Digits(5);
+		Bits bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		auto check = [&](const Digits& digits, const char* suffix, Bits expected) {
+			char buffer[WideInt_MaxChars<1024>::value];
+			std::string text(buffer, WideInt_Format(digits, 10, buffer, sizeof(buffer)));
+			if (point > 0)
+			{
+				text.insert(0, point + 1 > text.size() ? point + 1 - text.size() : 0, '0');
+				text.insert(text.size() - point, 1, '.');
+			}
+			text += suffix;
+			T parsed;
+			Bits parsedBits;
+			FloatFormatStatus status = FloatFormat_Parse(text.data(), text.size(), parsed);
+			std::memcpy(&parsedBits, &parsed, sizeof(parsedBits));
+			if (status != FloatFormatStatus::Ok || parsedBits != expected)
+				failures.Add("FloatFormat_Parse of " + text.substr(0, 60) + (text.size() > 60 ? "..." : ""));
+		};
+		const std::string sticky = (point > 0 ? "" : ".") + std::string(800, '0') + "1";
+		check(halfway, "", bits + (bits & 1));
+		check(halfway - Digits(1), "", bits);
+		check(halfway + Digits(1), "", bits + 1);
+		check(halfway, sticky.c_str(), bits + 1);
+	}
+
+	// The shape of a MiniFloat.h format, for the reference conversions below.
+	struct MiniFormat
+	{
+		int exponentBits;
+		int significandBits;
+		bool infinities;
+
+		int Bias() const { return (1 << (exponentBits - 1)) - 1; }
+		uint32_t SignBit() const { return 1u << (exponentBits + significandBits); }
+		uint32_t Infinity() const { return ((1u << exponentBits) - 1) << significandBits; }
+		uint32_t MaxFinite() const { return infinities ? Infinity() - 1 : SignBit() - 2; }
+		bool IsNaN(uint32_t bits) const
+		{
+			uint32_t magnitude = bits & (SignBit() - 1);
+			return infinities ? magnitude > Infinity() : magnitude == SignBit() - 1;
+		}
+	};
+
+	// 2^exponent, for exponents in the normal range of double.
+	double Pow2(int exponent)
+	{
+		uint64_t bits = static_cast<uint64_t>(1023 + exponent) << 52;
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// Rounds value to the format the slow way, independently of MiniFloat.cpp's tables and kernels: scale |value| to a
+	//  count of the format's ulps in double, where it is exact, and round that count to nearest even by adding and
+	//  subtracting 2^52. exponent is the one std::frexp gives for |value|.
+	// Returns the bit pattern, or ~0u for a NaN (the NaN payload is left to the kernel comparison).
+	uint32_t ReferenceNarrow(float value, int exponent, const MiniFormat& format, bool saturate)
+	{
+		uint32_t sign = std::signbit(value) ? format.SignBit() : 0;
+		uint32_t overflow = saturate ? format.MaxFinite() : format.infinities ? format.Infinity() : format.SignBit() - 1;
+		if (std::isnan(value))
+			return ~0u;
+		if (std::isinf(value))
+			return sign | overflow;
+		double magnitude = std::fabs(static_cast<double>(value));
+		if (magnitude == 0)
+			return sign;
+		int scale = std::max(exponent - 1, 1 - format.Bias());
+		const double shifter = 4503599627370496.0;   // 2^52
+		double rounded = magnitude * Pow2(format.significandBits - scale) + shifter;
+		uint32_t steps = static_cast<uint32_t>(rounded - shifter);
+		// steps counts ulps from the bottom of the binade's significand range, so a carry moves into the next binade.
+		uint32_t bits = (static_cast<uint32_t>(scale + format.Bias()) << format.significandBits) + steps
+			- (1u << format.significandBits);
+		return sign | (bits > format.MaxFinite() ? overflow : bits);
+	}
+
+	// The exact value of a pattern of the format (a NaN of either sign for NaNs).
+	double ReferenceWiden(uint32_t bits, const MiniFormat& format)
+	{
+		double sign = (bits & format.SignBit()) ? -1.0 : 1.0;
+		if (format.IsNaN(bits))
+			return std::copysign(std::nan(""), sign);
+		if (format.infinities && (bits & format.Infinity()) == format.Infinity())
+			return sign * HUGE_VAL;
+		int exponent = static_cast<int>((bits & (format.SignBit() - 1)) >> format.significandBits);
+		uint32_t significand = bits & ((1u << format.significandBits) - 1);
+		if (exponent == 0)
+			return sign * significand * Pow2(1 - format.Bias() - format.significandBits);
+		return sign * (significand + (1u << format.significandBits)) * Pow2(exponent - format.Bias() - format.significandBits);
+	}
+
+	// The value of c as a digit, or 36 if it is not a digit in any base.
+	unsigned NaiveDigitValue(char c)
+	{
+		return c >= '0' && c <= '9' ? unsigned(c - '0') : c >= 'a' && c <= 'z' ? unsigned(c - 'a' + 10)
+			: c >= 'A' && c <= 'Z' ? unsigned(c - 'A' + 10) : 36u;
+	}
+
+	std::string NaiveFormat(uint64_t magnitude, bool negative, unsigned base, bool uppercase)
+	{
+		std::string digits;
+		do
+		{
+			unsigned digit = static_cast<unsigned>(magnitude % base);
+			digits.insert(digits.begin(), static_cast<char>(digit < 10 ? '0' + digit : (uppercase ? 'A' : 'a') + digit - 10));
+			magnitude /= base;
+		} while (magnitude != 0);
+		return negative ? "-" + digits : digits;
+	}
+
+	// Radix_Parse the slow way: one digit at a time into 128 bits, then the range check for T.
+	template <typename T>
+	RadixStatus NaiveParse(const std::string& text, unsigned base, T& value)
+	{
+		if (base < 2 || base > 36)
+			return RadixStatus::InvalidBase;
+		size_t i = 0;
+		bool negative = false;
+		if (!text.empty() && (text[0] == '+' || text[0] == '-'))
+		{
+			if (text[0] == '-' && !std::is_signed<T>::value)
+				return RadixStatus::InvalidDigit;
+			negative = text[i++] == '-';
+		}
+		if (i == text.size())
+			return RadixStatus::Empty;
+		UInt128 magnitude;
+		bool tooBig = false;
+		for (; i < text.size(); ++i)
+		{
+			unsigned digit = NaiveDigitValue(text[i]);
+			if (digit >= base)
+				return RadixStatus::InvalidDigit;
+			tooBig |= magnitude.MultiplyAddWord(base, digit) != 0 || magnitude.Word(1) != 0;
+		}
+		UInt128 limit(static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0));
+		if (tooBig || magnitude > limit)
+			return RadixStatus::OutOfRange;
+		value = static_cast<T>(negative ? uint64_t(0) - magnitude.Word(0) : magnitude.Word(0));
+		return RadixStatus::Ok;
+	}
+
+	// Radix_ParseLiteral the slow way: the sign, then the prefix, then NaiveParse of the digits in that base.
+	template <typename T>
+	RadixStatus NaiveParseLiteral(const std::string& text, T& value)
+	{
+		size_t i = !text.empty() && (text[0] == '+' || text[0] == '-') ? 1 : 0;
+		std::string sign = text.substr(0, i), digits = text.substr(i);
+		unsigned base = 10;
+		if (digits.size() >= 2 && digits[0] == '0')
+		{
+			bool hex = digits[1] == 'x' || digits[1] == 'X', binary = digits[1] == 'b' || digits[1] == 'B';
+			base = hex ? 16 : binary ? 2 : 8;
+			digits.erase(0, hex || binary ? 2 : 1);
+		}
+		// A second sign after the prefix is not a digit.
+		if (!digits.empty() && (digits[0] == '+' || digits[0] == '-'))
+			return RadixStatus::InvalidDigit;
+		return NaiveParse(sign + digits, base, value);
+	}
+
+	// Radix_Format and Radix_Parse of type T against the naive versions, in every base, on random values written
+	//  correctly and then spoiled: leading zeros, signs, case, stray characters, extra digits and bad bases.
+	template <typename T>
+	uint64_t CheckRadixType(std::mt19937_64& rng, FailureLog& failures)
+	{
+		const std::string name = std::string(std::is_signed<T>::value ? "int" : "uint") + std::to_string(sizeof(T) * 8);
+		const char strays[] = { '/', ':', '@', '[', '`', '{', ' ', '.', '_', '\0', '\x80', '\xff', 'z', 'Z', '-', '+' };
+		uint64_t checked = 0;
+		for (int i = 0; i < 40000; ++i)
+		{
+			T value = static_cast<T>(rng() >> (rng() % 64));
+			if (std::is_signed<T>::value && (rng() & 1))
+				value = static_cast<T>(uint64_t(0) - static_cast<uint64_t>(value));
+			if (i < 4)
+				value = i < 2 ? std::numeric_limits<T>::min() + T(i) : std::numeric_limits<T>::max() - T(i - 2);
+			unsigned base = 2 + static_cast<unsigned>(rng() % 35);
+			bool uppercase = (rng() & 1) != 0;
+			bool negative = std::is_signed<T>::value && value < T(0);
+			uint64_t magnitude = negative ? uint64_t(0) - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+			std::string expected = NaiveFormat(magnitude, negative, base, uppercase);
+
+			char text[Radix_MaxChars];
+			size_t length = Radix_Format(value, base, text, sizeof(text), uppercase);
+			bool ok = std::string(text, length) == expected
+				&& Radix_Format(value, base, text, expected.size() - 1, uppercase) == 0
+				&& Radix_Format(value, (rng() & 1) ? 1u : 37u, text, sizeof(text)) == 0;
+			if (!ok)
+				failures.Add(name + " format " + expected + " in base " + std::to_string(base));
+
+			std::string spoiled = expected;
+			switch (rng() % 8)
+			{
+			case 0: spoiled.insert(negative ? 1 : 0, rng() % 70, '0'); break;
+			case 1: spoiled[rng() % spoiled.size()] = strays[rng() % sizeof(strays)]; break;
+			case 2: spoiled.insert(spoiled.begin() + rng() % (spoiled.size() + 1), strays[rng() % sizeof(strays)]); break;
+			case 3: spoiled += NaiveFormat(rng() % base, false, base, !uppercase); break;
+			case 4: spoiled += std::string(rng() % 3 + 1, NaiveFormat(base - 1, false, base, false)[0]); break;
+			case 5: spoiled = spoiled.substr(0, negative ? 1 : 0) + ((rng() & 1) ? "" : "+"); break;
+			case 6: spoiled.insert(0, (rng() & 1) ? "+" : "-"); break;
+			default: break;
+			}
+			unsigned parseBase = rng() % 64 == 0 ? static_cast<unsigned>(rng() % 40) : base;
+			T parsed = T(7), reference = T(7);
+			RadixStatus status = Radix_Parse(spoiled.data(), spoiled.size(), parseBase, parsed);
+			RadixStatus expectedStatus = NaiveParse(spoiled, parseBase, reference);
+			if (status != expectedStatus || parsed != reference)
+				failures.Add(name + " parse \"" + spoiled + "\" in base " + std::to_string(parseBase) + " gives status "
+					+ std::to_string(static_cast<int>(status)) + ", expected " + std::to_string(static_cast<int>(expectedStatus)));
+
+			// The same digits as a C++ literal, sometimes with the digits missing after the prefix.
+			unsigned literalBase = base == 16 || base == 2 || base == 8 ? base : 10;
+			std::string prefix = literalBase == 16 ? ((rng() & 1) ? "0x" : "0X") : literalBase == 2 ? ((rng() & 1) ? "0b" : "0B")
+				: literalBase == 8 ? "0" : "";
+			std::string literal = (negative ? "-" : "") + prefix + (rng() % 8 == 0 ? "" : NaiveFormat(magnitude, false, literalBase, uppercase));
+			T literalValue = T(7), literalReference = T(7);
+			RadixStatus literalStatus = Radix_ParseLiteral(literal.data(), literal.size(), literalValue);
+			RadixStatus literalExpected = NaiveParseLiteral(literal, literalReference);
+			if (literalStatus != literalExpected || literalValue != literalReference)
+				failures.Add(name + " literal \"" + literal + "\"");
+			checked += 3;
+		}
+		return checked;
+	}
+
+	// Fixed point with fractionBits bits below the point, for the exact sums of the Summation check. value must be
+	//  a multiple of 2^-fractionBits small enough to fit.
+	Int256 ToFixedPoint(double value, int fractionBits)
+	{
+		if (value == 0)
+			return Int256(0);
+		int exponent;
+		double fraction = std::frexp(value, &exponent);
+		Int256 significand(static_cast<int64_t>(std::ldexp(fraction, 53)));
+		int shift = exponent - 53 + fractionBits;
+		return shift >= 0 ? significand << static_cast<unsigned>(shift) : significand >> static_cast<unsigned>(-shift);
+	}
+
+	double FromFixedPoint(const Int256& value, int fractionBits)
+	{
+		UInt256 magnitude = value.Magnitude();
+		double result = 0;
+		for (unsigned i = UInt256::Words; i-- > 0;)
+			result = std::ldexp(result, 64) + static_cast<double>(magnitude.Word(i));
+		return std::ldexp(value.IsNegative() ? -result : result, -fractionBits);
+	}
+
+	// Sum_Floats and Sum_DotProduct of every method: the kernels must agree bit for bit, and the error against the
+	//  exact sum must stay within Sum_ErrorBound. Terms lie between 2^-30 and 2^30 in magnitude, so every sum and
+	//  product is exact in 256-bit fixed point with 120 fractional bits.
+	uint64_t CheckSummation(const std::vector<float>& a, const std::vector<float>& b, const std::string& data, FailureLog& failures)
+	{
+		const int fractionBits = 120;
+		const size_t count = a.size();
+		Int256 exactSum, exactDot, magnitudes, productMagnitudes;
+		for (size_t i = 0; i < count; ++i)
+		{
+			Int256 x = ToFixedPoint(a[i], fractionBits), product = ToFixedPoint(static_cast<double>(a[i]) * b[i], fractionBits);
+			exactSum += x;
+			exactDot += product;
+			magnitudes += Int256::FromBits(x.Magnitude());
+			productMagnitudes += Int256::FromBits(product.Magnitude());
+		}
+		const char* names[] = { "Naive", "Kahan", "Neumaier", "Pairwise", "Cascaded" };
+		for (SumMethod method : { SumMethod::Naive, SumMethod::Kahan, SumMethod::Neumaier, SumMethod::Pairwise, SumMethod::Cascaded })
+		{
+			double sum = Sum_Floats(a.data(), count, method, SumKernel::Scalar);
+			double dot = Sum_DotProduct(a.data(), b.data(), count, method, SumKernel::Scalar);
+			double sumError = std::fabs(FromFixedPoint(ToFixedPoint(sum, fractionBits) - exactSum, fractionBits));
+			double dotError = std::fabs(FromFixedPoint(ToFixedPoint(dot, fractionBits) - exactDot, fractionBits));
+			double sumBound = Sum_ErrorBound(method, count, FromFixedPoint(magnitudes, fractionBits));
+			double dotBound = Sum_ErrorBound(method, count, FromFixedPoint(productMagnitudes, fractionBits), true);
+			const std::string what = std::string(names[static_cast<int>(method)]) + ", " + data + ", " + std::to_string(count) + " terms";
+			if (sumError > sumBound)
+			{
+				std::ostringstream message;
+				message << "Sum_Floats " << what << ": error " << sumError << " above the bound " << sumBound;
+				failures.Add(message.str());
+			}
+			if (dotError > dotBound)
+			{
+				std::ostringstream message;
+				message << "Sum_DotProduct " << what << ": error " << dotError << " above the bound " << dotBound;
+				failures.Add(message.str());
+			}
+			for (SumKernel kernel : { SumKernel::SSE2, SumKernel::AVX2 })
+			{
+				double kernelSum = Sum_Floats(a.data(), count, method, kernel);
+				double kernelDot = Sum_DotProduct(a.data(), b.data(), count, method, kernel);
+				if (std::memcmp(&kernelSum, &sum, sizeof(sum)) != 0 || std::memcmp(&kernelDot, &dot, sizeof(dot)) != 0)
+					failures.Add("kernel " + std::to_string(static_cast<int>(kernel)) + " differs from scalar, " + what);
+			}
+		}
+		return 5 * count;
+	}
+
+	// Decimal units widened to 256 bits, where every product and scaled dividend of the checks below is exact.
+	Int256 WidenUnits(int64_t units) { return Int256(units); }
+
+	Int256 WidenUnits(const Int128& units)
+	{
+		UInt256 bits(units.ToBits());
+		if (units.IsNegative())
+		{
+			bits.SetWord(2, ~uint64_t(0));
+			bits.SetWord(3, ~uint64_t(0));
+		}
+		return Int256::FromBits(bits);
+	}
+
+	// Narrows value to the representation, returning false if it does not fit.
+	bool NarrowUnits(const Int256& value, int64_t& units)
+	{
+		if (value < Int256(INT64_MIN) || value > Int256(INT64_MAX))
+			return false;
+		units = static_cast<int64_t>(value.ToBits().Word(0));
+		return true;
+	}
+
+	bool NarrowUnits(const Int256& value, Int128& units)
+	{
+		if (value < WidenUnits(Int128::Min()) || value > WidenUnits(Int128::Max()))
+			return false;
+		units = Int128::FromBits(UInt128(value.ToBits()));
+		return true;
+	}
+
+	std::string WideText(const Int256& value)
+	{
+		char text[WideInt_MaxChars<256>::value];
+		return std::string(text, WideInt_Format(value, 10, text, sizeof(text)));
+	}
+
+	// numerator / denominator rounded with mode, the slow and obvious way. denominator must be positive.
+	Int256 ReferenceRound(const Int256& numerator, const Int256& denominator, RoundingMode mode)
+	{
+		Int256 quotient = numerator / denominator, remainder = numerator % denominator;
+		if (remainder == Int256(0))
+			return quotient;
+		bool negative = numerator < Int256(0);
+		Int256 twice = (negative ? -remainder : remainder) * Int256(2), away = Int256(negative ? -1 : 1);
+		bool odd = quotient.ToBits().Bit(0);
+		switch (mode)
+		{
+		case RoundingMode::HalfEven: return twice > denominator || (twice == denominator && odd) ? quotient + away : quotient;
+		case RoundingMode::HalfAwayFromZero: return twice >= denominator ? quotient + away : quotient;
+		case RoundingMode::Floor: return negative ? quotient - Int256(1) : quotient;
+		case RoundingMode::Ceiling: return negative ? quotient : quotient + Int256(1);
+		default: return quotient;
+		}
+	}
+
+	const RoundingMode AllRoundingModes[] = { RoundingMode::HalfEven, RoundingMode::HalfAwayFromZero,
+		RoundingMode::TowardZero, RoundingMode::Floor, RoundingMode::Ceiling };
+
+	// Checks one Decimal_Multiply or Decimal_Divide result against the exact quotient: the units must match when
+	//  the rounded quotient fits, and the overflow flag must be set exactly when it does not.
+	template <typename Decimal>
+	bool CheckDecimalResult(Decimal result, bool overflow, const Int256& numerator, const Int256& denominator,
+		RoundingMode mode)
+	{
+		typename Decimal::rep_type expected;
+		bool fits = NarrowUnits(ReferenceRound(numerator, denominator, mode), expected);
+		return overflow == !fits && (!fits || result.Units() == expected);
+	}
+
+	// Decimal128 has only the generic loop.
+	template <typename Decimal>
+	void CheckDecimalBatch(const std::vector<Decimal>& as, const std::vector<Decimal>& bs, const std::vector<Decimal>& products,
+		bool anyOverflow, RoundingMode mode, const std::string& name, FailureLog& failures)
+	{
+		std::vector<Decimal> out(as.size());
+		bool overflow = false;
+		Decimal_MultiplyBatch(as.data(), bs.data(), out.data(), as.size(), mode, &overflow);
+		if (out != products || overflow != anyOverflow)
+			failures.Add(name + " Decimal_MultiplyBatch, mode " + std::to_string(static_cast<int>(mode)));
+	}
+
+	// Decimal64 has the batch kernels, and Decimal_SumProducts.
+	template <int Scale>
+	void CheckDecimalBatch(const std::vector<Decimal64<Scale>>& as, const std::vector<Decimal64<Scale>>& bs,
+		const std::vector<Decimal64<Scale>>& products, bool anyOverflow, RoundingMode mode, const std::string& name, FailureLog& failures)
+	{
+		for (DecimalKernel kernel : { DecimalKernel::Scalar, DecimalKernel::AVX2 })
+			for (size_t length : { as.size(), size_t(13), size_t(3) })
+			{
+				std::vector<Decimal64<Scale>> out(bs.begin(), bs.begin() + length);
+				bool overflow = false, expectedOverflow = length == as.size() && anyOverflow;
+				for (size_t i = 0; i < length && length != as.size(); ++i)
+					Decimal_Multiply(as[i], bs[i], mode, &expectedOverflow);
+				// In place, over b.
+				Decimal_MultiplyBatch(as.data(), out.data(), out.data(), length, mode, &overflow, kernel);
+				if (!std::equal(out.begin(), out.end(), products.begin()) || overflow != expectedOverflow)
+					failures.Add(name + " Decimal_MultiplyBatch, kernel " + std::to_string(static_cast<int>(kernel)) + ", mode "
+						+ std::to_string(static_cast<int>(mode)) + ", length " + std::to_string(length));
+			}
+
+		// Runs of products summed exactly, including runs whose partial sums go far beyond 128 bits.
+		const Int256 unit = WidenUnits(Decimal64<Scale>::Unit());
+		for (size_t begin = 0; begin < as.size(); begin += 97)
+		{
+			size_t length = std::min<size_t>(as.size() - begin, 1 + begin % 200);
+			Int256 exact;
+			for (size_t i = begin; i < begin + length; ++i)
+				exact += WidenUnits(as[i].Units()) * WidenUnits(bs[i].Units());
+			bool overflow = false;
+			Decimal64<Scale> sum = Decimal_SumProducts(as.data() + begin, bs.data() + begin, length, mode, &overflow);
+			if (!CheckDecimalResult(sum, overflow, exact, unit, mode))
+				failures.Add(name + " Decimal_SumProducts of " + std::to_string(length) + " from " + std::to_string(begin)
+					+ ", mode " + std::to_string(static_cast<int>(mode)));
+		}
+	}
+
+	// Decimal_Multiply, Decimal_Divide, the batch kernels and Decimal_SumProducts (for Decimal64) against
+	//  ReferenceRound, on random operands and on operands whose results round to the edges of the representation.
+	template <typename Decimal>
+	uint64_t CheckDecimalArithmetic(std::mt19937_64& rng, FailureLog& failures)
+	{
+		typedef typename Decimal::rep_type Rep;
+		const int bits = sizeof(Rep) * 8;
+		const Int256 unit = WidenUnits(Decimal::Unit());
+		const std::string name = std::string(bits == 64 ? "Decimal64<" : "Decimal128<") + std::to_string(WideText(unit).size() - 1) + ">";
+		// A random value of up to the full width, either sign.
+		auto random = [&] {
+			UInt256 magnitude(rng());
+			if (bits == 128)
+				magnitude = (magnitude << 64) | UInt256(rng());
+			magnitude >>= static_cast<unsigned>(rng() % bits) + 1;
+			Int256 value = Int256::FromBits(magnitude);
+			return (rng() & 1) ? -value : value;
+		};
+		const Int256 low = WidenUnits(IntTraits<Rep>::Min()), high = WidenUnits(IntTraits<Rep>::Max());
+		const Int256 specials[] = { Int256(0), Int256(1), Int256(-1), unit, -unit, unit + Int256(1), -unit - Int256(1), low, high, low + Int256(1) };
+		// Targets for quotients that round to the most negative value, to 2^(bits - 1) and to 2^bits.
+		const Int256 edges[] = { high, -high, high + Int256(1), -high - Int256(1), -high - Int256(2),
+			(high + Int256(1)) * Int256(2), -(high + Int256(1)) * Int256(2) };
+
+		const size_t count = 20000;
+		std::vector<Decimal> as, bs;
+		for (size_t i = 0; i < count; ++i)
+		{
+			Int256 a = random(), b = random();
+			switch (rng() % 8)
+			{
+			case 0: a = specials[rng() % 10]; break;
+			case 1: b = specials[rng() % 10]; break;
+			case 2:
+			case 3:
+			{
+				// a * b / unit lands within a few units of an edge, with a fraction in between.
+				const Int256& edge = edges[rng() % 7];
+				b = unit * Int256(2) + Int256(static_cast<int64_t>(rng() % 1000));
+				a = edge * unit / b + Int256(static_cast<int64_t>(rng() % 7) - 3);
+				break;
+			}
+			case 4:
+			{
+				// a * unit / b lands near an edge.
+				const Int256& edge = edges[rng() % 7];
+				b = Int256(static_cast<int64_t>(rng() % 1000) + 1);
+				a = edge * b / unit + Int256(static_cast<int64_t>(rng() % 7) - 3);
+				break;
+			}
+			default: break;
+			}
+			Rep ra, rb;
+			if (NarrowUnits(a, ra) && NarrowUnits(b, rb))
+			{
+				as.push_back(Decimal::FromUnits(ra));
+				bs.push_back(Decimal::FromUnits(rb));
+			}
+		}
+
+		for (RoundingMode mode : AllRoundingModes)
+		{
+			std::vector<Decimal> products(as.size());
+			bool anyOverflow = false;
+			for (size_t i = 0; i < as.size(); ++i)
+			{
+				Int256 a = WidenUnits(as[i].Units()), b = WidenUnits(bs[i].Units());
+				bool overflow = false;
+				products[i] = Decimal_Multiply(as[i], bs[i], mode, &overflow);
+				anyOverflow |= overflow;
+				if (!CheckDecimalResult(products[i], overflow, a * b, unit, mode))
+					failures.Add(name + " multiply " + WideText(a) + " * " + WideText(b) + ", mode " + std::to_string(static_cast<int>(mode)));
+				if (b == Int256(0))
+					continue;
+				overflow = false;
+				Decimal quotient = Decimal_Divide(as[i], bs[i], mode, &overflow);
+				Int256 numerator = a * unit;
+				if (!CheckDecimalResult(quotient, overflow, b < Int256(0) ? -numerator : numerator, b < Int256(0) ? -b : b, mode))
+					failures.Add(name + " divide " + WideText(a) + " / " + WideText(b) + ", mode " + std::to_string(static_cast<int>(mode)));
+			}
+			CheckDecimalBatch(as, bs, products, anyOverflow, mode, name, failures);
+		}
+		return 5 * as.size();
+	}
+
+	// Parse against the exact value of the text: well-formed numbers with up to Scale + 4 fractional digits, near the
+	//  limits of the representation as well as small, then malformed and out-of-range text that must be rejected.
+	template <typename Decimal>
+	uint64_t CheckDecimalParse(std::mt19937_64& rng, FailureLog& failures)
+	{
+		typedef typename Decimal::rep_type Rep;
+		const Int256 unit = WidenUnits(Decimal::Unit());
+		const int scale = static_cast<int>(WideText(unit).size()) - 1;
+		const std::string name = std::string(sizeof(Rep) == 8 ? "Decimal64<" : "Decimal128<") + std::to_string(scale) + ">";
+		const Int256 high = WidenUnits(IntTraits<Rep>::Max());
+		uint64_t checked = 0;
+		for (int i = 0; i < 20000; ++i)
+		{
+			int fraction = static_cast<int>(rng() % (scale + 5));
+			Int256 power(1);
+			for (int k = 0; k < fraction; ++k)
+				power *= Int256(10);
+			// The digits as an integer, fraction of them after the point: either small, or near the largest
+			//  magnitude at this many fractional digits.
+			Int256 digits;
+			if (rng() & 1)
+				digits = Int256(static_cast<int64_t>(rng() >> (rng() % 64 + 1)));
+			else
+				digits = high * power / unit + Int256(static_cast<int64_t>(rng() % 2001) - 1000);
+			if (digits < Int256(0))
+				digits = Int256(0);
+			bool negative = (rng() & 1) != 0;
+			std::string text = WideText(digits);
+			if (text.size() <= static_cast<size_t>(fraction))
+				text.insert(0, fraction + 1 - text.size(), '0');
+			if (fraction > 0)
+				text.insert(text.size() - fraction, ".");
+			text.insert(0, negative ? "-" : (rng() & 1) ? "+" : "");
+
+			Int256 numerator = negative ? -digits : digits;
+			for (RoundingMode mode : AllRoundingModes)
+			{
+				// The units are digits * 10^(scale - fraction), or digits / 10^(fraction - scale) rounded.
+				Int256 exact = fraction <= scale ? numerator * (unit / power) : ReferenceRound(numerator, power / unit, mode);
+				Rep expected;
+				bool fits = NarrowUnits(exact, expected);
+				Decimal value = Decimal::FromUnits(Rep(7));
+				bool parsed = Decimal::Parse(text.data(), text.size(), value, mode);
+				if (parsed != fits || (fits && value.Units() != expected) || (!fits && value.Units() != Rep(7)))
+					failures.Add(name + " parse " + text + ", mode " + std::to_string(static_cast<int>(mode)));
+				else if (fits)
+				{
+					// Format writes the units back with exactly Scale digits, which parse to the same units.
+					char formatted[64];
+					size_t length = value.Format(formatted, sizeof(formatted));
+					Decimal back;
+					if (!Decimal::Parse(formatted, length, back) || back != value)
+						failures.Add(name + " format " + std::string(formatted, length));
+				}
+				++checked;
+			}
+		}
+
+		const char* malformed[] = { "", "-", "+", ".", "-.", "+.", "1.2.3", "1a", " 1", "1 ", "--1", "+-1", "1e5", "0x10",
+			"1,5", "\xd9\xa1" };
+		for (const char* text : malformed)
+		{
+			Decimal value = Decimal::FromUnits(Rep(7));
+			if (Decimal::Parse(text, std::strlen(text), value) || value.Units() != Rep(7))
+				failures.Add(name + " parse accepted \"" + text + "\"");
+			++checked;
+		}
+		// One past the largest magnitude of each sign, with and without fractional digits.
+		std::string top = WideText(high + Int256(1)), bottom = WideText(-high - Int256(2));
+		for (const std::string& digits : { top, bottom })
+		{
+			std::string text = digits.substr(0, digits.size() - scale) + (scale > 0 ? "." + digits.substr(digits.size() - scale) : "");
+			Decimal value;
+			if (Decimal::Parse(text.data(), text.size(), value))
+				failures.Add(name + " parse accepted " + text);
+			++checked;
+		}
+		return checked;
+	}
+
+	// FromDouble against ReferenceRound on dyadic values small enough that value * 10^Scale is exact in double, the
+	//  edges of Rep at scale 0, and NaN, infinities and far out-of-range values, which must set the overflow flag.
+	template <typename Decimal>
+	uint64_t CheckDecimalFromDouble(std::mt19937_64& rng, FailureLog& failures)
+	{
+		typedef typename Decimal::rep_type Rep;
+		const Int256 unit = WidenUnits(Decimal::Unit());
+		const int scale = static_cast<int>(WideText(unit).size()) - 1;
+		const std::string name = std::string(sizeof(Rep) == 8 ? "Decimal64<" : "Decimal128<") + std::to_string(scale) + ">";
+		const int bits = static_cast<int>(sizeof(Rep) * 8);
+		const double limit = std::ldexp(1.0, bits - 1), unitValue = std::pow(10.0, scale);
+		uint64_t checked = 0;
+		auto check = [&](double value, RoundingMode mode, bool fits, const Int256& expected) {
+			bool overflow = false;
+			Decimal result = Decimal::FromDouble(value, mode, &overflow);
+			if (overflow == fits || (fits && WidenUnits(result.Units()) != expected) || (!fits && result.Units() != Rep(0)))
+			{
+				std::ostringstream message;
+				message << name << " FromDouble(" << value << "), mode " << static_cast<int>(mode);
+				failures.Add(message.str());
+			}
+			++checked;
+		};
+
+		if (scale <= 4)
+			for (int i = 0; i < 20000; ++i)
+			{
+				int64_t numerator = static_cast<int64_t>(rng() >> 28) - (int64_t(1) << 35);
+				int shift = static_cast<int>(rng() % 11);
+				double value = std::ldexp(static_cast<double>(numerator), -shift);
+				for (RoundingMode mode : AllRoundingModes)
+					check(value, mode, true, ReferenceRound(Int256(numerator) * unit, Int256(int64_t(1) << shift), mode));
+			}
+		if (scale == 0)
+		{
+			// -2^(bits - 1) fits, 2^(bits - 1) does not, and the double below it is 2^(bits - 54) less.
+			const Int256 top = Int256::FromBits(UInt256(1) << static_cast<unsigned>(bits - 1));
+			const Int256 step = Int256::FromBits(UInt256(1) << static_cast<unsigned>(bits - 54));
+			for (RoundingMode mode : AllRoundingModes)
+			{
+				check(-limit, mode, true, Int256(0) - top);
+				check(limit, mode, false, Int256());
+				check(std::nextafter(limit, 0.0), mode, true, top - step);
+			}
+		}
+		const double rejected[] = { std::numeric_limits<double>::quiet_NaN(), HUGE_VAL, -HUGE_VAL, 2 * limit / unitValue,
+			-2 * limit / unitValue, 1e300, -1e300 };
+		for (double value : rejected)
+			for (RoundingMode mode : AllRoundingModes)
+				check(value, mode, false, Int256());
+		return checked;
+	}
+}
+
+bool SelfChecks::RunAll()
+{
+	bool ok = RadixCheck();
+	ok = FloatFormatCheck() && ok;
+	ok = SummationCheck() && ok;
+	ok = FloatClassifyCheck() && ok;
+	ok = FloatBitsCheck() && ok;
+	ok = UlpHarnessCheck() && ok;
+	ok = CheckedIntCheck() && ok;
+	ok = DecimalCheck() && ok;
+	ok = MiniFloatCheck() && ok;
+	ok = FloatCompareCheck() && ok;
+	ok = BitsCheck() && ok;
+	ok = VarIntCheck() && ok;
+	ok = FloatMathCheck() && ok;
+	std::cout << (ok ? "All checks passed.\n" : "Some checks FAILED.\n");
+	return ok;
+}
+
+bool SelfChecks::FloatFormatCheck()
+{
+	// Every one of the 2^32 float bit patterns: shortest text, parsed back, must give the same bits.
+	FloatExhaustiveResult floats = FloatExhaustive_Check([](float value) { return CheckFloatFormat<float, uint32_t>(value, nullptr); });
+	bool ok = FloatExhaustive_Report("FloatFormat, all floats", floats);
+
+	// Doubles cannot be enumerated; random bit patterns, half of them with exponents near 1, stand in.
+	FailureLog doubleFailures;
+	auto start = std::chrono::steady_clock::now();
+	const size_t doubleCount = 1 << 24;
+	ParallelFor(doubleCount >> 16, 1, [&](size_t begin, size_t end) {
+		std::mt19937_64 rng(begin);
+		for (size_t i = begin << 16; i < (end << 16); ++i)
+		{
+			uint64_t bits = rng();
+			if (i & 1)
+				bits = (bits & 0x800FFFFFFFFFFFFFull) | (uint64_t(1023 - 40 + rng() % 80) << 52);
+			double value;
+			std::memcpy(&value, &bits, sizeof(value));
+			CheckFloatFormat<double, uint64_t>(value, &doubleFailures);
+		}
+	});
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	ok = doubleFailures.Report("FloatFormat, random doubles", doubleCount, elapsed.count()) && ok;
+
+	// Values between 2^-300 and 2^900 (every normal float), four halfway cases each.
+	FailureLog halfwayFailures;
+	start = std::chrono::steady_clock::now();
+	const size_t halfwayCount = 20000;
+	std::mt19937_64 rng(7);
+	for (size_t i = 0; i < halfwayCount; ++i)
+	{
+		uint64_t bits = rng();
+		if (i & 1)
+		{
+			uint32_t floatBits = static_cast<uint32_t>((bits & 0x7FFFFF) | ((1 + bits % 0xFE) << 23));
+			float value;
+			std::memcpy(&value, &floatBits, sizeof(value));
+			CheckHalfwayParse<float, uint32_t>(value, halfwayFailures);
+		}
+		else
+		{
+			bits = (bits & 0xFFFFFFFFFFFFFull) | (uint64_t(1023 - 300 + (bits >> 52) % 1200) << 52);
+			double value;
+			std::memcpy(&value, &bits, sizeof(value));
+			CheckHalfwayParse<double, uint64_t>(value, halfwayFailures);
+		}
+	}
+	elapsed = std::chrono::steady_clock::now() - start;
+	return halfwayFailures.Report("FloatFormat, halfway points", 4 * halfwayCount, elapsed.count()) && ok;
+}
+
+bool SelfChecks::RadixCheck()
+{
+	FailureLog failures;
+	auto start = std::chrono::steady_clock::now();
+	std::mt19937_64 rng(3);
+	uint64_t checked = 0;
+	checked += CheckRadixType<int8_t>(rng, failures);
+	checked += CheckRadixType<uint8_t>(rng, failures);
+	checked += CheckRadixType<int16_t>(rng, failures);
+	checked += CheckRadixType<uint16_t>(rng, failures);
+	checked += CheckRadixType<int32_t>(rng, failures);
+	checked += CheckRadixType<uint32_t>(rng, failures);
+	checked += CheckRadixType<int64_t>(rng, failures);
+	checked += CheckRadixType<uint64_t>(rng, failures);
+
+	// The fixed-width hexadecimal batches stop at the first field with a bad character, wherever it is.
+	const size_t count = 100;
+	std::vector<uint64_t> values(count), parsed(count);
+	std::vector<char> text(16 * count);
+	for (int round = 0; round < 1000; ++round)
+	{
+		for (uint64_t& value : values)
+			value = rng() >> (rng() % 64);
+		Radix_FormatHex64Batch(values.data(), count, text.data(), (round & 1) != 0);
+		size_t bad = rng() % (count + 1);
+		std::string expected;
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::string digits = NaiveFormat(values[i], false, 16, (round & 1) != 0);
+			expected += std::string(16 - digits.size(), '0') + digits;
+		}
+		bool ok = std::string(text.data(), text.size()) == expected;
+		if (bad < count)
+			text[16 * bad + rng() % 16] = "g/:@G \x80"[rng() % 7];
+		ok = ok && Radix_ParseHex64Batch(text.data(), count, parsed.data()) == bad
+			&& std::equal(values.begin(), values.begin() + bad, parsed.begin());
+		if (!ok)
+			failures.Add("Radix_FormatHex64Batch / Radix_ParseHex64Batch, bad field " + std::to_string(bad));
+		checked += count;
+	}
+
+	// The digit classifiers against NaiveDigitValue, on strings that are all digits but for at most one character,
+	//  chosen next to the edges of the digit ranges.
+	const char nearMisses[] = { '/', ':', '@', 'G', '`', 'g', '2', '\x80', '\xb0', '\xff', '\0' };
+	for (int round = 0; round < 20000; ++round)
+	{
+		std::string digits(rng() % 48, '0');
+		for (char& c : digits)
+			c = "0123456789abcdefABCDEF"[rng() % 22];
+		if (!digits.empty() && (rng() & 1))
+			digits[rng() % digits.size()] = nearMisses[rng() % sizeof(nearMisses)];
+		for (unsigned base : { 2u, 10u, 16u })
+		{
+			std::string text = digits;
+			if (base != 16)
+				for (char& c : text)
+					if (NaiveDigitValue(c) < 16 && NaiveDigitValue(c) >= base)
+						c = static_cast<char>('0' + NaiveDigitValue(c) % base);
+			bool expected = std::all_of(text.begin(), text.end(), [&](char c) { return NaiveDigitValue(c) < base; });
+			bool result = base == 2 ? Radix_IsBinaryDigits(text.data(), text.size())
+				: base == 10 ? Radix_IsDecimalDigits(text.data(), text.size()) : Radix_IsHexDigits(text.data(), text.size());
+			if (result != expected)
+				failures.Add("Radix_Is digits, base " + std::to_string(base) + ", \"" + text + "\"");
+			++checked;
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return failures.Report("Radix", checked, elapsed.count());
+}
+
+bool SelfChecks::SummationCheck()
+{
+	FailureLog failures;
+	auto start = std::chrono::steady_clock::now();
+	std::mt19937_64 rng(8);
+	// A float of random sign with an exponent between lowest and highest.
+	auto term = [&](int lowest, int highest) {
+		float significand = 1.0f + static_cast<float>(rng() >> 41) * std::ldexp(1.0f, -23);
+		int exponent = lowest + static_cast<int>(rng() % static_cast<uint64_t>(highest - lowest + 1));
+		return std::ldexp((rng() & 1) ? -significand : significand, exponent);
+	};
+	uint64_t checked = 0;
+	std::vector<size_t> lengths;
+	for (size_t length = 0; length <= 70; ++length)
+		lengths.push_back(length);
+	lengths.push_back(1023);
+	lengths.push_back(1025);
+	lengths.push_back(50000);
+	lengths.push_back(1 << 20);
+	for (size_t length : lengths)
+	{
+		std::vector<float> a(length), b(length);
+		// Terms of similar size.
+		for (size_t i = 0; i < length; ++i)
+		{
+			a[i] = term(-4, 4);
+			b[i] = term(-4, 4);
+		}
+		checked += CheckSummation(a, b, "similar terms", failures);
+		// A large running total and small readings, the 1000000.0f + 0.01f case.
+		for (size_t i = 0; i < length; ++i)
+		{
+			a[i] = i % 97 == 0 ? std::fabs(term(20, 30)) : std::fabs(term(-30, -10));
+			b[i] = std::fabs(term(-2, 2));
+		}
+		checked += CheckSummation(a, b, "large and small terms", failures);
+		// Terms that cancel to a tiny fraction of their magnitude.
+		for (size_t i = 0; i + 1 < length; i += 2)
+		{
+			a[i] = term(-30, 30);
+			a[i + 1] = -a[i] * (1.0f + std::ldexp(1.0f, -23) * static_cast<float>(rng() % 4));
+			b[i] = term(-30, 30);
+			b[i + 1] = b[i];
+		}
+		checked += CheckSummation(a, b, "cancelling terms", failures);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return failures.Report("Summation", checked, elapsed.count());
+}
+
+bool SelfChecks::FloatClassifyCheck()
+{
+	return FloatExhaustive_Report("Float_Classify, all floats", FloatExhaustive_Check(FloatExhaustive_ClassifiesLikeStd));
+}
+
+bool SelfChecks::FloatBitsCheck()
+{
+	bool ok = FloatExhaustive_Report("FloatBits, all floats", FloatExhaustive_Check(CheckFloatBits<float>));
+
+	FailureLog failures;
+	auto start = std::chrono::steady_clock::now();
+	uint64_t checked = 0;
+	// Every power of two, from far below the subnormals to far past the largest finite value.
+	for (int exponent = -1200; exponent <= 1200; ++exponent, ++checked)
+		if (Float_Pow2<double>(exponent) != std::ldexp(1.0, exponent) || Float_Pow2<float>(exponent) != std::ldexp(1.0f, exponent))
+			failures.Add("Float_Pow2(" + std::to_string(exponent) + ")");
+	// Random doubles of every exponent, and the special patterns at the edges of the categories.
+	std::mt19937_64 rng(11);
+	std::vector<uint64_t> patterns = { 0, 1, 0x000FFFFFFFFFFFFFull, 0x0010000000000000ull, 0x7FEFFFFFFFFFFFFFull,
+		0x7FF0000000000000ull, 0x7FF0000000000001ull, 0x7FF8000000000000ull, 0x7FFFFFFFFFFFFFFFull };
+	for (size_t i = patterns.size(); i > 0; --i)
+		patterns.push_back(patterns[i - 1] | 0x8000000000000000ull);
+	for (size_t i = 0; i < (1 << 22); ++i)
+		patterns.push_back(rng());
+	for (uint64_t bits : patterns)
+		if (!CheckFloatBits(Float_FromBits<double>(bits)))
+			failures.Add("double bits " + std::to_string(bits));
+	checked += patterns.size();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return failures.Report("FloatBits, powers of two and doubles", checked, elapsed.count()) && ok;
+}
+
+bool SelfChecks::UlpHarnessCheck()
+{
+	// IEEE754 requires a correctly rounded square root, so float sqrt must be within half an ulp of the double one.
+	// This keeps the ulp measurement honest: an error in it shows up here rather than in a kernel being checked.
+	FloatExhaustiveResult result = FloatExhaustive_CheckUlp(
+		[](float value) { return std::sqrt(value); },
+		[](float value) { return std::sqrt(static_cast<double>(value)); }, 0.5);
+	return FloatExhaustive_Report("std::sqrt(float) within 0.5 ulp, all floats", result);
+}
+
+bool SelfChecks::CheckedIntCheck()
+{
+	FailureLog failures;
+	auto start = std::chrono::steady_clock::now();
+	uint64_t checked = 2 * 65536;
+	CheckSmallIntPairs<int8_t>(failures);
+	CheckSmallIntPairs<uint8_t>(failures);
+
+	// 64-bit products against the exact 128-bit product, and wide division against multiplication.
+	std::mt19937_64 rng(5);
+	auto operand = [&] { return rng() >> (rng() % 64); };
+	const size_t randomCount = 1 << 20;
+	for (size_t i = 0; i < randomCount; ++i)
+	{
+		uint64_t a = operand(), b = operand(), product;
+		UInt128 exact = UInt128(a) * UInt128(b);
+		bool ok = Int_MulOverflow(a, b, product) == (exact.Word(1) != 0) && product == exact.Word(0);
+
+		int64_t sa = static_cast<int64_t>(a) * ((rng() & 1) ? 1 : -1), sb = static_cast<int64_t>(b) * ((rng() & 1) ? 1 : -1), sp;
+		Int128 signedExact = Int128(sa) * Int128(sb);
+		bool fits = signedExact >= Int128(INT64_MIN) && signedExact <= Int128(INT64_MAX);
+		ok = ok && Int_MulOverflow(sa, sb, sp) == !fits && sp == static_cast<int64_t>(signedExact.ToBits().Word(0));
+
+		UInt256 n = UInt256(exact) * UInt256(operand()) + UInt256(operand()), d = UInt256(exact) + UInt256(1), r;
+		UInt256 q = UInt256::DivMod(n, d, r);
+		ok = ok && q * d + r == n && r < d;
+		char text[WideInt_MaxChars<256>::value];
+		unsigned base = 2 + static_cast<unsigned>(i % 35);
+		UInt256 back;
+		ok = ok && WideInt_Parse(text, WideInt_Format(n, base, text, sizeof(text)), base, back) == RadixStatus::Ok && back == n;
+		if (!ok)
+			failures.Add("random operands " + std::to_string(a) + ", " + std::to_string(b));
+	}
+	checked += randomCount;
+
+	// The batch kernels against the scalar functions, on lengths that exercise the tails.
+	for (size_t length = 0; length < 64; ++length)
+	{
+		std::vector<int32_t> a(length), b(length), out(length);
+		std::vector<uint64_t> ua(length), ub(length), uout(length);
+		for (size_t i = 0; i < length; ++i)
+		{
+			a[i] = static_cast<int32_t>(rng() >> (32 + rng() % 32)) * ((rng() & 1) ? 1 : -1);
+			b[i] = static_cast<int32_t>(rng() >> (32 + rng() % 32)) * ((rng() & 1) ? 1 : -1);
+			ua[i] = operand();
+			ub[i] = operand();
+		}
+		for (IntKernel kernel : { IntKernel::Scalar, IntKernel::AVX2 })
+		{
+			size_t clamped = Int_SaturatingMulBatch(a.data(), b.data(), out.data(), length, kernel), expected = 0;
+			bool ok = true;
+			for (size_t i = 0; i < length; ++i)
+			{
+				int32_t product;
+				expected += Int_MulOverflow(a[i], b[i], product);
+				ok = ok && out[i] == Int_SaturatingMul(a[i], b[i]);
+			}
+			clamped += Int_SaturatingAddBatch(ua.data(), ub.data(), uout.data(), length, kernel);
+			for (size_t i = 0; i < length; ++i)
+			{
+				uint64_t sum;
+				expected += Int_AddOverflow(ua[i], ub[i], sum);
+				ok = ok && uout[i] == Int_SaturatingAdd(ua[i], ub[i]);
+			}
+			if (!ok || clamped != expected)
+				failures.Add("batch kernel " + std::to_string(static_cast<int>(kernel)) + ", length " + std::to_string(length));
+		}
+		checked += length;
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return failures.Report("CheckedInt and WideInt", checked, elapsed.count());
+}
+
+bool SelfChecks::DecimalCheck()
+{
+	FailureLog failures;
+	auto start = std::chrono::steady_clock::now();
+	std::mt19937_64 rng(6);
+	uint64_t checked = 0;
+	checked += CheckDecimalArithmetic<Decimal64<0>>(rng, failures);
+	checked += CheckDecimalArithmetic<Decimal64<2>>(rng, failures);
+	checked += CheckDecimalArithmetic<Decimal64<9>>(rng, failures);
+	checked += CheckDecimalArithmetic<Decimal64<15>>(rng, failures);
+	checked += CheckDecimalArithmetic<Decimal64<18>>(rng, failures);
+	checked += CheckDecimalArithmetic<Decimal128<4>>(rng, failures);
+	checked += CheckDecimalArithmetic<Decimal128<30>>(rng, failures);
+	checked += CheckDecimalParse<Decimal64<0>>(rng, failures);
+	checked += CheckDecimalParse<Decimal64<2>>(rng, failures);
+	checked += CheckDecimalParse<Decimal64<18>>(rng, failures);
+	checked += CheckDecimalParse<Decimal128<4>>(rng, failures);
+	checked += CheckDecimalParse<Decimal128<38>>(rng, failures);
+	checked += CheckDecimalFromDouble<Decimal64<0>>(rng, failures);
+	checked += CheckDecimalFromDouble<Decimal64<2>>(rng, failures);
+	checked += CheckDecimalFromDouble<Decimal64<18>>(rng, failures);
+	checked += CheckDecimalFromDouble<Decimal128<0>>(rng, failures);
+	checked += CheckDecimalFromDouble<Decimal128<4>>(rng, failures);
+	checked += CheckDecimalFromDouble<Decimal128<38>>(rng, failures);
+
+	// The product that once rounded up past 2^64 and wrapped to zero without reporting the overflow.
+	bool overflow = false;
+	Decimal_Multiply(Decimal64<2>::FromUnits(9177484613785846575), Decimal64<2>::FromUnits(201), RoundingMode::HalfEven, &overflow);
+	if (!overflow)
+		failures.Add("Decimal64<2> multiply 9177484613785846575 * 201 does not overflow");
+	++checked;
+
+	// A scale outside [0, 18] is reported through the overflow flag, whatever the kernel, and writes nothing.
+	for (int scale : { -1, 19, 64 })
+		for (DecimalKernel kernel : { DecimalKernel::Scalar, DecimalKernel::AVX2 })
+		{
+			int64_t a[5] = { 1, 2, 3, 4, 5 }, out[5] = { 7, 7, 7, 7, 7 };
+			overflow = false;
+			Decimal_MultiplyUnitsBatch(a, a, out, 5, scale, RoundingMode::HalfEven, &overflow, kernel);
+			if (!overflow || out[0] != 7 || out[4] != 7)
+				failures.Add("Decimal_MultiplyUnitsBatch accepts scale " + std::to_string(scale));
+			++checked;
+		}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return failures.Report("Decimal", checked, elapsed.count());
+}
+
+bool SelfChecks::MiniFloatCheck()
+{
+	const MiniFormat half = { 5, 10, true }, bfloat16 = { 8, 7, true }, e4m3 = { 4, 3, false }, e5m2 = { 5, 2, true };
+	// The six narrowing conversions: Half, BFloat16, then each FP8 format without and with saturation.
+	const MiniFormat* formats[6] = { &half, &bfloat16, &e4m3, &e4m3, &e5m2, &e5m2 };
+	const bool saturates[6] = { false, false, false, true, false, true };
+	const MiniFloatKernel simdKernels[] = { MiniFloatKernel::AVX2, MiniFloatKernel::AVX512 };
+
+	// Every float through every conversion: the scalar kernel against the reference,
+	//  and every SIMD kernel against the scalar kernel, NaN payloads included.
+	FloatExhaustiveResult narrowing = FloatExhaustive_Run([&](uint32_t first, uint32_t count, FloatExhaustiveBlock& block) {
+		std::vector<float> values(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t bits = first + i;
+			std::memcpy(&values[i], &bits, sizeof(bits));
+		}
+		std::vector<uint16_t> sixteen(count);
+		std::vector<uint8_t> eight(count);
+		// One value and then the rest, so the kernels also run unaligned and finish with a tail.
+		auto inTwoParts = [count](auto convertRange) {
+			convertRange(0u, 1u);
+			convertRange(1u, count - 1);
+		};
+		auto convert = [&](MiniFloatKernel kernel, std::vector<uint32_t>* results) {
+			inTwoParts([&](uint32_t begin, uint32_t length) {
+				Half_FromFloats(values.data() + begin, length, sixteen.data() + begin, kernel);
+			});
+			results[0].assign(sixteen.begin(), sixteen.end());
+			inTwoParts([&](uint32_t begin, uint32_t length) {
+				BFloat16_FromFloats(values.data() + begin, length, sixteen.data() + begin, kernel);
+			});
+			results[1].assign(sixteen.begin(), sixteen.end());
+			for (int c = 2; c < 6; ++c)
+			{
+				FP8Overflow overflow = saturates[c] ? FP8Overflow::Saturate : FP8Overflow::NonFinite;
+				inTwoParts([&](uint32_t begin, uint32_t length) {
+					if (formats[c] == &e4m3)
+						FP8E4M3_FromFloats(values.data() + begin, length, eight.data() + begin, overflow, kernel);
+					else
+						FP8E5M2_FromFloats(values.data() + begin, length, eight.data() + begin, overflow, kernel);
+				});
+				results[c].assign(eight.begin(), eight.end());
+			}
+		};
+
+		std::vector<uint32_t> scalar[6], simd[6];
+		std::vector<bool> failed(count);
+		convert(MiniFloatKernel::Scalar, scalar);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			int exponent = 0;
+			std::frexp(std::fabs(values[i]), &exponent);
+			for (int c = 0; c < 6; ++c)
+			{
+				uint32_t expected = ReferenceNarrow(values[i], exponent, *formats[c], saturates[c]);
+				uint32_t actual = scalar[c][i];
+				bool sameSign = ((actual & formats[c]->SignBit()) != 0) == std::signbit(values[i]);
+				if (expected == ~0u ? !(formats[c]->IsNaN(actual) && sameSign) : actual != expected)
+					failed[i] = true;
+			}
+		}
+		for (MiniFloatKernel kernel : simdKernels)
+		{
+			if (!MiniFloat_KernelSupported(kernel))
+				continue;
+			convert(kernel, simd);
+			for (int c = 0; c < 6; ++c)
+				for (uint32_t i = 0; i < count; ++i)
+					if (simd[c][i] != scalar[c][i])
+						failed[i] = true;
+		}
+		for (uint32_t i = 0; i < count; ++i)
+			if (failed[i])
+				block.Fail(first + i);
+	});
+	bool ok = FloatExhaustive_Report("MiniFloat narrowing, all floats, formats and kernels", narrowing);
+
+	// Every 16- and 8-bit pattern widened by every kernel: exactly its value, and narrowed back to the same pattern.
+	FailureLog failures;
+	auto start = std::chrono::steady_clock::now();
+	uint64_t checked = 0;
+	std::vector<uint16_t> sixteen(65536);
+	std::vector<uint8_t> eight(256);
+	for (uint32_t i = 0; i < 65536; ++i)
+		sixteen[i] = static_cast<uint16_t>(i);
+	for (uint32_t i = 0; i < 256; ++i)
+		eight[i] = static_cast<uint8_t>(i);
+	std::vector<float> widened(65536);
+	// Each batch is converted in two parts here too.
+	auto verify = [&](const char* name, MiniFloatKernel kernel, const MiniFormat& format, uint32_t patterns,
+		uint32_t (*narrow)(float), float (*widen)(uint32_t)) {
+		for (uint32_t bits = 0; bits < patterns; ++bits)
+		{
+			float value = widened[bits], single = widen(bits);
+			double expected = ReferenceWiden(bits, format);
+			bool ok = std::memcmp(&value, &single, sizeof(value)) == 0 && (std::isnan(expected)
+				? std::isnan(value) && std::signbit(value) == std::signbit(expected)
+				: static_cast<double>(value) == expected && std::signbit(value) == std::signbit(expected) && narrow(value) == bits);
+			if (!ok)
+				failures.Add(std::string(name) + " kernel " + std::to_string(static_cast<int>(kernel)) + ", pattern " + std::to_string(bits));
+		}
+		checked += patterns;
+	};
+	for (MiniFloatKernel kernel : { MiniFloatKernel::Scalar, MiniFloatKernel::AVX2, MiniFloatKernel::AVX512 })
+	{
+		if (!MiniFloat_KernelSupported(kernel))
+			continue;
+		Half_ToFloats(sixteen.data(), 1, widened.data(), kernel);
+		Half_ToFloats(sixteen.data() + 1, 65535, widened.data() + 1, kernel);
+		verify("Half_ToFloats", kernel, half, 65536,
+			[](float value) -> uint32_t { return Half_FromFloat(value); },
+			[](uint32_t bits) { return Half_ToFloat(static_cast<uint16_t>(bits)); });
+		BFloat16_ToFloats(sixteen.data(), 1, widened.data(), kernel);
+		BFloat16_ToFloats(sixteen.data() + 1, 65535, widened.data() + 1, kernel);
+		verify("BFloat16_ToFloats", kernel, bfloat16, 65536,
+			[](float value) -> uint32_t { return BFloat16_FromFloat(value); },
+			[](uint32_t bits) { return BFloat16_ToFloat(static_cast<uint16_t>(bits)); });
+		FP8E4M3_ToFloats(eight.data(), 1, widened.data(), kernel);
+		FP8E4M3_ToFloats(eight.data() + 1, 255, widened.data() + 1, kernel);
+		verify("FP8E4M3_ToFloats", kernel, e4m3, 256,
+			[](float value) -> uint32_t { return FP8E4M3_FromFloat(value); },
+			[](uint32_t bits) { return FP8E4M3_ToFloat(static_cast<uint8_t>(bits)); });
+		FP8E5M2_ToFloats(eight.data(), 1, widened.data(), kernel);
+		FP8E5M2_ToFloats(eight.data() + 1, 255, widened.data() + 1, kernel);
+		verify("FP8E5M2_ToFloats", kernel, e5m2, 256,
+			[](float value) -> uint32_t { return FP8E5M2_FromFloat(value); },
+			[](uint32_t bits) { return FP8E5M2_ToFloat(static_cast<uint8_t>(bits)); });
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return failures.Report("MiniFloat widening, all patterns and kernels", checked, elapsed.count()) && ok;
+}
+
+bool SelfChecks::FloatCompareCheck()
+{
+	// Every float is 1 ulp from the next one up, as many ulps from zero as its magnitude bits,
+	//  and twice that from its negation. A NaN is as far as possible from everything, itself included.
+	FloatExhaustiveResult distances = FloatExhaustive_Check([](float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		uint32_t magnitude = bits & 0x7FFFFFFFu;
+		if (std::isnan(value))
+			return Float_UlpDistance(value, 0.0f) == UINT32_MAX && !Float_NearlyEqualUlps(value, value, UINT32_MAX);
+		float next = std::nextafter(value, std::numeric_limits<float>::infinity());
+		return (value == std::numeric_limits<float>::infinity() || Float_UlpDistance(value, next) == 1)
+			&& Float_UlpDistance(value, 0.0f) == magnitude && Float_UlpDistance(0.0f, value) == magnitude
+			&& Float_UlpDistance(value, -value) == 2 * magnitude && Float_NearlyEqualUlps(value, value, 0);
+	});
+	bool ok = FloatExhaustive_Report("Float_UlpDistance, all floats", distances);
+
+	FailureLog failures;
+	auto start = std::chrono::steady_clock::now();
+	uint64_t checked = CheckCompareArrays<float, uint32_t, FloatTolerance>({ FloatTolerance(), { 4, 0.0f, 0.0f, true },
+		{ 0, 1e-6f, 1e-5f, false }, { UINT32_MAX, 0.0f, 0.0f, false } }, failures);
+	checked += CheckCompareArrays<double, uint64_t, DoubleTolerance>({ DoubleTolerance(), { 4, 0.0, 0.0, true },
+		{ 0, 1e-6, 1e-5, false }, { UINT64_MAX, 0.0, 0.0, false } }, failures);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return failures.Report("Float_CompareArrays, all kernels", checked, elapsed.count()) && ok;
+}
+
+bool SelfChecks::BitsCheck()
+{
+	FailureLog failures;
+	auto start = std::chrono::steady_clock::now();
+	uint64_t checked = 0;
+	std::mt19937_64 rng(7);
+	// All 8- and 16-bit values, then random values of every bit width and density.
+	for (uint32_t value = 0; value < 65536; ++value)
+	{
+		uint16_t mask = static_cast<uint16_t>(rng());
+		if (!CheckBitsOf(static_cast<uint8_t>(value), static_cast<uint8_t>(mask)) || !CheckBitsOf(static_cast<uint16_t>(value), mask))
+			failures.Add("value " + std::to_string(value));
+	}
+	checked += 65536;
+	auto randomWord = [&] {
+		uint64_t word = rng() >> (rng() % 64);
+		return (rng() & 1) ? word : word & rng() & rng();
+	};
+	const size_t randomCount = 1 << 20;
+	for (size_t i = 0; i < randomCount; ++i)
+	{
+		uint64_t value = randomWord(), mask = randomWord();
+		if (!CheckBitsOf(value, mask) || !CheckBitsOf(static_cast<uint32_t>(value), static_cast<uint32_t>(mask)))
+			failures.Add("value " + std::to_string(value) + ", mask " + std::to_string(mask));
+	}
+	checked += randomCount;
+
+	// The batch kernels against the single-value functions, on lengths that exercise the tails
+	//  and one long enough for the byte counters of the AVX2 kernel to be widened many times.
+	std::vector<size_t> lengths;
+	for (size_t length = 0; length < 80; ++length)
+		lengths.push_back(length);
+	lengths.push_back(100003);
+	for (size_t length : lengths)
+	{
+		std::vector<uint64_t> a(length), b(length), out(length);
+		for (size_t i = 0; i < length; ++i)
+		{
+			a[i] = (i % 7 == 0) ? ~uint64_t(0) : randomWord();
+			b[i] = randomWord();
+		}
+		uint64_t mask = randomWord(), expected = 0, expectedAnd = 0;
+		for (size_t i = 0; i < length; ++i)
+		{
+			expected += Bits_PopCount(a[i]);
+			expectedAnd += Bits_PopCount(a[i] & b[i]);
+		}
+		std::vector<uint64_t> positions(expected + 1);
+		size_t written = Bits_SetPositions(a.data(), length, positions.data());
+		bool positionsOk = written == expected;
+		for (size_t i = 0, next = 0; i < 64 * length && positionsOk; ++i)
+			if ((a[i / 64] >> (i % 64)) & 1)
+				positionsOk = positions[next++] == i;
+		if (!positionsOk)
+			failures.Add("Bits_SetPositions, length " + std::to_string(length));
+		for (BitsCountKernel kernel : { BitsCountKernel::Portable, BitsCountKernel::Hardware, BitsCountKernel::AVX2 })
+			if (Bits_PopCountArray(a.data(), length, kernel) != expected
+				|| Bits_PopCountAnd(a.data(), b.data(), length, kernel) != expectedAnd)
+				failures.Add("count kernel " + std::to_string(static_cast<int>(kernel)) + ", length " + std::to_string(length));
+		for (BitsDepositKernel kernel : { BitsDepositKernel::Portable, BitsDepositKernel::Hardware })
+		{
+			bool ok = true;
+			Bits_DepositArray(a.data(), length, mask, out.data(), kernel);
+			for (size_t i = 0; i < length; ++i)
+				ok = ok && out[i] == Bits_Deposit(a[i], mask);
+			// In place
+			out = a;
+			Bits_ExtractArray(out.data(), length, mask, out.data(), kernel);
+			for (size_t i = 0; i < length; ++i)
+				ok = ok && out[i] == Bits_Extract(a[i], mask);
+			if (!ok)
+				failures.Add("deposit kernel " + std::to_string(static_cast<int>(kernel)) + ", length " + std::to_string(length));
+		}
+		checked += length;
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return failures.Report("Bits", checked, elapsed.count());
+}
+
+bool SelfChecks::VarIntCheck()
+{
+	FailureLog failures;
+	auto start = std::chrono::steady_clock::now();
+	uint64_t checked = 0;
+	std::mt19937_64 rng(13);
+	// Every bit width equally often, plus the values at the edges of each LEB128 and Stream VByte length.
+	auto randomValue = [&] { return rng() >> (rng() % 64); };
+	std::vector<uint64_t> edges = { 0, UINT64_MAX, UINT32_MAX };
+	for (int bits = 7; bits < 64; bits += 7)
+		for (uint64_t value : { (uint64_t(1) << bits) - 1, uint64_t(1) << bits })
+			edges.push_back(value);
+	for (int bits = 8; bits <= 32; bits += 8)
+		edges.push_back((uint64_t(1) << bits) - 1);
+
+	for (int32_t value = -70000; value <= 70000; ++value)
+		if (VarInt_ZigZagDecode(VarInt_ZigZagEncode(value)) != value || VarInt_ZigZagEncode(value) != (value < 0 ? -2 * int64_t(value) - 1 : 2 * int64_t(value)))
+			failures.Add("zigzag " + std::to_string(value));
+	checked += 140001;
+
+	// Arrays of lengths that exercise every tail of the SIMD kernels, and one long one.
+	std::vector<size_t> lengths;
+	for (size_t length = 0; length < 70; ++length)
+		lengths.push_back(length);
+	lengths.push_back(100003);
+	for (size_t length : lengths)
+	{
+		std::vector<uint64_t> values(length), back(length);
+		for (size_t i = 0; i < length; ++i)
+			values[i] = i < edges.size() && length < 70 ? edges[(i + length) % edges.size()] : randomValue();
+		std::vector<uint8_t> expected;
+		for (uint64_t value : values)
+			NaiveLEB128(value, expected);
+
+		// LEB128: the bytes, the round trip, and every truncation of the last value.
+		std::vector<uint8_t> encoded(VarInt_LEB128MaxBytes * length);
+		size_t size = VarInt_EncodeLEB128(values.data(), length, encoded.data());
+		encoded.resize(size);
+		size_t used = 0;
+		bool ok = encoded == expected && VarInt_DecodeLEB128(encoded.data(), size, back.data(), length, &used) == VarIntStatus::Ok
+			&& used == size && back == values;
+		if (length > 0)
+			ok = ok && VarInt_DecodeLEB128(encoded.data(), size - 1, back.data(), length) == VarIntStatus::Truncated;
+		std::vector<int64_t> signedValues(length), signedBack(length);
+		for (size_t i = 0; i < length; ++i)
+			signedValues[i] = static_cast<int64_t>(values[i]) >> (i % 3 == 0 ? 40 : 0);
+		size = VarInt_EncodeLEB128(signedValues.data(), length, encoded.data());
+		ok = ok && VarInt_DecodeLEB128(encoded.data(), size, signedBack.data(), length) == VarIntStatus::Ok && signedBack == signedValues;
+		if (!ok)
+			failures.Add("LEB128, length " + std::to_string(length));
+
+		// Stream VByte with every kernel, from a buffer with no room after the data.
+		std::vector<uint32_t> narrow(length), narrowBack(length);
+		std::vector<int32_t> narrowSigned(length), narrowSignedBack(length);
+		for (size_t i = 0; i < length; ++i)
+		{
+			narrow[i] = static_cast<uint32_t>(values[i] >> (values[i] > UINT32_MAX ? 32 : 0));
+			narrowSigned[i] = static_cast<int32_t>(narrow[i]) >> (i % 3 == 0 ? 20 : 0);
+		}
+		std::vector<uint8_t> svb(VarInt_StreamVByteMaxBytes(length)), svbSigned(VarInt_StreamVByteMaxBytes(length));
+		svb.resize(VarInt_EncodeStreamVByte(narrow.data(), length, svb.data()));
+		svbSigned.resize(VarInt_EncodeStreamVByte(narrowSigned.data(), length, svbSigned.data()));
+		size_t expectedSize = (length + 3) / 4;
+		for (uint32_t value : narrow)
+			expectedSize += value > 0xFFFFFF ? 4 : value > 0xFFFF ? 3 : value > 0xFF ? 2 : 1;
+		for (VarIntKernel kernel : { VarIntKernel::Scalar, VarIntKernel::SSSE3, VarIntKernel::AVX2 })
+		{
+			std::fill(narrowBack.begin(), narrowBack.end(), 0xDEADBEEF);
+			bool kernelOk = svb.size() == expectedSize
+				&& VarInt_DecodeStreamVByte(svb.data(), svb.size(), narrowBack.data(), length, &used, kernel) == VarIntStatus::Ok
+				&& used == svb.size() && narrowBack == narrow
+				&& VarInt_DecodeStreamVByte(svbSigned.data(), svbSigned.size(), narrowSignedBack.data(), length, nullptr, kernel) == VarIntStatus::Ok
+				&& narrowSignedBack == narrowSigned;
+			if (length > 0)
+				kernelOk = kernelOk && VarInt_DecodeStreamVByte(svb.data(), svb.size() - 1, narrowBack.data(), length, nullptr, kernel) == VarIntStatus::Truncated;
+			if (!kernelOk)
+				failures.Add("Stream VByte kernel " + std::to_string(static_cast<int>(kernel)) + ", length " + std::to_string(length));
+		}
+		checked += length;
+	}
+
+	// Values that do not fit in 64 bits.
+	const uint8_t tooLong[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x80, 0x00 };
+	const uint8_t tooLarge[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02 };
+	uint64_t value;
+	if (VarInt_DecodeLEB128(tooLong, sizeof(tooLong), &value, 1) != VarIntStatus::Overflow
+		|| VarInt_DecodeLEB128(tooLarge, sizeof(tooLarge), &value, 1) != VarIntStatus::Overflow)
+		failures.Add("LEB128 overflow not detected");
+
+	// The streams, read back in pieces of awkward sizes, whole and with the last byte missing.
+	const size_t streamCount = 300007;
+	std::vector<uint64_t> wide(streamCount), wideBack(streamCount);
+	std::vector<uint32_t> narrow(streamCount), narrowBack(streamCount);
+	for (size_t i = 0; i < streamCount; ++i)
+	{
+		wide[i] = randomValue();
+		narrow[i] = static_cast<uint32_t>(wide[i]);
+	}
+	std::ostringstream lebOut, svbOut;
+	{
+		LEB128Writer lebWriter(lebOut);
+		StreamVByteWriter svbWriter(svbOut);
+		for (size_t i = 0; i < streamCount; i += 1000)
+		{
+			lebWriter.Write(wide.data() + i, std::min<size_t>(1000, streamCount - i));
+			svbWriter.Write(narrow.data() + i, std::min<size_t>(1000, streamCount - i));
+		}
+	}
+	for (bool truncate : { false, true })
+	{
+		std::string lebText = lebOut.str(), svbText = svbOut.str();
+		if (truncate)
+		{
+			lebText.pop_back();
+			svbText.pop_back();
+		}
+		std::istringstream lebIn(lebText), svbIn(svbText);
+		LEB128Reader lebReader(lebIn);
+		StreamVByteReader svbReader(svbIn);
+		size_t lebRead = 0, svbRead = 0;
+		for (size_t piece = 1; lebRead < streamCount || svbRead < streamCount; piece = piece * 3 % 10007)
+		{
+			size_t lebNext = lebReader.Read(wideBack.data() + lebRead, std::min(piece, streamCount - lebRead));
+			size_t svbNext = svbReader.Read(narrowBack.data() + svbRead, std::min(piece, streamCount - svbRead));
+			lebRead += lebNext;
+			svbRead += svbNext;
+			if (lebNext == 0 && svbNext == 0)
+				break;
+		}
+		VarIntStatus expected = truncate ? VarIntStatus::Truncated : VarIntStatus::Ok;
+		bool lebOk = lebReader.Status() == expected && (truncate || (lebRead == streamCount && wideBack == wide && lebReader.Read(&value, 1) == 0));
+		bool svbOk = svbReader.Status() == expected && (truncate || (svbRead == streamCount && narrowBack == narrow));
+		if (!lebOk || !svbOk)
+			failures.Add(std::string(truncate ? "truncated " : "") + (lebOk ? "Stream VByte stream" : "LEB128 stream"));
+	}
+	checked += streamCount;
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return failures.Report("VarInt", checked, elapsed.count());
+}
+
+bool SelfChecks::FloatMathCheck()
+{
+	typedef void (*Batch)(const float*, size_t, float*, FloatMathKernel);
+	const struct
+	{
+		const char* name;
+		Batch batch;
+		double (*reference)(double);
+		double maxUlp;
+	} functions[] = {
+		{ "FloatMath_Rsqrt", FloatMath_Rsqrt, [](double x) { return 1.0 / std::sqrt(x); }, FloatMath_RsqrtMaxUlp },
+		{ "FloatMath_Sqrt", FloatMath_Sqrt, [](double x) { return std::sqrt(x); }, FloatMath_SqrtMaxUlp },
+		{ "FloatMath_Exp", FloatMath_Exp, [](double x) { return std::exp(x); }, FloatMath_ExpMaxUlp },
+		{ "FloatMath_Log", FloatMath_Log, [](double x) { return std::log(x); }, FloatMath_LogMaxUlp },
+		{ "FloatMath_Sin", FloatMath_Sin, [](double x) { return std::sin(x); }, FloatMath_SinCosMaxUlp },
+		{ "FloatMath_Cos", FloatMath_Cos, [](double x) { return std::cos(x); }, FloatMath_SinCosMaxUlp },
+	};
+	const FloatMathKernel kernels[] = { FloatMathKernel::Scalar, FloatMathKernel::SSE2, FloatMathKernel::AVX2 };
+
+	// Every float through every kernel: within the bound of the double precision result, and except for the
+	//  estimate-based 1/sqrt, bit-identical to the scalar kernel. Each block runs in two parts, so that the
+	//  SIMD kernels also start unaligned and finish with a tail.
+	bool ok = true;
+	for (const auto& f : functions)
+	{
+		const bool identical = f.batch != FloatMath_Rsqrt;
+		FloatExhaustiveResult result = FloatExhaustive_Run([&](uint32_t first, uint32_t count, FloatExhaustiveBlock& block) {
+			std::vector<float> values(count), scalar(count), out(count);
+			std::vector<double> expected(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				uint32_t bits = first + i;
+				std::memcpy(&values[i], &bits, sizeof(bits));
+				expected[i] = f.reference(values[i]);
+			}
+			std::vector<double> worst(count, 0.0);
+			std::vector<bool> failed(count);
+			for (FloatMathKernel kernel : kernels)
+			{
+				if (!FloatMath_KernelSupported(kernel))
+					continue;
+				float* results = kernel == FloatMathKernel::Scalar ? scalar.data() : out.data();
+				f.batch(values.data(), 1, results, kernel);
+				f.batch(values.data() + 1, count - 1, results + 1, kernel);
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					double ulp = FloatExhaustive_UlpError(results[i], expected[i]);
+					if (!(ulp <= worst[i]))
+						worst[i] = ulp;
+					if (identical && std::memcmp(&results[i], &scalar[i], sizeof(float)) != 0)
+						failed[i] = true;
+				}
+			}
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				block.RecordUlp(first + i, worst[i]);
+				if (failed[i] || !(worst[i] <= f.maxUlp))
+					block.Fail(first + i);
+			}
+		});
+		std::ostringstream name;
+		name << f.name << " within " << f.maxUlp << " ulp, all floats and kernels";
+		ok = FloatExhaustive_Report(name.str().c_str(), result) && ok;
+	}
+
+	// Vec3_NormalizeBatch: random directions at lengths from 1e-15 to 1e15, against the exact quotient.
+	FailureLog failures;
+	auto start = std::chrono::steady_clock::now();
+	const size_t count = 1 << 20;
+	std::mt19937 rng(17);
+	std::uniform_real_distribution<float> component(-1.0f, 1.0f), exponent(-15.0f, 15.0f);
+	vec3SoA points;
+	points.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		float scale = std::pow(10.0f, exponent(rng));
+		points.x[i] = component(rng) * scale;
+		points.y[i] = component(rng) * scale;
+		points.z[i] = (i % 16 == 0) ? 0.0f : component(rng) * scale;
+	}
+	points.x[7] = points.y[7] = points.z[7] = 0.0f;
+	double worst = 0;
+	for (FloatMathKernel kernel : kernels)
+	{
+		if (!FloatMath_KernelSupported(kernel))
+			continue;
+		vec3SoA normalized = points;
+		Vec3_NormalizeBatch(normalized, kernel);
+		for (size_t i = 0; i < count; ++i)
+		{
+			double x = points.x[i], y = points.y[i], z = points.z[i];
+			double length = std::sqrt(x * x + y * y + z * z);
+			const float actual[3] = { normalized.x[i], normalized.y[i], normalized.z[i] };
+			const double exact[3] = { x, y, z };
+			for (int c = 0; c < 3; ++c)
+			{
+				double ulp = length == 0 ? (actual[c] == 0.0f ? 0.0 : HUGE_VAL) : FloatExhaustive_UlpError(actual[c], exact[c] / length);
+				worst = std::max(worst, ulp);
+				if (!(ulp <= FloatMath_NormalizeMaxUlp))
+					failures.Add("Vec3_NormalizeBatch, kernel " + std::to_string(static_cast<int>(kernel)) + ", vector " + std::to_string(i));
+			}
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "Vec3_NormalizeBatch: largest error " << worst << " ulp\n";
+	return failures.Report("Vec3_NormalizeBatch", count, elapsed.count()) && ok;
+}
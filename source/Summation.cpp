@@ -0,0 +1,531 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Summation.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/Summation.h"
+#include "../header/CpuFeatures.h"
+
+#include <cmath>
+
+#if defined(NUMBERS_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	const size_t Lanes = 16;
+	// Pairwise summation adds blocks of this many terms naively, then combines the block sums in pairs.
+	const size_t PairwiseBlock = 1024;
+
+	struct FloatLanes
+	{
+		float sum[Lanes];
+		float compensation[Lanes];
+	};
+
+	struct DoubleLanes
+	{
+		double sum[Lanes];
+	};
+
+	template <bool Dot>
+	float Term(const float* a, const float* b, size_t i)
+	{
+		return Dot ? a[i] * b[i] : a[i];
+	}
+
+	// The scalar kernels. They also finish the terms the SIMD kernels leave over, in the same lanes,
+	//  so they must perform exactly the operations of one SIMD lane.
+
+	template <bool Dot>
+	void NaiveScalar(const float* a, const float* b, size_t begin, size_t count, FloatLanes& lanes)
+	{
+		for (size_t i = begin; i < count; ++i)
+			lanes.sum[i % Lanes] += Term<Dot>(a, b, i);
+	}
+
+	template <bool Dot>
+	void KahanScalar(const float* a, const float* b, size_t begin, size_t count, FloatLanes& lanes)
+	{
+		for (size_t i = begin; i < count; ++i)
+		{
+			float& s = lanes.sum[i % Lanes];
+			float& c = lanes.compensation[i % Lanes];
+			// c holds what the previous addition lost (with the opposite sign); take it back off this term.
+			float y = Term<Dot>(a, b, i) - c;
+			float t = s + y;
+			c = (t - s) - y;
+			s = t;
+		}
+	}
+
+	template <bool Dot>
+	void NeumaierScalar(const float* a, const float* b, size_t begin, size_t count, FloatLanes& lanes)
+	{
+		for (size_t i = begin; i < count; ++i)
+		{
+			float& s = lanes.sum[i % Lanes];
+			float& c = lanes.compensation[i % Lanes];
+			float x = Term<Dot>(a, b, i);
+			float t = s + x;
+			// The rounding error of s + x is exact to compute once the larger operand is known.
+			bool sumIsLarger = std::fabs(s) >= std::fabs(x);
+			float big = sumIsLarger ? s : x;
+			float small = sumIsLarger ? x : s;
+			c += (big - t) + small;
+			s = t;
+		}
+	}
+
+	template <bool Dot>
+	void CascadedScalar(const float* a, const float* b, size_t begin, size_t count, DoubleLanes& lanes)
+	{
+		for (size_t i = begin; i < count; ++i)
+		{
+			// A product of two floats has at most 48 significant bits, so it is exact in double.
+			double term = Dot ? static_cast<double>(a[i]) * static_cast<double>(b[i]) : static_cast<double>(a[i]);
+			lanes.sum[i % Lanes] += term;
+		}
+	}
+
+#if defined(NUMBERS_X86)
+	// The SIMD kernels keep every accumulator in a named register variable: with arrays and inner loops
+	//  compilers tend to leave the accumulators in memory, which puts a store and a load into every
+	//  dependency chain.
+
+	template <bool Dot>
+	NUMBERS_TARGET("sse2")
+	inline __m128 TermSSE2(const float* a, const float* b, size_t i)
+	{
+		return Dot ? _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)) : _mm_loadu_ps(a + i);
+	}
+
+	NUMBERS_TARGET("sse2")
+	inline void KahanStepSSE2(__m128 x, __m128& s, __m128& c)
+	{
+		__m128 y = _mm_sub_ps(x, c);
+		__m128 t = _mm_add_ps(s, y);
+		c = _mm_sub_ps(_mm_sub_ps(t, s), y);
+		s = t;
+	}
+
+	NUMBERS_TARGET("sse2")
+	inline void NeumaierStepSSE2(__m128 x, __m128& s, __m128& c)
+	{
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+		__m128 t = _mm_add_ps(s, x);
+		__m128 sumIsLarger = _mm_cmpge_ps(_mm_andnot_ps(signBit, s), _mm_andnot_ps(signBit, x));
+		__m128 big = _mm_or_ps(_mm_and_ps(sumIsLarger, s), _mm_andnot_ps(sumIsLarger, x));
+		__m128 small = _mm_or_ps(_mm_and_ps(sumIsLarger, x), _mm_andnot_ps(sumIsLarger, s));
+		c = _mm_add_ps(c, _mm_add_ps(_mm_sub_ps(big, t), small));
+		s = t;
+	}
+
+	// Adds 4 terms starting at i to two registers of two double lanes each.
+	template <bool Dot>
+	NUMBERS_TARGET("sse2")
+	inline void CascadedStepSSE2(const float* a, const float* b, size_t i, __m128d& low, __m128d& high)
+	{
+		__m128 x = _mm_loadu_ps(a + i);
+		__m128d xLow = _mm_cvtps_pd(x), xHigh = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+		if (Dot)
+		{
+			__m128 y = _mm_loadu_ps(b + i);
+			xLow = _mm_mul_pd(xLow, _mm_cvtps_pd(y));
+			xHigh = _mm_mul_pd(xHigh, _mm_cvtps_pd(_mm_movehl_ps(y, y)));
+		}
+		low = _mm_add_pd(low, xLow);
+		high = _mm_add_pd(high, xHigh);
+	}
+
+	template <bool Dot>
+	NUMBERS_TARGET("sse2")
+	void NaiveSSE2(const float* a, const float* b, size_t count, FloatLanes& lanes)
+	{
+		__m128 s0 = _mm_loadu_ps(lanes.sum), s1 = _mm_loadu_ps(lanes.sum + 4);
+		__m128 s2 = _mm_loadu_ps(lanes.sum + 8), s3 = _mm_loadu_ps(lanes.sum + 12);
+		size_t i = 0;
+		for (; i + Lanes <= count; i += Lanes)
+		{
+			s0 = _mm_add_ps(s0, TermSSE2<Dot>(a, b, i));
+			s1 = _mm_add_ps(s1, TermSSE2<Dot>(a, b, i + 4));
+			s2 = _mm_add_ps(s2, TermSSE2<Dot>(a, b, i + 8));
+			s3 = _mm_add_ps(s3, TermSSE2<Dot>(a, b, i + 12));
+		}
+		_mm_storeu_ps(lanes.sum, s0);
+		_mm_storeu_ps(lanes.sum + 4, s1);
+		_mm_storeu_ps(lanes.sum + 8, s2);
+		_mm_storeu_ps(lanes.sum + 12, s3);
+		NaiveScalar<Dot>(a, b, i, count, lanes);
+	}
+
+	template <bool Dot, bool Neumaier>
+	NUMBERS_TARGET("sse2")
+	void CompensatedSSE2(const float* a, const float* b, size_t count, FloatLanes& lanes)
+	{
+		__m128 s0 = _mm_loadu_ps(lanes.sum), s1 = _mm_loadu_ps(lanes.sum + 4);
+		__m128 s2 = _mm_loadu_ps(lanes.sum + 8), s3 = _mm_loadu_ps(lanes.sum + 12);
+		__m128 c0 = _mm_loadu_ps(lanes.compensation), c1 = _mm_loadu_ps(lanes.compensation + 4);
+		__m128 c2 = _mm_loadu_ps(lanes.compensation + 8), c3 = _mm_loadu_ps(lanes.compensation + 12);
+		size_t i = 0;
+		for (; i + Lanes <= count; i += Lanes)
+		{
+			if (Neumaier)
+			{
+				NeumaierStepSSE2(TermSSE2<Dot>(a, b, i), s0, c0);
+				NeumaierStepSSE2(TermSSE2<Dot>(a, b, i + 4), s1, c1);
+				NeumaierStepSSE2(TermSSE2<Dot>(a, b, i + 8), s2, c2);
+				NeumaierStepSSE2(TermSSE2<Dot>(a, b, i + 12), s3, c3);
+			}
+			else
+			{
+				KahanStepSSE2(TermSSE2<Dot>(a, b, i), s0, c0);
+				KahanStepSSE2(TermSSE2<Dot>(a, b, i + 4), s1, c1);
+				KahanStepSSE2(TermSSE2<Dot>(a, b, i + 8), s2, c2);
+				KahanStepSSE2(TermSSE2<Dot>(a, b, i + 12), s3, c3);
+			}
+		}
+		_mm_storeu_ps(lanes.sum, s0);
+		_mm_storeu_ps(lanes.sum + 4, s1);
+		_mm_storeu_ps(lanes.sum + 8, s2);
+		_mm_storeu_ps(lanes.sum + 12, s3);
+		_mm_storeu_ps(lanes.compensation, c0);
+		_mm_storeu_ps(lanes.compensation + 4, c1);
+		_mm_storeu_ps(lanes.compensation + 8, c2);
+		_mm_storeu_ps(lanes.compensation + 12, c3);
+		if (Neumaier)
+			NeumaierScalar<Dot>(a, b, i, count, lanes);
+		else
+			KahanScalar<Dot>(a, b, i, count, lanes);
+	}
+
+	template <bool Dot>
+	NUMBERS_TARGET("sse2")
+	void CascadedSSE2(const float* a, const float* b, size_t count, DoubleLanes& lanes)
+	{
+		// Eight registers of two doubles; register k holds lanes 2k and 2k + 1.
+		__m128d s0 = _mm_loadu_pd(lanes.sum), s1 = _mm_loadu_pd(lanes.sum + 2);
+		__m128d s2 = _mm_loadu_pd(lanes.sum + 4), s3 = _mm_loadu_pd(lanes.sum + 6);
+		__m128d s4 = _mm_loadu_pd(lanes.sum + 8), s5 = _mm_loadu_pd(lanes.sum + 10);
+		__m128d s6 = _mm_loadu_pd(lanes.sum + 12), s7 = _mm_loadu_pd(lanes.sum + 14);
+		size_t i = 0;
+		for (; i + Lanes <= count; i += Lanes)
+		{
+			CascadedStepSSE2<Dot>(a, b, i, s0, s1);
+			CascadedStepSSE2<Dot>(a, b, i + 4, s2, s3);
+			CascadedStepSSE2<Dot>(a, b, i + 8, s4, s5);
+			CascadedStepSSE2<Dot>(a, b, i + 12, s6, s7);
+		}
+		_mm_storeu_pd(lanes.sum, s0);
+		_mm_storeu_pd(lanes.sum + 2, s1);
+		_mm_storeu_pd(lanes.sum + 4, s2);
+		_mm_storeu_pd(lanes.sum + 6, s3);
+		_mm_storeu_pd(lanes.sum + 8, s4);
+		_mm_storeu_pd(lanes.sum + 10, s5);
+		_mm_storeu_pd(lanes.sum + 12, s6);
+		_mm_storeu_pd(lanes.sum + 14, s7);
+		CascadedScalar<Dot>(a, b, i, count, lanes);
+	}
+
+	template <bool Dot>
+	NUMBERS_TARGET("avx2")
+	inline __m256 TermAVX2(const float* a, const float* b, size_t i)
+	{
+		return Dot ? _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)) : _mm256_loadu_ps(a + i);
+	}
+
+	NUMBERS_TARGET("avx2")
+	inline void KahanStepAVX2(__m256 x, __m256& s, __m256& c)
+	{
+		__m256 y = _mm256_sub_ps(x, c);
+		__m256 t = _mm256_add_ps(s, y);
+		c = _mm256_sub_ps(_mm256_sub_ps(t, s), y);
+		s = t;
+	}
+
+	NUMBERS_TARGET("avx2")
+	inline void NeumaierStepAVX2(__m256 x, __m256& s, __m256& c)
+	{
+		const __m256 signBit = _mm256_set1_ps(-0.0f);
+		__m256 t = _mm256_add_ps(s, x);
+		__m256 sumIsLarger = _mm256_cmp_ps(_mm256_andnot_ps(signBit, s), _mm256_andnot_ps(signBit, x), _CMP_GE_OQ);
+		__m256 big = _mm256_blendv_ps(x, s, sumIsLarger);
+		__m256 small = _mm256_blendv_ps(s, x, sumIsLarger);
+		c = _mm256_add_ps(c, _mm256_add_ps(_mm256_sub_ps(big, t), small));
+		s = t;
+	}
+
+	// Adds 4 terms starting at i to a register of four double lanes.
+	template <bool Dot>
+	NUMBERS_TARGET("avx2")
+	inline __m256d CascadedStepAVX2(const float* a, const float* b, size_t i, __m256d s)
+	{
+		__m256d x = _mm256_cvtps_pd(_mm_loadu_ps(a + i));
+		if (Dot)
+			x = _mm256_mul_pd(x, _mm256_cvtps_pd(_mm_loadu_ps(b + i)));
+		return _mm256_add_pd(s, x);
+	}
+
+	template <bool Dot>
+	NUMBERS_TARGET("avx2")
+	void NaiveAVX2(const float* a, const float* b, size_t count, FloatLanes& lanes)
+	{
+		__m256 s0 = _mm256_loadu_ps(lanes.sum), s1 = _mm256_loadu_ps(lanes.sum + 8);
+		size_t i = 0;
+		for (; i + Lanes <= count; i += Lanes)
+		{
+			s0 = _mm256_add_ps(s0, TermAVX2<Dot>(a, b, i));
+			s1 = _mm256_add_ps(s1, TermAVX2<Dot>(a, b, i + 8));
+		}
+		_mm256_storeu_ps(lanes.sum, s0);
+		_mm256_storeu_ps(lanes.sum + 8, s1);
+		NaiveScalar<Dot>(a, b, i, count, lanes);
+	}
+
+	template <bool Dot, bool Neumaier>
+	NUMBERS_TARGET("avx2")
+	void CompensatedAVX2(const float* a, const float* b, size_t count, FloatLanes& lanes)
+	{
+		__m256 s0 = _mm256_loadu_ps(lanes.sum), s1 = _mm256_loadu_ps(lanes.sum + 8);
+		__m256 c0 = _mm256_loadu_ps(lanes.compensation), c1 = _mm256_loadu_ps(lanes.compensation + 8);
+		size_t i = 0;
+		for (; i + Lanes <= count; i += Lanes)
+		{
+			if (Neumaier)
+			{
+				NeumaierStepAVX2(TermAVX2<Dot>(a, b, i), s0, c0);
+				NeumaierStepAVX2(TermAVX2<Dot>(a, b, i + 8), s1, c1);
+			}
+			else
+			{
+				KahanStepAVX2(TermAVX2<Dot>(a, b, i), s0, c0);
+				KahanStepAVX2(TermAVX2<Dot>(a, b, i + 8), s1, c1);
+			}
+		}
+		_mm256_storeu_ps(lanes.sum, s0);
+		_mm256_storeu_ps(lanes.sum + 8, s1);
+		_mm256_storeu_ps(lanes.compensation, c0);
+		_mm256_storeu_ps(lanes.compensation + 8, c1);
+		if (Neumaier)
+			NeumaierScalar<Dot>(a, b, i, count, lanes);
+		else
+			KahanScalar<Dot>(a, b, i, count, lanes);
+	}
+
+	template <bool Dot>
+	NUMBERS_TARGET("avx2")
+	void CascadedAVX2(const float* a, const float* b, size_t count, DoubleLanes& lanes)
+	{
+		// Four registers of four doubles; register k holds lanes 4k to 4k + 3.
+		__m256d s0 = _mm256_loadu_pd(lanes.sum), s1 = _mm256_loadu_pd(lanes.sum + 4);
+		__m256d s2 = _mm256_loadu_pd(lanes.sum + 8), s3 = _mm256_loadu_pd(lanes.sum + 12);
+		size_t i = 0;
+		for (; i + Lanes <= count; i += Lanes)
+		{
+			s0 = CascadedStepAVX2<Dot>(a, b, i, s0);
+			s1 = CascadedStepAVX2<Dot>(a, b, i + 4, s1);
+			s2 = CascadedStepAVX2<Dot>(a, b, i + 8, s2);
+			s3 = CascadedStepAVX2<Dot>(a, b, i + 12, s3);
+		}
+		_mm256_storeu_pd(lanes.sum, s0);
+		_mm256_storeu_pd(lanes.sum + 4, s1);
+		_mm256_storeu_pd(lanes.sum + 8, s2);
+		_mm256_storeu_pd(lanes.sum + 12, s3);
+		CascadedScalar<Dot>(a, b, i, count, lanes);
+	}
+#endif
+
+	// Adds the lanes in a fixed tree order, the way a SIMD horizontal sum would.
+	float ReduceLanes(FloatLanes& lanes)
+	{
+		for (size_t step = Lanes / 2; step > 0; step /= 2)
+			for (size_t lane = 0; lane < step; ++lane)
+				lanes.sum[lane] += lanes.sum[lane + step];
+		return lanes.sum[0];
+	}
+
+	template <bool Dot>
+	void RunFloatLanes(SumMethod method, SumKernel kernel, const float* a, const float* b, size_t count, FloatLanes& lanes)
+	{
+		for (size_t lane = 0; lane < Lanes; ++lane)
+			lanes.sum[lane] = lanes.compensation[lane] = 0.0f;
+#if defined(NUMBERS_X86)
+		if (kernel == SumKernel::AVX2)
+		{
+			if (method == SumMethod::Kahan)
+				CompensatedAVX2<Dot, false>(a, b, count, lanes);
+			else if (method == SumMethod::Neumaier)
+				CompensatedAVX2<Dot, true>(a, b, count, lanes);
+			else
+				NaiveAVX2<Dot>(a, b, count, lanes);
+			return;
+		}
+		if (kernel == SumKernel::SSE2)
+		{
+			if (method == SumMethod::Kahan)
+				CompensatedSSE2<Dot, false>(a, b, count, lanes);
+			else if (method == SumMethod::Neumaier)
+				CompensatedSSE2<Dot, true>(a, b, count, lanes);
+			else
+				NaiveSSE2<Dot>(a, b, count, lanes);
+			return;
+		}
+#endif
+		if (method == SumMethod::Kahan)
+			KahanScalar<Dot>(a, b, 0, count, lanes);
+		else if (method == SumMethod::Neumaier)
+			NeumaierScalar<Dot>(a, b, 0, count, lanes);
+		else
+			NaiveScalar<Dot>(a, b, 0, count, lanes);
+	}
+
+	template <bool Dot>
+	float PairwiseSum(SumKernel kernel, const float* a, const float* b, size_t count)
+	{
+		if (count <= PairwiseBlock)
+		{
+			FloatLanes lanes;
+			RunFloatLanes<Dot>(SumMethod::Naive, kernel, a, b, count, lanes);
+			return ReduceLanes(lanes);
+		}
+		// Split on a multiple of the lane count, so that every block starts at lane 0.
+		size_t half = count / 2 / Lanes * Lanes;
+		return PairwiseSum<Dot>(kernel, a, b, half) + PairwiseSum<Dot>(kernel, a + half, Dot ? b + half : b, count - half);
+	}
+
+	template <bool Dot>
+	double Sum(const float* a, const float* b, size_t count, SumMethod method, SumKernel kernel)
+	{
+		kernel = Sum_ResolveKernel(kernel);
+		if (method == SumMethod::Pairwise)
+			return PairwiseSum<Dot>(kernel, a, b, count);
+
+		if (method == SumMethod::Cascaded)
+		{
+			DoubleLanes lanes;
+			for (size_t lane = 0; lane < Lanes; ++lane)
+				lanes.sum[lane] = 0.0;
+#if defined(NUMBERS_X86)
+			if (kernel == SumKernel::AVX2)
+				CascadedAVX2<Dot>(a, b, count, lanes);
+			else if (kernel == SumKernel::SSE2)
+				CascadedSSE2<Dot>(a, b, count, lanes);
+			else
+#endif
+				CascadedScalar<Dot>(a, b, 0, count, lanes);
+			double total = 0.0;
+			for (size_t lane = 0; lane < Lanes; ++lane)
+				total += lanes.sum[lane];
+			return total;
+		}
+
+		FloatLanes lanes;
+		RunFloatLanes<Dot>(method, kernel, a, b, count, lanes);
+		if (method == SumMethod::Naive)
+			return ReduceLanes(lanes);
+		// The compensation terms are below the precision of the float sums, but not of a double.
+		// Kahan's holds the negated lost part, Neumaier's the lost part itself.
+		double total = 0.0;
+		for (size_t lane = 0; lane < Lanes; ++lane)
+		{
+			double compensation = lanes.compensation[lane];
+			total += lanes.sum[lane];
+			total += method == SumMethod::Kahan ? -compensation : compensation;
+		}
+		return total;
+	}
+}
+
+bool Sum_KernelSupported(SumKernel kernel)
+{
+	switch (kernel)
+	{
+	case SumKernel::Auto:
+	case SumKernel::Scalar:
+		return true;
+#if defined(NUMBERS_X86)
+	case SumKernel::SSE2:
+		return CpuFeatures::HasSSE2();
+	case SumKernel::AVX2:
+		return CpuFeatures::HasAVX2();
+#endif
+	default:
+		return false;
+	}
+}
+
+SumKernel Sum_ResolveKernel(SumKernel kernel)
+{
+	if (kernel == SumKernel::Auto)
+	{
+		if (Sum_KernelSupported(SumKernel::AVX2))
+			return SumKernel::AVX2;
+		if (Sum_KernelSupported(SumKernel::SSE2))
+			return SumKernel::SSE2;
+		return SumKernel::Scalar;
+	}
+	return Sum_KernelSupported(kernel) ? kernel : SumKernel::Scalar;
+}
+
+double Sum_Floats(const float* values, size_t count, SumMethod method, SumKernel kernel)
+{
+	return Sum<false>(values, nullptr, count, method, kernel);
+}
+
+double Sum_DotProduct(const float* a, const float* b, size_t count, SumMethod method, SumKernel kernel)
+{
+	return Sum<true>(a, b, count, method, kernel);
+}
+
+double Sum_ErrorBound(SumMethod method, size_t count, double magnitudeSum, bool dotProduct)
+{
+	// u is the unit roundoff (half an ulp of 1); gamma(n) bounds the relative error of n roundings in a row.
+	const double u = std::ldexp(1.0, -24);
+	const double doubleU = std::ldexp(1.0, -53);
+	auto gamma = [](double n, double unit) { return n * unit / (1.0 - n * unit); };
+	const double perLane = std::ceil(static_cast<double>(count) / Lanes);
+	const double treeLevels = 4;  // log2(Lanes)
+
+	double bound;
+	switch (method)
+	{
+	case SumMethod::Naive:
+		bound = gamma(perLane + treeLevels, u) * magnitudeSum;
+		break;
+	case SumMethod::Kahan:
+	case SumMethod::Neumaier:
+		// 2u |sum| + O(n u^2) per lane (|sum| <= magnitudeSum), then 32 additions in double.
+		bound = (2.0 * u + 2.0 * perLane * u * u) * magnitudeSum + gamma(2 * Lanes, doubleU) * magnitudeSum;
+		break;
+	case SumMethod::Pairwise:
+	{
+		double blocks = std::ceil(static_cast<double>(count) / PairwiseBlock);
+		double levels = blocks > 1.0 ? std::ceil(std::log2(blocks)) : 0.0;
+		bound = gamma(PairwiseBlock / Lanes + treeLevels + levels, u) * magnitudeSum;
+		break;
+	}
+	default:
+		// Exact products, perLane additions per lane and 16 more to combine the lanes, all in double,
+		//  then the conversion of the result is the caller's.
+		return gamma(perLane + Lanes, doubleU) * magnitudeSum;
+	}
+	// Every method but Cascaded rounds each product to float first, which adds u to each term's relative error.
+	return dotProduct ? bound * (1.0 + u) + u * magnitudeSum : bound;
+}
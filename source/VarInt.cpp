@@ -0,0 +1,576 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: VarInt.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/VarInt.h"
+#include "../header/Bits.h"
+#include "../header/CpuFeatures.h"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+#if defined(NUMBERS_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// The largest Stream VByte block in a stream.
+	const size_t BlockValues = 1 << 16;
+	// The size of the LEB128 stream buffers.
+	const size_t StreamBufferBytes = 1 << 16;
+
+	// Little-endian loads and stores, written byte by byte so that they mean the same on every platform;
+	//  compilers turn them into single moves on little-endian processors.
+	inline uint64_t Load64(const uint8_t* p)
+	{
+		uint64_t word = 0;
+		for (int i = 0; i < 8; ++i)
+			word |= static_cast<uint64_t>(p[i]) << (8 * i);
+		return word;
+	}
+
+	inline uint32_t Load32(const uint8_t* p)
+	{
+		return p[0] | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+	}
+
+	inline void Store32(uint8_t* p, uint32_t value)
+	{
+		p[0] = static_cast<uint8_t>(value);
+		p[1] = static_cast<uint8_t>(value >> 8);
+		p[2] = static_cast<uint8_t>(value >> 16);
+		p[3] = static_cast<uint8_t>(value >> 24);
+	}
+
+	// ---------------------------------------------------------------- LEB128
+
+	template <bool ZigZag, typename T>
+	size_t EncodeLEB128(const T* values, size_t count, uint8_t* out)
+	{
+		uint8_t* p = out;
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint64_t value = ZigZag ? VarInt_ZigZagEncode(static_cast<int64_t>(values[i])) : static_cast<uint64_t>(values[i]);
+			for (; value >= 0x80; value >>= 7)
+				*p++ = static_cast<uint8_t>(value | 0x80);
+			*p++ = static_cast<uint8_t>(value);
+		}
+		return static_cast<size_t>(p - out);
+	}
+
+	// Reads the value at p, which is before end, and moves p past it.
+	inline VarIntStatus ReadLEB128(const uint8_t*& p, const uint8_t* end, uint64_t& value)
+	{
+		if (end - p >= 8)
+		{
+			// The first byte without the continuation bit ends the value. If it is among the next 8 bytes,
+			//  the 7-bit groups are joined without a loop: into 14-bit groups, then 28-bit ones, then one 56-bit value.
+			uint64_t word = Load64(p);
+			uint64_t stops = ~word & 0x8080808080808080ull;
+			if (stops != 0)
+			{
+				int length = (Bits_CountTrailingZeros(stops) + 1) / 8;
+				uint64_t x = word & (~uint64_t(0) >> (64 - 8 * length)) & 0x7F7F7F7F7F7F7F7Full;
+				x = (x & 0x007F007F007F007Full) | ((x & 0x7F007F007F007F00ull) >> 1);
+				x = (x & 0x00003FFF00003FFFull) | ((x & 0x3FFF00003FFF0000ull) >> 2);
+				x = (x & 0x000000000FFFFFFFull) | ((x & 0x0FFFFFFF00000000ull) >> 4);
+				value = x;
+				p += length;
+				return VarIntStatus::Ok;
+			}
+		}
+		// Values of 9 or 10 bytes, and values near the end of the input.
+		value = 0;
+		for (int shift = 0; ; shift += 7)
+		{
+			if (p == end)
+				return VarIntStatus::Truncated;
+			uint8_t byte = *p++;
+			// The tenth byte holds bit 63 only.
+			if (shift == 63 && byte > 1)
+				return VarIntStatus::Overflow;
+			value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return VarIntStatus::Ok;
+		}
+	}
+
+	// Decodes values until done reaches count or p reaches stop. A value that starts before stop must end before end.
+	template <bool ZigZag, typename T>
+	VarIntStatus DecodeLEB128(const uint8_t*& p, const uint8_t* stop, const uint8_t* end, T* values, size_t count, size_t& done)
+	{
+		while (done < count && p < stop)
+		{
+			uint64_t value;
+			VarIntStatus status = ReadLEB128(p, end, value);
+			if (status != VarIntStatus::Ok)
+				return status;
+			values[done++] = ZigZag ? static_cast<T>(VarInt_ZigZagDecode(value)) : static_cast<T>(value);
+		}
+		return VarIntStatus::Ok;
+	}
+
+	template <bool ZigZag, typename T>
+	VarIntStatus DecodeLEB128Array(const uint8_t* in, size_t size, T* values, size_t count, size_t* used)
+	{
+		const uint8_t* p = in;
+		size_t done = 0;
+		VarIntStatus status = DecodeLEB128<ZigZag>(p, in + size, in + size, values, count, done);
+		if (status == VarIntStatus::Ok && done < count)
+			status = VarIntStatus::Truncated;
+		if (used)
+			*used = static_cast<size_t>(p - in);
+		return status;
+	}
+
+	// ---------------------------------------------------------------- Stream VByte
+
+	// For every control byte: the number of data bytes of its four values, and the PSHUFB pattern that moves
+	//  each value's bytes to the bottom of its 32-bit lane and fills the rest with zeros (index 0xFF).
+	struct StreamVByteTables
+	{
+		uint8_t lengths[256];
+		alignas(16) uint8_t shuffles[256][16];
+	};
+
+	constexpr StreamVByteTables MakeStreamVByteTables()
+	{
+		StreamVByteTables tables = {};
+		for (int control = 0; control < 256; ++control)
+		{
+			int offset = 0;
+			for (int value = 0; value < 4; ++value)
+			{
+				int length = ((control >> (2 * value)) & 3) + 1;
+				for (int byte = 0; byte < 4; ++byte)
+					tables.shuffles[control][4 * value + byte] = static_cast<uint8_t>(byte < length ? offset + byte : 0xFF);
+				offset += length;
+			}
+			tables.lengths[control] = static_cast<uint8_t>(offset);
+		}
+		return tables;
+	}
+
+	constexpr StreamVByteTables Tables = MakeStreamVByteTables();
+
+	// 0 to 3 for values of 1 to 4 bytes.
+	inline uint32_t LengthCode(uint32_t value)
+	{
+		return static_cast<uint32_t>(value > 0xFF) + static_cast<uint32_t>(value > 0xFFFF) + static_cast<uint32_t>(value > 0xFFFFFF);
+	}
+
+	template <bool ZigZag, typename T>
+	size_t EncodeStreamVByte(const T* values, size_t count, uint8_t* out)
+	{
+		uint8_t* controls = out;
+		uint8_t* data = out + (count + 3) / 4;
+		for (size_t group = 0; group < count; group += 4)
+		{
+			uint32_t control = 0;
+			size_t n = std::min<size_t>(count - group, 4);
+			for (size_t k = 0; k < n; ++k)
+			{
+				uint32_t value = ZigZag ? VarInt_ZigZagEncode(static_cast<int32_t>(values[group + k])) : static_cast<uint32_t>(values[group + k]);
+				uint32_t code = LengthCode(value);
+				control |= code << (2 * k);
+				// All 4 bytes are stored and the pointer moves past the ones that count; out has room for 4 per value.
+				Store32(data, value);
+				data += code + 1;
+			}
+			controls[group / 4] = static_cast<uint8_t>(control);
+		}
+		return static_cast<size_t>(data - out);
+	}
+
+	// The number of data bytes that follow the control bytes of count values.
+	size_t StreamVByteDataLength(const uint8_t* controls, size_t count)
+	{
+		size_t length = 0;
+		for (size_t group = 0; group < count / 4; ++group)
+			length += Tables.lengths[controls[group]];
+		for (size_t k = 0; k < count % 4; ++k)
+			length += ((controls[count / 4] >> (2 * k)) & 3) + 1;
+		return length;
+	}
+
+	// Decodes values [begin, count), where begin is a multiple of 4 and data points at the first byte of value begin.
+	// The SIMD kernels below decode the whole groups they can and leave the rest to this one.
+	template <bool ZigZag>
+	void DecodeStreamVByteScalar(const uint8_t* controls, size_t begin, size_t count, const uint8_t* data, const uint8_t* end,
+		uint32_t* values)
+	{
+		for (size_t i = begin; i < count; ++i)
+		{
+			uint32_t length = ((controls[i / 4] >> (2 * (i % 4))) & 3) + 1;
+			uint32_t value;
+			if (end - data >= 4)
+				value = Load32(data) & (~0u >> (32 - 8 * length));
+			else
+			{
+				value = 0;
+				for (uint32_t byte = 0; byte < length; ++byte)
+					value |= static_cast<uint32_t>(data[byte]) << (8 * byte);
+			}
+			data += length;
+			values[i] = ZigZag ? static_cast<uint32_t>(VarInt_ZigZagDecode(value)) : value;
+		}
+	}
+
+#if defined(NUMBERS_X86)
+	NUMBERS_TARGET("ssse3")
+	inline __m128i ZigZagDecode128(__m128i v)
+	{
+		__m128i negate = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, _mm_set1_epi32(1)));
+		return _mm_xor_si128(_mm_srli_epi32(v, 1), negate);
+	}
+
+	// Four values per step: one 16-byte load holds all of their bytes, and the table entry for the control byte
+	//  spreads them out. Stops while 16 bytes can still be read, and returns the number of groups decoded.
+	template <bool ZigZag>
+	NUMBERS_TARGET("ssse3")
+	size_t DecodeStreamVByteSSSE3(const uint8_t* controls, size_t begin, size_t groups, const uint8_t*& data, const uint8_t* end,
+		uint32_t* values)
+	{
+		size_t group = begin;
+		for (; group < groups && end - data >= 16; ++group)
+		{
+			uint8_t control = controls[group];
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+			__m128i v = _mm_shuffle_epi8(bytes, _mm_load_si128(reinterpret_cast<const __m128i*>(Tables.shuffles[control])));
+			if (ZigZag)
+				v = ZigZagDecode128(v);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + 4 * group), v);
+			data += Tables.lengths[control];
+		}
+		return group;
+	}
+
+	// Eight values per step: the bytes of two groups go into the two halves of a 256-bit register,
+	//  which VPSHUFB shuffles separately. The last groups are left to the SSSE3 kernel.
+	template <bool ZigZag>
+	NUMBERS_TARGET("avx2")
+	size_t DecodeStreamVByteAVX2(const uint8_t* controls, size_t groups, const uint8_t*& data, const uint8_t* end,
+		uint32_t* values)
+	{
+		size_t group = 0;
+		for (; group + 2 <= groups && end - data >= 32; group += 2)
+		{
+			uint8_t first = controls[group], second = controls[group + 1];
+			const uint8_t* secondData = data + Tables.lengths[first];
+			__m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data))),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(secondData)), 1);
+			__m256i shuffle = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(Tables.shuffles[first]))),
+				_mm_load_si128(reinterpret_cast<const __m128i*>(Tables.shuffles[second])), 1);
+			__m256i v = _mm256_shuffle_epi8(bytes, shuffle);
+			if (ZigZag)
+			{
+				__m256i negate = _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_and_si256(v, _mm256_set1_epi32(1)));
+				v = _mm256_xor_si256(_mm256_srli_epi32(v, 1), negate);
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + 4 * group), v);
+			data = secondData + Tables.lengths[second];
+		}
+		return DecodeStreamVByteSSSE3<ZigZag>(controls, group, groups, data, end, values);
+	}
+#endif
+
+	template <bool ZigZag>
+	VarIntStatus DecodeStreamVByte(const uint8_t* in, size_t size, uint32_t* values, size_t count, size_t* used, VarIntKernel kernel)
+	{
+		// The control bytes give the length of the data, so a short input is found before anything is decoded,
+		//  and the kernels only have to check how far they may read ahead.
+		size_t controlBytes = (count + 3) / 4;
+		size_t total = controlBytes;
+		VarIntStatus status = VarIntStatus::Truncated;
+		if (size >= controlBytes)
+		{
+			total += StreamVByteDataLength(in, count);
+			if (size >= total)
+				status = VarIntStatus::Ok;
+		}
+		if (used)
+			*used = status == VarIntStatus::Ok ? total : 0;
+		if (status != VarIntStatus::Ok)
+			return status;
+
+		const uint8_t* data = in + controlBytes;
+		const uint8_t* end = in + size;
+		size_t groups = 0;
+		switch (VarInt_ResolveKernel(kernel))
+		{
+#if defined(NUMBERS_X86)
+		case VarIntKernel::AVX2:
+			groups = DecodeStreamVByteAVX2<ZigZag>(in, count / 4, data, end, values);
+			break;
+		case VarIntKernel::SSSE3:
+			groups = DecodeStreamVByteSSSE3<ZigZag>(in, 0, count / 4, data, end, values);
+			break;
+#endif
+		default:
+			break;
+		}
+		DecodeStreamVByteScalar<ZigZag>(in, 4 * groups, count, data, end, values);
+		return VarIntStatus::Ok;
+	}
+
+	// Reads exactly size bytes; otherwise sets status to StreamError for a failed stream, or Truncated.
+	bool ReadExactly(std::istream& stream, uint8_t* bytes, size_t size, VarIntStatus& status)
+	{
+		stream.read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(size));
+		if (static_cast<size_t>(stream.gcount()) == size)
+			return true;
+		status = stream.bad() ? VarIntStatus::StreamError : VarIntStatus::Truncated;
+		return false;
+	}
+}
+
+bool VarInt_KernelSupported(VarIntKernel kernel)
+{
+	switch (kernel)
+	{
+	case VarIntKernel::Auto:
+	case VarIntKernel::Scalar:
+		return true;
+#if defined(NUMBERS_X86)
+	case VarIntKernel::SSSE3:
+		return CpuFeatures::HasSSSE3();
+	case VarIntKernel::AVX2:
+		return CpuFeatures::HasSSSE3() && CpuFeatures::HasAVX2();
+#endif
+	default:
+		return false;
+	}
+}
+
+VarIntKernel VarInt_ResolveKernel(VarIntKernel kernel)
+{
+	if (kernel == VarIntKernel::Auto)
+	{
+		if (VarInt_KernelSupported(VarIntKernel::AVX2))
+			return VarIntKernel::AVX2;
+		if (VarInt_KernelSupported(VarIntKernel::SSSE3))
+			return VarIntKernel::SSSE3;
+		return VarIntKernel::Scalar;
+	}
+	return VarInt_KernelSupported(kernel) ? kernel : VarIntKernel::Scalar;
+}
+
+size_t VarInt_EncodeLEB128(const uint64_t* values, size_t count, uint8_t* out)
+{
+	return EncodeLEB128<false>(values, count, out);
+}
+
+size_t VarInt_EncodeLEB128(const int64_t* values, size_t count, uint8_t* out)
+{
+	return EncodeLEB128<true>(values, count, out);
+}
+
+VarIntStatus VarInt_DecodeLEB128(const uint8_t* in, size_t size, uint64_t* values, size_t count, size_t* used)
+{
+	return DecodeLEB128Array<false>(in, size, values, count, used);
+}
+
+VarIntStatus VarInt_DecodeLEB128(const uint8_t* in, size_t size, int64_t* values, size_t count, size_t* used)
+{
+	return DecodeLEB128Array<true>(in, size, values, count, used);
+}
+
+size_t VarInt_EncodeStreamVByte(const uint32_t* values, size_t count, uint8_t* out)
+{
+	return EncodeStreamVByte<false>(values, count, out);
+}
+
+size_t VarInt_EncodeStreamVByte(const int32_t* values, size_t count, uint8_t* out)
+{
+	return EncodeStreamVByte<true>(values, count, out);
+}
+
+VarIntStatus VarInt_DecodeStreamVByte(const uint8_t* in, size_t size, uint32_t* values, size_t count, size_t* used, VarIntKernel kernel)
+{
+	return DecodeStreamVByte<false>(in, size, values, count, used, kernel);
+}
+
+VarIntStatus VarInt_DecodeStreamVByte(const uint8_t* in, size_t size, int32_t* values, size_t count, size_t* used, VarIntKernel kernel)
+{
+	// int32_t and uint32_t may be accessed through each other.
+	return DecodeStreamVByte<true>(in, size, reinterpret_cast<uint32_t*>(values), count, used, kernel);
+}
+
+// ---------------------------------------------------------------- streams
+
+LEB128Writer::LEB128Writer(std::ostream& stream) : m_stream(stream), m_buffer(StreamBufferBytes), m_used(0) {}
+
+LEB128Writer::~LEB128Writer()
+{
+	Flush();
+}
+
+void LEB128Writer::Write(const uint64_t* values, size_t count)
+{
+	while (count > 0)
+	{
+		size_t room = (m_buffer.size() - m_used) / VarInt_LEB128MaxBytes;
+		if (room == 0)
+		{
+			Flush();
+			continue;
+		}
+		size_t n = std::min(room, count);
+		m_used += VarInt_EncodeLEB128(values, n, m_buffer.data() + m_used);
+		values += n;
+		count -= n;
+	}
+}
+
+bool LEB128Writer::Flush()
+{
+	m_stream.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<std::streamsize>(m_used));
+	m_used = 0;
+	return !m_stream.fail();
+}
+
+LEB128Reader::LEB128Reader(std::istream& stream)
+	: m_stream(stream), m_buffer(StreamBufferBytes), m_begin(0), m_end(0), m_eof(false), m_status(VarIntStatus::Ok) {}
+
+bool LEB128Reader::Refill()
+{
+	// Carries the unread bytes, fewer than one value's worth, over to the front of the buffer.
+	std::copy(m_buffer.begin() + m_begin, m_buffer.begin() + m_end, m_buffer.begin());
+	m_end -= m_begin;
+	m_begin = 0;
+	m_stream.read(reinterpret_cast<char*>(m_buffer.data() + m_end), static_cast<std::streamsize>(m_buffer.size() - m_end));
+	m_end += static_cast<size_t>(m_stream.gcount());
+	if (m_stream.bad())
+	{
+		m_status = VarIntStatus::StreamError;
+		return false;
+	}
+	m_eof = m_stream.eof();
+	return true;
+}
+
+size_t LEB128Reader::Read(uint64_t* values, size_t maxCount)
+{
+	size_t done = 0;
+	while (done < maxCount && m_status == VarIntStatus::Ok)
+	{
+		if (m_end - m_begin < VarInt_LEB128MaxBytes && !m_eof && !Refill())
+			break;
+		if (m_begin == m_end)
+			break;
+		// Until the stream has ended, only values that start at least VarInt_LEB128MaxBytes before the end of the
+		//  buffer are read, so that none of them can be cut off by it.
+		const uint8_t* p = m_buffer.data() + m_begin;
+		const uint8_t* end = m_buffer.data() + m_end;
+		const uint8_t* stop = m_eof ? end : end - (VarInt_LEB128MaxBytes - 1);
+		m_status = DecodeLEB128<false>(p, stop, end, values, maxCount, done);
+		m_begin = static_cast<size_t>(p - m_buffer.data());
+	}
+	return done;
+}
+
+StreamVByteWriter::StreamVByteWriter(std::ostream& stream)
+	: m_stream(stream), m_encoded(4 + VarInt_StreamVByteMaxBytes(BlockValues))
+{
+	m_values.reserve(BlockValues);
+}
+
+StreamVByteWriter::~StreamVByteWriter()
+{
+	Flush();
+}
+
+void StreamVByteWriter::Write(const uint32_t* values, size_t count)
+{
+	while (count > 0)
+	{
+		size_t n = std::min(BlockValues - m_values.size(), count);
+		m_values.insert(m_values.end(), values, values + n);
+		values += n;
+		count -= n;
+		if (m_values.size() == BlockValues)
+			Flush();
+	}
+}
+
+bool StreamVByteWriter::Flush()
+{
+	if (!m_values.empty())
+	{
+		Store32(m_encoded.data(), static_cast<uint32_t>(m_values.size()));
+		size_t size = 4 + VarInt_EncodeStreamVByte(m_values.data(), m_values.size(), m_encoded.data() + 4);
+		m_stream.write(reinterpret_cast<const char*>(m_encoded.data()), static_cast<std::streamsize>(size));
+		m_values.clear();
+	}
+	return !m_stream.fail();
+}
+
+StreamVByteReader::StreamVByteReader(std::istream& stream, VarIntKernel kernel)
+	: m_stream(stream), m_kernel(kernel), m_encoded(VarInt_StreamVByteMaxBytes(BlockValues)), m_next(0), m_status(VarIntStatus::Ok)
+{
+	m_values.reserve(BlockValues);
+}
+
+bool StreamVByteReader::NextBlock()
+{
+	uint8_t header[4];
+	m_stream.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (m_stream.gcount() == 0 && m_stream.eof() && !m_stream.bad())
+		return false;
+	if (static_cast<size_t>(m_stream.gcount()) != sizeof(header))
+	{
+		m_status = m_stream.bad() ? VarIntStatus::StreamError : VarIntStatus::Truncated;
+		return false;
+	}
+	size_t count = Load32(header);
+	if (count > BlockValues)
+	{
+		m_status = VarIntStatus::Overflow;
+		return false;
+	}
+	// The control bytes first, which give the length of the data.
+	size_t controlBytes = (count + 3) / 4;
+	if (!ReadExactly(m_stream, m_encoded.data(), controlBytes, m_status))
+		return false;
+	size_t size = controlBytes + StreamVByteDataLength(m_encoded.data(), count);
+	if (!ReadExactly(m_stream, m_encoded.data() + controlBytes, size - controlBytes, m_status))
+		return false;
+	m_values.resize(count);
+	m_next = 0;
+	m_status = VarInt_DecodeStreamVByte(m_encoded.data(), size, m_values.data(), count, nullptr, m_kernel);
+	return m_status == VarIntStatus::Ok;
+}
+
+size_t StreamVByteReader::Read(uint32_t* values, size_t maxCount)
+{
+	size_t done = 0;
+	while (done < maxCount && m_status == VarIntStatus::Ok)
+	{
+		if (m_next == m_values.size() && !NextBlock())
+			break;
+		size_t n = std::min(maxCount - done, m_values.size() - m_next);
+		std::copy(m_values.begin() + m_next, m_values.begin() + m_next + n, values + done);
+		m_next += n;
+		done += n;
+	}
+	return done;
+}
@@ -0,0 +1,193 @@
+/*
+Title: Representation of Integers and Floating Point numbers
+File Name: Vec3Batch.cpp
+Copyright  2016
+Author: Andrew Litfin
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../header/Vec3Batch.h"
+#include "../header/CpuFeatures.h"
+
+#if defined(NUMBERS_X86)
+#include <immintrin.h>
+#endif
+
+// Compute the dot product of two vec3s
+float Vec3_DotProduct(vec3 lhs, vec3 rhs)
+{
+	return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+}
+
+namespace
+{
+	void DotProductScalar(const float* xs, const float* ys, const float* zs, size_t begin, size_t count,
+		vec3 normal, float* out)
+	{
+		for (size_t i = begin; i < count; ++i)
+			out[i] = xs[i] * normal.x + ys[i] * normal.y + zs[i] * normal.z;
+	}
+
+	void AoSToSoAScalar(const vec3* points, size_t begin, size_t count, float* xs, float* ys, float* zs)
+	{
+		for (size_t i = begin; i < count; ++i)
+		{
+			xs[i] = points[i].x;
+			ys[i] = points[i].y;
+			zs[i] = points[i].z;
+		}
+	}
+
+#if defined(NUMBERS_X86)
+	NUMBERS_TARGET("sse2")
+	void DotProductSSE2(const float* xs, const float* ys, const float* zs, size_t count, vec3 normal, float* out)
+	{
+		const __m128 nx = _mm_set1_ps(normal.x);
+		const __m128 ny = _mm_set1_ps(normal.y);
+		const __m128 nz = _mm_set1_ps(normal.z);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 xy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(xs + i), nx), _mm_mul_ps(_mm_loadu_ps(ys + i), ny));
+			_mm_storeu_ps(out + i, _mm_add_ps(xy, _mm_mul_ps(_mm_loadu_ps(zs + i), nz)));
+		}
+		DotProductScalar(xs, ys, zs, i, count, normal, out);
+	}
+
+	NUMBERS_TARGET("avx2")
+	void DotProductAVX2(const float* xs, const float* ys, const float* zs, size_t count, vec3 normal, float* out)
+	{
+		const __m256 nx = _mm256_set1_ps(normal.x);
+		const __m256 ny = _mm256_set1_ps(normal.y);
+		const __m256 nz = _mm256_set1_ps(normal.z);
+		size_t i = 0;
+		// Two vectors per iteration hide the latency of the add chain.
+		for (; i + 16 <= count; i += 16)
+		{
+			__m256 xy0 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(xs + i), nx), _mm256_mul_ps(_mm256_loadu_ps(ys + i), ny));
+			__m256 xy1 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(xs + i + 8), nx), _mm256_mul_ps(_mm256_loadu_ps(ys + i + 8), ny));
+			_mm256_storeu_ps(out + i, _mm256_add_ps(xy0, _mm256_mul_ps(_mm256_loadu_ps(zs + i), nz)));
+			_mm256_storeu_ps(out + i + 8, _mm256_add_ps(xy1, _mm256_mul_ps(_mm256_loadu_ps(zs + i + 8), nz)));
+		}
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 xy = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(xs + i), nx), _mm256_mul_ps(_mm256_loadu_ps(ys + i), ny));
+			_mm256_storeu_ps(out + i, _mm256_add_ps(xy, _mm256_mul_ps(_mm256_loadu_ps(zs + i), nz)));
+		}
+		DotProductScalar(xs, ys, zs, i, count, normal, out);
+	}
+
+	// Four points (12 floats) are three unaligned loads:
+	//  a0 = x0 y0 z0 x1, a1 = y1 z1 x2 y2, a2 = z2 x3 y3 z3
+	// and seven shuffles regroup them by component.
+	NUMBERS_TARGET("sse2")
+	void AoSToSoASSE2(const vec3* points, size_t count, float* xs, float* ys, float* zs)
+	{
+		const float* in = &points[0].x;
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4, in += 12)
+		{
+			__m128 a0 = _mm_loadu_ps(in);
+			__m128 a1 = _mm_loadu_ps(in + 4);
+			__m128 a2 = _mm_loadu_ps(in + 8);
+			__m128 x2y2x3y3 = _mm_shuffle_ps(a1, a2, _MM_SHUFFLE(2, 1, 3, 2));
+			__m128 y0z0y1y1 = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(0, 0, 2, 1));
+			__m128 z1z1z2z3 = _mm_shuffle_ps(a1, a2, _MM_SHUFFLE(3, 0, 1, 1));
+			__m128 z0z0z1z1 = _mm_shuffle_ps(y0z0y1y1, z1z1z2z3, _MM_SHUFFLE(0, 0, 1, 1));
+			_mm_storeu_ps(xs + i, _mm_shuffle_ps(a0, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0)));
+			_mm_storeu_ps(ys + i, _mm_shuffle_ps(y0z0y1y1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0)));
+			_mm_storeu_ps(zs + i, _mm_shuffle_ps(z0z0z1z1, z1z1z2z3, _MM_SHUFFLE(3, 2, 2, 0)));
+		}
+		AoSToSoAScalar(points, i, count, xs, ys, zs);
+	}
+#endif
+}
+
+bool Vec3_KernelSupported(Vec3Kernel kernel)
+{
+	switch (kernel)
+	{
+	case Vec3Kernel::Auto:
+	case Vec3Kernel::Scalar:
+		return true;
+#if defined(NUMBERS_X86)
+	case Vec3Kernel::SSE2:
+		return CpuFeatures::HasSSE2();
+	case Vec3Kernel::AVX2:
+		return CpuFeatures::HasAVX2();
+#endif
+	default:
+		return false;
+	}
+}
+
+Vec3Kernel Vec3_ResolveKernel(Vec3Kernel kernel)
+{
+	if (kernel == Vec3Kernel::Auto)
+	{
+		if (CpuFeatures::HasAVX2())
+			return Vec3Kernel::AVX2;
+		if (CpuFeatures::HasSSE2())
+			return Vec3Kernel::SSE2;
+		return Vec3Kernel::Scalar;
+	}
+	return Vec3_KernelSupported(kernel) ? kernel : Vec3Kernel::Scalar;
+}
+
+void Vec3_AoSToSoA(const vec3* points, size_t count, float* xs, float* ys, float* zs)
+{
+#if defined(NUMBERS_X86)
+	if (CpuFeatures::HasSSE2())
+	{
+		AoSToSoASSE2(points, count, xs, ys, zs);
+		return;
+	}
+#endif
+	AoSToSoAScalar(points, 0, count, xs, ys, zs);
+}
+
+vec3SoA Vec3_ToSoA(const vec3* points, size_t count)
+{
+	vec3SoA soa;
+	soa.resize(count);
+	if (count > 0)
+		Vec3_AoSToSoA(points, count, soa.x.data(), soa.y.data(), soa.z.data());
+	return soa;
+}
+
+void Vec3_DotProductBatch(const float* xs, const float* ys, const float* zs, size_t count,
+	vec3 normal, float* out, Vec3Kernel kernel)
+{
+	switch (Vec3_ResolveKernel(kernel))
+	{
+#if defined(NUMBERS_X86)
+	case Vec3Kernel::AVX2:
+		DotProductAVX2(xs, ys, zs, count, normal, out);
+		return;
+	case Vec3Kernel::SSE2:
+		DotProductSSE2(xs, ys, zs, count, normal, out);
+		return;
+#endif
+	default:
+		DotProductScalar(xs, ys, zs, 0, count, normal, out);
+		return;
+	}
+}
+
+void Vec3_DotProductBatch(const vec3SoA& points, vec3 normal, float* out, Vec3Kernel kernel)
+{
+	Vec3_DotProductBatch(points.x.data(), points.y.data(), points.z.data(), points.size(), normal, out, kernel);
+}
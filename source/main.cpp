@@ -28,10 +28,42 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "../header/ClassDeclarations.h"
 
-int main() {
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// True when standard input is a console or terminal rather than a file, a pipe or nothing at all.
+static bool InputIsInteractive()
+{
+#if defined(_WIN32)
+	return _isatty(_fileno(stdin)) != 0;
+#else
+	return isatty(fileno(stdin)) != 0;
+#endif
+}
+
+int main(int argc, char* argv[]) {
+	// "Numbers --benchmark" times the batch kernels instead of running the examples.
+	if (argc > 1 && std::strcmp(argv[1], "--benchmark") == 0)
+	{
+		Benchmarks::RunAll();
+		return 0;
+	}
+	// "Numbers --check" runs the correctness checks; the exit code is non-zero if one fails.
+	if (argc > 1 && std::strcmp(argv[1], "--check") == 0)
+		return SelfChecks::RunAll() ? 0 : 1;
+
 	Integers::IntegersExample();
 	FloatingPoint::FloatingPointExample();
 
-	std::cin.ignore();
+	// Keep the console window open when the program is started from Visual Studio or Explorer,
+	//  but not when input is redirected or absent (scripts, CI), where waiting for a key would hang.
+	if (InputIsInteractive())
+		std::cin.ignore();
 	return 0;
 }